@@ -0,0 +1,431 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "gf256.hpp"
+
+/// A Cauchy Reed-Solomon code over GF(2^8) computed with XORs only. Each
+/// coefficient e of the generator matrix is replaced by the 8 x 8 matrix
+/// over GF(2) of the multiplication by e, whose column c holds the bits of
+/// e * 2^c. The symbols are split into groups of 8 packets, packet b of a
+/// group standing for bit b of its bytes, so a coding packet is the XOR of
+/// the data packets selected by its row of the bit matrix.
+///
+/// The XORs are scheduled as in Jerasure's "smart" schedules: the coding
+/// packets are computed in a greedy order, each one either from scratch or
+/// from an already computed packet whose row differs in fewer bits. The
+/// matrix is the "good" Cauchy matrix, scaled to minimize its ones. The
+/// sources of each packet are XORed together in one pass, a SIMD register
+/// at a time.
+struct cauchy_bitmatrix_codec
+{
+    /// A packet of a group: the symbol (device) and the bit
+    struct packet
+    {
+        uint32_t device;
+        uint32_t bit;
+    };
+
+    /// A computed packet, the XOR of its sources
+    struct operation
+    {
+        packet destination;
+        std::vector<packet> sources;
+    };
+
+    typedef std::vector<operation> schedule;
+
+    cauchy_bitmatrix_codec(uint32_t k, uint32_t m, uint32_t packet_size) :
+        m_k(k), m_m(m), m_packet_size(packet_size)
+    {
+        assert(k > 0 && m > 0 && k + m <= 256);
+        assert(packet_size > 0);
+
+        m_matrix = good_cauchy_matrix(k, m);
+
+        // The coding packets from the data packets
+        std::vector<uint32_t> data(k), coding(m);
+        for (uint32_t i = 0; i < k; i++)
+            data[i] = i;
+        for (uint32_t i = 0; i < m; i++)
+            coding[i] = k + i;
+
+        m_encoding = smart_schedule(bit_rows(m_matrix, m, k), data, coding);
+    }
+
+    /// Compute the m coding symbols from the k data symbols of size bytes
+    void encode(uint8_t** data, uint8_t** coding, uint32_t size) const
+    {
+        std::vector<uint8_t*> symbols(data, data + m_k);
+        symbols.insert(symbols.end(), coding, coding + m_m);
+        run(m_encoding, &symbols[0], size);
+    }
+
+    /// Recover the erased symbols, given by their indices (data symbols
+    /// first, then coding symbols), in place in the k + m symbols. Returns
+    /// false if more than m symbols are erased.
+    bool decode(const std::vector<uint32_t>& erased, uint8_t** symbols,
+        uint32_t size) const
+    {
+        if (erased.size() > m_m)
+            return false;
+
+        std::vector<bool> lost(m_k + m_m, false);
+        for (uint32_t e : erased)
+            lost[e] = true;
+
+        // The first k surviving symbols, and their rows of the generator
+        // matrix (identity for the data symbols)
+        std::vector<uint32_t> survivors;
+        std::vector<uint8_t> rows;
+        for (uint32_t i = 0; i < m_k + m_m && survivors.size() < m_k; i++)
+        {
+            if (lost[i])
+                continue;
+
+            survivors.push_back(i);
+            for (uint32_t j = 0; j < m_k; j++)
+            {
+                rows.push_back(i < m_k ? (i == j) :
+                    m_matrix[(i - m_k) * m_k + j]);
+            }
+        }
+
+        std::vector<uint32_t> lost_data, lost_coding;
+        for (uint32_t e : erased)
+            (e < m_k ? lost_data : lost_coding).push_back(e);
+
+        // The lost data symbols from the survivors, through the rows of the
+        // inverse
+        if (!lost_data.empty())
+        {
+            std::vector<uint8_t> inverse;
+            if (!gf256::invert(rows, inverse, m_k))
+                return false;
+
+            std::vector<uint8_t> recovery;
+            for (uint32_t e : lost_data)
+            {
+                recovery.insert(recovery.end(), &inverse[e * m_k],
+                    &inverse[e * m_k] + m_k);
+            }
+
+            run(smart_schedule(bit_rows(recovery, lost_data.size(), m_k),
+                survivors, lost_data), symbols, size);
+        }
+
+        // The lost coding symbols from the complete data
+        if (!lost_coding.empty())
+        {
+            std::vector<uint8_t> regeneration;
+            std::vector<uint32_t> data(m_k);
+            for (uint32_t i = 0; i < m_k; i++)
+                data[i] = i;
+
+            for (uint32_t e : lost_coding)
+            {
+                regeneration.insert(regeneration.end(),
+                    &m_matrix[(e - m_k) * m_k],
+                    &m_matrix[(e - m_k) * m_k] + m_k);
+            }
+
+            run(smart_schedule(bit_rows(regeneration, lost_coding.size(),
+                m_k), data, lost_coding), symbols, size);
+        }
+
+        return true;
+    }
+
+    /// The number of XORs of packets per group of the encoding
+    uint32_t encoding_xors() const
+    {
+        uint32_t xors = 0;
+        for (const auto& op : m_encoding)
+            xors += std::max<uint32_t>(1, op.sources.size()) - 1;
+        return xors;
+    }
+
+    /// The generator matrix, m rows of k coefficients
+    const std::vector<uint8_t>& matrix() const
+    {
+        return m_matrix;
+    }
+
+    /// The Cauchy matrix 1 / (x_i + y_j) with x_i = i and y_j = m + j,
+    /// whose columns are scaled so that the first row is all ones, and
+    /// whose following rows are each scaled by the inverse of the element
+    /// giving the fewest ones in their bit matrices
+    static std::vector<uint8_t> good_cauchy_matrix(uint32_t k, uint32_t m)
+    {
+        std::vector<uint8_t> a(m * k);
+        for (uint32_t i = 0; i < m; i++)
+            for (uint32_t j = 0; j < k; j++)
+                a[i * k + j] = gf256::inv((uint8_t)(i ^ (m + j)));
+
+        for (uint32_t j = 0; j < k; j++)
+        {
+            uint8_t scale = gf256::inv(a[j]);
+            for (uint32_t i = 0; i < m; i++)
+                a[i * k + j] = gf256::mul(a[i * k + j], scale);
+        }
+
+        for (uint32_t i = 1; i < m; i++)
+        {
+            uint32_t best = row_ones(&a[i * k], k, 1);
+            uint8_t best_scale = 1;
+            for (uint32_t j = 0; j < k; j++)
+            {
+                uint8_t scale = gf256::inv(a[i * k + j]);
+                uint32_t ones = row_ones(&a[i * k], k, scale);
+                if (ones < best)
+                {
+                    best = ones;
+                    best_scale = scale;
+                }
+            }
+
+            for (uint32_t j = 0; j < k; j++)
+                a[i * k + j] = gf256::mul(a[i * k + j], best_scale);
+        }
+        return a;
+    }
+
+    /// The number of ones of the bit matrix of e
+    static uint32_t ones(uint8_t e)
+    {
+        uint32_t n = 0;
+        for (uint32_t c = 0; c < 8; c++)
+            n += __builtin_popcount(gf256::mul(e, (uint8_t)(1 << c)));
+        return n;
+    }
+
+private:
+
+    static uint32_t row_ones(const uint8_t* row, uint32_t k, uint8_t scale)
+    {
+        uint32_t n = 0;
+        for (uint32_t j = 0; j < k; j++)
+            n += ones(gf256::mul(row[j], scale));
+        return n;
+    }
+
+    /// The bit matrix of the rows x columns matrix a: 8 * rows rows of
+    /// 8 * columns bits, bit 8 * j + c of row 8 * i + r being bit r of
+    /// a[i][j] * 2^c
+    static std::vector<std::vector<uint8_t>> bit_rows(
+        const std::vector<uint8_t>& a, uint32_t rows, uint32_t columns)
+    {
+        std::vector<std::vector<uint8_t>> bits(8 * rows,
+            std::vector<uint8_t>(8 * columns, 0));
+
+        for (uint32_t i = 0; i < rows; i++)
+        {
+            for (uint32_t j = 0; j < columns; j++)
+            {
+                for (uint32_t c = 0; c < 8; c++)
+                {
+                    uint8_t column = gf256::mul(a[i * columns + j],
+                        (uint8_t)(1 << c));
+                    for (uint32_t r = 0; r < 8; r++)
+                        bits[8 * i + r][8 * j + c] = (column >> r) & 1;
+                }
+            }
+        }
+        return bits;
+    }
+
+    /// Schedule the computation of the packets of the outputs symbols from
+    /// the packets of the inputs symbols, given the bit rows of the outputs
+    static schedule smart_schedule(
+        const std::vector<std::vector<uint8_t>>& rows,
+        const std::vector<uint32_t>& inputs,
+        const std::vector<uint32_t>& outputs)
+    {
+        uint32_t n = rows.size();
+        uint32_t width = rows.empty() ? 0 : rows[0].size();
+
+        // The number of sources of each row, from scratch at first, and
+        // the computed row it is best derived from
+        std::vector<uint32_t> cost(n);
+        std::vector<int32_t> from(n, -1);
+        std::vector<bool> done(n, false);
+        for (uint32_t i = 0; i < n; i++)
+            cost[i] = std::count(rows[i].begin(), rows[i].end(), 1);
+
+        schedule s;
+        for (uint32_t step = 0; step < n; step++)
+        {
+            uint32_t row = n;
+            for (uint32_t i = 0; i < n; i++)
+            {
+                if (!done[i] && (row == n || cost[i] < cost[row]))
+                    row = i;
+            }
+            done[row] = true;
+
+            operation op;
+            op.destination = { outputs[row / 8], row % 8 };
+
+            if (from[row] >= 0)
+            {
+                op.sources.push_back({ outputs[from[row] / 8],
+                    (uint32_t)from[row] % 8 });
+            }
+
+            for (uint32_t t = 0; t < width; t++)
+            {
+                uint8_t bit = rows[row][t];
+                if (from[row] >= 0)
+                    bit ^= rows[from[row]][t];
+                if (bit)
+                    op.sources.push_back({ inputs[t / 8], t % 8 });
+            }
+            s.push_back(op);
+
+            // The remaining rows may be cheaper from this one
+            for (uint32_t i = 0; i < n; i++)
+            {
+                if (done[i])
+                    continue;
+
+                uint32_t c = 1;
+                for (uint32_t t = 0; t < width; t++)
+                    c += rows[i][t] ^ rows[row][t];
+
+                if (c < cost[i])
+                {
+                    cost[i] = c;
+                    from[i] = row;
+                }
+            }
+        }
+        return s;
+    }
+
+    /// Execute a schedule on the groups of the symbols. The last group may
+    /// have shorter packets, size being a multiple of 8.
+    void run(const schedule& s, uint8_t** symbols, uint32_t size) const
+    {
+        assert(size % 8 == 0);
+
+        std::vector<const uint8_t*> sources;
+        for (uint32_t offset = 0; offset < size; offset += 8 * m_packet_size)
+        {
+            uint32_t length = std::min(m_packet_size, (size - offset) / 8);
+
+            for (const auto& op : s)
+            {
+                sources.clear();
+                for (const auto& p : op.sources)
+                {
+                    sources.push_back(symbols[p.device] + offset +
+                        p.bit * length);
+                }
+
+                uint8_t* destination = symbols[op.destination.device] +
+                    offset + op.destination.bit * length;
+
+                xor_packets(destination, sources, length);
+            }
+        }
+    }
+
+    /// Write the XOR of the sources to the destination, a few registers at
+    /// a time, with AVX2 or SSE2 as enabled at compile time (the SIMD_SHARED
+    /// flags of the wscript)
+    static void xor_packets(uint8_t* destination,
+        const std::vector<const uint8_t*>& sources, uint32_t length)
+    {
+        if (sources.empty())
+        {
+            memset(destination, 0, length);
+            return;
+        }
+
+        uint32_t n = sources.size();
+        uint32_t i = 0;
+
+#if defined(__AVX2__)
+        for (; i + 128 <= length; i += 128)
+        {
+            __m256i x[4];
+            for (uint32_t r = 0; r < 4; r++)
+            {
+                x[r] = _mm256_loadu_si256(
+                    (const __m256i*)(sources[0] + i + 32 * r));
+            }
+
+            for (uint32_t s = 1; s < n; s++)
+            {
+                for (uint32_t r = 0; r < 4; r++)
+                {
+                    x[r] = _mm256_xor_si256(x[r], _mm256_loadu_si256(
+                        (const __m256i*)(sources[s] + i + 32 * r)));
+                }
+            }
+
+            for (uint32_t r = 0; r < 4; r++)
+                _mm256_storeu_si256((__m256i*)(destination + i + 32 * r), x[r]);
+        }
+#elif defined(__SSE2__)
+        for (; i + 64 <= length; i += 64)
+        {
+            __m128i x[4];
+            for (uint32_t r = 0; r < 4; r++)
+            {
+                x[r] = _mm_loadu_si128(
+                    (const __m128i*)(sources[0] + i + 16 * r));
+            }
+
+            for (uint32_t s = 1; s < n; s++)
+            {
+                for (uint32_t r = 0; r < 4; r++)
+                {
+                    x[r] = _mm_xor_si128(x[r], _mm_loadu_si128(
+                        (const __m128i*)(sources[s] + i + 16 * r)));
+                }
+            }
+
+            for (uint32_t r = 0; r < 4; r++)
+                _mm_storeu_si128((__m128i*)(destination + i + 16 * r), x[r]);
+        }
+#endif
+
+        for (; i < length; i++)
+        {
+            uint8_t x = sources[0][i];
+            for (uint32_t s = 1; s < n; s++)
+                x ^= sources[s][i];
+            destination[i] = x;
+        }
+    }
+
+private:
+
+    /// The numbers of data and coding symbols
+    uint32_t m_k;
+    uint32_t m_m;
+
+    /// The size of a packet, a group of a symbol being 8 packets
+    uint32_t m_packet_size;
+
+    /// The generator matrix, m rows of k coefficients
+    std::vector<uint8_t> m_matrix;
+
+    /// The schedule of the encoding
+    schedule m_encoding;
+};
@@ -0,0 +1,288 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+#include "../cauchy_bitmatrix.hpp"
+#include "../erasure_pattern.hpp"
+#include "../throughput_benchmark.hpp"
+
+/// The packet size of the codecs created by the next encoders and decoders
+static uint32_t cauchy_packet_size = 2048;
+
+struct cauchy_encoder
+{
+    cauchy_encoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
+        m_codec(symbols, encoded_symbols, cauchy_packet_size),
+        m_symbols(symbols), m_symbol_size(symbol_size),
+        m_payload_count(encoded_symbols)
+    {
+        // Symbol size must be a multiple of 8 (the packets of a group)
+        assert(m_symbol_size % 8 == 0);
+
+        m_block_size = m_symbols * m_symbol_size;
+
+        // Allocate the data symbols followed by the coding symbols
+        m_buffer.resize((m_symbols + m_payload_count) * m_symbol_size);
+        for (uint32_t i = 0; i < m_symbols + m_payload_count; i++)
+            m_buffs.push_back(&m_buffer[i * m_symbol_size]);
+
+        // Make random data
+        for (uint32_t i = 0; i < m_block_size; i++)
+            m_buffer[i] = rand();
+    }
+
+    void encode_all()
+    {
+        m_codec.encode(&m_buffs[0], &m_buffs[m_symbols], m_symbol_size);
+    }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+    uint32_t payload_count() { return m_payload_count; }
+
+    /// The number of XORs of packets per group of the encoding
+    uint32_t encoding_xors() { return m_codec.encoding_xors(); }
+
+protected:
+
+    friend struct cauchy_decoder;
+
+    cauchy_bitmatrix_codec m_codec;
+
+    std::vector<uint8_t> m_buffer;
+    std::vector<uint8_t*> m_buffs;
+
+    // Number of data symbols
+    uint32_t m_symbols;
+    // Size of a symbol
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Number of generated payloads
+    uint32_t m_payload_count;
+};
+
+/// Recovers the erased data symbols from the surviving data and coding
+/// symbols of the encoder. The inverse of the surviving rows and the XOR
+/// schedule of the recovery are computed by each decoding.
+struct cauchy_decoder
+{
+    cauchy_decoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols,
+        const erasure_pattern& erasures = erasure_pattern()) :
+        m_codec(symbols, encoded_symbols, cauchy_packet_size),
+        m_symbols(symbols), m_symbol_size(symbol_size),
+        m_payload_count(encoded_symbols), m_complete(false)
+    {
+        m_block_size = m_symbols * m_symbol_size;
+
+        std::set<uint32_t> erased =
+            erasures.generate(m_symbols, encoded_symbols);
+        m_erased.assign(erased.begin(), erased.end());
+
+        // The recovered symbols
+        m_buffer.resize(m_erased.size() * m_symbol_size);
+    }
+
+    uint32_t decode_all(std::shared_ptr<cauchy_encoder> encoder)
+    {
+        assert(encoder->payload_count() == m_payload_count);
+
+        // The surviving symbols are read from the encoder, the erased ones
+        // are written to the decoder
+        std::vector<uint8_t*> symbols = encoder->m_buffs;
+        for (uint32_t i = 0; i < m_erased.size(); i++)
+            symbols[m_erased[i]] = &m_buffer[i * m_symbol_size];
+
+        m_complete = m_codec.decode(m_erased, &symbols[0], m_symbol_size);
+
+        return m_payload_count;
+    }
+
+    bool verify_data(std::shared_ptr<cauchy_encoder> encoder)
+    {
+        assert(m_block_size == encoder->block_size());
+
+        for (uint32_t i = 0; i < m_erased.size(); i++)
+        {
+            if (memcmp(&m_buffer[i * m_symbol_size],
+                encoder->m_buffs[m_erased[i]], m_symbol_size))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool is_complete() { return m_complete; }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+
+protected:
+
+    cauchy_bitmatrix_codec m_codec;
+
+    // The erased data symbols, and their recovered copies
+    std::vector<uint32_t> m_erased;
+    std::vector<uint8_t> m_buffer;
+
+    // Number of data symbols
+    uint32_t m_symbols;
+    // Size of a symbol
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Number of coding symbols
+    uint32_t m_payload_count;
+    // Whether the last decoding succeeded
+    bool m_complete;
+};
+
+/// The throughput benchmark with the packet size of the packet_size option,
+/// and the number of XORs per group of the encoding schedule
+struct cauchy_throughput :
+    public throughput_benchmark<cauchy_encoder, cauchy_decoder>
+{
+    typedef throughput_benchmark<cauchy_encoder, cauchy_decoder> base;
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        base::get_options(options);
+        cauchy_packet_size = options["packet_size"].as<uint32_t>();
+    }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        if (!results.has_column("xors"))
+            results.add_column("xors");
+
+        results.set_value("xors", m_encoder->encoding_xors());
+    }
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(throughput_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<double> loss_rate;
+    loss_rate.push_back(0.5);
+
+    auto default_loss_rate =
+        gauge::po::value<std::vector<double>>()->default_value(
+            loss_rate, "")->multitoken();
+
+    // Symbol size must be a multiple of 64
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1000000);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    std::vector<std::string> erasure_models;
+    erasure_models.push_back("uniform");
+
+    auto default_erasure_models =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            erasure_models, "")->multitoken();
+
+    auto default_burst_length = gauge::po::value<uint32_t>()->default_value(4);
+
+    auto default_failure_domains =
+        gauge::po::value<uint32_t>()->default_value(8);
+
+    auto default_packet_size =
+        gauge::po::value<uint32_t>()->default_value(2048);
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("loss_rate", default_loss_rate, "Set the ratio of repair symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    options.add_options()
+        ("erasure_model", default_erasure_models,
+         "Set the erasure model of the decoders "
+         "[uniform|burst|markov|failure_domain]");
+
+    options.add_options()
+        ("burst_length", default_burst_length,
+         "Set the (mean) burst length of the burst and markov models");
+
+    options.add_options()
+        ("failure_domains", default_failure_domains,
+         "Set the number of failure domains of the failure_domain model");
+
+    options.add_options()
+        ("packet_size", default_packet_size,
+         "Set the size in bytes of the packets XORed by the codec, a group "
+         "of a symbol being 8 packets");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// Cauchy Reed-Solomon bit matrix
+//------------------------------------------------------------------
+
+BENCHMARK_F_INLINE(cauchy_throughput, CauchyBitmatrix, ErasureCode, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+/// Measures the latency of a degraded read: a client reads range_size
+/// bytes of an erased source symbol, which the decoder reconstructs from
+/// the same byte range of k surviving symbols only, as each byte of a
+/// symbol only depends on the bytes at the same offset.
+template<class Encoder, class Decoder>
+struct degraded_read_benchmark : public gauge::time_benchmark
+{
+    void store_run(tables::table& results)
+    {
+        // The time spent per read, in microseconds
+        if (!results.has_column("latency"))
+            results.add_column("latency");
+
+        results.set_value("latency", measurement());
+    }
+
+    bool needs_warmup_iteration()
+    {
+        return false;
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t range_size = cs.get_value<uint32_t>("range_size");
+
+        // At this point, the read range should be equal to the original
+        assert(m_decoder->verify_range(m_encoder, m_symbol, m_offset,
+            range_size, &m_range[0]));
+        (void)range_size;
+
+        return true;
+    }
+
+    std::string unit_text() const
+    {
+        return "us";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto loss_rate = options["loss_rate"].as<std::vector<double> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto range_size = options["range_size"].as<std::vector<uint32_t> >();
+
+        assert(symbols.size() > 0);
+        assert(loss_rate.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(range_size.size() > 0);
+
+        for (const auto& s : symbols)
+        {
+            for (const auto& r : loss_rate)
+            {
+                for (const auto& p : symbol_size)
+                {
+                    for (const auto& g : range_size)
+                    {
+                        // The range must fit in a symbol
+                        if (g > p)
+                            continue;
+
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("symbols", s);
+                        cs.set_value<uint32_t>("symbol_size", p);
+                        cs.set_value<double>("loss_rate", r);
+                        cs.set_value<uint32_t>("range_size", g);
+
+                        // At least the read symbol is erased
+                        uint32_t erased =
+                            std::max(1U, (uint32_t)std::ceil(s * r));
+                        cs.set_value<uint32_t>("erased_symbols", erased);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t erased_symbols = cs.get_value<uint32_t>("erased_symbols");
+        uint32_t range_size = cs.get_value<uint32_t>("range_size");
+
+        m_encoder = std::make_shared<Encoder>(
+            symbols, symbol_size, erased_symbols);
+        m_decoder = std::make_shared<Decoder>(
+            symbols, symbol_size, erased_symbols);
+
+        // Read a random range of an erased symbol
+        m_symbol = m_decoder->erased_symbol();
+        m_offset = rand() % (symbol_size - range_size + 1);
+        m_range.resize(range_size);
+
+        m_encoder->encode_all();
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t range_size = cs.get_value<uint32_t>("range_size");
+
+        // The clock is running
+        RUN
+        {
+            m_decoder->decode_range(m_encoder, m_symbol, m_offset,
+                range_size, &m_range[0]);
+        }
+    }
+
+protected:
+
+    /// The encoder
+    std::shared_ptr<Encoder> m_encoder;
+
+    /// The decoder
+    std::shared_ptr<Decoder> m_decoder;
+
+    /// The erased symbol that is read, and the offset of the range
+    uint32_t m_symbol;
+    uint32_t m_offset;
+
+    /// The bytes read
+    std::vector<uint8_t> m_range;
+};
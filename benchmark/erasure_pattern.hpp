@@ -0,0 +1,130 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+/// Selects which source symbols of a block are erased by the decoders of
+/// the throughput benchmarks. Every model erases exactly the requested
+/// number of symbols, only their positions differ:
+///  - "uniform": symbols picked uniformly at random;
+///  - "burst": runs of burst_length consecutive symbols at random places;
+///  - "markov": a two-state (Gilbert-Elliott) Markov chain, as the one of
+///    examples/openfec/tx_simulator.c, whose loss state lasts burst_length
+///    symbols on average and whose stationary loss rate is the requested
+///    one. The chain runs over the block until enough symbols are lost;
+///  - "failure_domain": the symbols are striped over failure_domains
+///    domains (symbol i is stored in domain i % failure_domains) and whole
+///    domains are lost, the last one partially to reach the exact count.
+struct erasure_pattern
+{
+    erasure_pattern(const std::string& model = "uniform",
+        uint32_t burst_length = 4, uint32_t failure_domains = 8) :
+        m_model(model), m_burst_length(std::max(1U, burst_length)),
+        m_failure_domains(std::max(1U, failure_domains))
+    {
+        assert(is_model(m_model));
+    }
+
+    /// Whether a model name is known
+    static bool is_model(const std::string& model)
+    {
+        return model == "uniform" || model == "burst" || model == "markov" ||
+            model == "failure_domain";
+    }
+
+    /// Pick the erased symbols among symbols source symbols
+    std::set<uint32_t> generate(uint32_t symbols, uint32_t erased) const
+    {
+        assert(erased <= symbols);
+
+        std::set<uint32_t> pattern;
+
+        if (m_model == "burst")
+        {
+            while (pattern.size() < erased)
+            {
+                uint32_t start = rand() % symbols;
+                for (uint32_t i = 0; i < m_burst_length &&
+                     start + i < symbols && pattern.size() < erased; i++)
+                {
+                    pattern.insert(start + i);
+                }
+            }
+        }
+        else if (m_model == "markov")
+        {
+            // Probabilities of leaving the loss and the no loss states
+            double p_success_when_losses = 1.0 / m_burst_length;
+            double rate = (double)erased / symbols;
+            double p_loss_when_ok = (rate < 1.0) ?
+                std::min(1.0, rate * p_success_when_losses / (1.0 - rate)) :
+                1.0;
+
+            bool lost = false;
+            while (pattern.size() < erased)
+            {
+                for (uint32_t i = 0; i < symbols && pattern.size() < erased;
+                     i++)
+                {
+                    double p = (double)rand() / RAND_MAX;
+                    lost = lost ? (p >= p_success_when_losses) :
+                        (p < p_loss_when_ok);
+                    if (lost)
+                        pattern.insert(i);
+                }
+            }
+        }
+        else if (m_model == "failure_domain")
+        {
+            // The domains in a random order
+            std::vector<uint32_t> domains(m_failure_domains);
+            for (uint32_t d = 0; d < m_failure_domains; d++)
+            {
+                uint32_t j = rand() % (d + 1);
+                domains[d] = domains[j];
+                domains[j] = d;
+            }
+
+            for (uint32_t d = 0; pattern.size() < erased; d++)
+            {
+                for (uint32_t i = domains[d]; i < symbols &&
+                     pattern.size() < erased; i += m_failure_domains)
+                {
+                    pattern.insert(i);
+                }
+            }
+        }
+        else
+        {
+            while (pattern.size() < erased)
+            {
+                pattern.insert(rand() % symbols);
+            }
+        }
+
+        assert(pattern.size() == erased);
+        return pattern;
+    }
+
+    const std::string& model() const
+    {
+        return m_model;
+    }
+
+private:
+
+    std::string m_model;
+    uint32_t m_burst_length;
+    uint32_t m_failure_domains;
+};
@@ -0,0 +1,187 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "gf256.hpp"
+#include "isa_intrinsics.hpp"
+
+namespace fixed_rs
+{
+    /// GF{2} to the power e
+    constexpr uint8_t gf_pow2(uint32_t e)
+    {
+        return e == 0 ? 1 : gf256::mul2(gf_pow2(e - 1));
+    }
+
+    /// The coefficient of source j in parity r of the matrix of
+    /// gf_gen_rs_matrix(): the row of parity r is the powers of GF{2}^r
+    constexpr uint8_t coefficient(uint32_t r, uint32_t j)
+    {
+        return gf_pow2((r * j) % 255);
+    }
+
+    /// A list of indices, built in a logarithmic number of instantiations
+    template<uint32_t... I>
+    struct indices
+    {
+        typedef indices type;
+    };
+
+    template<class A, class B>
+    struct concat;
+
+    template<uint32_t... A, uint32_t... B>
+    struct concat<indices<A...>, indices<B...>> :
+        indices<A..., (sizeof...(A) + B)...>
+    { };
+
+    template<uint32_t N>
+    struct make_indices :
+        concat<typename make_indices<N / 2>::type,
+            typename make_indices<N - N / 2>::type>
+    { };
+
+    template<>
+    struct make_indices<0> : indices<>
+    { };
+
+    template<>
+    struct make_indices<1> : indices<0>
+    { };
+
+    /// Entry i of the 32-byte tables of the coefficients of a matrix with k
+    /// columns (as ec_init_tables()): the products of the coefficient by
+    /// the 16 low then the 16 high halves of a byte
+    constexpr uint8_t table_entry(uint32_t k, uint32_t i)
+    {
+        return gf256::product(coefficient(i / (32 * k), (i / 32) % k),
+            (uint8_t)((i % 32) < 16 ? i % 32 : (i % 32 - 16) << 4));
+    }
+
+    /// The tables of the M x K coefficients, parity by parity then source by
+    /// source, computed at compile time
+    template<uint32_t K, uint32_t M,
+        class Indices = typename make_indices<M * K * 32>::type>
+    struct tables;
+
+    template<uint32_t K, uint32_t M, uint32_t... I>
+    struct tables<K, M, indices<I...>>
+    {
+        static constexpr uint8_t values[sizeof...(I)] = { table_entry(K, I)... };
+    };
+
+    template<uint32_t K, uint32_t M, uint32_t... I>
+    constexpr uint8_t tables<K, M, indices<I...>>::values[sizeof...(I)];
+
+    /// Encodes K source symbols into M parity symbols with the generator
+    /// matrix of gf_gen_rs_matrix(), for a geometry fixed at compile time.
+    /// The 32-byte tables of the coefficients (as ec_init_tables()) are
+    /// constants, so there is no table setup per call, and the loops over
+    /// the sources and the parities are fully unrolled: the M parities are
+    /// accumulated in registers, for block registers of each source at a
+    /// time. Simd is one of the instruction sets of isa_intrinsics.
+    template<uint32_t K, uint32_t M, class Simd>
+    struct encoder
+    {
+        static_assert(K > 0 && M > 0 && K + M <= 255,
+            "The geometry must fit in GF(2^8)");
+
+        typedef typename Simd::value_type value_type;
+
+        /// The number of registers of each source processed at a time. The
+        /// 2 * M accumulators still fit in the registers for M <= 4
+        static const uint32_t block = M <= 4 ? 2 : 1;
+
+        /// Encode the K data symbols of len bytes into the M coding symbols
+        static void encode(uint32_t len, unsigned char** data,
+            unsigned char** coding)
+        {
+            uint32_t i = 0;
+            for (; i + block * Simd::width <= len; i += block * Simd::width)
+                encode_block<block>(i, data, coding);
+
+            for (; i + Simd::width <= len; i += Simd::width)
+                encode_block<1>(i, data, coding);
+
+            for (; i < len; i++)
+            {
+                for (uint32_t r = 0; r < M; r++)
+                {
+                    unsigned char s = 0;
+                    for (uint32_t j = 0; j < K; j++)
+                    {
+                        s ^= isa_intrinsics::multiply(data[j][i],
+                            &tables<K, M>::values[32 * (r * K + j)]);
+                    }
+                    coding[r][i] = s;
+                }
+            }
+        }
+
+    private:
+
+        template<uint32_t N>
+        using constant = std::integral_constant<uint32_t, N>;
+
+        /// Compute B registers of each parity from the offset i
+        template<uint32_t B>
+        static inline void encode_block(uint32_t i, unsigned char** data,
+            unsigned char** coding)
+        {
+            value_type p[M * B];
+            for (uint32_t r = 0; r < M * B; r++)
+                p[r] = Simd::zero();
+
+            add_source<B>(p, data, i, constant<0>());
+
+            for (uint32_t r = 0; r < M; r++)
+                for (uint32_t b = 0; b < B; b++)
+                    Simd::store(coding[r] + i + b * Simd::width, p[r * B + b]);
+        }
+
+        /// Add the products of source J, and of the following ones, to the
+        /// parities
+        template<uint32_t B, uint32_t J>
+        static inline void add_source(value_type* p, unsigned char** data,
+            uint32_t i, constant<J>)
+        {
+            value_type x[B];
+            for (uint32_t b = 0; b < B; b++)
+                x[b] = Simd::load(data[J] + i + b * Simd::width);
+
+            add_products<B, J>(p, x, constant<0>());
+            add_source<B>(p, data, i, constant<J + 1>());
+        }
+
+        template<uint32_t B>
+        static inline void add_source(value_type*, unsigned char**, uint32_t,
+            constant<K>)
+        { }
+
+        /// Add the products of source J by the coefficients of parity R, and
+        /// of the following ones
+        template<uint32_t B, uint32_t J, uint32_t R>
+        static inline void add_products(value_type* p, const value_type* x,
+            constant<R>)
+        {
+            const uint8_t* tbl = &tables<K, M>::values[32 * (R * K + J)];
+            for (uint32_t b = 0; b < B; b++)
+            {
+                p[R * B + b] = Simd::add(p[R * B + b],
+                    Simd::multiply(x[b], tbl));
+            }
+            add_products<B, J>(p, x, constant<R + 1>());
+        }
+
+        template<uint32_t B, uint32_t J>
+        static inline void add_products(value_type*, const value_type*,
+            constant<M>)
+        { }
+    };
+}
@@ -0,0 +1,129 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <vector>
+
+/// Arithmetic in GF(2^8) with the polynomial of ISA and Jerasure (0x11d)
+struct gf256
+{
+    /// The product of a by GF{2}
+    static constexpr uint8_t mul2(uint8_t a)
+    {
+        return (uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1d : 0));
+    }
+
+    /// The product of a and b computed bit by bit, without the log tables,
+    /// so that it is also a constant expression (the tables of fixed_rs)
+    static constexpr uint8_t product(uint8_t a, uint8_t b)
+    {
+        return b == 0 ? 0 :
+            (uint8_t)(((b & 1) ? a : 0) ^ product(mul2(a), b >> 1));
+    }
+
+    static uint8_t mul(uint8_t a, uint8_t b)
+    {
+        if (a == 0 || b == 0)
+            return 0;
+        return tables().exp[tables().log[a] + tables().log[b]];
+    }
+
+    static uint8_t inv(uint8_t a)
+    {
+        assert(a != 0);
+        return tables().exp[255 - tables().log[a]];
+    }
+
+    static uint8_t div(uint8_t a, uint8_t b)
+    {
+        return mul(a, inv(b));
+    }
+
+    /// GF{2} to the power e
+    static uint8_t pow2(uint32_t e)
+    {
+        return tables().exp[e % 255];
+    }
+
+    /// Invert the n x n matrix in (destroyed) into out, returns false if it
+    /// is singular
+    static bool invert(std::vector<uint8_t> in, std::vector<uint8_t>& out,
+        uint32_t n)
+    {
+        out.assign(n * n, 0);
+        for (uint32_t i = 0; i < n; i++)
+            out[i * n + i] = 1;
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            // A pivot for column i
+            uint32_t p = i;
+            while (p < n && in[p * n + i] == 0)
+                p++;
+            if (p == n)
+                return false;
+
+            for (uint32_t j = 0; j < n; j++)
+            {
+                std::swap(in[i * n + j], in[p * n + j]);
+                std::swap(out[i * n + j], out[p * n + j]);
+            }
+
+            uint8_t scale = inv(in[i * n + i]);
+            for (uint32_t j = 0; j < n; j++)
+            {
+                in[i * n + j] = mul(in[i * n + j], scale);
+                out[i * n + j] = mul(out[i * n + j], scale);
+            }
+
+            for (uint32_t r = 0; r < n; r++)
+            {
+                uint8_t c = in[r * n + i];
+                if (r == i || c == 0)
+                    continue;
+
+                for (uint32_t j = 0; j < n; j++)
+                {
+                    in[r * n + j] ^= mul(c, in[i * n + j]);
+                    out[r * n + j] ^= mul(c, out[i * n + j]);
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+
+    struct log_tables
+    {
+        log_tables()
+        {
+            uint32_t x = 1;
+            for (uint32_t i = 0; i < 255; i++)
+            {
+                exp[i] = exp[i + 255] = (uint8_t)x;
+                log[x] = (uint8_t)i;
+                x <<= 1;
+                if (x & 0x100)
+                    x ^= 0x11d;
+            }
+            log[0] = 0;
+        }
+
+        uint8_t exp[510];
+        uint8_t log[256];
+    };
+
+    static const log_tables& tables()
+    {
+        static const log_tables t;
+        return t;
+    }
+};
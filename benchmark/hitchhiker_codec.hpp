@@ -0,0 +1,226 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <vector>
+
+#include "isa_linear_codec.hpp"
+
+/// The piggybacked RS code of Hitchhiker (the XOR version), with the
+/// storage overhead of the RS code of k + m symbols. Each symbol is split
+/// into two substripes a and b (its halves), both encoded with the RS code.
+/// The data symbols are split into m - 1 groups, and the XOR of the a
+/// halves of group g is added (piggybacked) to the b half of parity g + 1.
+///
+/// A lost data symbol j of group g is repaired by reading:
+/// - the b halves of the k - 1 other data symbols and of parity 0, which
+///   give b_j;
+/// - the b half of parity g + 1, which with all the b halves gives the
+///   piggyback;
+/// - the a halves of the other symbols of the group, which with the
+///   piggyback give a_j.
+/// That is k + |g| halves instead of the 2k halves of RS. The parities
+/// are computed again from the k data symbols.
+struct hitchhiker_codec
+{
+    hitchhiker_codec(uint32_t k, uint32_t m) :
+        m_k(k), m_m(m), m_code(isa_linear_codec::cauchy(k, m))
+    {
+        // A parity without piggyback, and at least one with
+        assert(m >= 2);
+
+        std::vector<uint8_t> a(m * k);
+        for (uint32_t i = 0; i < m; i++)
+            std::copy(m_code.row(k + i), m_code.row(k + i) + k, &a[i * k]);
+
+        m_tables.resize(k * m * 32);
+        ec_init_tables(k, m, a.data(), m_tables.data());
+
+        // The XORs of the piggybacks are multiply-accumulates by 1
+        std::vector<uint8_t> ones(k, 1);
+        m_ones.resize(k * 32);
+        ec_init_tables(k, 1, ones.data(), m_ones.data());
+    }
+
+    uint32_t k() const { return m_k; }
+    uint32_t n() const { return m_k + m_m; }
+
+    /// The piggyback group of data symbol j, the groups being contiguous
+    uint32_t group(uint32_t j) const
+    {
+        return j * (m_m - 1) / m_k;
+    }
+
+    /// Compute the m parities from the k data symbols of size bytes (an
+    /// even size), the n symbols following each other in symbols
+    void encode(uint8_t** symbols, uint32_t size) const
+    {
+        assert(size % 2 == 0);
+        uint32_t half = size / 2;
+
+        std::vector<uint8_t*> a = halves(symbols, 0, half);
+        std::vector<uint8_t*> b = halves(symbols, 1, half);
+
+        ec_encode_data(half, m_k, m_m, (unsigned char*)m_tables.data(),
+            a.data(), &a[m_k]);
+        ec_encode_data(half, m_k, m_m, (unsigned char*)m_tables.data(),
+            b.data(), &b[m_k]);
+
+        for (uint32_t j = 0; j < m_k; j++)
+            add(a[j], b[m_k + group(j) + 1], half);
+    }
+
+    /// Recover the erased symbols in place in the n symbols: the a
+    /// substripe with the RS code, then the b substripe once the
+    /// piggybacks are removed from its parities. Returns the number of
+    /// bytes read by the two decodings, or 0 if the erasures cannot be
+    /// decoded.
+    uint64_t decode(const std::vector<uint32_t>& erased, uint8_t** symbols,
+        uint32_t size) const
+    {
+        if (erased.empty())
+            return 0;
+
+        uint32_t half = size / 2;
+        std::vector<uint8_t*> a = halves(symbols, 0, half);
+        std::vector<uint8_t*> b = halves(symbols, 1, half);
+
+        uint64_t read_a = m_code.decode(erased, a.data(), half);
+        if (read_a == 0)
+            return 0;
+
+        std::vector<bool> lost(n(), false);
+        for (uint32_t e : erased)
+            lost[e] = true;
+
+        // The surviving piggybacked parities, without their piggybacks
+        std::vector<uint8_t> plain((m_m - 1) * half);
+        for (uint32_t i = 1; i < m_m; i++)
+        {
+            if (lost[m_k + i])
+                continue;
+
+            uint8_t* p = &plain[(i - 1) * half];
+            memcpy(p, b[m_k + i], half);
+            for (uint32_t j = 0; j < m_k; j++)
+            {
+                if (group(j) + 1 == i)
+                    add(a[j], p, half);
+            }
+            b[m_k + i] = p;
+        }
+
+        uint64_t read_b = m_code.decode(erased, b.data(), half);
+        if (read_b == 0)
+            return 0;
+
+        // The piggybacks of the lost parities
+        for (uint32_t e : erased)
+        {
+            if (e <= m_k)
+                continue;
+
+            for (uint32_t j = 0; j < m_k; j++)
+            {
+                if (group(j) + 1 == e - m_k)
+                    add(a[j], b[e], half);
+            }
+        }
+
+        return read_a + read_b;
+    }
+
+    /// Recover the single erased symbol e in place. Returns the number of
+    /// bytes read.
+    uint64_t repair(uint32_t e, uint8_t** symbols, uint32_t size) const
+    {
+        uint32_t half = size / 2;
+        std::vector<uint8_t*> a = halves(symbols, 0, half);
+        std::vector<uint8_t*> b = halves(symbols, 1, half);
+
+        if (e >= m_k)
+        {
+            // A parity is computed again from the data symbols
+            uint32_t i = e - m_k;
+            unsigned char* tables =
+                (unsigned char*)&m_tables[i * m_k * 32];
+
+            ec_encode_data(half, m_k, 1, tables, a.data(), &a[e]);
+            ec_encode_data(half, m_k, 1, tables, b.data(), &b[e]);
+
+            for (uint32_t j = 0; j < m_k; j++)
+            {
+                if (i > 0 && group(j) + 1 == i)
+                    add(a[j], b[e], half);
+            }
+            return (uint64_t)m_k * size;
+        }
+
+        // b_e from the k - 1 other data symbols and parity 0, the first
+        // survivors of the b substripe
+        uint64_t read = m_code.repair(e, b.data(), half);
+
+        // The piggyback is the b half of the parity of the group minus the
+        // parity of the complete b substripe, a_e is the piggyback minus
+        // the a halves of the other symbols of the group
+        uint32_t p = m_k + group(e) + 1;
+        ec_encode_data(half, m_k, 1,
+            (unsigned char*)&m_tables[(p - m_k) * m_k * 32], b.data(),
+            &a[e]);
+
+        add(b[p], a[e], half);
+        read += half;
+
+        for (uint32_t j = 0; j < m_k; j++)
+        {
+            if (j != e && group(j) == group(e))
+            {
+                add(a[j], a[e], half);
+                read += half;
+            }
+        }
+
+        return read;
+    }
+
+private:
+
+    /// The halves h of the n symbols
+    std::vector<uint8_t*> halves(uint8_t** symbols, uint32_t h,
+        uint32_t half) const
+    {
+        std::vector<uint8_t*> v(n());
+        for (uint32_t i = 0; i < n(); i++)
+            v[i] = symbols[i] + h * half;
+        return v;
+    }
+
+    /// dest += src, with the multiply-accumulate kernel of ISA. The
+    /// vectorized versions need 32 bytes at least, and leave dest
+    /// unchanged below
+    void add(uint8_t* src, uint8_t* dest, uint32_t len) const
+    {
+        unsigned char* ones = (unsigned char*)m_ones.data();
+        if (len >= 32)
+            gf_vect_mad(len, m_k, 0, ones, src, dest);
+        else
+            gf_vect_mad_base(len, m_k, 0, ones, src, dest);
+    }
+
+    uint32_t m_k;
+    uint32_t m_m;
+
+    // The RS code of both substripes
+    isa_linear_codec m_code;
+
+    // The tables of the m parities, and of a coefficient of 1
+    std::vector<uint8_t> m_tables;
+    std::vector<uint8_t> m_ones;
+};
@@ -9,6 +9,9 @@
 #include <cstdlib>
 #include <cstring>  // for memset, memcmp
 
+#include <algorithm>
+#include <string>
+#include <tuple>
 #include <vector>
 #include <set>
 
@@ -22,6 +25,8 @@ extern "C"
 #include "test.h"
 }
 
+#include "../isa_kernel_tuner.hpp"
+
 
 #define TEST_SOURCES 250
 #define MMAX TEST_SOURCES
@@ -390,6 +395,557 @@ public:
     }
 };
 
+/// Benchmark fixture for the encoding of vectors larger than the cache,
+/// over the sizes of the nt_size option, with the kernel selected by
+/// ec_encode_data() for each size
+class arithmetic_encode_large_setup : public arithmetic_setup
+{
+public:
+
+    using base = arithmetic_setup;
+
+public:
+
+    arithmetic_encode_large_setup() :
+        m_streaming(false)
+    { }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto sizes = options["nt_size"].as<std::vector<uint32_t>>();
+        auto vectors = options["vectors"].as<std::vector<uint32_t>>();
+        auto prefetch = options["prefetch"].as<std::vector<uint32_t>>();
+
+        assert(sizes.size() > 0);
+        assert(vectors.size() > 0);
+        assert(prefetch.size() > 0);
+
+        for (const auto& s : sizes)
+        {
+            for (const auto& v : vectors)
+            {
+                for (const auto& p : prefetch)
+                {
+                    // Only the streaming kernels take a prefetch distance
+                    if (!m_streaming && p != prefetch[0])
+                        continue;
+
+                    gauge::config_set cs;
+                    cs.set_value<uint32_t>("size", s);
+                    cs.set_value<uint32_t>("vectors", v);
+                    cs.set_value<uint32_t>("prefetch", p);
+
+                    add_configuration(cs);
+                }
+            }
+        }
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t prefetch = cs.get_value<uint32_t>("prefetch");
+
+        RUN
+        {
+            // Make parity vects
+            ec_init_tables(vectors, vectors, &a[vectors * vectors], g_tbls);
+
+            uint8_t** data = m_symbols_two.data();
+            uint8_t** coding = m_symbols_one.data();
+            uint8_t* table = base::g_tbls;
+
+            if (m_streaming)
+            {
+                ec_encode_data_nt(size, vectors, vectors, table, data, coding,
+                    prefetch);
+            }
+            else
+            {
+                ec_encode_data(size, vectors, vectors, table, data, coding);
+            }
+        }
+    }
+
+protected:
+
+    /// Whether the streaming stores of ec_encode_data_nt() are always used
+    bool m_streaming;
+};
+
+/// Benchmark fixture for the encoding of vectors larger than the cache with
+/// streaming stores and prefetching at every size
+class arithmetic_encode_nt_setup : public arithmetic_encode_large_setup
+{
+public:
+
+    arithmetic_encode_nt_setup()
+    {
+        m_streaming = true;
+    }
+};
+
+/// Benchmark fixture for the expansion of the coefficients of a k x m
+/// matrix into the 32-byte tables used by the dot products, as done for
+/// each erasure pattern before decoding
+class table_expansion_setup : public gauge::time_benchmark
+{
+public:
+
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        // The nanoseconds per expanded coefficient
+        return time * 1000 / (vectors * rows);
+    }
+
+    void store_run(tables::table& results)
+    {
+        if(!results.has_column("time_per_table"))
+            results.add_column("time_per_table");
+
+        results.set_value("time_per_table", measurement());
+    }
+
+    std::string unit_text() const
+    {
+        return "ns";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto vectors = options["vectors"].as<std::vector<uint32_t>>();
+        auto rows = options["rows"].as<std::vector<uint32_t>>();
+
+        assert(vectors.size() > 0);
+        assert(rows.size() > 0);
+
+        for (const auto& v : vectors)
+        {
+            for (const auto& r : rows)
+            {
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("vectors", v);
+                cs.set_value<uint32_t>("rows", r);
+
+                add_configuration(cs);
+            }
+        }
+    }
+
+    /// Prepares the data structures between each run
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        gf_gen_rs_matrix(a, vectors + rows, vectors);
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        // The tables must match the ones of the baseline version
+        std::vector<uint8_t> tables(vectors * rows * 32);
+        ec_init_tables_base(vectors, rows, &a[vectors * vectors],
+            tables.data());
+        assert(memcmp(tables.data(), g_tbls, tables.size()) == 0);
+
+        return true;
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        RUN
+        {
+            ec_init_tables(vectors, rows, &a[vectors * vectors], g_tbls);
+        }
+    }
+
+protected:
+
+    uint8_t a[MMAX*KMAX];
+    uint8_t g_tbls[KMAX*TEST_SOURCES*32];
+};
+
+class table_expansion_base_setup : public table_expansion_setup
+{
+public:
+
+    using base = table_expansion_setup;
+
+    using base::g_tbls;
+    using base::a;
+
+public:
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        RUN
+        {
+            ec_init_tables_base(vectors, rows, &a[vectors * vectors], g_tbls);
+        }
+    }
+};
+
+/// Benchmark fixture for the inversion of the decoding matrix of a Cauchy
+/// code with k source symbols, losses of which are replaced by parity
+/// symbols, by Gauss-Jordan elimination with scalar row operations
+class matrix_inversion_setup : public gauge::time_benchmark
+{
+public:
+
+    double measurement()
+    {
+        // The time spent per inversion
+        return gauge::time_benchmark::measurement();
+    }
+
+    void store_run(tables::table& results)
+    {
+        if(!results.has_column("latency"))
+            results.add_column("latency");
+
+        results.set_value("latency", measurement());
+    }
+
+    std::string unit_text() const
+    {
+        return "us";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto sizes = options["matrix_size"].as<std::vector<uint32_t>>();
+        auto losses = options["losses"].as<uint32_t>();
+
+        assert(sizes.size() > 0);
+
+        for (const auto& k : sizes)
+        {
+            // The Cauchy matrix has at most 255 rows
+            assert(k > 0 && k < 255);
+
+            gauge::config_set cs;
+            cs.set_value<uint32_t>("k", k);
+            cs.set_value<uint32_t>("losses",
+                std::min(losses, std::min(k, 255 - k)));
+
+            add_configuration(cs);
+        }
+    }
+
+    /// Prepares the data structures between each run
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t k = cs.get_value<uint32_t>("k");
+        uint32_t losses = cs.get_value<uint32_t>("losses");
+
+        gf_gen_cauchy1_matrix(a, k + losses, k);
+
+        // Lose random source symbols, the k remaining rows make the
+        // decoding matrix
+        std::set<uint32_t> lost;
+        while (lost.size() < losses)
+            lost.insert(rand() % k);
+
+        m_rows.clear();
+        for (uint32_t i = 0; i < k + losses; ++i)
+        {
+            if (lost.count(i) == 0)
+                m_rows.push_back(i);
+        }
+
+        m_matrix.resize(k * k);
+        for (uint32_t i = 0; i < k; ++i)
+            memcpy(&m_matrix[i * k], &a[m_rows[i] * k], k);
+
+        m_inverse.resize(k * k);
+        m_scratch.resize(k * k);
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+
+        // The inverse must match the one of the baseline version
+        std::vector<uint8_t> inverse(k * k);
+        m_scratch = m_matrix;
+        gf_invert_matrix(m_scratch.data(), inverse.data(), k);
+        assert(inverse == m_inverse);
+
+        return true;
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+
+        RUN
+        {
+            // The elimination overwrites its input
+            m_scratch = m_matrix;
+            gf_invert_matrix(m_scratch.data(), m_inverse.data(), k);
+        }
+    }
+
+protected:
+
+    uint8_t a[MMAX*KMAX];
+
+    /// The rows of the generator matrix making the decoding matrix
+    std::vector<uint8_t> m_rows;
+
+    /// The decoding matrix, its copy being inverted, and its inverse
+    std::vector<uint8_t> m_matrix;
+    std::vector<uint8_t> m_scratch;
+    std::vector<uint8_t> m_inverse;
+};
+
+class matrix_inversion_mad_setup : public matrix_inversion_setup
+{
+public:
+
+    using base = matrix_inversion_setup;
+
+    using base::m_matrix;
+    using base::m_scratch;
+    using base::m_inverse;
+
+public:
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+
+        RUN
+        {
+            // The elimination overwrites its input
+            m_scratch = m_matrix;
+            gf_invert_matrix_mad(m_scratch.data(), m_inverse.data(), k);
+        }
+    }
+};
+
+class matrix_inversion_cauchy_setup : public matrix_inversion_setup
+{
+public:
+
+    using base = matrix_inversion_setup;
+
+    using base::m_rows;
+    using base::m_inverse;
+
+public:
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+
+        RUN
+        {
+            gf_invert_cauchy1_submatrix(m_rows.data(), m_inverse.data(), k);
+        }
+    }
+};
+
+/// Benchmark fixture for the auto-tuner of the ISA encode paths: each
+/// candidate kernel of isa_kernel_tuner computes rows output vectors from
+/// the vectors sources, and the fastest one of each (vectors, rows, size)
+/// problem is kept in the tuning_file read by the TunedErasureCode
+/// benchmark of isa_throughput. The problems found in the tuning_file are
+/// tuned again, the other ones are kept.
+class kernel_tuning_setup : public arithmetic_setup
+{
+public:
+
+    using base = arithmetic_setup;
+
+    using base::m_symbols_one;
+    using base::m_symbols_two;
+    using base::m_data_one;
+    using base::m_data_two;
+    using base::g_tbls;
+    using base::a;
+
+public:
+
+    kernel_tuning_setup() :
+        m_valid(false)
+    { }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        gauge::config_set cs = get_current_configuration();
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        // The entry of a problem is replaced by the first measurement of
+        // this execution
+        auto problem = std::make_tuple(vectors, rows, size);
+        if (m_tuned.insert(problem).second)
+            m_tuner.clear(vectors, rows, size);
+
+        if (!m_valid)
+            return;
+
+        isa_kernel_tuner::kernel entry = m_kernel;
+        entry.m_time = gauge::time_benchmark::measurement();
+        m_tuner.update(vectors, rows, size, entry);
+
+        if (!m_tuner.save(m_tuning_file))
+            printf("Cannot write the tuning file %s\n", m_tuning_file.c_str());
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto sizes = options["size"].as<std::vector<uint32_t>>();
+        auto vectors = options["vectors"].as<std::vector<uint32_t>>();
+        auto rows = options["rows"].as<std::vector<uint32_t>>();
+
+        assert(sizes.size() > 0);
+        assert(vectors.size() > 0);
+        assert(rows.size() > 0);
+
+        m_tuning_file = options["tuning_file"].as<std::string>();
+        m_tuner.load(m_tuning_file);
+
+        for (const auto& s : sizes)
+        {
+            for (const auto& v : vectors)
+            {
+                for (const auto& r : rows)
+                {
+                    for (const auto& k : isa_kernel_tuner::candidates(s))
+                    {
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("size", s);
+                        cs.set_value<uint32_t>("vectors", v);
+                        cs.set_value<uint32_t>("rows", r);
+                        cs.set_value<std::string>("kernel", k.name());
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Prepares the data structures between each run
+    void setup()
+    {
+        base::setup();
+
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+        std::string kernel = cs.get_value<std::string>("kernel");
+
+        // Random sources, and the rows output vectors
+        for (auto& b : m_data_two)
+            b = rand() % 256;
+
+        m_data_one.resize(rows * size);
+        m_symbols_one.resize(rows);
+        for (uint32_t i = 0; i < rows; ++i)
+            m_symbols_one[i] = &m_data_one[i * size];
+
+        // Random coefficients
+        for (uint32_t i = 0; i < vectors * rows; ++i)
+            a[i] = rand() % 256;
+        ec_init_tables(vectors, rows, a, g_tbls);
+
+        for (const auto& k : isa_kernel_tuner::candidates(size))
+        {
+            if (k.name() == kernel)
+                m_kernel = k;
+        }
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        // A candidate must produce the output of ec_encode_data()
+        aligned_vector data(rows * size);
+        std::vector<uint8_t*> expected(rows);
+        for (uint32_t i = 0; i < rows; ++i)
+            expected[i] = &data[i * size];
+
+        ec_encode_data(size, vectors, rows, g_tbls, m_symbols_two.data(),
+            expected.data());
+
+        m_valid = (data == m_data_one);
+        return true;
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t vectors = cs.get_value<uint32_t>("vectors");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        RUN
+        {
+            isa_kernel_tuner::run(m_kernel, size, vectors, rows, g_tbls,
+                m_symbols_two.data(), m_symbols_one.data());
+        }
+    }
+
+protected:
+
+    /// The kernels selected so far, saved to the tuning_file
+    isa_kernel_tuner m_tuner;
+    std::string m_tuning_file;
+
+    /// The problems measured by this execution
+    std::set<std::tuple<uint32_t, uint32_t, uint32_t>> m_tuned;
+
+    /// The kernel of the current configuration, and whether its output
+    /// matched the one of ec_encode_data()
+    isa_kernel_tuner::kernel m_kernel;
+    bool m_valid;
+};
+
 /// Using this macro we may specify options. For specifying options
 /// we use the boost program options library. So you may additional
 /// details on how to do it in the manual for that library.
@@ -406,6 +962,41 @@ BENCHMARK_OPTION(arithmetic_options)
         default_value({8,16,32}, "")->multitoken(),
         "Set the number of vectors to perform the operations on");
 
+    options.add_options()
+        ("nt_size", gauge::po::value<std::vector<uint32_t>>()->default_value(
+        {65536,1048576,4194304}, "")->multitoken(),
+        "Set the sizes of a vector in bytes of the dot_product_encode_large "
+        "and dot_product_encode_nt benchmarks");
+
+    options.add_options()
+        ("prefetch", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({0,512,1024}, "")->multitoken(),
+        "Set the prefetch distances in bytes of the dot_product_encode_nt "
+        "benchmark");
+
+    options.add_options()
+        ("rows", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({1,4,8}, "")->multitoken(),
+        "Set the number of rows of the tables expanded by the "
+        "table_expansion benchmarks, and of the output vectors of the "
+        "kernel_tuning benchmark");
+
+    options.add_options()
+        ("matrix_size", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({4,16,64,128,250}, "")->multitoken(),
+        "Set the sizes k of the matrices inverted by the matrix_inversion "
+        "benchmarks");
+
+    options.add_options()
+        ("losses", gauge::po::value<uint32_t>()->default_value(4),
+        "Set the number of lost source symbols of the matrix_inversion "
+        "benchmarks");
+
+    options.add_options()
+        ("tuning_file", gauge::po::value<std::string>()->default_value(
+        "isa_tuning.txt"), "Set the file storing the kernels selected by "
+        "the kernel_tuning benchmark");
+
     gauge::runner::instance().register_options(options);
 }
 
@@ -446,6 +1037,48 @@ BENCHMARK_F_INLINE(arithmetic_encode_avx2_setup, ISA, dot_product_encode_avx2, 1
     run_benchmark();
 }
 
+BENCHMARK_F_INLINE(arithmetic_encode_large_setup, ISA,
+    dot_product_encode_large, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(arithmetic_encode_nt_setup, ISA, dot_product_encode_nt, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(table_expansion_setup, ISA, table_expansion, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(table_expansion_base_setup, ISA, table_expansion_base, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(matrix_inversion_setup, ISA, matrix_inversion, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(matrix_inversion_mad_setup, ISA, matrix_inversion_mad, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(matrix_inversion_cauchy_setup, ISA,
+    matrix_inversion_cauchy, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(kernel_tuning_setup, ISA, kernel_tuning, 1)
+{
+    run_benchmark();
+}
+
 int main(int argc, const char* argv[])
 {
     srand(static_cast<uint32_t>(time(0)));
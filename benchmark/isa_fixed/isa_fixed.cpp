@@ -0,0 +1,274 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <cassert>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>  // for memcmp
+
+#include <string>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+extern "C"
+{
+#include "erasure_code.h"
+}
+
+#include "../fixed_rs_encoder.hpp"
+
+/// An encoder specialized for a geometry
+typedef void (*fixed_encode_function)(uint32_t, unsigned char**,
+    unsigned char**);
+
+/// The geometries with a specialized encoder
+struct fixed_geometry
+{
+    uint32_t k;
+    uint32_t m;
+    fixed_encode_function encode;
+};
+
+/// The widest instruction set of the build machine, the wscript_build
+/// only building the benchmark when it has SSSE3
+#ifdef __AVX2__
+typedef isa_intrinsics::avx2 fixed_simd;
+#else
+typedef isa_intrinsics::ssse3 fixed_simd;
+#endif
+
+static const fixed_geometry fixed_geometries[] =
+{
+    { 4, 2, fixed_rs::encoder<4, 2, fixed_simd>::encode },
+    { 6, 3, fixed_rs::encoder<6, 3, fixed_simd>::encode },
+    { 8, 3, fixed_rs::encoder<8, 3, fixed_simd>::encode },
+    { 10, 4, fixed_rs::encoder<10, 4, fixed_simd>::encode },
+    { 12, 4, fixed_rs::encoder<12, 4, fixed_simd>::encode }
+};
+
+/// The specialized encoder of the k + m geometry, if any
+fixed_encode_function find_fixed_encoder(uint32_t k, uint32_t m)
+{
+    for (const auto& g : fixed_geometries)
+    {
+        if (g.k == k && g.m == m)
+            return g.encode;
+    }
+    return nullptr;
+}
+
+/// Benchmark fixture for the encoding of a stripe of k source symbols into
+/// m parity symbols, for the geometries of the geometry option ("k+m"),
+/// either with the encoder specialized for the geometry (Fixed) or with
+/// ec_encode_data() as isa_encoder does
+template<bool Fixed>
+class fixed_geometry_setup : public gauge::time_benchmark
+{
+public:
+
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        gauge::config_set cs = get_current_configuration();
+        uint32_t m = cs.get_value<uint32_t>("m");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // The parity bytes encoded per iteration, as the throughput
+        // benchmarks count them
+        uint64_t bytes = (uint64_t)m * symbol_size;
+
+        return bytes / time; // MB/s for each iteration
+    }
+
+    void store_run(tables::table& results)
+    {
+        if (!results.has_column("goodput"))
+            results.add_column("goodput");
+
+        results.set_value("goodput", measurement());
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+        uint32_t m = cs.get_value<uint32_t>("m");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // The parity symbols must match the ones of the baseline version
+        std::vector<uint8_t> expected(m * symbol_size);
+        std::vector<unsigned char*> outputs(m);
+        for (uint32_t i = 0; i < m; ++i)
+            outputs[i] = &expected[i * symbol_size];
+
+        gf_gen_rs_matrix(m_matrix.data(), k + m, k);
+        ec_init_tables(k, m, &m_matrix[k * k], m_tables.data());
+        ec_encode_data_base(symbol_size, k, m, m_tables.data(),
+            m_data.data(), outputs.data());
+
+        for (uint32_t i = 0; i < m; ++i)
+        {
+            assert(memcmp(outputs[i], m_coding[i], symbol_size) == 0);
+            (void)i;
+        }
+
+        return true;
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto geometries = options["geometry"].as<std::vector<std::string>>();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t>>();
+
+        assert(geometries.size() > 0);
+        assert(symbol_size.size() > 0);
+
+        for (const auto& g : geometries)
+        {
+            uint32_t k = 0, m = 0;
+            if (sscanf(g.c_str(), "%u+%u", &k, &m) != 2 ||
+                !find_fixed_encoder(k, m))
+            {
+                printf("No specialized encoder for the geometry %s\n",
+                    g.c_str());
+                continue;
+            }
+
+            for (const auto& p : symbol_size)
+            {
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("k", k);
+                cs.set_value<uint32_t>("m", m);
+                cs.set_value<uint32_t>("symbol_size", p);
+
+                add_configuration(cs);
+            }
+        }
+    }
+
+    /// Prepares the data structures between each run
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+        uint32_t m = cs.get_value<uint32_t>("m");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        m_buffer.resize((k + m) * symbol_size);
+        for (auto& b : m_buffer)
+            b = rand() % 256;
+
+        m_data.resize(k);
+        for (uint32_t i = 0; i < k; ++i)
+            m_data[i] = &m_buffer[i * symbol_size];
+
+        m_coding.resize(m);
+        for (uint32_t i = 0; i < m; ++i)
+            m_coding[i] = &m_buffer[(k + i) * symbol_size];
+
+        m_matrix.resize((k + m) * k);
+        m_tables.resize(k * m * 32);
+        m_encode = find_fixed_encoder(k, m);
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+        uint32_t m = cs.get_value<uint32_t>("m");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // The clock is running
+        RUN
+        {
+            if (Fixed)
+            {
+                m_encode(symbol_size, m_data.data(), m_coding.data());
+            }
+            else
+            {
+                gf_gen_rs_matrix(m_matrix.data(), k + m, k);
+                ec_init_tables(k, m, &m_matrix[k * k], m_tables.data());
+                ec_encode_data(symbol_size, k, m, m_tables.data(),
+                    m_data.data(), m_coding.data());
+            }
+        }
+    }
+
+protected:
+
+    /// The source symbols followed by the parity symbols
+    std::vector<unsigned char> m_buffer;
+
+    /// The source symbols
+    std::vector<unsigned char*> m_data;
+
+    /// The parity symbols
+    std::vector<unsigned char*> m_coding;
+
+    /// The generator matrix and the tables of ec_encode_data()
+    std::vector<unsigned char> m_matrix;
+    std::vector<unsigned char> m_tables;
+
+    /// The specialized encoder of the geometry
+    fixed_encode_function m_encode;
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(fixed_options)
+{
+    gauge::po::options_description options;
+
+    options.add_options()
+        ("geometry", gauge::po::value<std::vector<std::string>>()->
+        default_value({"4+2", "6+3", "8+3", "10+4", "12+4"}, "")->
+        multitoken(), "Set the geometries k+m of the stripes");
+
+    options.add_options()
+        ("symbol_size", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({4096, 65536, 1048576}, "")->multitoken(),
+        "Set the size of a symbol in bytes");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// ISA Fixed geometries
+//------------------------------------------------------------------
+
+typedef fixed_geometry_setup<true> fixed_encoder_setup;
+typedef fixed_geometry_setup<false> generic_encoder_setup;
+
+BENCHMARK_F_INLINE(fixed_encoder_setup, ISA, FixedGeometryEncoder, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(generic_encoder_setup, ISA, GenericEncoder, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
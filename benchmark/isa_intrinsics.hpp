@@ -0,0 +1,281 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "gf256.hpp"
+
+/// Header-only C++ versions of the ISA dot product and multiply-accumulate
+/// kernels, written with intrinsics so that they build with any compiler
+/// that has them (gcc, clang) and on 32-bit targets, where the yasm kernels
+/// of ISA are not available. The functions take the same parameters and
+/// the same 32-byte tables (ec_init_tables()) as their ISA counterparts.
+///
+/// The instruction sets are the ones enabled at compile time: ssse3 needs
+/// -mssse3 and avx2 needs -mavx2, which the SIMD_SHARED flags of the wscript
+/// give when the build machine has them. A program selecting them at
+/// runtime builds each one in its own translation unit. On other CPUs only
+/// the generic kernels remain.
+namespace isa_intrinsics
+{
+#if defined(__x86_64__) || defined(__i386__)
+#ifdef __SSSE3__
+    /// The operations on 16 bytes at a time
+    struct ssse3
+    {
+        typedef __m128i value_type;
+
+        static const int width = 16;
+
+        static value_type load(const unsigned char* p)
+        {
+            return _mm_loadu_si128((const __m128i*) p);
+        }
+
+        static void store(unsigned char* p, value_type v)
+        {
+            _mm_storeu_si128((__m128i*) p, v);
+        }
+
+        static value_type zero()
+        {
+            return _mm_setzero_si128();
+        }
+
+        static value_type add(value_type a, value_type b)
+        {
+            return _mm_xor_si128(a, b);
+        }
+
+        /// Multiplies the bytes of x by the coefficient of the tables tbl,
+        /// looking up the products of their low and high halves
+        static value_type multiply(value_type x, const unsigned char* tbl)
+        {
+            __m128i mask = _mm_set1_epi8(0x0f);
+            __m128i lo = _mm_loadu_si128((const __m128i*) tbl);
+            __m128i hi = _mm_loadu_si128((const __m128i*) (tbl + 16));
+
+            return _mm_xor_si128(
+                _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        }
+    };
+#endif
+
+#ifdef __AVX2__
+    /// The operations on 32 bytes at a time
+    struct avx2
+    {
+        typedef __m256i value_type;
+
+        static const int width = 32;
+
+        static value_type load(const unsigned char* p)
+        {
+            return _mm256_loadu_si256((const __m256i*) p);
+        }
+
+        static void store(unsigned char* p, value_type v)
+        {
+            _mm256_storeu_si256((__m256i*) p, v);
+        }
+
+        static value_type zero()
+        {
+            return _mm256_setzero_si256();
+        }
+
+        static value_type add(value_type a, value_type b)
+        {
+            return _mm256_xor_si256(a, b);
+        }
+
+        /// Multiplies the bytes of x by the coefficient of the tables tbl,
+        /// the tables being repeated in both lanes
+        static value_type multiply(value_type x, const unsigned char* tbl)
+        {
+            __m256i mask = _mm256_set1_epi8(0x0f);
+            __m256i lo = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i*) tbl));
+            __m256i hi = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i*) (tbl + 16)));
+
+            return _mm256_xor_si256(
+                _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                _mm256_shuffle_epi8(hi,
+                    _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        }
+    };
+#endif
+#endif
+
+    /// The product of a byte by the coefficient of the tables tbl
+    inline unsigned char multiply(unsigned char b, const unsigned char* tbl)
+    {
+        return tbl[b & 0x0f] ^ tbl[16 + (b >> 4)];
+    }
+
+    /// Same as ec_init_tables(): the 32-byte tables of the rows x k
+    /// coefficients of a
+    inline void init_tables(int k, int rows, const unsigned char* a,
+        unsigned char* g_tbls)
+    {
+        for (int i = 0; i < k * rows; i++)
+        {
+            for (int j = 0; j < 16; j++)
+            {
+                g_tbls[32 * i + j] = gf256::mul(a[i], j);
+                g_tbls[32 * i + 16 + j] = gf256::mul(a[i], j << 4);
+            }
+        }
+    }
+
+    /// Same as gf_Nvect_dot_prod() with Vectors outputs: the dot products
+    /// of the k sources with Vectors rows of coefficients. Any length is
+    /// supported, the bytes after the last whole register being computed
+    /// one at a time.
+    template<class Simd, int Vectors>
+    void dot_prod(int len, int k, unsigned char* g_tbls, unsigned char** src,
+        unsigned char** dest)
+    {
+        int i = 0;
+        for (; i + Simd::width <= len; i += Simd::width)
+        {
+            typename Simd::value_type p[Vectors];
+            for (int v = 0; v < Vectors; v++)
+                p[v] = Simd::zero();
+
+            for (int j = 0; j < k; j++)
+            {
+                typename Simd::value_type x = Simd::load(src[j] + i);
+                for (int v = 0; v < Vectors; v++)
+                {
+                    p[v] = Simd::add(p[v],
+                        Simd::multiply(x, &g_tbls[32 * (v * k + j)]));
+                }
+            }
+
+            for (int v = 0; v < Vectors; v++)
+                Simd::store(dest[v] + i, p[v]);
+        }
+
+        for (; i < len; i++)
+        {
+            for (int v = 0; v < Vectors; v++)
+            {
+                unsigned char s = 0;
+                for (int j = 0; j < k; j++)
+                    s ^= multiply(src[j][i], &g_tbls[32 * (v * k + j)]);
+                dest[v][i] = s;
+            }
+        }
+    }
+
+    /// Same as gf_Nvect_mad() with Vectors outputs: adds the products of
+    /// the source vec_i by Vectors coefficients to the outputs
+    template<class Simd, int Vectors>
+    void mad(int len, int vec, int vec_i, unsigned char* g_tbls,
+        unsigned char* src, unsigned char** dest)
+    {
+        int i = 0;
+        for (; i + Simd::width <= len; i += Simd::width)
+        {
+            typename Simd::value_type x = Simd::load(src + i);
+            for (int v = 0; v < Vectors; v++)
+            {
+                unsigned char* tbl = &g_tbls[32 * (v * vec + vec_i)];
+                Simd::store(dest[v] + i, Simd::add(Simd::load(dest[v] + i),
+                    Simd::multiply(x, tbl)));
+            }
+        }
+
+        for (; i < len; i++)
+        {
+            for (int v = 0; v < Vectors; v++)
+                dest[v][i] ^= multiply(src[i], &g_tbls[32 * (v * vec + vec_i)]);
+        }
+    }
+
+    /// Same as gf_vect_dot_prod()
+    template<class Simd>
+    void vect_dot_prod(int len, int vlen, unsigned char* g_tbls,
+        unsigned char** src, unsigned char* dest)
+    {
+        dot_prod<Simd, 1>(len, vlen, g_tbls, src, &dest);
+    }
+
+    /// Same as gf_vect_mad()
+    template<class Simd>
+    void vect_mad(int len, int vec, int vec_i, unsigned char* g_tbls,
+        unsigned char* src, unsigned char* dest)
+    {
+        mad<Simd, 1>(len, vec, vec_i, g_tbls, src, &dest);
+    }
+
+    /// Same as ec_encode_data(): the rows outputs are computed 4 at a time
+    template<class Simd>
+    void encode_data(int len, int k, int rows, unsigned char* g_tbls,
+        unsigned char** data, unsigned char** coding)
+    {
+        while (rows >= 4)
+        {
+            dot_prod<Simd, 4>(len, k, g_tbls, data, coding);
+            g_tbls += 4 * k * 32;
+            coding += 4;
+            rows -= 4;
+        }
+        switch (rows)
+        {
+        case 3:
+            dot_prod<Simd, 3>(len, k, g_tbls, data, coding);
+            break;
+        case 2:
+            dot_prod<Simd, 2>(len, k, g_tbls, data, coding);
+            break;
+        case 1:
+            dot_prod<Simd, 1>(len, k, g_tbls, data, coding);
+            break;
+        }
+    }
+
+    /// Same as ec_encode_data_update(): the rows outputs are updated 6 at a
+    /// time with the source vec_i
+    template<class Simd>
+    void encode_data_update(int len, int k, int rows, int vec_i,
+        unsigned char* g_tbls, unsigned char* data, unsigned char** coding)
+    {
+        while (rows >= 6)
+        {
+            mad<Simd, 6>(len, k, vec_i, g_tbls, data, coding);
+            g_tbls += 6 * k * 32;
+            coding += 6;
+            rows -= 6;
+        }
+        switch (rows)
+        {
+        case 5:
+            mad<Simd, 5>(len, k, vec_i, g_tbls, data, coding);
+            break;
+        case 4:
+            mad<Simd, 4>(len, k, vec_i, g_tbls, data, coding);
+            break;
+        case 3:
+            mad<Simd, 3>(len, k, vec_i, g_tbls, data, coding);
+            break;
+        case 2:
+            mad<Simd, 2>(len, k, vec_i, g_tbls, data, coding);
+            break;
+        case 1:
+            mad<Simd, 1>(len, k, vec_i, g_tbls, data, coding);
+            break;
+        }
+    }
+}
@@ -0,0 +1,432 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <cassert>
+#include <ctime>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>  // for memset
+
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+#ifdef ISA_ENABLED
+extern "C"
+{
+#include "erasure_code.h"
+}
+#endif
+
+#include "../isa_intrinsics.hpp"
+
+/// A dot product kernel with the number of outputs of its table entry
+typedef void (*dot_prod_function)(int, int, unsigned char*, unsigned char**,
+    unsigned char**);
+
+/// A multiply-accumulate kernel with the number of outputs of its table entry
+typedef void (*mad_function)(int, int, int, unsigned char*, unsigned char*,
+    unsigned char**);
+
+/// The single output ISA kernels take a pointer to the output
+template<void (*Function)(int, int, unsigned char*, unsigned char**,
+    unsigned char*)>
+void dot_prod1(int len, int vlen, unsigned char* g_tbls, unsigned char** src,
+    unsigned char** dest)
+{
+    Function(len, vlen, g_tbls, src, *dest);
+}
+
+template<void (*Function)(int, int, int, unsigned char*, unsigned char*,
+    unsigned char*)>
+void mad1(int len, int vec, int vec_i, unsigned char* g_tbls,
+    unsigned char* src, unsigned char** dest)
+{
+    Function(len, vec, vec_i, g_tbls, src, *dest);
+}
+
+#ifdef ISA_ENABLED
+/// The yasm kernels of ISA for SSE
+struct asm_sse_kernels
+{
+    static dot_prod_function dot_prod(uint32_t rows)
+    {
+        static const dot_prod_function functions[6] =
+        {
+            dot_prod1<gf_vect_dot_prod_sse>, gf_2vect_dot_prod_sse,
+            gf_3vect_dot_prod_sse, gf_4vect_dot_prod_sse,
+            gf_5vect_dot_prod_sse, gf_6vect_dot_prod_sse
+        };
+        return functions[rows - 1];
+    }
+
+    static mad_function mad(uint32_t rows)
+    {
+        static const mad_function functions[6] =
+        {
+            mad1<gf_vect_mad_sse>, gf_2vect_mad_sse, gf_3vect_mad_sse,
+            gf_4vect_mad_sse, gf_5vect_mad_sse, gf_6vect_mad_sse
+        };
+        return functions[rows - 1];
+    }
+};
+
+/// The yasm kernels of ISA for AVX2
+struct asm_avx2_kernels
+{
+    static dot_prod_function dot_prod(uint32_t rows)
+    {
+        static const dot_prod_function functions[6] =
+        {
+            dot_prod1<gf_vect_dot_prod_avx2>, gf_2vect_dot_prod_avx2,
+            gf_3vect_dot_prod_avx2, gf_4vect_dot_prod_avx2,
+            gf_5vect_dot_prod_avx2, gf_6vect_dot_prod_avx2
+        };
+        return functions[rows - 1];
+    }
+
+    static mad_function mad(uint32_t rows)
+    {
+        static const mad_function functions[6] =
+        {
+            mad1<gf_vect_mad_avx2>, gf_2vect_mad_avx2, gf_3vect_mad_avx2,
+            gf_4vect_mad_avx2, gf_5vect_mad_avx2, gf_6vect_mad_avx2
+        };
+        return functions[rows - 1];
+    }
+};
+#endif
+
+/// The intrinsics kernels of an instruction set
+template<class Simd>
+struct intrinsics_kernels
+{
+    static dot_prod_function dot_prod(uint32_t rows)
+    {
+        static const dot_prod_function functions[6] =
+        {
+            isa_intrinsics::dot_prod<Simd, 1>,
+            isa_intrinsics::dot_prod<Simd, 2>,
+            isa_intrinsics::dot_prod<Simd, 3>,
+            isa_intrinsics::dot_prod<Simd, 4>,
+            isa_intrinsics::dot_prod<Simd, 5>,
+            isa_intrinsics::dot_prod<Simd, 6>
+        };
+        return functions[rows - 1];
+    }
+
+    static mad_function mad(uint32_t rows)
+    {
+        static const mad_function functions[6] =
+        {
+            isa_intrinsics::mad<Simd, 1>,
+            isa_intrinsics::mad<Simd, 2>,
+            isa_intrinsics::mad<Simd, 3>,
+            isa_intrinsics::mad<Simd, 4>,
+            isa_intrinsics::mad<Simd, 5>,
+            isa_intrinsics::mad<Simd, 6>
+        };
+        return functions[rows - 1];
+    }
+};
+
+/// Benchmark fixture for one call of a kernel computing rows outputs from
+/// k sources, either by dot products or by multiply-accumulates of each
+/// source in turn (Mad)
+template<class Kernels, bool Mad>
+class kernel_setup : public gauge::time_benchmark
+{
+public:
+
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t sources = cs.get_value<uint32_t>("sources");
+
+        // The number of source bytes processed per iteration
+        uint64_t bytes = (uint64_t)size * sources;
+
+        return bytes / time; // MB/s for each iteration
+    }
+
+    void store_run(tables::table& results)
+    {
+        if (!results.has_column("throughput"))
+            results.add_column("throughput");
+
+        results.set_value("throughput", measurement());
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t sources = cs.get_value<uint32_t>("sources");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        // The outputs must match the products of the coefficients computed
+        // one byte at a time
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            for (uint32_t b = 0; b < size; ++b)
+            {
+                unsigned char expected = 0;
+                for (uint32_t j = 0; j < sources; ++j)
+                {
+                    expected ^= gf256::mul(
+                        m_coefficients[r * sources + j], m_sources[j][b]);
+                }
+                assert(m_outputs[r][b] == expected);
+                (void)expected;
+            }
+        }
+
+        return true;
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto sizes = options["size"].as<std::vector<uint32_t>>();
+        auto sources = options["sources"].as<std::vector<uint32_t>>();
+        auto rows = options["rows"].as<std::vector<uint32_t>>();
+
+        assert(sizes.size() > 0);
+        assert(sources.size() > 0);
+        assert(rows.size() > 0);
+
+        for (const auto& s : sizes)
+        {
+            for (const auto& k : sources)
+            {
+                for (const auto& r : rows)
+                {
+                    // The kernels compute 1 to 6 outputs
+                    assert(r >= 1 && r <= 6);
+
+                    gauge::config_set cs;
+                    cs.set_value<uint32_t>("size", s);
+                    cs.set_value<uint32_t>("sources", k);
+                    cs.set_value<uint32_t>("rows", r);
+
+                    add_configuration(cs);
+                }
+            }
+        }
+    }
+
+    /// Prepares the data structures between each run
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t sources = cs.get_value<uint32_t>("sources");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        m_data.resize((sources + rows) * size);
+        for (auto& d : m_data)
+            d = rand() % 256;
+
+        m_sources.resize(sources);
+        for (uint32_t i = 0; i < sources; ++i)
+            m_sources[i] = &m_data[i * size];
+
+        m_outputs.resize(rows);
+        for (uint32_t i = 0; i < rows; ++i)
+            m_outputs[i] = &m_data[(sources + i) * size];
+
+        m_coefficients.resize(sources * rows);
+        for (auto& c : m_coefficients)
+            c = rand() % 256;
+
+        // The tables of ec_init_tables(), which the yasm kernels also take
+        m_tables.resize(sources * rows * 32);
+        isa_intrinsics::init_tables(sources, rows, m_coefficients.data(),
+            m_tables.data());
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t size = cs.get_value<uint32_t>("size");
+        uint32_t sources = cs.get_value<uint32_t>("sources");
+        uint32_t rows = cs.get_value<uint32_t>("rows");
+
+        unsigned char* tables = m_tables.data();
+        unsigned char** data = m_sources.data();
+        unsigned char** coding = m_outputs.data();
+
+        if (Mad)
+        {
+            mad_function mad = Kernels::mad(rows);
+
+            RUN
+            {
+                for (uint32_t i = 0; i < rows; ++i)
+                    memset(coding[i], 0, size);
+
+                for (uint32_t i = 0; i < sources; ++i)
+                    mad(size, sources, i, tables, data[i], coding);
+            }
+        }
+        else
+        {
+            dot_prod_function dot_prod = Kernels::dot_prod(rows);
+
+            RUN
+            {
+                dot_prod(size, sources, tables, data, coding);
+            }
+        }
+    }
+
+protected:
+
+    /// The sources followed by the outputs
+    std::vector<unsigned char> m_data;
+
+    /// The sources
+    std::vector<unsigned char*> m_sources;
+
+    /// The outputs
+    std::vector<unsigned char*> m_outputs;
+
+    /// The rows x sources coefficients and their tables
+    std::vector<unsigned char> m_coefficients;
+    std::vector<unsigned char> m_tables;
+};
+
+#ifdef ISA_ENABLED
+typedef kernel_setup<asm_sse_kernels, false> dot_prod_sse_setup;
+typedef kernel_setup<asm_sse_kernels, true> mad_sse_setup;
+typedef kernel_setup<asm_avx2_kernels, false> dot_prod_avx2_setup;
+typedef kernel_setup<asm_avx2_kernels, true> mad_avx2_setup;
+#endif
+
+#ifdef __SSSE3__
+typedef kernel_setup<intrinsics_kernels<isa_intrinsics::ssse3>, false>
+    dot_prod_ssse3_intrinsics_setup;
+typedef kernel_setup<intrinsics_kernels<isa_intrinsics::ssse3>, true>
+    mad_ssse3_intrinsics_setup;
+#endif
+
+#ifdef __AVX2__
+typedef kernel_setup<intrinsics_kernels<isa_intrinsics::avx2>, false>
+    dot_prod_avx2_intrinsics_setup;
+typedef kernel_setup<intrinsics_kernels<isa_intrinsics::avx2>, true>
+    mad_avx2_intrinsics_setup;
+#endif
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(intrinsics_options)
+{
+    gauge::po::options_description options;
+
+    options.add_options()
+        ("size", gauge::po::value<std::vector<uint32_t>>()->default_value(
+        {4096,65536,1000000}, "")->multitoken(),
+        "Set the size of a vector in bytes");
+
+    options.add_options()
+        ("sources", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({10}, "")->multitoken(),
+        "Set the number of source vectors");
+
+    options.add_options()
+        ("rows", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({1,2,3,4,5,6}, "")->multitoken(),
+        "Set the number of output vectors computed by a kernel (1 to 6)");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// ISA Kernels
+//------------------------------------------------------------------
+
+// The yasm kernels need the ISA library, and both the yasm and the
+// intrinsics kernels the instruction sets of the build machine
+
+#if defined(ISA_ENABLED) && defined(__SSSE3__)
+BENCHMARK_F_INLINE(dot_prod_sse_setup, ISA, dot_prod_sse, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#ifdef __SSSE3__
+BENCHMARK_F_INLINE(dot_prod_ssse3_intrinsics_setup, ISA,
+    dot_prod_ssse3_intrinsics, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#if defined(ISA_ENABLED) && defined(__AVX2__)
+BENCHMARK_F_INLINE(dot_prod_avx2_setup, ISA, dot_prod_avx2, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#ifdef __AVX2__
+BENCHMARK_F_INLINE(dot_prod_avx2_intrinsics_setup, ISA,
+    dot_prod_avx2_intrinsics, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#if defined(ISA_ENABLED) && defined(__SSSE3__)
+BENCHMARK_F_INLINE(mad_sse_setup, ISA, mad_sse, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#ifdef __SSSE3__
+BENCHMARK_F_INLINE(mad_ssse3_intrinsics_setup, ISA, mad_ssse3_intrinsics, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#if defined(ISA_ENABLED) && defined(__AVX2__)
+BENCHMARK_F_INLINE(mad_avx2_setup, ISA, mad_avx2, 1)
+{
+    run_benchmark();
+}
+#endif
+
+#ifdef __AVX2__
+BENCHMARK_F_INLINE(mad_avx2_intrinsics_setup, ISA, mad_avx2_intrinsics, 1)
+{
+    run_benchmark();
+}
+#endif
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
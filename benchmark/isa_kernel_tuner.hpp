@@ -0,0 +1,318 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+extern "C"
+{
+#include "erasure_code.h"
+}
+
+/// Selects, for each (k, rows, len) encoding problem, the fastest way of
+/// running it with the ISA kernels of this CPU: the instruction set
+/// (sse, avx or avx2), the number of output vectors computed per call
+/// (1 to 6) and the strategy, either dot products over all the sources
+/// ("dot_prod", as ec_encode_data) or multiply-accumulates of one source
+/// at a time ("mad", as ec_encode_data_update). The candidates are
+/// micro-benchmarked by the kernel_tuning benchmark of isa_arithmetic, which
+/// keeps the winners in a tuning table with update(). The table is stored
+/// in a text file with one problem per line.
+struct isa_kernel_tuner
+{
+    /// A way of running an encoding. The "default" arch stands for the
+    /// static choice of ec_encode_data()
+    struct kernel
+    {
+        kernel(const std::string& arch = "default",
+            const std::string& strategy = "dot_prod", uint32_t group = 4,
+            double time = 0) :
+            m_arch(arch), m_strategy(strategy), m_group(group), m_time(time)
+        { }
+
+        std::string name() const
+        {
+            if (m_arch == "default")
+                return m_arch;
+
+            std::ostringstream name;
+            name << m_arch << "_" << m_strategy << m_group;
+            return name.str();
+        }
+
+        std::string m_arch;
+        std::string m_strategy;
+        uint32_t m_group;
+
+        /// The time of one encoding measured by the tuner, in microseconds
+        double m_time;
+    };
+
+    /// Whether the tuning table has an entry for the problem
+    bool has(uint32_t k, uint32_t rows, uint32_t len) const
+    {
+        return m_table.count(std::make_tuple(k, rows, len)) > 0;
+    }
+
+    /// The kernel selected for the problem, ec_encode_data() if it was not
+    /// tuned
+    kernel find(uint32_t k, uint32_t rows, uint32_t len) const
+    {
+        auto it = m_table.find(std::make_tuple(k, rows, len));
+        return it != m_table.end() ? it->second : kernel();
+    }
+
+    /// Generate or decode rows output vectors, as ec_encode_data()
+    void encode(int len, int k, int rows, unsigned char* g_tbls,
+        unsigned char** data, unsigned char** coding) const
+    {
+        run(find(k, rows, len), len, k, rows, g_tbls, data, coding);
+    }
+
+    /// Keep the kernel for the problem if it was measured faster than the
+    /// one selected so far
+    void update(uint32_t k, uint32_t rows, uint32_t len, const kernel& entry)
+    {
+        auto problem = std::make_tuple(k, rows, len);
+        auto it = m_table.find(problem);
+        if (it == m_table.end() || entry.m_time < it->second.m_time)
+            m_table[problem] = entry;
+    }
+
+    /// Forget the kernel selected for the problem, to tune it again
+    void clear(uint32_t k, uint32_t rows, uint32_t len)
+    {
+        m_table.erase(std::make_tuple(k, rows, len));
+    }
+
+    /// Read a tuning table written by save(), returns false if the file
+    /// can not be read. The table may come from another CPU: the entries
+    /// of kernels this CPU can not run are dropped, so their problems are
+    /// tuned again.
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path.c_str());
+        if (!file)
+            return false;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream fields(line);
+            uint32_t k, rows, len;
+            kernel entry;
+            if (fields >> k >> rows >> len >> entry.m_arch >>
+                entry.m_strategy >> entry.m_group >> entry.m_time &&
+                valid(entry))
+            {
+                m_table[std::make_tuple(k, rows, len)] = entry;
+            }
+        }
+        return true;
+    }
+
+    /// Write the tuning table, returns false if the file can not be written
+    bool save(const std::string& path) const
+    {
+        std::ofstream file(path.c_str());
+        if (!file)
+            return false;
+
+        file << "# k rows len arch strategy group time_us" << std::endl;
+        for (const auto& entry : m_table)
+        {
+            file << std::get<0>(entry.first) << " "
+                 << std::get<1>(entry.first) << " "
+                 << std::get<2>(entry.first) << " "
+                 << entry.second.m_arch << " " << entry.second.m_strategy
+                 << " " << entry.second.m_group << " "
+                 << entry.second.m_time << std::endl;
+        }
+        return true;
+    }
+
+    /// The kernels which can run vectors of len bytes on this CPU
+    static std::vector<kernel> candidates(uint32_t len)
+    {
+        std::vector<kernel> kernels;
+        kernels.push_back(kernel());
+
+        // The vectorized kernels need 32 bytes at least
+        if (len < 32)
+            return kernels;
+
+        const char* archs[] = { "sse", "avx", "avx2" };
+        const char* strategies[] = { "dot_prod", "mad" };
+
+        for (uint32_t a = 0; a < 3; a++)
+        {
+            if (!supported(archs[a]))
+                continue;
+
+            for (uint32_t s = 0; s < 2; s++)
+                for (uint32_t g = 1; g <= 6; g++)
+                    kernels.push_back(kernel(archs[a], strategies[s], g));
+        }
+        return kernels;
+    }
+
+    /// Whether a kernel exists and can run on this CPU
+    static bool valid(const kernel& k)
+    {
+        if (!supported(k.m_arch))
+            return false;
+
+        return k.m_arch == "default" ||
+            ((k.m_strategy == "dot_prod" || k.m_strategy == "mad") &&
+             k.m_group >= 1 && k.m_group <= 6);
+    }
+
+    /// Whether the CPU and the OS support an instruction set
+    static bool supported(const std::string& arch)
+    {
+        __builtin_cpu_init();
+
+        if (arch == "sse")
+            return __builtin_cpu_supports("sse4.1");
+        if (arch == "avx")
+            return __builtin_cpu_supports("avx");
+        if (arch == "avx2")
+            return __builtin_cpu_supports("avx2");
+        return arch == "default";
+    }
+
+    /// Run an encoding with a kernel
+    static void run(const kernel& k, int len, int vectors, int rows,
+        unsigned char* g_tbls, unsigned char** data, unsigned char** coding)
+    {
+        uint32_t a = (k.m_arch == "sse") ? 0 : (k.m_arch == "avx") ? 1 :
+            (k.m_arch == "avx2") ? 2 : 3;
+
+        if (a == 3 || len < 32)
+        {
+            ec_encode_data(len, vectors, rows, g_tbls, data, coding);
+        }
+        else if (k.m_strategy == "dot_prod")
+        {
+            // The output vectors by groups, over all the sources
+            while (rows > 0)
+            {
+                int n = std::min(rows, (int)k.m_group);
+                dot_prods()[a][n - 1](len, vectors, g_tbls, data, coding);
+                g_tbls += n * vectors * 32;
+                coding += n;
+                rows -= n;
+            }
+        }
+        else
+        {
+            // The sources one at a time, accumulated in the output vectors
+            // by groups
+            for (int r = 0; r < rows; r++)
+                memset(coding[r], 0, len);
+
+            for (int i = 0; i < vectors; i++)
+            {
+                unsigned char* tbls = g_tbls;
+                for (int r = 0; r < rows; r += k.m_group)
+                {
+                    int n = std::min(rows - r, (int)k.m_group);
+                    mads()[a][n - 1](len, vectors, i, tbls, data[i],
+                        &coding[r]);
+                    tbls += n * vectors * 32;
+                }
+            }
+        }
+    }
+
+private:
+
+    typedef void (*dot_prod_function)(int, int, unsigned char*,
+        unsigned char**, unsigned char**);
+
+    typedef void (*mad_function)(int, int, int, unsigned char*,
+        unsigned char*, unsigned char**);
+
+    /// The single vector kernels take a single output vector
+    template<void (*Function)(int, int, unsigned char*, unsigned char**,
+        unsigned char*)>
+    static void dot_prod1(int len, int vlen, unsigned char* g_tbls,
+        unsigned char** src, unsigned char** dest)
+    {
+        Function(len, vlen, g_tbls, src, *dest);
+    }
+
+    template<void (*Function)(int, int, int, unsigned char*, unsigned char*,
+        unsigned char*)>
+    static void mad1(int len, int vec, int vec_i, unsigned char* g_tbls,
+        unsigned char* src, unsigned char** dest)
+    {
+        Function(len, vec, vec_i, g_tbls, src, *dest);
+    }
+
+    /// The dot product kernels by instruction set and number of outputs
+    static const dot_prod_function (&dot_prods())[3][6]
+    {
+        static const dot_prod_function functions[3][6] =
+        {
+            { dot_prod1<gf_vect_dot_prod_sse>, gf_2vect_dot_prod_sse,
+              gf_3vect_dot_prod_sse, gf_4vect_dot_prod_sse,
+              gf_5vect_dot_prod_sse, gf_6vect_dot_prod_sse },
+            { dot_prod1<gf_vect_dot_prod_avx>, gf_2vect_dot_prod_avx,
+              gf_3vect_dot_prod_avx, gf_4vect_dot_prod_avx,
+              gf_5vect_dot_prod_avx, gf_6vect_dot_prod_avx },
+            { dot_prod1<gf_vect_dot_prod_avx2>, gf_2vect_dot_prod_avx2,
+              gf_3vect_dot_prod_avx2, gf_4vect_dot_prod_avx2,
+              gf_5vect_dot_prod_avx2, gf_6vect_dot_prod_avx2 }
+        };
+        return functions;
+    }
+
+    /// The multiply-accumulate kernels by instruction set and number of
+    /// outputs
+    static const mad_function (&mads())[3][6]
+    {
+        static const mad_function functions[3][6] =
+        {
+            { mad1<gf_vect_mad_sse>, gf_2vect_mad_sse, gf_3vect_mad_sse,
+              gf_4vect_mad_sse, gf_5vect_mad_sse, gf_6vect_mad_sse },
+            { mad1<gf_vect_mad_avx>, gf_2vect_mad_avx, gf_3vect_mad_avx,
+              gf_4vect_mad_avx, gf_5vect_mad_avx, gf_6vect_mad_avx },
+            { mad1<gf_vect_mad_avx2>, gf_2vect_mad_avx2, gf_3vect_mad_avx2,
+              gf_4vect_mad_avx2, gf_5vect_mad_avx2, gf_6vect_mad_avx2 }
+        };
+        return functions;
+    }
+
+private:
+
+    /// The kernel of each (k, rows, len) problem
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, kernel> m_table;
+};
+
+/// Run ec_encode_data() or, with a tuner, the kernel it selected
+inline void isa_encode_data(const isa_kernel_tuner* tuner, int len, int k,
+    int rows, unsigned char* g_tbls, unsigned char** data,
+    unsigned char** coding)
+{
+    if (tuner)
+        tuner->encode(len, k, rows, g_tbls, data, coding);
+    else
+        ec_encode_data(len, k, rows, g_tbls, data, coding);
+}
@@ -0,0 +1,174 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <vector>
+
+extern "C"
+{
+#include "erasure_code.h"
+}
+
+/// A systematic linear code of k data symbols and n - k parities over
+/// GF(2^8), given by the (n - k) x k matrix of its parities, run with the
+/// ISA kernels. Any erasures are decoded from k surviving symbols whose
+/// rows of the generator matrix are independent, the data symbols being
+/// preferred, in one call of ec_encode_data().
+struct isa_linear_codec
+{
+    isa_linear_codec(uint32_t k, uint32_t n,
+        const std::vector<uint8_t>& parity_matrix) :
+        m_k(k), m_n(n)
+    {
+        assert(k > 0 && n > k);
+        assert(parity_matrix.size() == (n - k) * k);
+
+        // The generator matrix: the identity, then the parities
+        m_matrix.assign(n * k, 0);
+        for (uint32_t i = 0; i < k; i++)
+            m_matrix[i * k + i] = 1;
+        std::copy(parity_matrix.begin(), parity_matrix.end(),
+            m_matrix.begin() + k * k);
+
+        m_tables.resize(k * (n - k) * 32);
+        ec_init_tables(k, n - k, &m_matrix[k * k], m_tables.data());
+    }
+
+    /// The RS code of k + m symbols with the Cauchy matrix of ISA
+    static isa_linear_codec cauchy(uint32_t k, uint32_t m)
+    {
+        std::vector<uint8_t> a((k + m) * k);
+        gf_gen_cauchy1_matrix(a.data(), k + m, k);
+        return isa_linear_codec(k, k + m,
+            std::vector<uint8_t>(a.begin() + k * k, a.end()));
+    }
+
+    uint32_t k() const { return m_k; }
+    uint32_t n() const { return m_n; }
+
+    /// The row of symbol i of the generator matrix
+    const uint8_t* row(uint32_t i) const
+    {
+        return &m_matrix[i * m_k];
+    }
+
+    /// Compute the n - k parities from the k data symbols of size bytes, the
+    /// n symbols following each other in symbols
+    void encode(uint8_t** symbols, uint32_t size) const
+    {
+        ec_encode_data(size, m_k, m_n - m_k, (unsigned char*)m_tables.data(),
+            symbols, &symbols[m_k]);
+    }
+
+    /// Recover the erased symbols in place in the n symbols. Returns the
+    /// number of bytes read, or 0 if the erasures cannot be decoded.
+    uint64_t decode(const std::vector<uint32_t>& erased, uint8_t** symbols,
+        uint32_t size) const
+    {
+        if (erased.empty())
+            return 0;
+
+        std::vector<bool> lost(m_n, false);
+        for (uint32_t e : erased)
+            lost[e] = true;
+
+        // The first surviving symbols with independent rows, each row
+        // being reduced by the previous ones (kept in echelon form)
+        std::vector<uint32_t> sources;
+        std::vector<uint8_t> echelon;
+        std::vector<uint32_t> pivots;
+        for (uint32_t i = 0; i < m_n && sources.size() < m_k; i++)
+        {
+            if (lost[i])
+                continue;
+
+            std::vector<uint8_t> r(row(i), row(i) + m_k);
+            for (uint32_t b = 0; b < pivots.size(); b++)
+            {
+                uint8_t c = r[pivots[b]];
+                if (c == 0)
+                    continue;
+                for (uint32_t j = 0; j < m_k; j++)
+                    r[j] ^= gf_mul(c, echelon[b * m_k + j]);
+            }
+
+            uint32_t pivot = 0;
+            while (pivot < m_k && r[pivot] == 0)
+                pivot++;
+            if (pivot == m_k)
+                continue;
+
+            uint8_t scale = gf_inv(r[pivot]);
+            for (uint32_t j = 0; j < m_k; j++)
+                r[j] = gf_mul(r[j], scale);
+
+            echelon.insert(echelon.end(), r.begin(), r.end());
+            pivots.push_back(pivot);
+            sources.push_back(i);
+        }
+
+        if (sources.size() < m_k)
+            return 0;
+
+        // The inverse of the rows of the sources
+        std::vector<uint8_t> b(m_k * m_k), d(m_k * m_k);
+        for (uint32_t s = 0; s < m_k; s++)
+            std::copy(row(sources[s]), row(sources[s]) + m_k, &b[s * m_k]);
+        if (gf_invert_matrix(b.data(), d.data(), m_k) < 0)
+            return 0;
+
+        // The erased symbols from the sources: their rows of the generator
+        // matrix times the inverse
+        std::vector<uint8_t> c(erased.size() * m_k, 0);
+        for (uint32_t e = 0; e < erased.size(); e++)
+        {
+            const uint8_t* g = row(erased[e]);
+            for (uint32_t j = 0; j < m_k; j++)
+            {
+                if (g[j] == 0)
+                    continue;
+                for (uint32_t s = 0; s < m_k; s++)
+                    c[e * m_k + s] ^= gf_mul(g[j], d[j * m_k + s]);
+            }
+        }
+
+        std::vector<uint8_t> tables(m_k * erased.size() * 32);
+        ec_init_tables(m_k, erased.size(), c.data(), tables.data());
+
+        std::vector<uint8_t*> in(m_k), out(erased.size());
+        for (uint32_t s = 0; s < m_k; s++)
+            in[s] = symbols[sources[s]];
+        for (uint32_t e = 0; e < erased.size(); e++)
+            out[e] = symbols[erased[e]];
+
+        ec_encode_data(size, m_k, erased.size(), tables.data(), in.data(),
+            out.data());
+
+        return (uint64_t)m_k * size;
+    }
+
+    /// Recover the single erased symbol e in place. Returns the number of
+    /// bytes read.
+    uint64_t repair(uint32_t e, uint8_t** symbols, uint32_t size) const
+    {
+        return decode(std::vector<uint32_t>(1, e), symbols, size);
+    }
+
+private:
+
+    uint32_t m_k;
+    uint32_t m_n;
+
+    // The n x k generator matrix
+    std::vector<uint8_t> m_matrix;
+
+    // The tables of the parities for ec_encode_data()
+    std::vector<uint8_t> m_tables;
+};
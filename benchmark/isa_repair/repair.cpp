@@ -0,0 +1,296 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <cassert>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>  // for memset, memcmp
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+#include "../hitchhiker_codec.hpp"
+#include "../isa_linear_codec.hpp"
+#include "../lrc_codec.hpp"
+
+/// The codecs compared by the repair benchmarks, made for a geometry of k
+/// data symbols, l local parities and r global parities. The RS and the
+/// Hitchhiker codes have the same overhead, l + r parities.
+template<class Codec>
+struct repair_codec;
+
+template<>
+struct repair_codec<lrc_codec>
+{
+    static lrc_codec make(uint32_t k, uint32_t l, uint32_t r)
+    {
+        return lrc_codec(k, l, r);
+    }
+};
+
+template<>
+struct repair_codec<isa_linear_codec>
+{
+    static isa_linear_codec make(uint32_t k, uint32_t l, uint32_t r)
+    {
+        return isa_linear_codec::cauchy(k, l + r);
+    }
+};
+
+template<>
+struct repair_codec<hitchhiker_codec>
+{
+    static hitchhiker_codec make(uint32_t k, uint32_t l, uint32_t r)
+    {
+        return hitchhiker_codec(k, l + r);
+    }
+};
+
+/// Benchmark fixture for the repair of a single lost symbol, each symbol of
+/// the stripe being lost in turn. The bytes read by the repairs give the
+/// read amplification (bytes read per byte repaired), for all the symbols
+/// and for the data symbols only.
+template<class Codec>
+class repair_setup : public gauge::time_benchmark
+{
+public:
+
+    void start()
+    {
+        m_repaired_bytes = 0;
+        m_read_bytes = 0;
+        m_data_repaired_bytes = 0;
+        m_data_read_bytes = 0;
+        gauge::time_benchmark::start();
+    }
+
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        // The bytes repaired per iteration
+        uint64_t bytes =
+            m_repaired_bytes / gauge::time_benchmark::iteration_count();
+
+        return bytes / time; // MB/s for each iteration
+    }
+
+    void store_run(tables::table& results)
+    {
+        if (!results.has_column("goodput"))
+            results.add_column("goodput");
+
+        results.set_value("goodput", measurement());
+
+        if (!results.has_column("read_amplification"))
+            results.add_column("read_amplification");
+
+        results.set_value("read_amplification",
+            (double)m_read_bytes / m_repaired_bytes);
+
+        if (!results.has_column("data_read_amplification"))
+            results.add_column("data_read_amplification");
+
+        results.set_value("data_read_amplification",
+            (double)m_data_read_bytes / m_data_repaired_bytes);
+
+        // The time of a repair in microseconds
+        if (!results.has_column("repair_time"))
+            results.add_column("repair_time");
+
+        results.set_value("repair_time",
+            gauge::time_benchmark::measurement() / m_codec->n());
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    bool needs_warmup_iteration()
+    {
+        return false;
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // Every symbol must be repaired from the others
+        for (uint32_t e = 0; e < m_codec->n(); e++)
+        {
+            memset(m_symbols[e], 0, symbol_size);
+            m_codec->repair(e, m_symbols.data(), symbol_size);
+
+            assert(memcmp(m_symbols[e], &m_reference[e * symbol_size],
+                symbol_size) == 0);
+        }
+
+        return true;
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto geometries = options["geometry"].as<std::vector<std::string>>();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t>>();
+
+        assert(geometries.size() > 0);
+        assert(symbol_size.size() > 0);
+
+        for (const auto& g : geometries)
+        {
+            uint32_t k = 0, l = 0, r = 0;
+            if (sscanf(g.c_str(), "%u+%u+%u", &k, &l, &r) != 3 ||
+                l == 0 || k % l != 0 || l + r < 2)
+            {
+                printf("Invalid geometry %s\n", g.c_str());
+                continue;
+            }
+
+            for (const auto& p : symbol_size)
+            {
+                // The Hitchhiker codes split the symbols in halves
+                assert(p % 2 == 0);
+
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("k", k);
+                cs.set_value<uint32_t>("l", l);
+                cs.set_value<uint32_t>("r", r);
+                cs.set_value<uint32_t>("symbol_size", p);
+
+                add_configuration(cs);
+            }
+        }
+    }
+
+    /// Prepares the data structures between each run
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t k = cs.get_value<uint32_t>("k");
+        uint32_t l = cs.get_value<uint32_t>("l");
+        uint32_t r = cs.get_value<uint32_t>("r");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        m_codec = std::make_shared<Codec>(repair_codec<Codec>::make(k, l, r));
+
+        uint32_t n = m_codec->n();
+        m_buffer.resize(n * symbol_size);
+        for (uint32_t i = 0; i < k * symbol_size; i++)
+            m_buffer[i] = rand() % 256;
+
+        m_symbols.resize(n);
+        for (uint32_t i = 0; i < n; i++)
+            m_symbols[i] = &m_buffer[i * symbol_size];
+
+        m_codec->encode(m_symbols.data(), symbol_size);
+        m_reference = m_buffer;
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        uint32_t k = m_codec->k();
+        uint32_t n = m_codec->n();
+
+        // The clock is running
+        RUN
+        {
+            for (uint32_t e = 0; e < n; e++)
+            {
+                uint64_t read =
+                    m_codec->repair(e, m_symbols.data(), symbol_size);
+
+                m_repaired_bytes += symbol_size;
+                m_read_bytes += read;
+
+                if (e < k)
+                {
+                    m_data_repaired_bytes += symbol_size;
+                    m_data_read_bytes += read;
+                }
+            }
+        }
+    }
+
+protected:
+
+    std::shared_ptr<Codec> m_codec;
+
+    /// The n symbols of the stripe, and a copy of them
+    std::vector<uint8_t> m_buffer;
+    std::vector<uint8_t> m_reference;
+    std::vector<uint8_t*> m_symbols;
+
+    /// The bytes repaired and read, for all the symbols and for the data
+    /// symbols
+    uint64_t m_repaired_bytes;
+    uint64_t m_read_bytes;
+    uint64_t m_data_repaired_bytes;
+    uint64_t m_data_read_bytes;
+};
+
+/// Using this macro we may specify options. For specifying options
+/// we use the boost program options library. So you may additional
+/// details on how to do it in the manual for that library.
+BENCHMARK_OPTION(repair_options)
+{
+    gauge::po::options_description options;
+
+    options.add_options()
+        ("geometry", gauge::po::value<std::vector<std::string>>()->
+        default_value({"6+2+2", "10+2+2", "12+2+2", "12+4+2"}, "")->multitoken(),
+        "Set the geometries k+l+r of the stripes: k data symbols, l local "
+        "parities and r global parities (l + r parities for RS)");
+
+    options.add_options()
+        ("symbol_size", gauge::po::value<std::vector<uint32_t>>()->
+        default_value({65536, 1048576}, "")->multitoken(),
+        "Set the size of a symbol in bytes");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// ISA Repair
+//------------------------------------------------------------------
+
+typedef repair_setup<lrc_codec> lrc_repair_setup;
+typedef repair_setup<isa_linear_codec> rs_repair_setup;
+typedef repair_setup<hitchhiker_codec> hitchhiker_repair_setup;
+
+BENCHMARK_F_INLINE(lrc_repair_setup, ISA, LRCRepair, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(rs_repair_setup, ISA, RSRepair, 1)
+{
+    run_benchmark();
+}
+
+BENCHMARK_F_INLINE(hitchhiker_repair_setup, ISA, HitchhikerRepair, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -4,13 +4,17 @@
 // http://www.steinwurf.com/licensing
 
 #include <ctime>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>  // for memset, memcmp
+#include <cmath>
 
+#include <algorithm>
 #include <vector>
 #include <set>
+#include <type_traits>
 
 #include <gauge/gauge.hpp>
 
@@ -20,6 +24,9 @@ extern "C"
 #include "test.h"
 }
 
+#include "../degraded_read_benchmark.hpp"
+#include "../isa_kernel_tuner.hpp"
+#include "../raid6_pq.hpp"
 #include "../throughput_benchmark.hpp"
 
 #define TEST_SOURCES 250
@@ -74,10 +81,16 @@ struct isa_encoder
 
         // Make parity vects
         ec_init_tables(k, m - k, &a[k * k], g_tbls);
-        ec_encode_data(m_symbol_size,
+        isa_encode_data(m_tuner.get(), m_symbol_size,
             k, m - k, g_tbls, m_buffs, &m_buffs[k]);
     }
 
+    /// Run the kernels selected by a tuner instead of ec_encode_data()
+    void set_tuner(std::shared_ptr<isa_kernel_tuner> tuner)
+    {
+        m_tuner = tuner;
+    }
+
     uint32_t block_size() { return m_block_size; }
     uint32_t symbol_size() { return m_symbol_size; }
     uint32_t payload_size() { return m_symbol_size; }
@@ -85,7 +98,7 @@ struct isa_encoder
 
 protected:
 
-    friend struct isa_decoder;
+    template<class Erasures> friend struct isa_decoder;
 
     uint8_t* m_buffs[TEST_SOURCES];
     uint8_t a[MMAX*KMAX];
@@ -102,13 +115,158 @@ protected:
     uint32_t m_block_size;
     // Number of generated payloads
     uint32_t m_payload_count;
+
+    // The tuner selecting the kernels, if any
+    std::shared_ptr<isa_kernel_tuner> m_tuner;
+};
+
+
+/// Encodes many small stripes of k + m symbols which share one generator
+/// matrix, as the objects of a metadata tier. To bound the memory used, at
+/// most max_bytes of stripes are distinct, the following stripes reuse
+/// their buffers.
+struct isa_stripe_encoder
+{
+    isa_stripe_encoder(uint32_t stripes, uint32_t symbols,
+        uint32_t symbol_size, uint32_t encoded_symbols,
+        uint64_t max_bytes = 256 * 1024 * 1024) :
+        m_stripes(stripes), m_symbol_size(symbol_size)
+    {
+        k = symbols;
+        m = symbols + encoded_symbols;
+
+        // Symbol size must be a multiple of 64
+        assert(m_symbol_size % 64 == 0);
+        assert(m <= TEST_SOURCES);
+
+        uint64_t stripe_bytes = (uint64_t)m * m_symbol_size;
+        m_distinct = (uint32_t)std::min<uint64_t>(m_stripes,
+            std::max<uint64_t>(1, max_bytes / stripe_bytes));
+
+        // Allocate the distinct stripes in one array
+        void* buf = 0;
+        if (posix_memalign(&buf, 64, m_distinct * stripe_bytes))
+        {
+            printf("alloc error: Fail\n");
+        }
+        m_storage = (uint8_t*)buf;
+
+        // Set the symbol pointers of every stripe, source symbols first
+        m_buffs.resize((size_t)m_stripes * m);
+        m_data.resize(m_stripes);
+        m_coding.resize(m_stripes);
+        for (uint32_t s = 0; s < m_stripes; s++)
+        {
+            uint8_t* stripe = m_storage + (s % m_distinct) * stripe_bytes;
+            for (int i = 0; i < m; i++)
+                m_buffs[(size_t)s * m + i] = stripe + i * m_symbol_size;
+
+            m_data[s] = &m_buffs[(size_t)s * m];
+            m_coding[s] = &m_buffs[(size_t)s * m + k];
+        }
+
+        // Make random data
+        for (uint32_t s = 0; s < m_distinct; s++)
+            for (int i = 0; i < k; i++)
+                for (uint32_t j = 0; j < m_symbol_size; j++)
+                    m_data[s][i][j] = rand();
+
+        gf_gen_rs_matrix(a, m, k);
+    }
+
+    ~isa_stripe_encoder()
+    {
+        free(m_storage);
+    }
+
+    /// Encode each stripe on its own, initializing the tables for each of
+    /// them as isa_encoder does for a block
+    void encode_each()
+    {
+        for (uint32_t s = 0; s < m_stripes; s++)
+        {
+            ec_init_tables(k, m - k, &a[k * k], g_tbls);
+            ec_encode_data(m_symbol_size,
+                k, m - k, g_tbls, m_data[s], m_coding[s]);
+        }
+    }
+
+    /// Encode all the stripes with one set of tables and one call
+    void encode_all()
+    {
+        ec_init_tables(k, m - k, &a[k * k], g_tbls);
+        ec_encode_data_stripes(m_symbol_size, k, m - k, g_tbls,
+            (int)m_stripes, &m_data[0], &m_coding[0]);
+    }
+
+    /// Check the parity symbols of stripe s against the baseline encoder
+    bool verify_stripe(uint32_t s)
+    {
+        assert(s < m_stripes);
+
+        std::vector<uint8_t> parity((m - k) * m_symbol_size);
+        std::vector<uint8_t*> coding(m - k);
+        for (int i = 0; i < m - k; i++)
+            coding[i] = &parity[i * m_symbol_size];
+
+        ec_init_tables(k, m - k, &a[k * k], g_tbls);
+        ec_encode_data_base(m_symbol_size,
+            k, m - k, g_tbls, m_data[s], &coding[0]);
+
+        for (int i = 0; i < m - k; i++)
+        {
+            if (memcmp(coding[i], m_coding[s][i], m_symbol_size))
+                return false;
+        }
+
+        return true;
+    }
+
+    uint32_t stripes() { return m_stripes; }
+    uint32_t distinct_stripes() { return m_distinct; }
+
+    /// The k + m symbol pointers of each stripe, source symbols first
+    uint8_t*** stripe_symbols() { return &m_data[0]; }
+
+protected:
+
+    uint8_t a[MMAX*KMAX];
+    uint8_t g_tbls[KMAX*TEST_SOURCES*32];
+
+    // Code parameters
+    int k, m;
+
+    // Number of stripes, and of stripes with their own buffers
+    uint32_t m_stripes;
+    uint32_t m_distinct;
+    // Size of a symbol
+    uint32_t m_symbol_size;
+
+    // Storage for the distinct stripes
+    uint8_t* m_storage;
+    // Symbol pointers of all the stripes, and the source and parity
+    // pointers of each stripe
+    std::vector<uint8_t*> m_buffs;
+    std::vector<uint8_t**> m_data;
+    std::vector<uint8_t**> m_coding;
 };
 
 
+/// Tags selecting which symbols the decoder erases: only source symbols
+/// (default), or any symbol of the stripe, source or parity
+struct data_erasures{};
+struct mixed_erasures{};
+
+/// The lost source symbols are recovered through the inverse of k
+/// surviving rows of the encoding matrix, then the lost parity symbols are
+/// regenerated from the complete data with only their rows of the encoding
+/// matrix. The time spent in each step is recorded.
+template<class Erasures = data_erasures>
 struct isa_decoder
 {
     isa_decoder(
-        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols,
+        const erasure_pattern& erasures = erasure_pattern()) :
         m_symbols(symbols), m_symbol_size(symbol_size)
     {
         k = m_symbols;
@@ -117,6 +275,8 @@ struct isa_decoder
 
         m_block_size = m_symbols * m_symbol_size;
         m_decoding_result = -1;
+        m_data_rebuild_time = 0;
+        m_parity_rebuild_time = 0;
 
         // Allocate the arrays
         int i;
@@ -130,26 +290,26 @@ struct isa_decoder
             m_buffs[i] = (uint8_t*)buf;
         }
 
-        // Simulate m-k erasures (erase some original symbols)
+        // Simulate m-k erasures (erase some original symbols, or any
+        // symbol with mixed erasures)
         // The symbols will be restored by processing the encoded symbols
         memset(src_in_err, 0, TEST_SOURCES);
 
-        std::set<uint8_t> erased;
-        while (erased.size() < payload_count)
-        {
-            uint8_t random_symbol = rand() % k;
-            auto ret = erased.insert(random_symbol);
-            // Skip this symbol if it was already included in the erased set
-            if (ret.second==false) continue;
-            // Indicate the erasure
-            src_in_err[random_symbol] = 1;
-        }
+        uint32_t stripe_symbols =
+            std::is_same<Erasures, mixed_erasures>::value ? m : k;
+        std::set<uint32_t> erased =
+            erasures.generate(stripe_symbols, payload_count);
 
-        // Fill the erasure list
+        // Indicate the erasures and fill the erasure list, the source
+        // symbols coming first
         int errors = 0;
-        for (const uint8_t& e : erased)
+        nerrs_data = 0;
+        for (const uint32_t& e : erased)
         {
-            src_err_list[errors++] = e;
+            src_in_err[e] = 1;
+            src_err_list[errors++] = (uint8_t)e;
+            if ((int)e < k)
+                nerrs_data++;
         }
 
         nerrs = erased.size();
@@ -172,44 +332,166 @@ struct isa_decoder
         assert(payload_count == (uint32_t)(m - k));
 
         int i, j, r;
-        // Construct b by removing error rows from a
-        // a contains m rows and k columns
-        for (i = 0, r = 0; i < k; i++, r++)
+        auto t0 = std::chrono::high_resolution_clock::now();
+
+        if (nerrs_data > 0)
         {
-            while (src_in_err[r]) r++;
-            for (j = 0; j < k; j++)
-                b[k * i + j] = a[k * r + j];
+            if (!init_recovery_tables())
+            {
+                m_decoding_result = -1;
+                return 0;
+            }
+
+            // Set data pointers to point to the encoder payloads
+            for (i = 0, r = 0; i < k; i++, r++)
+            {
+                while (src_in_err[r]) r++;
+                data[i] = encoder->m_buffs[r];
+            }
+
+            // Recover data
+            isa_encode_data(m_tuner.get(), m_symbol_size,
+                k, nerrs_data, g_tbls, &data[0], &m_buffs[0]);
         }
 
-        // Invert the b matrix into d
-        if (gf_invert_matrix(b, d, k) < 0)
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        if (nerrs > nerrs_data)
+        {
+            // The complete data: the surviving and the recovered source
+            // symbols
+            for (i = 0, r = 0; i < k; i++)
+            {
+                data[i] = src_in_err[i] ? m_buffs[r++] : encoder->m_buffs[i];
+            }
+
+            // Construct c by copying the rows of the lost parity symbols
+            // from a
+            for (i = nerrs_data; i < nerrs; i++)
+            {
+                for (j = 0; j < k; j++)
+                    c[k * (i - nerrs_data) + j] = a[k * src_err_list[i] + j];
+            }
+
+            // Regenerate parity
+            ec_init_tables(k, nerrs - nerrs_data, c, g_tbls);
+            isa_encode_data(m_tuner.get(), m_symbol_size, k,
+                nerrs - nerrs_data, g_tbls, &data[0], &m_buffs[nerrs_data]);
+        }
+
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        m_data_rebuild_time = (double)std::chrono::duration_cast<
+            std::chrono::microseconds>(t1 - t0).count();
+        m_parity_rebuild_time = (double)std::chrono::duration_cast<
+            std::chrono::microseconds>(t2 - t1).count();
+        m_decoding_result = 0;
+
+        return payload_count;
+    }
+
+    /// Recover the erased source symbols of several independent stripes
+    /// which lost the same symbols, as all the stripes of a failed disk.
+    /// stripes[s] holds the k + m symbol pointers of stripe s, source
+    /// symbols first, and recovered[s] the buffers of its erased source
+    /// symbols. The inverse and the tables are computed once, then the
+    /// stripes are either interleaved by ec_encode_data_stripes(), which
+    /// keeps each group of tables in the L1 cache over all the stripes, or
+    /// decoded one after the other with ec_encode_data().
+    uint32_t decode_stripes(uint8_t*** stripes, uint8_t*** recovered,
+        uint32_t count, bool interleaved)
+    {
+        // Only the source symbols are recovered
+        assert(nerrs == nerrs_data);
+
+        int i, r;
+        if (!init_recovery_tables())
         {
-            printf("BAD MATRIX\n");
             m_decoding_result = -1;
             return 0;
         }
 
-        // Set data pointers to point to the encoder payloads
-        for (i = 0, r = 0; i < k; i++, r++)
+        // Set the data pointers of each stripe to its survivors
+        m_survivors.resize((size_t)count * k);
+        m_stripe_survivors.resize(count);
+        for (uint32_t s = 0; s < count; s++)
         {
-            while (src_in_err[r]) r++;
-            data[i] = encoder->m_buffs[r];
+            uint8_t** survivors = &m_survivors[(size_t)s * k];
+            for (i = 0, r = 0; i < k; i++, r++)
+            {
+                while (src_in_err[r]) r++;
+                survivors[i] = stripes[s][r];
+            }
+            m_stripe_survivors[s] = survivors;
         }
 
-        // Construct c by copying the erasure rows from the inverse matrix d
-        for (i = 0; i < nerrs; i++)
+        if (interleaved)
         {
-            for (j = 0; j < k; j++)
-                c[k * i + j] = d[k * src_err_list[i] + j];
+            ec_encode_data_stripes(m_symbol_size, k, nerrs_data, g_tbls,
+                (int)count, &m_stripe_survivors[0], recovered);
+        }
+        else
+        {
+            for (uint32_t s = 0; s < count; s++)
+            {
+                ec_encode_data(m_symbol_size, k, nerrs_data, g_tbls,
+                    m_stripe_survivors[s], recovered[s]);
+            }
         }
 
-        // Recover data
-        ec_init_tables(k, nerrs, c, g_tbls);
-        ec_encode_data(m_symbol_size,
-            k, nerrs, g_tbls, &data[0], &m_buffs[0]);
         m_decoding_result = 0;
+        return nerrs_data * count;
+    }
 
-        return payload_count;
+    /// Check the source symbols recovered by decode_stripes() for the
+    /// stripe holding the symbols stripe
+    bool verify_stripe(uint8_t** stripe, uint8_t** recovered)
+    {
+        for (int i = 0; i < nerrs_data; i++)
+        {
+            if (memcmp(recovered[i], stripe[src_err_list[i]], m_symbol_size))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Reconstruct only bytes offset to offset + length - 1 of the erased
+    /// source symbol esi into out, from the same range of k survivors
+    bool decode_range(std::shared_ptr<isa_encoder> encoder, uint32_t esi,
+        uint32_t offset, uint32_t length, uint8_t* out)
+    {
+        assert((int)esi < k && src_in_err[esi]);
+
+        int i, r;
+        if (!invert_surviving_rows())
+            return false;
+
+        // Set data pointers to point to the range of the encoder payloads
+        for (i = 0, r = 0; i < k; i++, r++)
+        {
+            while (src_in_err[r]) r++;
+            data[i] = encoder->m_buffs[r] + offset;
+        }
+
+        // Recover the range with the row of the inverse matrix d
+        ec_init_tables(k, 1, &d[k * esi], g_tbls);
+        ec_encode_data(length, k, 1, g_tbls, &data[0], &out);
+
+        return true;
+    }
+
+    /// The first erased source symbol
+    uint32_t erased_symbol()
+    {
+        assert(nerrs_data > 0);
+        return src_err_list[0];
+    }
+
+    bool verify_range(std::shared_ptr<isa_encoder> encoder, uint32_t esi,
+        uint32_t offset, uint32_t length, const uint8_t* range)
+    {
+        return memcmp(range, encoder->m_buffs[esi] + offset, length) == 0;
     }
 
     bool verify_data(std::shared_ptr<isa_encoder> encoder)
@@ -230,23 +512,86 @@ struct isa_decoder
 
     bool is_complete() { return (m_decoding_result != -1); }
 
+    /// Run the kernels selected by a tuner instead of ec_encode_data()
+    void set_tuner(std::shared_ptr<isa_kernel_tuner> tuner)
+    {
+        m_tuner = tuner;
+    }
+
     uint32_t block_size() { return m_block_size; }
     uint32_t symbol_size() { return m_symbol_size; }
     uint32_t payload_size() { return m_symbol_size; }
 
+    uint32_t data_erasures() { return nerrs_data; }
+    uint32_t parity_erasures() { return nerrs - nerrs_data; }
+
+    /// The time spent recovering the source symbols and regenerating the
+    /// parity symbols by the last decoding, in microseconds
+    double data_rebuild_time() { return m_data_rebuild_time; }
+    double parity_rebuild_time() { return m_parity_rebuild_time; }
+
 protected:
 
+    /// Construct b with the first k surviving rows of a, and invert it
+    /// into d
+    bool invert_surviving_rows()
+    {
+        int i, j, r;
+
+        // Construct b by removing error rows from a
+        // a contains m rows and k columns
+        for (i = 0, r = 0; i < k; i++, r++)
+        {
+            while (src_in_err[r]) r++;
+            for (j = 0; j < k; j++)
+                b[k * i + j] = a[k * r + j];
+        }
+
+        // Invert the b matrix into d
+        if (gf_invert_matrix(b, d, k) < 0)
+        {
+            printf("BAD MATRIX\n");
+            return false;
+        }
+        return true;
+    }
+
+    /// Construct c with the rows of the inverse matrix d of the erased
+    /// source symbols, and initialize g_tbls with it
+    bool init_recovery_tables()
+    {
+        int i, j;
+
+        if (!invert_surviving_rows())
+            return false;
+
+        // Construct c by copying the erasure rows from the inverse
+        // matrix d
+        for (i = 0; i < nerrs_data; i++)
+        {
+            for (j = 0; j < k; j++)
+                c[k * i + j] = d[k * src_err_list[i] + j];
+        }
+
+        ec_init_tables(k, nerrs_data, c, g_tbls);
+        return true;
+    }
+
     uint8_t* m_buffs[TEST_SOURCES];
     uint8_t a[MMAX*KMAX], b[MMAX*KMAX], c[MMAX*KMAX], d[MMAX*KMAX];
     uint8_t g_tbls[KMAX*TEST_SOURCES*32];
     uint8_t src_in_err[TEST_SOURCES];
     uint8_t src_err_list[TEST_SOURCES];
     uint8_t* data[TEST_SOURCES];
+    // Survivor pointers of the stripes of decode_stripes()
+    std::vector<uint8_t*> m_survivors;
+    std::vector<uint8_t**> m_stripe_survivors;
 
     // Code parameters
     int k, m;
-    // Number of erasures
+    // Number of erasures, and of erased source symbols
     int nerrs;
+    int nerrs_data;
 
     // Number of symbols
     uint32_t m_symbols;
@@ -256,6 +601,148 @@ protected:
     uint32_t m_block_size;
 
     int m_decoding_result;
+
+    // Duration of the source and parity rebuild steps
+    double m_data_rebuild_time;
+    double m_parity_rebuild_time;
+
+    // The tuner selecting the kernels, if any
+    std::shared_ptr<isa_kernel_tuner> m_tuner;
+};
+
+/// The RAID-6 encoder of P, and of Q with 2 encoded symbols. The parities
+/// are the ones of isa_encoder with the same number of encoded symbols.
+struct raid6_pq_encoder
+{
+    raid6_pq_encoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
+        m_codec(symbols), m_symbols(symbols), m_symbol_size(symbol_size),
+        m_payload_count(encoded_symbols)
+    {
+        // P and Q are the only parities
+        assert(m_payload_count >= 1 && m_payload_count <= 2);
+
+        // Symbol size must be a multiple of 64
+        assert(m_symbol_size % 64 == 0);
+
+        m_block_size = m_symbols * m_symbol_size;
+
+        // Allocate the data symbols followed by P and Q
+        m_buffer.resize((m_symbols + 2) * m_symbol_size);
+        for (uint32_t i = 0; i < m_symbols + 2; i++)
+            m_buffs.push_back(&m_buffer[i * m_symbol_size]);
+
+        // Make random data
+        for (uint32_t i = 0; i < m_block_size; i++)
+            m_buffer[i] = rand();
+    }
+
+    void encode_all()
+    {
+        m_codec.encode(&m_buffs[0], m_buffs[m_symbols],
+            m_payload_count > 1 ? m_buffs[m_symbols + 1] : nullptr,
+            m_symbol_size);
+    }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+    uint32_t payload_count() { return m_payload_count; }
+
+protected:
+
+    friend struct raid6_pq_decoder;
+
+    raid6_pq_codec m_codec;
+
+    std::vector<uint8_t> m_buffer;
+    std::vector<uint8_t*> m_buffs;
+
+    // Number of data symbols
+    uint32_t m_symbols;
+    // Size of a symbol
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Number of generated payloads
+    uint32_t m_payload_count;
+};
+
+/// Recovers 1 erased data symbol from P, or 2 from P and Q, the syndromes
+/// and the recovered symbols being written to the decoder
+struct raid6_pq_decoder
+{
+    raid6_pq_decoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols,
+        const erasure_pattern& erasures = erasure_pattern()) :
+        m_codec(symbols), m_symbols(symbols), m_symbol_size(symbol_size),
+        m_payload_count(encoded_symbols), m_complete(false)
+    {
+        m_block_size = m_symbols * m_symbol_size;
+
+        std::set<uint32_t> erased =
+            erasures.generate(m_symbols, encoded_symbols);
+        m_erased.assign(erased.begin(), erased.end());
+
+        // The recovered symbols
+        m_buffer.resize(m_erased.size() * m_symbol_size);
+    }
+
+    uint32_t decode_all(std::shared_ptr<raid6_pq_encoder> encoder)
+    {
+        assert(encoder->payload_count() == m_payload_count);
+
+        // The surviving symbols are read from the encoder, the erased ones
+        // are written to the decoder
+        std::vector<uint8_t*> symbols = encoder->m_buffs;
+        for (uint32_t i = 0; i < m_erased.size(); i++)
+            symbols[m_erased[i]] = &m_buffer[i * m_symbol_size];
+
+        m_complete = m_codec.decode(m_erased, &symbols[0], m_symbol_size);
+
+        return m_payload_count;
+    }
+
+    bool verify_data(std::shared_ptr<raid6_pq_encoder> encoder)
+    {
+        assert(m_block_size == encoder->block_size());
+
+        for (uint32_t i = 0; i < m_erased.size(); i++)
+        {
+            if (memcmp(&m_buffer[i * m_symbol_size],
+                encoder->m_buffs[m_erased[i]], m_symbol_size))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool is_complete() { return m_complete; }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+
+protected:
+
+    raid6_pq_codec m_codec;
+
+    // The erased data symbols, and their recovered copies
+    std::vector<uint32_t> m_erased;
+    std::vector<uint8_t> m_buffer;
+
+    // Number of data symbols
+    uint32_t m_symbols;
+    // Size of a symbol
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Number of encoded symbols
+    uint32_t m_payload_count;
+    // Whether the last decoding succeeded
+    bool m_complete;
 };
 
 BENCHMARK_OPTION(throughput_options)
@@ -292,6 +779,70 @@ BENCHMARK_OPTION(throughput_options)
         gauge::po::value<std::vector<std::string> >()->default_value(
             types, "")->multitoken();
 
+    std::vector<std::string> erasure_models;
+    erasure_models.push_back("uniform");
+
+    auto default_erasure_models =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            erasure_models, "")->multitoken();
+
+    auto default_burst_length = gauge::po::value<uint32_t>()->default_value(4);
+
+    std::vector<uint32_t> range_size;
+    range_size.push_back(4096);
+    range_size.push_back(65536);
+    range_size.push_back(1000000);
+
+    auto default_range_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            range_size, "")->multitoken();
+
+    auto default_failure_domains =
+        gauge::po::value<uint32_t>()->default_value(8);
+
+    std::vector<uint32_t> stripes;
+    stripes.push_back(1);
+    stripes.push_back(8);
+    stripes.push_back(64);
+    stripes.push_back(512);
+
+    auto default_stripes =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            stripes, "")->multitoken();
+
+    auto default_tuning_file =
+        gauge::po::value<std::string>()->default_value("isa_tuning.txt");
+
+    std::vector<uint32_t> pq_symbols;
+    pq_symbols.push_back(4);
+    pq_symbols.push_back(8);
+    pq_symbols.push_back(16);
+    pq_symbols.push_back(32);
+
+    auto default_pq_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            pq_symbols, "")->multitoken();
+
+    std::vector<uint32_t> pq_erasures;
+    pq_erasures.push_back(1);
+    pq_erasures.push_back(2);
+
+    auto default_pq_erasures =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            pq_erasures, "")->multitoken();
+
+    auto default_small_stripes =
+        gauge::po::value<uint32_t>()->default_value(10000);
+
+    std::vector<uint32_t> small_symbol_size;
+    small_symbol_size.push_back(512);
+    small_symbol_size.push_back(4096);
+    small_symbol_size.push_back(65536);
+
+    auto default_small_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            small_symbol_size, "")->multitoken();
+
     options.add_options()
         ("symbols", default_symbols, "Set the number of symbols");
 
@@ -304,6 +855,52 @@ BENCHMARK_OPTION(throughput_options)
     options.add_options()
         ("type", default_types, "Set type [encoder|decoder]");
 
+    options.add_options()
+        ("erasure_model", default_erasure_models,
+         "Set the erasure model of the decoders "
+         "[uniform|burst|markov|failure_domain]");
+
+    options.add_options()
+        ("burst_length", default_burst_length,
+         "Set the (mean) burst length of the burst and markov models");
+
+    options.add_options()
+        ("failure_domains", default_failure_domains,
+         "Set the number of failure domains of the failure_domain model");
+
+    options.add_options()
+        ("range_size", default_range_size,
+         "Set the size in bytes of the ranges read by the DegradedRead "
+         "benchmarks");
+
+    options.add_options()
+        ("stripes", default_stripes,
+         "Set the number of stripes rebuilt by the Rebuild benchmark");
+
+    options.add_options()
+        ("tuning_file", default_tuning_file,
+         "Set the file of the kernels run by the TunedErasureCode benchmark, "
+         "as written by the kernel_tuning benchmark of isa_arithmetic");
+
+    options.add_options()
+        ("small_stripes", default_small_stripes,
+         "Set the number of stripes encoded by the SmallStripes benchmark");
+
+    options.add_options()
+        ("small_symbol_size", default_small_symbol_size,
+         "Set the symbol sizes in bytes of the SmallStripes and Rebuild "
+         "benchmarks");
+
+    options.add_options()
+        ("pq_symbols", default_pq_symbols,
+         "Set the numbers of data symbols of the k + 2 stripes of the PQ "
+         "benchmarks");
+
+    options.add_options()
+        ("pq_erasures", default_pq_erasures,
+         "Set the numbers of erased data symbols (1 or 2) of the PQ "
+         "benchmarks");
+
     gauge::runner::instance().register_options(options);
 }
 
@@ -311,7 +908,7 @@ BENCHMARK_OPTION(throughput_options)
 // ISA Erasure Code
 //------------------------------------------------------------------
 
-typedef throughput_benchmark<isa_encoder, isa_decoder>
+typedef throughput_benchmark<isa_encoder, isa_decoder<>>
     isa_throughput;
 
 BENCHMARK_F_INLINE(isa_throughput, ISA, ErasureCode, 1)
@@ -319,6 +916,525 @@ BENCHMARK_F_INLINE(isa_throughput, ISA, ErasureCode, 1)
     run_benchmark();
 }
 
+/// The encoders and decoders run the kernels selected by the auto-tuner
+/// for their problems. The tuning table is read from the tuning_file at
+/// startup, as written by the kernel_tuning benchmark of isa_arithmetic, and
+/// the problems missing from it run ec_encode_data().
+struct isa_tuned_throughput : public
+    throughput_benchmark<isa_encoder, isa_decoder<>>
+{
+    typedef throughput_benchmark<isa_encoder, isa_decoder<>> base;
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        base::get_options(options);
+
+        std::string tuning_file = options["tuning_file"].as<std::string>();
+
+        m_tuner = std::make_shared<isa_kernel_tuner>();
+        if (!m_tuner->load(tuning_file))
+            printf("Cannot read the tuning file %s\n", tuning_file.c_str());
+    }
+
+    void setup()
+    {
+        base::setup();
+
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t erased_symbols = cs.get_value<uint32_t>("erased_symbols");
+
+        // The encoder makes the parity symbols and the decoder the erased
+        // source symbols, their numbers being the same
+        m_kernel = m_tuner->find(symbols, erased_symbols, symbol_size);
+
+        m_encoder->set_tuner(m_tuner);
+        m_decoder->set_tuner(m_tuner);
+    }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        if (!results.has_column("kernel"))
+            results.add_column("kernel");
+
+        results.set_value("kernel", m_kernel.name());
+    }
+
+protected:
+
+    std::shared_ptr<isa_kernel_tuner> m_tuner;
+
+    // The kernel selected for the current configuration
+    isa_kernel_tuner::kernel m_kernel;
+};
+
+BENCHMARK_F_INLINE(isa_tuned_throughput, ISA, TunedErasureCode, 1)
+{
+    run_benchmark();
+}
+
+/// Any symbol of the stripe can be lost, the decoding cost being split
+/// between the recovery of the source symbols and the regeneration of the
+/// parity symbols
+struct isa_mixed_erasures_throughput : public
+    throughput_benchmark<isa_encoder, isa_decoder<mixed_erasures>>
+{
+    typedef throughput_benchmark<isa_encoder, isa_decoder<mixed_erasures>>
+        base;
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        if (type == "decoder")
+        {
+            if (!results.has_column("data_erasures"))
+                results.add_column("data_erasures");
+
+            results.set_value("data_erasures", m_decoder->data_erasures());
+
+            if (!results.has_column("parity_erasures"))
+                results.add_column("parity_erasures");
+
+            results.set_value("parity_erasures",
+                m_decoder->parity_erasures());
+
+            if (!results.has_column("data_rebuild_time"))
+                results.add_column("data_rebuild_time");
+
+            results.set_value("data_rebuild_time",
+                m_decoder->data_rebuild_time());
+
+            if (!results.has_column("parity_rebuild_time"))
+                results.add_column("parity_rebuild_time");
+
+            results.set_value("parity_rebuild_time",
+                m_decoder->parity_rebuild_time());
+        }
+    }
+};
+
+BENCHMARK_F_INLINE(isa_mixed_erasures_throughput, ISA, MixedErasures, 1)
+{
+    run_benchmark();
+}
+
+/// Rebuild of the stripes of a failed disk: every stripe lost the same
+/// source symbols, so the decoder recovers them all with one set of tables
+/// (see isa_decoder::decode_stripes). The stripes are independent, each
+/// with its own buffers, and are rebuilt either interleaved by
+/// ec_encode_data_stripes() ("interleaved") or one after the other
+/// ("sequential").
+struct isa_rebuild_throughput : public gauge::time_benchmark
+{
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        gauge::config_set cs = get_current_configuration();
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+
+        // The bytes recovered per iteration
+        uint64_t bytes = (uint64_t)m_recovered_symbols * symbol_size /
+            gauge::time_benchmark::iteration_count();
+
+        return bytes / time; // MB/s for each iteration
+    }
+
+    void store_run(tables::table& results)
+    {
+        if (!results.has_column("goodput"))
+            results.add_column("goodput");
+
+        results.set_value("goodput", measurement());
+    }
+
+    bool needs_warmup_iteration()
+    {
+        return false;
+    }
+
+    bool accept_measurement()
+    {
+        if (m_decoder->is_complete() == false)
+            return false;
+
+        // At this point, the output data should be equal to the input data
+        uint8_t*** stripes = m_encoder->stripe_symbols();
+        uint32_t last = m_encoder->stripes() - 1;
+        assert(m_decoder->verify_stripe(stripes[0], m_recovered[0]));
+        assert(m_decoder->verify_stripe(stripes[last], m_recovered[last]));
+        (void)stripes;
+        (void)last;
+
+        return true;
+    }
+
+    std::string unit_text() const
+    {
+        return "MB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto loss_rate = options["loss_rate"].as<std::vector<double> >();
+        auto symbol_size =
+            options["small_symbol_size"].as<std::vector<uint32_t> >();
+        auto stripes = options["stripes"].as<std::vector<uint32_t> >();
+
+        assert(symbols.size() > 0);
+        assert(loss_rate.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(stripes.size() > 0);
+
+        std::vector<std::string> rebuilds;
+        rebuilds.push_back("interleaved");
+        rebuilds.push_back("sequential");
+
+        for (const auto& s : symbols)
+        {
+            for (const auto& r : loss_rate)
+            {
+                for (const auto& p : symbol_size)
+                {
+                    // Symbol size must be a multiple of 64
+                    assert(p % 64 == 0);
+
+                    for (const auto& n : stripes)
+                    {
+                        if (n == 0)
+                            continue;
+
+                        for (const auto& e : rebuilds)
+                        {
+                            gauge::config_set cs;
+                            cs.set_value<uint32_t>("symbols", s);
+                            cs.set_value<uint32_t>("symbol_size", p);
+                            cs.set_value<double>("loss_rate", r);
+                            cs.set_value<uint32_t>("stripes", n);
+                            cs.set_value<std::string>("rebuild", e);
+
+                            uint32_t erased = (uint32_t)std::ceil(s * r);
+                            cs.set_value<uint32_t>("erased_symbols", erased);
+
+                            add_configuration(cs);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t erased_symbols = cs.get_value<uint32_t>("erased_symbols");
+        uint32_t stripes = cs.get_value<uint32_t>("stripes");
+
+        m_encoder = std::make_shared<isa_stripe_encoder>(
+            stripes, symbols, symbol_size, erased_symbols);
+        m_decoder = std::make_shared<isa_decoder<>>(
+            symbols, symbol_size, erased_symbols);
+
+        m_encoder->encode_all();
+
+        // The buffers of the recovered symbols, distinct for each stripe
+        // as the stripes of the encoder
+        uint32_t distinct = m_encoder->distinct_stripes();
+        m_storage.assign((size_t)distinct * erased_symbols * symbol_size, 0);
+        m_symbols.resize((size_t)stripes * erased_symbols);
+        m_recovered.resize(stripes);
+        for (uint32_t s = 0; s < stripes; s++)
+        {
+            for (uint32_t i = 0; i < erased_symbols; i++)
+            {
+                m_symbols[(size_t)s * erased_symbols + i] = &m_storage[
+                    ((size_t)(s % distinct) * erased_symbols + i) *
+                    symbol_size];
+            }
+            m_recovered[s] = &m_symbols[(size_t)s * erased_symbols];
+        }
+    }
+
+    void start()
+    {
+        m_recovered_symbols = 0;
+        gauge::time_benchmark::start();
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        bool interleaved =
+            cs.get_value<std::string>("rebuild") == "interleaved";
+
+        // The clock is running
+        RUN
+        {
+            m_recovered_symbols += m_decoder->decode_stripes(
+                m_encoder->stripe_symbols(), &m_recovered[0],
+                m_encoder->stripes(), interleaved);
+        }
+    }
+
+protected:
+
+    /// The encoder of the stripes
+    std::shared_ptr<isa_stripe_encoder> m_encoder;
+
+    /// The decoder
+    std::shared_ptr<isa_decoder<>> m_decoder;
+
+    /// Storage and pointers of the recovered symbols of each stripe
+    std::vector<uint8_t> m_storage;
+    std::vector<uint8_t*> m_symbols;
+    std::vector<uint8_t**> m_recovered;
+
+    /// The number of symbols recovered, over all the stripes
+    uint64_t m_recovered_symbols;
+};
+
+BENCHMARK_F_INLINE(isa_rebuild_throughput, ISA, Rebuild, 1)
+{
+    run_benchmark();
+}
+
+/// Encoding of many small stripes sharing one generator matrix, each one
+/// on its own ("per_stripe") or all of them with ec_encode_data_stripes()
+/// ("batched"), reported in stripes per second
+struct isa_small_stripes_throughput : public gauge::time_benchmark
+{
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        return m_encoder->stripes() / time * 1e6;
+    }
+
+    void store_run(tables::table& results)
+    {
+        if (!results.has_column("stripes_per_second"))
+            results.add_column("stripes_per_second");
+
+        double stripes_per_second = measurement();
+        results.set_value("stripes_per_second", stripes_per_second);
+
+        if (!results.has_column("ns_per_stripe"))
+            results.add_column("ns_per_stripe");
+
+        results.set_value("ns_per_stripe", 1e9 / stripes_per_second);
+    }
+
+    bool needs_warmup_iteration()
+    {
+        return false;
+    }
+
+    bool accept_measurement()
+    {
+        // The last stripe shares its buffers with no later stripe
+        assert(m_encoder->verify_stripe(0));
+        assert(m_encoder->verify_stripe(m_encoder->stripes() - 1));
+
+        return true;
+    }
+
+    std::string unit_text() const
+    {
+        return "stripes/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto loss_rate = options["loss_rate"].as<std::vector<double> >();
+        auto symbol_size =
+            options["small_symbol_size"].as<std::vector<uint32_t> >();
+        auto stripes = options["small_stripes"].as<uint32_t>();
+
+        assert(symbols.size() > 0);
+        assert(loss_rate.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(stripes > 0);
+
+        std::vector<std::string> encodings;
+        encodings.push_back("per_stripe");
+        encodings.push_back("batched");
+
+        for (const auto& s : symbols)
+        {
+            for (const auto& r : loss_rate)
+            {
+                for (const auto& p : symbol_size)
+                {
+                    // Symbol size must be a multiple of 64
+                    assert(p % 64 == 0);
+
+                    for (const auto& e : encodings)
+                    {
+                        gauge::config_set cs;
+                        cs.set_value<uint32_t>("symbols", s);
+                        cs.set_value<uint32_t>("symbol_size", p);
+                        cs.set_value<double>("loss_rate", r);
+                        cs.set_value<uint32_t>("stripes", stripes);
+                        cs.set_value<std::string>("encoding", e);
+
+                        uint32_t parity = (uint32_t)std::ceil(s * r);
+                        cs.set_value<uint32_t>("parity_symbols", parity);
+
+                        add_configuration(cs);
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t parity_symbols = cs.get_value<uint32_t>("parity_symbols");
+        uint32_t stripes = cs.get_value<uint32_t>("stripes");
+
+        m_encoder = std::make_shared<isa_stripe_encoder>(
+            stripes, symbols, symbol_size, parity_symbols);
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string encoding = cs.get_value<std::string>("encoding");
+
+        if (encoding == "batched")
+        {
+            // The clock is running
+            RUN
+            {
+                m_encoder->encode_all();
+            }
+        }
+        else
+        {
+            // The clock is running
+            RUN
+            {
+                m_encoder->encode_each();
+            }
+        }
+    }
+
+protected:
+
+    /// The encoder
+    std::shared_ptr<isa_stripe_encoder> m_encoder;
+};
+
+BENCHMARK_F_INLINE(isa_small_stripes_throughput, ISA, SmallStripes, 1)
+{
+    run_benchmark();
+}
+
+typedef degraded_read_benchmark<isa_encoder, isa_decoder<>>
+    isa_degraded_read;
+
+BENCHMARK_F_INLINE(isa_degraded_read, ISA, DegradedRead, 1)
+{
+    run_benchmark();
+}
+
+/// The k + 2 stripes of the warm tier: the throughput benchmark for the
+/// numbers of data symbols of the pq_symbols option, and 1 or 2 encoded and
+/// erased symbols (pq_erasures option) instead of the loss rate
+template<class Encoder, class Decoder>
+struct pq_throughput : public throughput_benchmark<Encoder, Decoder>
+{
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["pq_symbols"].as<std::vector<uint32_t> >();
+        auto erasures = options["pq_erasures"].as<std::vector<uint32_t> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto types = options["type"].as<std::vector<std::string> >();
+        auto models =
+            options["erasure_model"].as<std::vector<std::string> >();
+        this->m_burst_length = options["burst_length"].as<uint32_t>();
+        this->m_failure_domains = options["failure_domains"].as<uint32_t>();
+
+        assert(symbols.size() > 0);
+        assert(erasures.size() > 0);
+        assert(symbol_size.size() > 0);
+        assert(types.size() > 0);
+        assert(models.size() > 0);
+
+        for (const auto& s : symbols)
+        {
+            for (const auto& r : erasures)
+            {
+                // P and Q recover at most 2 symbols
+                assert(r >= 1 && r <= 2 && r <= s);
+
+                for (const auto& p : symbol_size)
+                {
+                    // Symbol size must be a multiple of 64
+                    assert(p % 64 == 0);
+
+                    for (const auto& t : types)
+                    {
+                        for (const auto& e : models)
+                        {
+                            assert(erasure_pattern::is_model(e));
+
+                            // The erasures only matter to the decoders
+                            if (t != "decoder" && e != models[0])
+                                continue;
+
+                            gauge::config_set cs;
+                            cs.set_value<uint32_t>("symbols", s);
+                            cs.set_value<uint32_t>("symbol_size", p);
+                            cs.set_value<double>("loss_rate", (double)r / s);
+                            cs.set_value<std::string>("type", t);
+                            cs.set_value<std::string>("erasure_model", e);
+                            cs.set_value<uint32_t>("erased_symbols", r);
+
+                            this->add_configuration(cs);
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+/// P and Q computed with XORs and multiplications by 2
+typedef pq_throughput<raid6_pq_encoder, raid6_pq_decoder> raid6_pq_throughput;
+
+BENCHMARK_F_INLINE(raid6_pq_throughput, ISA, PQ, 1)
+{
+    run_benchmark();
+}
+
+/// The same stripes with ec_encode_data(), as the ErasureCode benchmark
+typedef pq_throughput<isa_encoder, isa_decoder<>> isa_pq_throughput;
+
+BENCHMARK_F_INLINE(isa_pq_throughput, ISA, PQErasureCode, 1)
+{
+    run_benchmark();
+}
+
 int main(int argc, const char* argv[])
 {
     srand(static_cast<uint32_t>(time(0)));
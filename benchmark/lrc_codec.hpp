@@ -0,0 +1,180 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <vector>
+
+#include "isa_linear_codec.hpp"
+
+/// The Locally Repairable Code of Azure storage, LRC(k, l, r): the k data
+/// symbols are split into l groups of k / l symbols, each with a local
+/// parity (the XOR of the group), and r global parities are computed from
+/// all the data symbols (the rows of the Cauchy matrix of ISA). The
+/// symbols are the k data symbols, then the l local parities, then the r
+/// global parities.
+///
+/// A lost data symbol or local parity is repaired from the k / l other
+/// symbols of its group only, instead of k symbols for the RS code of the
+/// same overhead. The other erasures go through the generator matrix of
+/// the whole code, once the groups with a single erasure are repaired.
+struct lrc_codec
+{
+    lrc_codec(uint32_t k, uint32_t l, uint32_t r) :
+        m_k(k), m_l(l), m_r(r), m_group_size(k / l),
+        m_code(k, k + l + r, parity_matrix(k, l, r))
+    {
+        assert(l > 0 && k % l == 0);
+
+        // The tables of the global parities alone
+        m_global_tables.resize(k * r * 32);
+        if (r > 0)
+        {
+            ec_init_tables(k, r, (unsigned char*)m_code.row(k + l),
+                m_global_tables.data());
+        }
+    }
+
+    uint32_t k() const { return m_k; }
+    uint32_t n() const { return m_k + m_l + m_r; }
+
+    /// The size of the groups of the local parities
+    uint32_t group_size() const { return m_group_size; }
+
+    /// Compute the local and global parities from the k data symbols of
+    /// size bytes, the n symbols following each other in symbols
+    void encode(uint8_t** symbols, uint32_t size) const
+    {
+        for (uint32_t g = 0; g < m_l; g++)
+        {
+            xor_symbols(&symbols[g * m_group_size], m_group_size,
+                symbols[m_k + g], size);
+        }
+
+        if (m_r > 0)
+        {
+            ec_encode_data(size, m_k, m_r,
+                (unsigned char*)m_global_tables.data(), symbols,
+                &symbols[m_k + m_l]);
+        }
+    }
+
+    /// Recover the erased symbols in place in the n symbols: first in the
+    /// groups with a single erasure, then through the whole code. Returns
+    /// the number of bytes read, or 0 if the erasures cannot be decoded.
+    uint64_t decode(const std::vector<uint32_t>& erased, uint8_t** symbols,
+        uint32_t size) const
+    {
+        std::vector<uint32_t> lost(m_l, 0);
+        for (uint32_t e : erased)
+        {
+            if (e < m_k + m_l)
+                lost[group(e)]++;
+        }
+
+        uint64_t read = 0;
+        std::vector<uint32_t> remaining;
+        for (uint32_t e : erased)
+        {
+            if (e < m_k + m_l && lost[group(e)] == 1)
+                read += repair_local(e, symbols, size);
+            else
+                remaining.push_back(e);
+        }
+
+        if (remaining.empty())
+            return read;
+
+        // The symbols repaired in their groups are now available
+        uint64_t global = m_code.decode(remaining, symbols, size);
+        return global == 0 ? 0 : read + global;
+    }
+
+    /// Recover the single erased symbol e in place, in its group if it is a
+    /// data symbol or a local parity. Returns the number of bytes read.
+    uint64_t repair(uint32_t e, uint8_t** symbols, uint32_t size) const
+    {
+        if (e < m_k + m_l)
+            return repair_local(e, symbols, size);
+
+        // A global parity is computed again from the data symbols
+        ec_encode_data(size, m_k, 1,
+            (unsigned char*)&m_global_tables[(e - m_k - m_l) * m_k * 32],
+            symbols, &symbols[e]);
+        return (uint64_t)m_k * size;
+    }
+
+private:
+
+    /// The group of a data symbol or local parity
+    uint32_t group(uint32_t e) const
+    {
+        return e < m_k ? e / m_group_size : e - m_k;
+    }
+
+    /// Recover e as the XOR of the other symbols of its group
+    uint64_t repair_local(uint32_t e, uint8_t** symbols, uint32_t size) const
+    {
+        uint32_t g = group(e);
+
+        std::vector<uint8_t*> sources;
+        for (uint32_t i = g * m_group_size; i < (g + 1) * m_group_size; i++)
+        {
+            if (i != e)
+                sources.push_back(symbols[i]);
+        }
+        if (e != m_k + g)
+            sources.push_back(symbols[m_k + g]);
+
+        xor_symbols(sources.data(), m_group_size, symbols[e], size);
+        return (uint64_t)m_group_size * size;
+    }
+
+    /// Write the XOR of the count sources of size bytes to dest. The loops
+    /// are vectorized with the SIMD_SHARED flags of the wscript, without the
+    /// table lookups of a GF(2^8) dot product with coefficients of 1
+    static void xor_symbols(uint8_t* const* sources, uint32_t count,
+        uint8_t* dest, uint32_t size)
+    {
+        memcpy(dest, sources[0], size);
+        for (uint32_t s = 1; s < count; s++)
+        {
+            const uint8_t* src = sources[s];
+            for (uint32_t i = 0; i < size; i++)
+                dest[i] ^= src[i];
+        }
+    }
+
+    /// The l local rows of ones on their groups, then the r rows of the
+    /// Cauchy matrix
+    static std::vector<uint8_t> parity_matrix(uint32_t k, uint32_t l,
+        uint32_t r)
+    {
+        std::vector<uint8_t> a((l + r) * k, 0);
+        for (uint32_t g = 0; g < l; g++)
+            for (uint32_t j = g * (k / l); j < (g + 1) * (k / l); j++)
+                a[g * k + j] = 1;
+
+        std::vector<uint8_t> cauchy((k + r) * k);
+        gf_gen_cauchy1_matrix(cauchy.data(), k + r, k);
+        std::copy(cauchy.begin() + k * k, cauchy.end(), a.begin() + l * k);
+        return a;
+    }
+
+    uint32_t m_k;
+    uint32_t m_l;
+    uint32_t m_r;
+    uint32_t m_group_size;
+
+    // The whole code, for the erasures beyond the groups
+    isa_linear_codec m_code;
+
+    // The tables of the global parities
+    std::vector<uint8_t> m_global_tables;
+};
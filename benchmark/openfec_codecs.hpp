@@ -0,0 +1,783 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "erasure_pattern.hpp"
+#include "openfec_session.hpp"
+
+/// The OpenFEC Reed-Solomon and LDPC-Staircase encoders and decoders of a
+/// block, with the interface of throughput_benchmark
+
+struct openfec_rs_encoder
+{
+    openfec_rs_encoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
+        m_symbols(symbols), m_symbol_size(symbol_size)
+    {
+        k = m_symbols;
+        m = encoded_symbols;
+        m_block_size = m_symbols * m_symbol_size;
+        m_payload_count = encoded_symbols;
+        m_threads = 1;
+
+        int i;
+        int vector_count = k + m;
+
+        // Resize data vectors
+        m_symbol_table.resize(vector_count);
+        m_data.resize(vector_count);
+        for (i = 0; i < vector_count; i++)
+        {
+            m_data[i].resize(m_symbol_size);
+        }
+
+        // Set pointers to point to the input symbols
+        for (i = 0; i < k; i++)
+        {
+            // Fill source symbols with random data
+            for (uint8_t &e : m_data[i])
+            {
+                e = rand() % 256;
+            }
+            m_symbol_table[i] = (char*)&(m_data[i][0]);
+        }
+
+        // Set pointers to point to the repair symbol buffers
+        for (i = k; i < k + m; i++)
+        {
+            m_symbol_table[i] = (char*)&(m_data[i][0]);
+        }
+    }
+
+    ~openfec_rs_encoder()
+    {
+    }
+
+    static void set_parameters(of_rs_parameters_t& params, int k, int m,
+        uint32_t symbol_size)
+    {
+        params.nb_source_symbols = k;
+        params.nb_repair_symbols = m;
+        params.encoding_symbol_length = symbol_size;
+    }
+
+    void encode_all()
+    {
+        assert(m_payload_count == (uint32_t)m);
+
+        of_rs_parameters_t params;
+        set_parameters(params, k, m, m_symbol_size);
+
+        of_session_t* ses = openfec_create_session(
+            OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, OF_ENCODER,
+            (of_parameters_t*)&params);
+        if (ses == NULL)
+            return;
+
+        // Generate repair symbols. The repair symbols only depend on the
+        // source symbols, so each thread builds its own range of them with
+        // the shared session, which is left untouched by the encoding.
+        auto build_repair_symbols = [this, ses](int first, int last)
+        {
+            openfec_build_repair_symbols(ses, (void**)&m_symbol_table[0],
+                first, last);
+        };
+
+        uint32_t threads = std::min<uint32_t>(m_threads, m);
+
+        if (threads > 1)
+        {
+            std::vector<std::thread> workers;
+            for (uint32_t t = 1; t < threads; t++)
+            {
+                workers.emplace_back(build_repair_symbols,
+                    k + (int)(m * t / threads), k + (int)(m * (t + 1) / threads));
+            }
+            build_repair_symbols(k, k + (int)(m / threads));
+            for (auto& w : workers)
+            {
+                w.join();
+            }
+        }
+        else
+        {
+            build_repair_symbols(k, k + m);
+        }
+
+        openfec_release_session(ses);
+    }
+
+    void set_threads(uint32_t threads) { m_threads = threads; }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+    uint32_t payload_count() { return m_payload_count; }
+
+protected:
+
+    friend struct openfec_rs_decoder;
+
+    // Code parameters
+    int k, m;
+
+    // Threads building the repair symbols of the block
+    uint32_t m_threads;
+
+    // Number of symbols
+    uint32_t m_symbols;
+    // Size of k+m symbols
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Number of generated payloads
+    uint32_t m_payload_count;
+
+    // Table of all symbols (source+repair) in sequential order
+    std::vector<char*> m_symbol_table;
+
+    // Storage for source and repair symbols
+    std::vector<std::vector<uint8_t>> m_data;
+};
+
+
+struct openfec_rs_decoder
+{
+    openfec_rs_decoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols,
+        const erasure_pattern& erasures = erasure_pattern()) :
+        m_symbols(symbols), m_symbol_size(symbol_size)
+    {
+        k = m_symbols;
+        m = encoded_symbols;
+        m_block_size = m_symbols * m_symbol_size;
+        m_decoding_result = -1;
+        m_threads = 1;
+        uint32_t payload_count = encoded_symbols;
+
+        // Resize data vector to hold original symbols
+        m_data.resize(m_symbols);
+        for (uint32_t i = 0; i < m_symbols; i++)
+        {
+            m_data[i].resize(m_symbol_size);
+        }
+
+        // Simulate m erasures (erase some original symbols)
+        // The symbols will be restored by processing the encoded symbols
+        m_erased = erasures.generate(k, payload_count);
+    }
+
+    ~openfec_rs_decoder()
+    {
+    }
+
+    static void* allocate_source_symbol(void* context, uint32_t size,
+        uint32_t esi)
+    {
+        openfec_rs_decoder* self = (openfec_rs_decoder*)context;
+        assert(size == self->m_symbol_size);
+        return (void*)&(self->m_data[esi][0]);
+    }
+
+    static void* allocate_range_symbol(void* context, uint32_t size,
+        uint32_t esi)
+    {
+        openfec_rs_decoder* self = (openfec_rs_decoder*)context;
+        assert(size == self->m_range_length);
+
+        // The read range goes to the caller buffer, the same range of the
+        // other erased symbols is rebuilt in place
+        if (esi == self->m_range_symbol)
+            return (void*)self->m_range_out;
+        return (void*)&(self->m_data[esi][self->m_range_offset]);
+    }
+
+    /// Create a decoding session whose symbols are symbol_length bytes
+    of_session_t* create_session(uint32_t symbol_length)
+    {
+        of_rs_parameters_t params;
+        openfec_rs_encoder::set_parameters(params, k, m, symbol_length);
+
+        of_session_t* ses = openfec_create_session(
+            OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, OF_DECODER,
+            (of_parameters_t*)&params);
+        if (ses == NULL)
+            return NULL;
+
+        // The missing source symbols are rebuilt by byte ranges, one per
+        // thread
+        if (m_threads != 1)
+        {
+            UINT32 threads = m_threads;
+            if (of_set_control_parameter(ses,
+                OF_CRTL_REED_SOLOMON_SET_NB_THREADS, &threads,
+                sizeof(threads)) != OF_STATUS_OK)
+            {
+                printf("of_set_control_parameter() failed\n");
+            }
+        }
+
+        return ses;
+    }
+
+    uint32_t decode_all(std::shared_ptr<openfec_rs_encoder> encoder)
+    {
+        int payload_count = (int)encoder->payload_count();
+        assert(payload_count == m);
+        (void)payload_count;
+
+        of_session_t* ses = create_session(m_symbol_size);
+        if (ses == NULL)
+            return 0;
+
+        // The decoder uses pre-allocated data buffers to avoid unnecessary
+        // copying after decoding
+        of_set_callback_functions(ses,
+            allocate_source_symbol, NULL, (void*)this);
+
+        // Process original and repair symbols
+        bool complete;
+        uint32_t processed_symbols = openfec_decode_symbols(ses, k, m,
+            m_erased, [&encoder](int i) { return &encoder->m_data[i][0]; },
+            complete);
+        if (complete)
+            m_decoding_result = 0;
+
+        openfec_release_session(ses);
+
+        return processed_symbols;
+    }
+
+    /// Reconstruct only bytes offset to offset + length - 1 of the erased
+    /// source symbol esi into out. The session works on symbols of length
+    /// bytes, fed with the same range of the received symbols, so the same
+    /// range of the other erased source symbols is rebuilt along with it
+    bool decode_range(std::shared_ptr<openfec_rs_encoder> encoder,
+        uint32_t esi, uint32_t offset, uint32_t length, uint8_t* out)
+    {
+        assert(m_erased.count(esi));
+        assert(offset + length <= m_symbol_size);
+
+        of_session_t* ses = create_session(length);
+        if (ses == NULL)
+            return false;
+
+        m_range_symbol = esi;
+        m_range_offset = offset;
+        m_range_length = length;
+        m_range_out = out;
+
+        of_set_callback_functions(ses,
+            allocate_range_symbol, NULL, (void*)this);
+
+        bool complete;
+        openfec_decode_symbols(ses, k, m, m_erased,
+            [&encoder, offset](int i) { return &encoder->m_data[i][offset]; },
+            complete);
+
+        openfec_release_session(ses);
+
+        return complete;
+    }
+
+    /// The first erased source symbol
+    uint32_t erased_symbol()
+    {
+        assert(!m_erased.empty());
+        return *m_erased.begin();
+    }
+
+    bool verify_range(std::shared_ptr<openfec_rs_encoder> encoder,
+        uint32_t esi, uint32_t offset, uint32_t length, const uint8_t* range)
+    {
+        return memcmp(range, &(encoder->m_data[esi][offset]), length) == 0;
+    }
+
+    bool verify_data(std::shared_ptr<openfec_rs_encoder> encoder)
+    {
+        assert(m_block_size == encoder->block_size());
+
+        // We only verify the erased symbols
+        for (const uint32_t& e : m_erased)
+        {
+            if (memcmp(&m_data[e][0], &(encoder->m_data[e][0]), m_symbol_size))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool is_complete() { return (m_decoding_result != -1); }
+
+    void set_threads(uint32_t threads) { m_threads = threads; }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+
+protected:
+
+    // Code parameters
+    int k, m;
+
+    // Number of symbols
+    uint32_t m_symbols;
+    // Size of k+m symbols
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Set of erased symbols
+    std::set<uint32_t> m_erased;
+
+    int m_decoding_result;
+
+    // Threads rebuilding the missing source symbols of the block
+    uint32_t m_threads;
+
+    // The range being read by decode_range(), and its destination
+    uint32_t m_range_symbol;
+    uint32_t m_range_offset;
+    uint32_t m_range_length;
+    uint8_t* m_range_out;
+
+    // Storage for source symbols
+    std::vector<std::vector<uint8_t>> m_data;
+};
+
+struct openfec_ldpc_encoder
+{
+    openfec_ldpc_encoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
+        m_symbols(symbols), m_symbol_size(symbol_size)
+    {
+        k = m_symbols;
+        // Each source symbol takes part in N1 >= 3 repair equations, so
+        // there must be at least 3 repair symbols
+        m = std::max(encoded_symbols, 3U);
+        m_block_size = m_symbols * m_symbol_size;
+        m_payload_count = m;
+
+        int i;
+        int vector_count = k + m;
+
+        // Resize data vectors
+        m_symbol_table.resize(vector_count);
+        m_data.resize(vector_count);
+        for (i = 0; i < vector_count; i++)
+        {
+            m_data[i].resize(m_symbol_size);
+        }
+
+        // Set pointers to point to the input symbols
+        for (i = 0; i < k; i++)
+        {
+            // Fill source symbols with random data
+            for (uint8_t &e : m_data[i])
+            {
+                e = rand() % 256;
+            }
+            m_symbol_table[i] = (char*)&(m_data[i][0]);
+        }
+
+        // Set pointers to point to the repair symbol buffers
+        for (i = k; i < k + m; i++)
+        {
+            m_symbol_table[i] = (char*)&(m_data[i][0]);
+        }
+    }
+
+    ~openfec_ldpc_encoder()
+    {
+    }
+
+    static void set_parameters(of_ldpc_parameters_t& params, int k, int m,
+        uint32_t symbol_size)
+    {
+        params.nb_source_symbols = k;
+        params.nb_repair_symbols = m;
+        params.encoding_symbol_length = symbol_size;
+        // The encoder and the decoder must build the same matrix
+        params.prng_seed = 1234;
+        // N1 cannot exceed the number of repair symbols
+        params.N1 = (uint8_t)std::min(5, m);
+    }
+
+    void encode_all()
+    {
+        assert(m_payload_count == (uint32_t)m);
+
+        of_ldpc_parameters_t params;
+        set_parameters(params, k, m, m_symbol_size);
+
+        of_session_t* ses = openfec_create_session(
+            OF_CODEC_LDPC_STAIRCASE_STABLE, OF_ENCODER,
+            (of_parameters_t*)&params);
+        if (ses == NULL)
+            return;
+
+        openfec_build_repair_symbols(ses, (void**)&m_symbol_table[0],
+            k, k + m);
+
+        openfec_release_session(ses);
+    }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+    uint32_t payload_count() { return m_payload_count; }
+
+protected:
+
+    template<class Memory, class Elimination, class SymbolOps>
+    friend struct openfec_ldpc_decoder;
+
+    // Code parameters
+    int k, m;
+
+    // Number of symbols
+    uint32_t m_symbols;
+    // Size of k+m symbols
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Number of generated payloads
+    uint32_t m_payload_count;
+
+    // Table of all symbols (source+repair) in sequential order
+    std::vector<char*> m_symbol_table;
+
+    // Storage for source and repair symbols
+    std::vector<std::vector<uint8_t>> m_data;
+};
+
+
+/// Tags selecting how the LDPC decoder stores the repair symbols and the
+/// partial sums: on the heap (default), in a symbol pool reset between
+/// blocks, or in a pool without copying the received repair symbols
+struct heap_memory{};
+struct pool_memory{};
+struct zero_copy_memory{};
+
+/// Tags selecting how the ML decoder solves the simplified system: as a
+/// whole dense system eliminated one column at a time (default, the
+/// library's own algorithm) or by blocks of columns with the Method of Four
+/// Russians, or by inactivation decoding, only the inactive columns making
+/// a dense system eliminated with the Method of Four Russians
+struct column_elimination{};
+struct m4ri_elimination{};
+struct inactivation_decoding{};
+
+/// Tags selecting how the ML decoder executes the symbol XORs of the dense
+/// system: as soon as the elimination requests them (default), or recorded,
+/// optimized then executed at once
+struct immediate_symbol_ops{};
+struct deferred_symbol_ops{};
+
+template<class Memory = heap_memory,
+    class Elimination = column_elimination,
+    class SymbolOps = immediate_symbol_ops>
+struct openfec_ldpc_decoder
+{
+    openfec_ldpc_decoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t erased_symbols,
+        const erasure_pattern& erasures = erasure_pattern()) :
+        m_symbols(symbols), m_symbol_size(symbol_size)
+    {
+        k = m_symbols;
+        m_block_size = m_symbols * m_symbol_size;
+        m_decoding_result = -1;
+        m_pchk_bytes_per_entry = 0;
+        m_heap_allocs = 0;
+        m_pool_allocs = 0;
+        m_ml_dense_cols = 0;
+        m_ml_time = 0;
+        m_ml_symbol_xors = 0;
+        m_ml_saved_symbol_xors = 0;
+        m_ml_threads = 1;
+        m_pool = NULL;
+
+        // Resize data vector to hold original symbols
+        m_data.resize(m_symbols);
+        for (uint32_t i = 0; i < m_symbols; i++)
+        {
+            m_data[i].resize(m_symbol_size);
+        }
+
+        // Erase some original symbols, LDPC codes usually need a few more
+        // repair symbols than erased_symbols to restore them
+        m_erased = erasures.generate(k, erased_symbols);
+    }
+
+    ~openfec_ldpc_decoder()
+    {
+        of_symbol_pool_release(m_pool);
+    }
+
+    static void* allocate_source_symbol(void* context, uint32_t size,
+        uint32_t esi)
+    {
+        openfec_ldpc_decoder* self = (openfec_ldpc_decoder*)context;
+        assert(size == self->m_symbol_size);
+        return (void*)&(self->m_data[esi][0]);
+    }
+
+    uint32_t decode_all(std::shared_ptr<openfec_ldpc_encoder> encoder)
+    {
+        int m = (int)encoder->payload_count();
+
+        if (!std::is_same<Memory, heap_memory>::value)
+        {
+            // Room for a copy of each repair symbol and a partial sum per
+            // equation. The pool is kept across blocks, and reset in O(1).
+            if (m_pool == NULL || m_pool->nb_symbols < 2 * (uint32_t)m)
+            {
+                of_symbol_pool_release(m_pool);
+                m_pool = of_symbol_pool_create(m_symbol_size, 2 * m);
+            }
+            else
+            {
+                of_symbol_pool_reset(m_pool);
+            }
+        }
+
+        uint32_t allocs = of_get_nb_allocs();
+
+        of_ldpc_parameters_t params;
+        openfec_ldpc_encoder::set_parameters(params, k, m, m_symbol_size);
+
+        of_session_t* ses = openfec_create_session(
+            OF_CODEC_LDPC_STAIRCASE_STABLE, OF_DECODER,
+            (of_parameters_t*)&params);
+        if (ses == NULL)
+            return 0;
+
+        // Measure the parity check matrix before decoding consumes it
+        if (of_get_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_GET_PCHK_BYTES_PER_ENTRY,
+            &m_pchk_bytes_per_entry, sizeof(m_pchk_bytes_per_entry)))
+        {
+            m_pchk_bytes_per_entry = 0;
+        }
+
+        if (m_pool != NULL && of_set_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL, &m_pool, sizeof(m_pool)))
+        {
+            printf("of_set_control_parameter() failed\n");
+        }
+
+        if (std::is_same<Memory, zero_copy_memory>::value)
+        {
+            // The encoder keeps the repair symbols alive during decoding
+            UINT32 zero_copy = 1;
+            if (of_set_control_parameter(ses,
+                OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY, &zero_copy,
+                sizeof(zero_copy)))
+            {
+                printf("of_set_control_parameter() failed\n");
+            }
+        }
+
+        // The ML decoder is configured by the tags only, whatever the
+        // defaults of the library
+        UINT32 inactivation =
+            std::is_same<Elimination, inactivation_decoding>::value;
+        if (of_set_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_SET_ML_INACTIVATION, &inactivation,
+            sizeof(inactivation)))
+        {
+            printf("of_set_control_parameter() failed\n");
+        }
+
+        UINT32 m4ri_k = std::is_same<Elimination, column_elimination>::value ?
+            0 : OF_ML_M4RI_DEFAULT_K;
+        if (of_set_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K, &m4ri_k, sizeof(m4ri_k)))
+        {
+            printf("of_set_control_parameter() failed\n");
+        }
+
+        UINT32 deferred = std::is_same<SymbolOps, deferred_symbol_ops>::value;
+        if (of_set_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_SET_ML_DEFERRED_SYMBOL_OPS, &deferred,
+            sizeof(deferred)))
+        {
+            printf("of_set_control_parameter() failed\n");
+        }
+
+        if (m_ml_threads != 1)
+        {
+            UINT32 threads = m_ml_threads;
+            if (of_set_control_parameter(ses,
+                OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS, &threads,
+                sizeof(threads)))
+            {
+                printf("of_set_control_parameter() failed\n");
+            }
+        }
+
+        // The decoder uses pre-allocated data buffers to avoid unnecessary
+        // copying after IT decoding
+        of_set_callback_functions(ses,
+            allocate_source_symbol, NULL, (void*)this);
+
+        // Process original and repair symbols
+        bool complete;
+        uint32_t processed_symbols = openfec_decode_symbols(ses, k, m,
+            m_erased, [&encoder](int i) { return &encoder->m_data[i][0]; },
+            complete);
+        if (complete)
+            m_decoding_result = 0;
+
+        // Fall back to ML decoding if IT decoding was not sufficient
+        m_ml_time = 0;
+        if (m_decoding_result == -1)
+        {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            if (of_finish_decoding(ses) == OF_STATUS_OK)
+            {
+                m_decoding_result = 0;
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            m_ml_time = (double)std::chrono::duration_cast<
+                std::chrono::microseconds>(t1 - t0).count();
+        }
+
+        if (of_get_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_GET_ML_DENSE_COLS, &m_ml_dense_cols,
+            sizeof(m_ml_dense_cols)))
+        {
+            m_ml_dense_cols = 0;
+        }
+
+        if (of_get_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_GET_ML_SYMBOL_XORS, &m_ml_symbol_xors,
+            sizeof(m_ml_symbol_xors)) ||
+            of_get_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_GET_ML_SAVED_SYMBOL_XORS,
+            &m_ml_saved_symbol_xors, sizeof(m_ml_saved_symbol_xors)))
+        {
+            m_ml_symbol_xors = 0;
+            m_ml_saved_symbol_xors = 0;
+        }
+
+        openfec_move_decoded_symbols(ses, k, m_erased, m_symbol_size,
+            [this](uint32_t e) { return &m_data[e][0]; });
+        openfec_release_session(ses);
+
+        m_heap_allocs = of_get_nb_allocs() - allocs;
+        m_pool_allocs = (m_pool != NULL) ? m_pool->nb_pool_allocs : 0;
+
+        return processed_symbols;
+    }
+
+    bool verify_data(std::shared_ptr<openfec_ldpc_encoder> encoder)
+    {
+        assert(m_block_size == encoder->block_size());
+
+        // We only verify the erased symbols
+        for (const uint32_t& e : m_erased)
+        {
+            if (memcmp(&m_data[e][0], &(encoder->m_data[e][0]), m_symbol_size))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool is_complete() { return (m_decoding_result != -1); }
+
+    uint32_t block_size() { return m_block_size; }
+    uint32_t symbol_size() { return m_symbol_size; }
+    uint32_t payload_size() { return m_symbol_size; }
+
+    /// @return The memory used per entry of the parity check matrix
+    uint32_t pchk_bytes_per_entry() { return m_pchk_bytes_per_entry; }
+
+    /// @return The number of heap allocations done by the last block
+    uint32_t heap_allocs() { return m_heap_allocs; }
+
+    /// @return The number of symbol buffers taken from the pool by the
+    ///         last block
+    uint32_t pool_allocs() { return m_pool_allocs; }
+
+    /// @return The number of columns of the dense system solved by ML
+    ///         decoding in the last block (0 if IT decoding was enough)
+    uint32_t ml_dense_cols() { return m_ml_dense_cols; }
+
+    /// @return The time spent in ML decoding in the last block, in
+    ///         microseconds
+    double ml_time() { return m_ml_time; }
+
+    /// @return The number of symbol XORs requested by the ML decoding of
+    ///         the last block
+    uint32_t ml_symbol_xors() { return m_ml_symbol_xors; }
+
+    /// @return The number of those symbol XORs that were not executed
+    uint32_t ml_saved_symbol_xors() { return m_ml_saved_symbol_xors; }
+
+    /// Set the number of threads executing the deferred symbol XORs of the
+    /// ML decoder (the library must be built with OF_USE_PTHREADS for more
+    /// than one)
+    void set_ml_threads(uint32_t threads) { m_ml_threads = threads; }
+
+protected:
+
+    // Code parameters
+    int k;
+
+    // Number of symbols
+    uint32_t m_symbols;
+    // Size of k+m symbols
+    uint32_t m_symbol_size;
+    // Size of a full generation (k symbols)
+    uint32_t m_block_size;
+    // Set of erased symbols
+    std::set<uint32_t> m_erased;
+
+    int m_decoding_result;
+
+    // Bytes per parity check matrix entry, as reported by the codec
+    uint32_t m_pchk_bytes_per_entry;
+
+    // Allocation counts of the last block
+    uint32_t m_heap_allocs;
+    uint32_t m_pool_allocs;
+
+    // Size and duration of the ML decoding of the last block
+    uint32_t m_ml_dense_cols;
+    double m_ml_time;
+
+    // Symbol XORs requested and saved by the ML decoding of the last block
+    uint32_t m_ml_symbol_xors;
+    uint32_t m_ml_saved_symbol_xors;
+
+    // Threads executing the deferred symbol XORs of the ML decoder
+    uint32_t m_ml_threads;
+
+    // Symbol pool, reused across blocks
+    of_symbol_pool_t* m_pool;
+
+    // Storage for source symbols
+    std::vector<std::vector<uint8_t>> m_data;
+};
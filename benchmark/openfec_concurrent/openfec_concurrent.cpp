@@ -0,0 +1,310 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+#include "../openfec_codecs.hpp"
+#include "../throughput_benchmark.hpp"
+
+BENCHMARK_OPTION(concurrent_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<double> loss_rate;
+    loss_rate.push_back(0.5);
+
+    auto default_loss_rate =
+        gauge::po::value<std::vector<double>>()->default_value(
+            loss_rate, "")->multitoken();
+
+    // Symbol size must be a multiple of 32
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1000000);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    std::vector<std::string> erasure_models;
+    erasure_models.push_back("uniform");
+
+    auto default_erasure_models =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            erasure_models, "")->multitoken();
+
+    auto default_burst_length = gauge::po::value<uint32_t>()->default_value(4);
+
+    auto default_failure_domains =
+        gauge::po::value<uint32_t>()->default_value(8);
+
+    auto default_sessions = gauge::po::value<uint32_t>()->default_value(0);
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("loss_rate", default_loss_rate, "Set the ratio of repair symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    options.add_options()
+        ("erasure_model", default_erasure_models,
+         "Set the erasure model of the decoders "
+         "[uniform|burst|markov|failure_domain]");
+
+    options.add_options()
+        ("burst_length", default_burst_length,
+         "Set the (mean) burst length of the burst and markov models");
+
+    options.add_options()
+        ("failure_domains", default_failure_domains,
+         "Set the number of failure domains of the failure_domain model");
+
+    options.add_options()
+        ("sessions", default_sessions,
+         "Set the number of concurrent sessions, one per thread "
+         "(0 for one per core)");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// OpenFEC concurrent sessions
+//------------------------------------------------------------------
+
+/// Runs independent encoders or decoders, each with its own session and
+/// data, on as many threads at once, and reports their aggregate goodput.
+/// This requires a library built with OF_USE_PTHREADS, whose one-time
+/// initializations are then thread-safe.
+template<class Encoder, class Decoder, bool Relaxed = false>
+struct openfec_concurrent_throughput :
+    public throughput_benchmark<Encoder, Decoder, Relaxed>
+{
+    typedef throughput_benchmark<Encoder, Decoder, Relaxed> base;
+
+    openfec_concurrent_throughput() : m_sessions(1)
+    { }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        base::get_options(options);
+        m_sessions = options["sessions"].as<uint32_t>();
+        if (m_sessions == 0)
+        {
+            m_sessions = std::max(1U, std::thread::hardware_concurrency());
+        }
+    }
+
+    void setup()
+    {
+        base::setup();
+
+        gauge::config_set cs = this->get_current_configuration();
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        uint32_t erased_symbols = cs.get_value<uint32_t>("erased_symbols");
+
+        // The first session uses the encoder and decoder of the base
+        m_encoders.assign(1, this->m_encoder);
+        m_decoders.assign(1, this->m_decoder);
+        for (uint32_t i = 1; i < m_sessions; i++)
+        {
+            m_encoders.push_back(std::make_shared<Encoder>(
+                symbols, symbol_size, erased_symbols * this->m_factor));
+            m_decoders.push_back(std::make_shared<Decoder>(
+                symbols, symbol_size, erased_symbols, this->erasures()));
+        }
+    }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        if (!results.has_column("sessions"))
+            results.add_column("sessions");
+
+        results.set_value("sessions", m_sessions);
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = this->get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        if (type == "decoder")
+        {
+            for (uint32_t i = 0; i < m_sessions; i++)
+            {
+                if (m_decoders[i]->is_complete() == false)
+                {
+                    if (Relaxed)
+                        ++this->m_factor;
+
+                    return false;
+                }
+                assert(m_decoders[i]->verify_data(m_encoders[i]));
+            }
+        }
+
+        return true;
+    }
+
+    /// Run all the encoders at once
+    void encode_payloads()
+    {
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < m_sessions; i++)
+        {
+            threads.emplace_back([this, i]() { m_encoders[i]->encode_all(); });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        for (uint32_t i = 0; i < m_sessions; i++)
+        {
+            this->m_encoded_symbols += m_encoders[i]->payload_count();
+        }
+    }
+
+    /// Run all the decoders at once
+    void decode_payloads()
+    {
+        std::vector<uint32_t> processed(m_sessions, 0);
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < m_sessions; i++)
+        {
+            threads.emplace_back([this, i, &processed]()
+            {
+                processed[i] = m_decoders[i]->decode_all(m_encoders[i]);
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        gauge::config_set cs = this->get_current_configuration();
+        uint32_t erased_symbols = cs.get_value<uint32_t>("erased_symbols");
+
+        // The extra symbols are reported for the first session
+        this->m_processed_symbols += processed[0];
+        for (uint32_t i = 0; i < m_sessions; i++)
+        {
+            if (m_decoders[i]->is_complete())
+            {
+                this->m_recovered_symbols += erased_symbols;
+            }
+        }
+    }
+
+    void run_encode()
+    {
+        // The clock is running
+        RUN
+        {
+            encode_payloads();
+        }
+    }
+
+    void run_decode()
+    {
+        // Encode some data
+        encode_payloads();
+
+        // The clock is running
+        RUN
+        {
+            decode_payloads();
+        }
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = this->get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        if (type == "encoder")
+        {
+            run_encode();
+        }
+        else if (type == "decoder")
+        {
+            run_decode();
+        }
+        else
+        {
+            assert(0);
+        }
+    }
+
+protected:
+
+    // Number of concurrent sessions
+    uint32_t m_sessions;
+
+    // The encoder and decoder of each session
+    std::vector<std::shared_ptr<Encoder>> m_encoders;
+    std::vector<std::shared_ptr<Decoder>> m_decoders;
+};
+
+typedef openfec_concurrent_throughput<openfec_rs_encoder, openfec_rs_decoder>
+    openfec_rs_concurrent_throughput;
+
+BENCHMARK_F_INLINE(openfec_rs_concurrent_throughput, OpenFEC,
+    ReedSolomonConcurrent, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_concurrent_throughput<openfec_ldpc_encoder,
+    openfec_ldpc_decoder<>, true> openfec_ldpc_concurrent_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_concurrent_throughput, OpenFEC,
+    LdpcStaircaseConcurrent, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -0,0 +1,342 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gauge/gauge.hpp>
+
+#include "../erasure_pattern.hpp"
+#include "../openfec_object_coder.hpp"
+
+BENCHMARK_OPTION(object_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> object_size;
+    object_size.push_back(256);
+
+    auto default_object_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            object_size, "")->multitoken();
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<double> loss_rate;
+    loss_rate.push_back(0.5);
+
+    auto default_loss_rate =
+        gauge::po::value<std::vector<double>>()->default_value(
+            loss_rate, "")->multitoken();
+
+    // Symbol size must be a multiple of 32
+    std::vector<uint32_t> symbol_size;
+    symbol_size.push_back(1000000);
+
+    auto default_symbol_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbol_size, "")->multitoken();
+
+    std::vector<uint32_t> object_threads;
+    object_threads.push_back(1);
+    object_threads.push_back(0);
+
+    auto default_object_threads =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            object_threads, "")->multitoken();
+
+    std::vector<std::string> types;
+    types.push_back("encoder");
+    types.push_back("decoder");
+
+    auto default_types =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            types, "")->multitoken();
+
+    std::vector<std::string> erasure_models;
+    erasure_models.push_back("uniform");
+
+    auto default_erasure_models =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            erasure_models, "")->multitoken();
+
+    auto default_burst_length = gauge::po::value<uint32_t>()->default_value(4);
+
+    auto default_failure_domains =
+        gauge::po::value<uint32_t>()->default_value(8);
+
+    options.add_options()
+        ("object_size", default_object_size,
+         "Set the object size in MB");
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("loss_rate", default_loss_rate, "Set the ratio of repair symbols");
+
+    options.add_options()
+        ("symbol_size", default_symbol_size, "Set the symbol size in bytes");
+
+    options.add_options()
+        ("object_threads", default_object_threads,
+         "Set the number of threads processing the blocks of an object "
+         "(0 for one per core)");
+
+    options.add_options()
+        ("type", default_types, "Set type [encoder|decoder]");
+
+    options.add_options()
+        ("erasure_model", default_erasure_models,
+         "Set the erasure model of the decoders "
+         "[uniform|burst|markov|failure_domain]");
+
+    options.add_options()
+        ("burst_length", default_burst_length,
+         "Set the (mean) burst length of the burst and markov models");
+
+    options.add_options()
+        ("failure_domains", default_failure_domains,
+         "Set the number of failure domains of the failure_domain model");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// OpenFEC object encoding
+//------------------------------------------------------------------
+
+/// Measures the end-to-end goodput of encoding or decoding a whole object,
+/// partitioned with the blocking structure into blocks of at most
+/// "symbols" source symbols, with a pool of threads. With Relaxed, the
+/// number of repair symbols per block is increased until decoding succeeds.
+template<class Codec, bool Relaxed = false>
+struct openfec_object_throughput : public gauge::time_benchmark
+{
+    void init()
+    {
+        m_factor = 1;
+        gauge::time_benchmark::init();
+    }
+
+    double measurement()
+    {
+        // Get the time spent per iteration
+        double time = gauge::time_benchmark::measurement();
+
+        return m_coder->object_size() / time / 1000.0; // GB/s
+    }
+
+    void store_run(tables::table& results)
+    {
+        if (!results.has_column("goodput"))
+            results.add_column("goodput");
+
+        results.set_value("goodput", measurement());
+
+        if (!results.has_column("blocks"))
+            results.add_column("blocks");
+
+        results.set_value("blocks", m_coder->nb_blocks());
+
+        if (Relaxed)
+        {
+            if (!results.has_column("repair_factor"))
+                results.add_column("repair_factor");
+
+            results.set_value("repair_factor", m_factor);
+        }
+    }
+
+    bool needs_warmup_iteration()
+    {
+        return false;
+    }
+
+    bool accept_measurement()
+    {
+        gauge::config_set cs = get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        if (type == "decoder")
+        {
+            if (m_coder->is_complete() == false)
+            {
+                if (Relaxed)
+                    ++m_factor;
+
+                return false;
+            }
+            assert(m_coder->verify_data());
+        }
+
+        return true;
+    }
+
+    std::string unit_text() const
+    {
+        return "GB/s";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto object_size = options["object_size"].as<std::vector<uint32_t> >();
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto loss_rate = options["loss_rate"].as<std::vector<double> >();
+        auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
+        auto threads = options["object_threads"].as<std::vector<uint32_t> >();
+        auto types = options["type"].as<std::vector<std::string> >();
+        auto models =
+            options["erasure_model"].as<std::vector<std::string> >();
+        m_burst_length = options["burst_length"].as<uint32_t>();
+        m_failure_domains = options["failure_domains"].as<uint32_t>();
+
+        for (const auto& o : object_size)
+        {
+            for (const auto& s : symbols)
+            {
+                for (const auto& r : loss_rate)
+                {
+                    for (const auto& p : symbol_size)
+                    {
+                        for (auto t : threads)
+                        {
+                            if (t == 0)
+                            {
+                                t = std::max(1U,
+                                    std::thread::hardware_concurrency());
+                            }
+
+                            for (const auto& y : types)
+                            {
+                                for (const auto& e : models)
+                                {
+                                    assert(erasure_pattern::is_model(e));
+
+                                    // The erasures only matter to the
+                                    // decoders
+                                    if (y != "decoder" && e != models[0])
+                                        continue;
+
+                                    gauge::config_set cs;
+                                    cs.set_value<uint32_t>("object_size", o);
+                                    cs.set_value<uint32_t>("symbols", s);
+                                    cs.set_value<uint32_t>("symbol_size", p);
+                                    cs.set_value<double>("loss_rate", r);
+                                    cs.set_value<uint32_t>("threads", t);
+                                    cs.set_value<std::string>("type", y);
+                                    cs.set_value<std::string>(
+                                        "erasure_model", e);
+
+                                    add_configuration(cs);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void setup()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        uint64_t object_size = cs.get_value<uint32_t>("object_size");
+        uint32_t symbols = cs.get_value<uint32_t>("symbols");
+        uint32_t symbol_size = cs.get_value<uint32_t>("symbol_size");
+        double loss_rate = cs.get_value<double>("loss_rate");
+
+        std::string model = cs.get_value<std::string>("erasure_model");
+
+        m_coder = std::make_shared<openfec_object_coder<Codec>>(
+            object_size << 20, symbols, symbol_size, loss_rate, m_factor,
+            erasure_pattern(model, m_burst_length, m_failure_domains));
+    }
+
+    void run_benchmark()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        std::string type = cs.get_value<std::string>("type");
+        uint32_t threads = cs.get_value<uint32_t>("threads");
+
+        if (type == "encoder")
+        {
+            // The clock is running
+            RUN
+            {
+                m_coder->encode_object(threads);
+            }
+        }
+        else if (type == "decoder")
+        {
+            m_coder->encode_object(threads);
+
+            // The clock is running
+            RUN
+            {
+                m_coder->decode_object(threads);
+            }
+        }
+        else
+        {
+            assert(0);
+        }
+    }
+
+protected:
+
+    // The object and its blocks
+    std::shared_ptr<openfec_object_coder<Codec>> m_coder;
+
+    // Number of repair symbols per erased source symbol
+    uint32_t m_factor;
+
+    // Parameters of the erasure models
+    uint32_t m_burst_length;
+    uint32_t m_failure_domains;
+};
+
+typedef openfec_object_throughput<reed_solomon_blocks>
+    openfec_rs_object_throughput;
+
+BENCHMARK_F_INLINE(openfec_rs_object_throughput, OpenFEC,
+    ReedSolomonObject, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_object_throughput<ldpc_staircase_blocks, true>
+    openfec_ldpc_object_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_object_throughput, OpenFEC,
+    LdpcStaircaseObject, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
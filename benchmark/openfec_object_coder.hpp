@@ -0,0 +1,351 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "erasure_pattern.hpp"
+#include "openfec_codecs.hpp"
+#include "openfec_session.hpp"
+
+/// Partitioning of an object into source blocks of at most B symbols, as
+/// computed by of_compute_blocking_struct() in examples/openfec (RFC 5052):
+/// the first I blocks have A_large source symbols, the others A_small.
+/// The transfer length is 64-bit, for multi-GB objects.
+struct openfec_blocking_struct
+{
+    openfec_blocking_struct(uint64_t L, uint32_t B, uint32_t E)
+    {
+        // Number of source symbols of the object
+        uint64_t T = (L + E - 1) / E;
+
+        nb_blocks = (uint32_t)((T + B - 1) / B);
+        A_large = (uint32_t)((T + nb_blocks - 1) / nb_blocks);
+        A_small = (uint32_t)(T / nb_blocks);
+        I = (uint32_t)(T - (uint64_t)A_small * nb_blocks);
+    }
+
+    /// The number of source symbols of a block
+    uint32_t block_symbols(uint32_t block) const
+    {
+        return (block < I) ? A_large : A_small;
+    }
+
+    /// The index in the object of the first source symbol of a block
+    uint64_t first_symbol(uint32_t block) const
+    {
+        if (block < I)
+            return (uint64_t)block * A_large;
+
+        return (uint64_t)I * A_large + (uint64_t)(block - I) * A_small;
+    }
+
+    uint32_t nb_blocks;
+    uint32_t I;
+    uint32_t A_large;
+    uint32_t A_small;
+};
+
+/// Runs task(i) for each i in [0, nb_tasks) on a pool of threads. Each
+/// thread starts with its own contiguous range of tasks, taken from the
+/// front, then steals the tasks left at the back of the other ranges, so
+/// that the threads finishing first take over the slower blocks.
+inline void openfec_work_stealing_run(uint32_t nb_tasks, uint32_t threads,
+    const std::function<void(uint32_t)>& task)
+{
+    struct task_range
+    {
+        std::mutex lock;
+        uint32_t first;
+        uint32_t last;
+    };
+
+    threads = std::max(1U, std::min(threads, nb_tasks));
+
+    std::vector<task_range> ranges(threads);
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        ranges[t].first = (uint32_t)((uint64_t)nb_tasks * t / threads);
+        ranges[t].last = (uint32_t)((uint64_t)nb_tasks * (t + 1) / threads);
+    }
+
+    auto worker = [&ranges, &task, threads, nb_tasks](uint32_t t)
+    {
+        while (true)
+        {
+            uint32_t next = nb_tasks;
+            {
+                std::lock_guard<std::mutex> guard(ranges[t].lock);
+                if (ranges[t].first < ranges[t].last)
+                    next = ranges[t].first++;
+            }
+            for (uint32_t v = 1; next == nb_tasks && v < threads; v++)
+            {
+                task_range& victim = ranges[(t + v) % threads];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (victim.first < victim.last)
+                    next = --victim.last;
+            }
+            if (next == nb_tasks)
+                return;
+
+            task(next);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 1; t < threads; t++)
+    {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+}
+
+/// Tags selecting the codec protecting each source block of an object
+struct reed_solomon_blocks{};
+struct ldpc_staircase_blocks{};
+
+/// Create a session for a source block and set its FEC parameters
+inline of_session_t* openfec_block_session(reed_solomon_blocks,
+    of_codec_type_t codec_type, int k, int m, uint32_t symbol_size)
+{
+    of_rs_parameters_t params;
+    openfec_rs_encoder::set_parameters(params, k, m, symbol_size);
+
+    return openfec_create_session(OF_CODEC_REED_SOLOMON_GF_2_8_STABLE,
+        codec_type, (of_parameters_t*)&params);
+}
+
+inline of_session_t* openfec_block_session(ldpc_staircase_blocks,
+    of_codec_type_t codec_type, int k, int m, uint32_t symbol_size)
+{
+    of_ldpc_parameters_t params;
+    openfec_ldpc_encoder::set_parameters(params, k, m, symbol_size);
+
+    return openfec_create_session(OF_CODEC_LDPC_STAIRCASE_STABLE,
+        codec_type, (of_parameters_t*)&params);
+}
+
+/// An object partitioned into source blocks with the blocking structure,
+/// whose blocks are encoded or decoded independently by a pool of
+/// threads. Each block gets repair_factor repair symbols per erased source
+/// symbol, and the decoder writes the recovered source symbols at their
+/// place in a copy of the object.
+template<class Codec>
+struct openfec_object_coder
+{
+    openfec_object_coder(uint64_t object_size, uint32_t block_symbols,
+        uint32_t symbol_size, double loss_rate, uint32_t repair_factor,
+        const erasure_pattern& erasures = erasure_pattern()) :
+        m_blocking(object_size, block_symbols, symbol_size),
+        m_symbol_size(symbol_size)
+    {
+        uint32_t nb_blocks = m_blocking.nb_blocks;
+        uint64_t source_symbols = m_blocking.first_symbol(nb_blocks);
+
+        m_erased.resize(nb_blocks);
+        m_first_repair.resize(nb_blocks + 1);
+        m_complete.assign(nb_blocks, 0);
+
+        m_first_repair[0] = 0;
+        for (uint32_t b = 0; b < nb_blocks; b++)
+        {
+            uint32_t k = m_blocking.block_symbols(b);
+            uint32_t erased = (uint32_t)std::ceil(k * loss_rate);
+
+            // Simulate the erasure of some source symbols of the block
+            m_erased[b] = erasures.generate(k, erased);
+            m_first_repair[b + 1] =
+                m_first_repair[b] + erased * repair_factor;
+        }
+
+        // The padding of the last symbol is part of the object
+        m_object.resize(source_symbols * symbol_size);
+        m_decoded.resize(source_symbols * symbol_size);
+        m_repair.resize(m_first_repair[nb_blocks] * symbol_size);
+
+        // Fill the object with random data, by 32-bit words since it can
+        // be large
+        std::minstd_rand generator(rand());
+        uint32_t word;
+        for (uint64_t i = 0; i < m_object.size(); i += sizeof(word))
+        {
+            word = (uint32_t)generator();
+            memcpy(&m_object[i], &word,
+                std::min<uint64_t>(sizeof(word), m_object.size() - i));
+        }
+    }
+
+    /// Build the repair symbols of all the blocks
+    void encode_object(uint32_t threads)
+    {
+        openfec_work_stealing_run(m_blocking.nb_blocks, threads,
+            [this](uint32_t b) { encode_block(b); });
+    }
+
+    /// Recover the erased source symbols of all the blocks
+    void decode_object(uint32_t threads)
+    {
+        std::fill(m_complete.begin(), m_complete.end(), 0);
+        openfec_work_stealing_run(m_blocking.nb_blocks, threads,
+            [this](uint32_t b) { decode_block(b); });
+    }
+
+    void encode_block(uint32_t b)
+    {
+        int k = (int)m_blocking.block_symbols(b);
+        int m = (int)(m_first_repair[b + 1] - m_first_repair[b]);
+
+        of_session_t* ses = openfec_block_session(Codec(), OF_ENCODER, k, m,
+            m_symbol_size);
+        if (ses == NULL)
+            return;
+
+        std::vector<void*> symbol_table(k + m);
+        for (int i = 0; i < k; i++)
+        {
+            symbol_table[i] = source_symbol(b, i);
+        }
+        for (int i = 0; i < m; i++)
+        {
+            symbol_table[k + i] = repair_symbol(b, i);
+        }
+
+        openfec_build_repair_symbols(ses, &symbol_table[0], k, k + m);
+
+        openfec_release_session(ses);
+    }
+
+    /// Context of the decoded source symbol callback of a block
+    struct block_context
+    {
+        openfec_object_coder* self;
+        uint32_t block;
+    };
+
+    static void* allocate_source_symbol(void* context, uint32_t size,
+        uint32_t esi)
+    {
+        block_context* c = (block_context*)context;
+        assert(size == c->self->m_symbol_size);
+        return c->self->decoded_symbol(c->block, esi);
+    }
+
+    void decode_block(uint32_t b)
+    {
+        int k = (int)m_blocking.block_symbols(b);
+        int m = (int)(m_first_repair[b + 1] - m_first_repair[b]);
+        const std::set<uint32_t>& erased = m_erased[b];
+
+        of_session_t* ses = openfec_block_session(Codec(), OF_DECODER, k, m,
+            m_symbol_size);
+        if (ses == NULL)
+            return;
+
+        // The decoded source symbols are written in place
+        block_context context = { this, b };
+        of_set_callback_functions(ses, allocate_source_symbol, NULL,
+            (void*)&context);
+
+        bool complete;
+        openfec_decode_symbols(ses, k, m, erased, [this, b, k](int i)
+            {
+                return (i < k) ? source_symbol(b, i) : repair_symbol(b, i - k);
+            }, complete);
+
+        // Fall back to ML decoding if IT decoding was not sufficient
+        if (!complete)
+        {
+            complete = (of_finish_decoding(ses) == OF_STATUS_OK);
+        }
+
+        // The recovered source symbols go to the decoded object
+        openfec_move_decoded_symbols(ses, k, erased, m_symbol_size,
+            [this, b](uint32_t e) { return decoded_symbol(b, e); });
+        openfec_release_session(ses);
+
+        m_complete[b] = complete;
+    }
+
+    bool is_complete()
+    {
+        return std::find(m_complete.begin(), m_complete.end(), 0) ==
+            m_complete.end();
+    }
+
+    bool verify_data()
+    {
+        // We only verify the erased symbols
+        for (uint32_t b = 0; b < m_blocking.nb_blocks; b++)
+        {
+            for (const uint32_t& e : m_erased[b])
+            {
+                if (memcmp(decoded_symbol(b, e), source_symbol(b, e),
+                    m_symbol_size))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    uint64_t object_size() { return m_object.size(); }
+    uint32_t nb_blocks() { return m_blocking.nb_blocks; }
+
+protected:
+
+    uint8_t* source_symbol(uint32_t b, uint32_t esi)
+    {
+        return &m_object[(m_blocking.first_symbol(b) + esi) * m_symbol_size];
+    }
+
+    uint8_t* decoded_symbol(uint32_t b, uint32_t esi)
+    {
+        return &m_decoded[(m_blocking.first_symbol(b) + esi) * m_symbol_size];
+    }
+
+    uint8_t* repair_symbol(uint32_t b, uint32_t i)
+    {
+        return &m_repair[(m_first_repair[b] + i) * m_symbol_size];
+    }
+
+    // Partitioning of the object into source blocks
+    openfec_blocking_struct m_blocking;
+
+    // Size of each symbol
+    uint32_t m_symbol_size;
+
+    // The object, its decoded copy and the repair symbols of all blocks
+    std::vector<uint8_t> m_object;
+    std::vector<uint8_t> m_decoded;
+    std::vector<uint8_t> m_repair;
+
+    // Index of the first repair symbol of each block in m_repair
+    std::vector<uint64_t> m_first_repair;
+
+    // Erased source symbols of each block
+    std::vector<std::set<uint32_t>> m_erased;
+
+    // Whether each block has been decoded
+    std::vector<uint8_t> m_complete;
+};
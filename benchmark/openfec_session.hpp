@@ -0,0 +1,123 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <set>
+#include <vector>
+
+extern "C"
+{
+#include <lib_common/of_openfec_api.h>
+}
+
+/// The steps shared by the encoders and decoders of the OpenFEC
+/// benchmarks: creating a session, building the repair symbols, feeding
+/// the received symbols to a decoder and collecting the symbols recovered
+/// by ML decoding. The errors of the library are printed, the benchmarks
+/// then report an incomplete decoding.
+
+/// Create a codec instance and set its FEC parameters
+/// @return The session, or NULL if it could not be created
+inline of_session_t* openfec_create_session(of_codec_id_t codec_id,
+    of_codec_type_t codec_type, of_parameters_t* params)
+{
+    of_session_t* ses;
+
+    // Create the codec instance and initialize it accordingly
+    if (of_create_codec_instance(&ses, codec_id, codec_type, of_verbosity))
+    {
+        printf("of_create_codec_instance() failed\n");
+        return NULL;
+    }
+
+    if (of_set_fec_parameters(ses, params))
+    {
+        printf("of_set_fec_parameters() failed\n");
+        of_release_codec_instance(ses);
+        return NULL;
+    }
+
+    return ses;
+}
+
+/// Release the FEC codec instance
+inline void openfec_release_session(of_session_t* ses)
+{
+    if (of_release_codec_instance(ses))
+    {
+        printf("of_release_codec_instance() failed\n");
+    }
+}
+
+/// Build the repair symbols first to last - 1 of symbol_table, in
+/// sequential order as each one depends on the previous one with the
+/// staircase structure
+inline void openfec_build_repair_symbols(of_session_t* ses,
+    void** symbol_table, int first, int last)
+{
+    for (int i = first; i < last; i++)
+    {
+        if (of_build_repair_symbol(ses, symbol_table, i))
+        {
+            printf("of_build_repair_symbol() failed\n");
+        }
+    }
+}
+
+/// Feed the k + m encoding symbols of a block, except the erased source
+/// symbols, to a decoding session until it completes. symbol(esi) returns
+/// the buffer of the encoding symbol esi.
+/// @return The number of repair symbols processed
+template<class Symbol>
+inline uint32_t openfec_decode_symbols(of_session_t* ses, int k, int m,
+    const std::set<uint32_t>& erased, Symbol symbol, bool& complete)
+{
+    uint32_t processed_symbols = 0;
+
+    complete = false;
+    for (int i = 0; i < k + m && !complete; i++)
+    {
+        // Skip the erased original symbols
+        if (erased.count(i)) continue;
+        if (of_decode_with_new_symbol(ses, (void*)symbol(i), i) ==
+            OF_STATUS_ERROR)
+        {
+            printf("of_decode_with_new_symbol() failed\n");
+        }
+
+        // Only count repair symbols
+        if (i >= k) processed_symbols++;
+
+        complete = (of_is_decoding_complete(ses) == true);
+    }
+
+    return processed_symbols;
+}
+
+/// The source symbols recovered by ML decoding are allocated by the
+/// library and must be moved to the buffers given by the decoded source
+/// symbol callback, buffer(esi) returning the one of the source symbol esi
+template<class Buffer>
+inline void openfec_move_decoded_symbols(of_session_t* ses, int k,
+    const std::set<uint32_t>& erased, uint32_t symbol_size, Buffer buffer)
+{
+    std::vector<void*> source_symbols(k);
+    of_get_source_symbols_tab(ses, &source_symbols[0]);
+    for (const uint32_t& e : erased)
+    {
+        if (source_symbols[e] != NULL &&
+            source_symbols[e] != (void*)buffer(e))
+        {
+            memcpy(buffer(e), source_symbols[e], symbol_size);
+            free(source_symbols[e]);
+        }
+    }
+}
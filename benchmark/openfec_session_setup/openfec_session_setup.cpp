@@ -0,0 +1,228 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include <gauge/gauge.hpp>
+
+#include "../openfec_codecs.hpp"
+
+BENCHMARK_OPTION(session_setup_options)
+{
+    gauge::po::options_description options;
+
+    std::vector<uint32_t> symbols;
+    symbols.push_back(16);
+
+    auto default_symbols =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            symbols, "")->multitoken();
+
+    std::vector<double> loss_rate;
+    loss_rate.push_back(0.5);
+
+    auto default_loss_rate =
+        gauge::po::value<std::vector<double>>()->default_value(
+            loss_rate, "")->multitoken();
+
+    auto default_pchk_cache_dir =
+        gauge::po::value<std::string>()->default_value("");
+
+    options.add_options()
+        ("symbols", default_symbols, "Set the number of symbols");
+
+    options.add_options()
+        ("loss_rate", default_loss_rate, "Set the ratio of repair symbols");
+
+    options.add_options()
+        ("pchk_cache_dir", default_pchk_cache_dir,
+         "Set the existing directory of the LDPC parity check matrix cache "
+         "(none by default: the cached session setup benchmark is skipped)");
+
+    gauge::runner::instance().register_options(options);
+}
+
+//------------------------------------------------------------------
+// OpenFEC LDPC-Staircase session setup
+//------------------------------------------------------------------
+
+/// Tags selecting how the LDPC-Staircase sessions get their parity check
+/// matrix: generated from the PRNG (default), or loaded from the on-disk
+/// cache filled by a first session
+struct generated_pchk{};
+struct cached_pchk{};
+
+/// Measures the time needed to create an LDPC-Staircase decoding session
+/// and set its FEC parameters, which includes building the parity check
+/// matrix. The symbols are not processed.
+template<class Pchk>
+struct openfec_ldpc_session_setup : public gauge::time_benchmark
+{
+    void init()
+    {
+        m_from_cache = 0;
+        gauge::time_benchmark::init();
+    }
+
+    void store_run(tables::table& results)
+    {
+        // The time spent per session, in microseconds
+        if (!results.has_column("setup_time"))
+            results.add_column("setup_time");
+
+        results.set_value("setup_time", measurement());
+
+        if (!results.has_column("pchk_from_cache"))
+            results.add_column("pchk_from_cache");
+
+        results.set_value("pchk_from_cache", m_from_cache);
+    }
+
+    bool needs_warmup_iteration()
+    {
+        return false;
+    }
+
+    std::string unit_text() const
+    {
+        return "us";
+    }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        auto symbols = options["symbols"].as<std::vector<uint32_t> >();
+        auto loss_rate = options["loss_rate"].as<std::vector<double> >();
+        m_pchk_cache_dir = options["pchk_cache_dir"].as<std::string>();
+
+        assert(symbols.size() > 0);
+        assert(loss_rate.size() > 0);
+
+        // The cache is only written to a directory given explicitly
+        if (std::is_same<Pchk, cached_pchk>::value && m_pchk_cache_dir.empty())
+        {
+            printf("No parity check matrix cache: set pchk_cache_dir to run "
+                "the cached session setup benchmark\n");
+            return;
+        }
+
+        for (const auto& s : symbols)
+        {
+            for (const auto& r : loss_rate)
+            {
+                gauge::config_set cs;
+                cs.set_value<uint32_t>("symbols", s);
+                cs.set_value<double>("loss_rate", r);
+
+                uint32_t repair = (uint32_t)std::ceil(s * r);
+                cs.set_value<uint32_t>("repair_symbols", repair);
+
+                add_configuration(cs);
+            }
+        }
+    }
+
+    void setup()
+    {
+        // Fill the cache before the clock is started
+        if (std::is_same<Pchk, cached_pchk>::value)
+        {
+            create_session();
+        }
+    }
+
+    /// Create a session, set its parameters and release it
+    void create_session()
+    {
+        gauge::config_set cs = get_current_configuration();
+        int k = (int)cs.get_value<uint32_t>("symbols");
+        int m = (int)cs.get_value<uint32_t>("repair_symbols");
+
+        of_session_t* ses;
+        if (of_create_codec_instance(&ses, OF_CODEC_LDPC_STAIRCASE_STABLE,
+            OF_DECODER, of_verbosity))
+        {
+            printf("of_create_codec_instance() failed\n");
+            return;
+        }
+
+        if (std::is_same<Pchk, cached_pchk>::value &&
+            of_set_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR,
+            (void*)m_pchk_cache_dir.c_str(), m_pchk_cache_dir.size() + 1))
+        {
+            printf("of_set_control_parameter() failed\n");
+        }
+
+        of_ldpc_parameters_t params;
+        openfec_ldpc_encoder::set_parameters(params, k, m, 64);
+
+        if (of_set_fec_parameters(ses, (of_parameters_t*)&params))
+        {
+            printf("of_set_fec_parameters() failed\n");
+        }
+
+        if (of_get_control_parameter(ses,
+            OF_CRTL_LDPC_STAIRCASE_GET_PCHK_FROM_CACHE, &m_from_cache,
+            sizeof(m_from_cache)))
+        {
+            m_from_cache = 0;
+        }
+
+        openfec_release_session(ses);
+    }
+
+    void run_benchmark()
+    {
+        // The clock is running
+        RUN
+        {
+            create_session();
+        }
+    }
+
+protected:
+
+    // Directory of the parity check matrix cache
+    std::string m_pchk_cache_dir;
+
+    // Whether the last session loaded its matrix from the cache
+    UINT32 m_from_cache;
+};
+
+typedef openfec_ldpc_session_setup<generated_pchk>
+    openfec_ldpc_generated_session_setup;
+
+BENCHMARK_F_INLINE(openfec_ldpc_generated_session_setup, OpenFEC,
+    LdpcStaircaseSessionSetup, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_session_setup<cached_pchk>
+    openfec_ldpc_cached_session_setup;
+
+BENCHMARK_F_INLINE(openfec_ldpc_cached_session_setup, OpenFEC,
+    LdpcStaircaseCachedSessionSetup, 1)
+{
+    run_benchmark();
+}
+
+int main(int argc, const char* argv[])
+{
+    srand(static_cast<uint32_t>(time(0)));
+
+    gauge::runner::add_default_printers();
+    gauge::runner::run_benchmarks(argc, argv);
+
+    return 0;
+}
@@ -4,34 +4,51 @@
 // http://www.steinwurf.com/licensing
 
 #include <ctime>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>  // for memset, memcmp
+#include <cmath>
 
+#include <unistd.h>  // for close
+
+#include <string>
 #include <vector>
 #include <set>
+#include <algorithm>
+#include <type_traits>
 
 #include <gauge/gauge.hpp>
 
-extern "C"
-{
-#include <lib_common/of_openfec_api.h>
-}
-
+#include "../degraded_read_benchmark.hpp"
+#include "../erasure_pattern.hpp"
+#include "../openfec_codecs.hpp"
 #include "../throughput_benchmark.hpp"
 
+#ifdef OF_USE_LDPC_FROM_FILE_CODEC
 
-struct openfec_rs_encoder
+/// Tags selecting the format of the parity check matrix file read by the
+/// LDPC from file codec: human readable, parsed line by line (default), or
+/// binary, mapped in memory
+struct text_matrix_file{};
+struct binary_matrix_file{};
+
+template<class Format = text_matrix_file>
+struct openfec_ldpc_ff_encoder
 {
-    openfec_rs_encoder(
+    openfec_ldpc_ff_encoder(
         uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
         m_symbols(symbols), m_symbol_size(symbol_size)
     {
         k = m_symbols;
-        m = encoded_symbols;
+        // Each source symbol takes part in 3 repair equations
+        m = std::max<uint32_t>(encoded_symbols, 3);
         m_block_size = m_symbols * m_symbol_size;
-        m_payload_count = encoded_symbols;
+        m_payload_count = m;
+        m_setup_time = 0;
+
+        write_matrix_file();
 
         int i;
         int vector_count = k + m;
@@ -42,69 +59,166 @@ struct openfec_rs_encoder
         for (i = 0; i < vector_count; i++)
         {
             m_data[i].resize(m_symbol_size);
+            m_symbol_table[i] = (char*)&(m_data[i][0]);
         }
 
-        // Set pointers to point to the input symbols
+        // Fill source symbols with random data
         for (i = 0; i < k; i++)
         {
-            // Fill source symbols with random data
             for (uint8_t &e : m_data[i])
             {
                 e = rand() % 256;
             }
-            m_symbol_table[i] = (char*)&(m_data[i][0]);
         }
+    }
+
+    ~openfec_ldpc_ff_encoder()
+    {
+        remove(m_matrix_file.c_str());
+    }
+
+    /// @return The directory where the matrix files are written
+    static std::string& matrix_dir()
+    {
+        static std::string dir = ".";
+        return dir;
+    }
 
-        // Set pointers to point to the repair symbol buffers
-        for (i = k; i < k + m; i++)
+    /// Create an empty matrix file in matrix_dir(), whose name is made
+    /// unique by mkstemp() so that concurrent runs do not clobber the files
+    /// of each other
+    /// @return The descriptor of the file, or -1 if it could not be created
+    int create_matrix_file(std::string& name)
+    {
+        char prefix[256];
+        snprintf(prefix, sizeof(prefix), "%s/openfec_ldpc_ff_k%d_m%d_",
+            matrix_dir().c_str(), k, m);
+        name = std::string(prefix) + "XXXXXX";
+
+        int fd = mkstemp(&name[0]);
+        if (fd < 0)
         {
-            m_symbol_table[i] = (char*)&(m_data[i][0]);
+            printf("cannot create %s\n", name.c_str());
+            name.clear();
         }
+        return fd;
     }
 
-    ~openfec_rs_encoder()
+    /// Write the matrix of a staircase code whose source symbols take part
+    /// in 3 random repair equations, as LDPC-Staircase with N1=3. The text
+    /// format lists the number of rows, columns, source and parity symbols,
+    /// then the row index and column indexes of each row.
+    void write_matrix_file()
     {
+        std::string text_file;
+        int fd = create_matrix_file(text_file);
+        if (fd < 0)
+            return;
+        m_matrix_file = text_file;
+
+        std::vector<std::vector<uint32_t>> rows(m);
+        uint32_t seed = 1234;
+        for (int col = 0; col < k; col++)
+        {
+            std::set<uint32_t> equations;
+            while (equations.size() < 3)
+            {
+                // Deterministic LCG, so that every run uses the same matrix
+                seed = seed * 1103515245 + 12345;
+                equations.insert((seed >> 8) % m);
+            }
+            for (uint32_t row : equations)
+            {
+                rows[row].push_back(col);
+            }
+        }
+
+        FILE* f = fdopen(fd, "w");
+        if (f == NULL)
+        {
+            printf("cannot write %s\n", text_file.c_str());
+            close(fd);
+            return;
+        }
+        fprintf(f, "%d\n%d\n%d\n%d\n", m, k + m, k, m);
+        for (int row = 0; row < m; row++)
+        {
+            fprintf(f, "%d", row);
+            for (uint32_t col : rows[row])
+            {
+                fprintf(f, " %u", col);
+            }
+            // Staircase part
+            if (row > 0)
+            {
+                fprintf(f, " %d", k + row - 1);
+            }
+            fprintf(f, " %d\n", k + row);
+        }
+        fclose(f);
+
+        if (std::is_same<Format, binary_matrix_file>::value)
+        {
+            // The binary file replaces the empty file of the unique name
+            std::string binary_file;
+            fd = create_matrix_file(binary_file);
+            if (fd >= 0)
+            {
+                close(fd);
+                if (of_ldpc_ff_write_binary_matrix_file(
+                    (char*)text_file.c_str(), (char*)binary_file.c_str()))
+                {
+                    printf("of_ldpc_ff_write_binary_matrix_file() failed\n");
+                }
+            }
+            m_matrix_file = binary_file;
+            remove(text_file.c_str());
+        }
     }
 
-    void encode_all()
+    /// Create a session and read its matrix file
+    of_session_t* create_session(of_codec_type_t codec_type)
     {
-        assert(m_payload_count == (uint32_t)m);
-
         of_session_t* ses;
-        of_codec_id_t codec_id = OF_CODEC_REED_SOLOMON_GF_2_8_STABLE;
-        of_codec_type_t codec_type = OF_ENCODER;
 
-        // Create the codec instance and initialize it accordingly
-        if (of_create_codec_instance(&ses, codec_id, codec_type,
-            of_verbosity))
+        if (of_create_codec_instance(&ses, OF_CODEC_LDPC_FROM_FILE_ADVANCED,
+            codec_type, of_verbosity))
         {
             printf("of_create_codec_instance() failed\n");
+            return NULL;
         }
 
-        of_rs_parameters_t params;
+        of_ldpc_ff_parameters_t params;
         params.nb_source_symbols = k;
         params.nb_repair_symbols = m;
         params.encoding_symbol_length = m_symbol_size;
+        params.pchk_file = (char*)m_matrix_file.c_str();
 
+        auto t0 = std::chrono::high_resolution_clock::now();
         if (of_set_fec_parameters(ses, (of_parameters_t*)&params))
         {
             printf("of_set_fec_parameters() failed\n");
+            of_release_codec_instance(ses);
+            return NULL;
         }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        m_setup_time = (double)std::chrono::duration_cast<
+            std::chrono::microseconds>(t1 - t0).count();
 
-        // Generate repair symbols
-        for (int i = k; i < k + m; i++)
-        {
-            if (of_build_repair_symbol(ses, (void**)&m_symbol_table[0], i))
-            {
-                printf("of_build_repair_symbol() failed\n");
-            }
-        }
+        return ses;
+    }
 
-        // Release the FEC codec instance.
-        if (of_release_codec_instance(ses))
-        {
-            printf("of_release_codec_instance() failed\n");
-        }
+    void encode_all()
+    {
+        assert(m_payload_count == (uint32_t)m);
+
+        of_session_t* ses = create_session(OF_ENCODER);
+        if (ses == NULL) return;
+
+        openfec_build_repair_symbols(ses, (void**)&m_symbol_table[0],
+            k, k + m);
+
+        openfec_release_session(ses);
     }
 
     uint32_t block_size() { return m_block_size; }
@@ -112,9 +226,14 @@ struct openfec_rs_encoder
     uint32_t payload_size() { return m_symbol_size; }
     uint32_t payload_count() { return m_payload_count; }
 
+    /// @return The time spent in of_set_fec_parameters() by the last
+    ///         session, in microseconds
+    double setup_time() { return m_setup_time; }
+
 protected:
 
-    friend struct openfec_rs_decoder;
+    template<class F>
+    friend struct openfec_ldpc_ff_decoder;
 
     // Code parameters
     int k, m;
@@ -128,6 +247,12 @@ protected:
     // Number of generated payloads
     uint32_t m_payload_count;
 
+    // Parity check matrix file, of the Format type
+    std::string m_matrix_file;
+
+    // Duration of the matrix loading of the last session
+    double m_setup_time;
+
     // Table of all symbols (source+repair) in sequential order
     std::vector<char*> m_symbol_table;
 
@@ -135,18 +260,17 @@ protected:
     std::vector<std::vector<uint8_t>> m_data;
 };
 
-
-struct openfec_rs_decoder
+template<class Format = text_matrix_file>
+struct openfec_ldpc_ff_decoder
 {
-    openfec_rs_decoder(
-        uint32_t symbols, uint32_t symbol_size, uint32_t encoded_symbols) :
+    openfec_ldpc_ff_decoder(
+        uint32_t symbols, uint32_t symbol_size, uint32_t erased_symbols,
+        const erasure_pattern& erasures = erasure_pattern()) :
         m_symbols(symbols), m_symbol_size(symbol_size)
     {
         k = m_symbols;
-        m = encoded_symbols;
         m_block_size = m_symbols * m_symbol_size;
         m_decoding_result = -1;
-        uint32_t payload_count = encoded_symbols;
 
         // Resize data vector to hold original symbols
         m_data.resize(m_symbols);
@@ -155,94 +279,53 @@ struct openfec_rs_decoder
             m_data[i].resize(m_symbol_size);
         }
 
-        // Simulate m erasures (erase some original symbols)
-        // The symbols will be restored by processing the encoded symbols
-        while (m_erased.size() < payload_count)
-        {
-            uint32_t random_symbol = rand() % k;
-            auto ret = m_erased.insert(random_symbol);
-            // Skip this symbol if it was already included in the erased set
-            if (ret.second==false) continue;
-        }
-    }
-
-    ~openfec_rs_decoder()
-    {
+        // Erase some original symbols, LDPC codes usually need a few more
+        // repair symbols than erased_symbols to restore them
+        m_erased = erasures.generate(k, erased_symbols);
     }
 
     static void* allocate_source_symbol(void* context, uint32_t size,
         uint32_t esi)
     {
-        openfec_rs_decoder* self = (openfec_rs_decoder*)context;
+        openfec_ldpc_ff_decoder* self = (openfec_ldpc_ff_decoder*)context;
         assert(size == self->m_symbol_size);
         return (void*)&(self->m_data[esi][0]);
     }
 
-    uint32_t decode_all(std::shared_ptr<openfec_rs_encoder> encoder)
+    uint32_t decode_all(
+        std::shared_ptr<openfec_ldpc_ff_encoder<Format>> encoder)
     {
-        uint32_t processed_symbols = 0;
-        int payload_count = (int)encoder->payload_count();
-        assert(payload_count == m);
-
-        of_session_t* ses;
-        of_codec_id_t codec_id = OF_CODEC_REED_SOLOMON_GF_2_8_STABLE;
-        of_codec_type_t codec_type = OF_DECODER;
+        int m = (int)encoder->payload_count();
 
-        // Create the codec instance and initialize it accordingly
-        if (of_create_codec_instance(&ses, codec_id, codec_type,
-            of_verbosity))
-        {
-            printf("of_create_codec_instance() failed\n");
-            return 0;
-        }
-
-        of_rs_parameters_t params;
-        params.nb_source_symbols = k;
-        params.nb_repair_symbols = m;
-        params.encoding_symbol_length = m_symbol_size;
-
-        if (of_set_fec_parameters(ses, (of_parameters_t*)&params))
-        {
-            printf("of_set_fec_parameters() failed\n");
-            return 0;
-        }
+        // The decoder reads the matrix file of the encoder
+        of_session_t* ses = encoder->create_session(OF_DECODER);
+        if (ses == NULL) return 0;
 
         // The decoder uses pre-allocated data buffers to avoid unnecessary
-        // copying after decoding
+        // copying after IT decoding
         of_set_callback_functions(ses,
             allocate_source_symbol, NULL, (void*)this);
 
         // Process original and repair symbols
-        for (int i = 0; i < k + m; i++)
-        {
-            // Skip the erased original symbols
-            if (m_erased.count(i)) continue;
-            if (of_decode_with_new_symbol(ses, &encoder->m_data[i][0], i) ==
-                OF_STATUS_ERROR)
-            {
-                printf("of_decode_with_new_symbol() failed\n");
-            }
-
-            // Only count repair symbols
-            if (i >= k) processed_symbols++;
+        bool complete;
+        uint32_t processed_symbols = openfec_decode_symbols(ses, k, m,
+            m_erased, [&encoder](int i) { return &encoder->m_data[i][0]; },
+            complete);
 
-            if (of_is_decoding_complete(ses) == true)
-            {
-                m_decoding_result = 0;
-                break;
-            }
-        }
-
-        // Release the FEC codec instance.
-        if (of_release_codec_instance(ses))
+        // Fall back to ML decoding if IT decoding was not sufficient
+        if (complete || of_finish_decoding(ses) == OF_STATUS_OK)
         {
-            printf("of_release_codec_instance() failed\n");
+            m_decoding_result = 0;
         }
 
+        openfec_move_decoded_symbols(ses, k, m_erased, m_symbol_size,
+            [this](uint32_t e) { return &m_data[e][0]; });
+        openfec_release_session(ses);
+
         return processed_symbols;
     }
 
-    bool verify_data(std::shared_ptr<openfec_rs_encoder> encoder)
+    bool verify_data(std::shared_ptr<openfec_ldpc_ff_encoder<Format>> encoder)
     {
         assert(m_block_size == encoder->block_size());
 
@@ -267,7 +350,7 @@ struct openfec_rs_decoder
 protected:
 
     // Code parameters
-    int k, m;
+    int k;
 
     // Number of symbols
     uint32_t m_symbols;
@@ -284,6 +367,8 @@ protected:
     std::vector<std::vector<uint8_t>> m_data;
 };
 
+#endif // OF_USE_LDPC_FROM_FILE_CODEC
+
 BENCHMARK_OPTION(throughput_options)
 {
     gauge::po::options_description options;
@@ -310,6 +395,13 @@ BENCHMARK_OPTION(throughput_options)
         gauge::po::value<std::vector<uint32_t> >()->default_value(
             symbol_size, "")->multitoken();
 
+    auto default_ml_threads = gauge::po::value<uint32_t>()->default_value(1);
+
+    auto default_threads = gauge::po::value<uint32_t>()->default_value(1);
+
+    auto default_pchk_cache_dir =
+        gauge::po::value<std::string>()->default_value("");
+
     std::vector<std::string> types;
     types.push_back("encoder");
     types.push_back("decoder");
@@ -318,6 +410,27 @@ BENCHMARK_OPTION(throughput_options)
         gauge::po::value<std::vector<std::string> >()->default_value(
             types, "")->multitoken();
 
+    std::vector<std::string> erasure_models;
+    erasure_models.push_back("uniform");
+
+    auto default_erasure_models =
+        gauge::po::value<std::vector<std::string> >()->default_value(
+            erasure_models, "")->multitoken();
+
+    auto default_burst_length = gauge::po::value<uint32_t>()->default_value(4);
+
+    std::vector<uint32_t> range_size;
+    range_size.push_back(4096);
+    range_size.push_back(65536);
+    range_size.push_back(1000000);
+
+    auto default_range_size =
+        gauge::po::value<std::vector<uint32_t> >()->default_value(
+            range_size, "")->multitoken();
+
+    auto default_failure_domains =
+        gauge::po::value<uint32_t>()->default_value(8);
+
     options.add_options()
         ("symbols", default_symbols, "Set the number of symbols");
 
@@ -330,6 +443,38 @@ BENCHMARK_OPTION(throughput_options)
     options.add_options()
         ("type", default_types, "Set type [encoder|decoder]");
 
+    options.add_options()
+        ("erasure_model", default_erasure_models,
+         "Set the erasure model of the decoders "
+         "[uniform|burst|markov|failure_domain]");
+
+    options.add_options()
+        ("burst_length", default_burst_length,
+         "Set the (mean) burst length of the burst and markov models");
+
+    options.add_options()
+        ("failure_domains", default_failure_domains,
+         "Set the number of failure domains of the failure_domain model");
+
+    options.add_options()
+        ("range_size", default_range_size,
+         "Set the size in bytes of the ranges read by the DegradedRead "
+         "benchmarks");
+
+    options.add_options()
+        ("ml_threads", default_ml_threads,
+         "Set the number of threads of the LDPC ML decoder symbol XORs");
+
+    options.add_options()
+        ("threads", default_threads,
+         "Set the number of threads encoding or decoding one Reed-Solomon "
+         "block");
+
+    options.add_options()
+        ("pchk_cache_dir", default_pchk_cache_dir,
+         "Set the existing directory of the LDPC from file matrix files "
+         "($TMPDIR or /tmp by default)");
+
     gauge::runner::instance().register_options(options);
 }
 
@@ -337,14 +482,259 @@ BENCHMARK_OPTION(throughput_options)
 // OpenFEC Reed-Solomon codec
 //------------------------------------------------------------------
 
-typedef throughput_benchmark<openfec_rs_encoder, openfec_rs_decoder>
-    openfec_rs_throughput;
+/// The repair symbols of a block are built by several threads sharing the
+/// encoder session, and the missing source symbols rebuilt by byte ranges,
+/// which measures how the latency of a single block scales with the threads
+struct openfec_rs_throughput :
+    public throughput_benchmark<openfec_rs_encoder, openfec_rs_decoder>
+{
+    typedef throughput_benchmark<openfec_rs_encoder, openfec_rs_decoder>
+        base;
+
+    openfec_rs_throughput() : m_threads(1)
+    { }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        base::get_options(options);
+        m_threads = options["threads"].as<uint32_t>();
+    }
+
+    void setup()
+    {
+        base::setup();
+        m_encoder->set_threads(m_threads);
+        m_decoder->set_threads(m_threads);
+    }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        if (!results.has_column("threads"))
+            results.add_column("threads");
+
+        results.set_value("threads", m_threads);
+    }
+
+protected:
+
+    // Threads encoding or decoding the block
+    uint32_t m_threads;
+};
 
 BENCHMARK_F_INLINE(openfec_rs_throughput, OpenFEC, ReedSolomon, 1)
 {
     run_benchmark();
 }
 
+typedef degraded_read_benchmark<openfec_rs_encoder, openfec_rs_decoder>
+    openfec_rs_degraded_read;
+
+BENCHMARK_F_INLINE(openfec_rs_degraded_read, OpenFEC,
+    ReedSolomonDegradedRead, 1)
+{
+    run_benchmark();
+}
+
+//------------------------------------------------------------------
+// OpenFEC LDPC-Staircase codec
+//------------------------------------------------------------------
+
+/// LDPC-Staircase needs a few extra repair symbols, so the relaxed mode
+/// increases their number until decoding succeeds. The memory footprint of
+/// the parity check matrix used by the IT decoder, the allocations done
+/// by each decoded block and the size, duration and symbol XORs of the
+/// ML decoding are also reported.
+template<class Memory, class Elimination = column_elimination,
+    class SymbolOps = immediate_symbol_ops>
+struct openfec_ldpc_throughput : public throughput_benchmark<
+    openfec_ldpc_encoder,
+    openfec_ldpc_decoder<Memory, Elimination, SymbolOps>, true>
+{
+    typedef throughput_benchmark<openfec_ldpc_encoder,
+        openfec_ldpc_decoder<Memory, Elimination, SymbolOps>, true> base;
+
+    openfec_ldpc_throughput() : m_ml_threads(1)
+    { }
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        base::get_options(options);
+        m_ml_threads = options["ml_threads"].as<uint32_t>();
+    }
+
+    void setup()
+    {
+        base::setup();
+        this->m_decoder->set_ml_threads(m_ml_threads);
+    }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        gauge::config_set cs = this->get_current_configuration();
+        std::string type = cs.get_value<std::string>("type");
+
+        if (type == "decoder")
+        {
+            if (!results.has_column("pchk_bytes_per_entry"))
+                results.add_column("pchk_bytes_per_entry");
+
+            results.set_value("pchk_bytes_per_entry",
+                this->m_decoder->pchk_bytes_per_entry());
+
+            if (!results.has_column("heap_allocs"))
+                results.add_column("heap_allocs");
+
+            results.set_value("heap_allocs", this->m_decoder->heap_allocs());
+
+            if (!results.has_column("pool_allocs"))
+                results.add_column("pool_allocs");
+
+            results.set_value("pool_allocs", this->m_decoder->pool_allocs());
+
+            if (!results.has_column("ml_dense_cols"))
+                results.add_column("ml_dense_cols");
+
+            results.set_value("ml_dense_cols",
+                this->m_decoder->ml_dense_cols());
+
+            if (!results.has_column("ml_time"))
+                results.add_column("ml_time");
+
+            results.set_value("ml_time", this->m_decoder->ml_time());
+
+            if (!results.has_column("ml_symbol_xors"))
+                results.add_column("ml_symbol_xors");
+
+            results.set_value("ml_symbol_xors",
+                this->m_decoder->ml_symbol_xors());
+
+            if (!results.has_column("ml_saved_symbol_xors"))
+                results.add_column("ml_saved_symbol_xors");
+
+            results.set_value("ml_saved_symbol_xors",
+                this->m_decoder->ml_saved_symbol_xors());
+        }
+    }
+
+protected:
+
+    // Threads executing the deferred symbol XORs of the ML decoder
+    uint32_t m_ml_threads;
+};
+
+typedef openfec_ldpc_throughput<heap_memory> openfec_ldpc_heap_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_heap_throughput, OpenFEC, LdpcStaircase, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_throughput<pool_memory> openfec_ldpc_pool_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_pool_throughput, OpenFEC, LdpcStaircasePool, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_throughput<zero_copy_memory>
+    openfec_ldpc_zero_copy_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_zero_copy_throughput, OpenFEC,
+    LdpcStaircaseZeroCopy, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_throughput<heap_memory, m4ri_elimination>
+    openfec_ldpc_m4ri_elimination_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_m4ri_elimination_throughput, OpenFEC,
+    LdpcStaircaseM4riElimination, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_throughput<heap_memory, m4ri_elimination,
+    deferred_symbol_ops> openfec_ldpc_deferred_symbol_ops_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_deferred_symbol_ops_throughput, OpenFEC,
+    LdpcStaircaseDeferredSymbolOps, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_throughput<heap_memory, inactivation_decoding,
+    deferred_symbol_ops> openfec_ldpc_inactivation_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_inactivation_throughput, OpenFEC,
+    LdpcStaircaseInactivation, 1)
+{
+    run_benchmark();
+}
+
+#ifdef OF_USE_LDPC_FROM_FILE_CODEC
+
+//------------------------------------------------------------------
+// OpenFEC LDPC from file codec
+//------------------------------------------------------------------
+
+/// The sessions read the parity check matrix file written when the encoder
+/// is created, so the goodput includes the matrix loading, whose duration
+/// is also reported.
+template<class Format>
+struct openfec_ldpc_ff_throughput : public throughput_benchmark<
+    openfec_ldpc_ff_encoder<Format>, openfec_ldpc_ff_decoder<Format>, true>
+{
+    typedef throughput_benchmark<openfec_ldpc_ff_encoder<Format>,
+        openfec_ldpc_ff_decoder<Format>, true> base;
+
+    void get_options(gauge::po::variables_map& options)
+    {
+        base::get_options(options);
+        std::string dir = options["pchk_cache_dir"].as<std::string>();
+        if (dir.empty())
+        {
+            // The matrix files are removed with the encoders
+            const char* tmp = getenv("TMPDIR");
+            dir = tmp != NULL && *tmp != '\0' ? tmp : "/tmp";
+        }
+        openfec_ldpc_ff_encoder<Format>::matrix_dir() = dir;
+    }
+
+    void store_run(tables::table& results)
+    {
+        base::store_run(results);
+
+        if (!results.has_column("setup_time"))
+            results.add_column("setup_time");
+
+        results.set_value("setup_time", this->m_encoder->setup_time());
+    }
+};
+
+typedef openfec_ldpc_ff_throughput<text_matrix_file>
+    openfec_ldpc_ff_text_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_ff_text_throughput, OpenFEC, LdpcFromFile, 1)
+{
+    run_benchmark();
+}
+
+typedef openfec_ldpc_ff_throughput<binary_matrix_file>
+    openfec_ldpc_ff_binary_throughput;
+
+BENCHMARK_F_INLINE(openfec_ldpc_ff_binary_throughput, OpenFEC,
+    LdpcFromFileBinary, 1)
+{
+    run_benchmark();
+}
+
+#endif // OF_USE_LDPC_FROM_FILE_CODEC
+
 int main(int argc, const char* argv[])
 {
     srand(static_cast<uint32_t>(time(0)));
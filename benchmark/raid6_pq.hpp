@@ -0,0 +1,373 @@
+// Copyright Steinwurf ApS 2011-2012.
+// Distributed under the "STEINWURF RESEARCH LICENSE 1.0".
+// See accompanying file LICENSE.rst or
+// http://www.steinwurf.com/licensing
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define RAID6_PQ_AVX2 1
+#endif
+
+#include "gf256.hpp"
+
+/// The RAID-6 code of k data symbols and the two parities P and Q, as in
+/// the md driver of Linux. P is the XOR of the data symbols, and Q their
+/// sum weighted by the powers of GF{2}: Q = sum 2^j * D_j, which is
+/// evaluated by Horner's rule with multiplications by 2 only, a shift, a
+/// mask and a XOR per byte. These are the first two rows of the parities
+/// of gf_gen_rs_matrix(), so the symbols are the ones of the k + 2 RS code
+/// of ISA.
+///
+/// The lost data symbols are recovered with the same evaluation, skipping
+/// them, followed by at most two multiplications by constants: one lost
+/// data symbol is the XOR of P and of the others (or from Q when P is lost
+/// too), and two lost data symbols are solved from the two syndromes.
+///
+/// The kernels process 64 bytes at a time with AVX2 when the processor
+/// supports it (chosen at runtime), and 8 bytes at a time in a 64-bit
+/// register otherwise.
+struct raid6_pq_codec
+{
+    explicit raid6_pq_codec(uint32_t k) :
+        m_k(k)
+    {
+        // The powers of 2 must be distinct for the k data symbols
+        assert(k > 0 && k <= 255);
+    }
+
+    /// Compute P and Q (if not null) from the k data symbols of size bytes
+    void encode(uint8_t** data, uint8_t* p, uint8_t* q, uint32_t size) const
+    {
+        syndromes(data, m_k, m_k, p, q, size);
+    }
+
+    /// Recover the erased symbols, given by their indices (data symbols
+    /// first, then P = k and Q = k + 1), in place in the k + 2 symbols.
+    /// Returns false if more than 2 symbols are erased.
+    bool decode(const std::vector<uint32_t>& erased, uint8_t** symbols,
+        uint32_t size) const
+    {
+        if (erased.size() > 2)
+            return false;
+
+        std::vector<uint32_t> lost(erased);
+        std::sort(lost.begin(), lost.end());
+
+        uint8_t* p = symbols[m_k];
+        uint8_t* q = symbols[m_k + 1];
+
+        if (lost.empty())
+            return true;
+
+        uint32_t x = lost[0];
+        uint32_t y = lost.size() > 1 ? lost[1] : m_k + 2;
+
+        if (x >= m_k)
+        {
+            // Only parities are lost, they are computed again
+            encode(symbols, x == m_k ? p : nullptr,
+                (x == m_k + 1 || y == m_k + 1) ? q : nullptr, size);
+        }
+        else if (y < m_k)
+        {
+            // Two data symbols: the syndromes of the others are computed
+            // in their buffers, then solved for D_x and D_y
+            syndromes(symbols, x, y, symbols[x], symbols[y], size);
+
+            uint8_t gyx = gf256::pow2(y - x);
+            uint8_t a = gf256::inv(gyx ^ 1);
+            uint8_t b = gf256::inv(gf256::pow2(x) ^ gf256::pow2(y));
+            recover_two(p, q, a, b, symbols[x], symbols[y], size);
+        }
+        else if (y == m_k)
+        {
+            // A data symbol and P: D_x = 2^-x * (Q + Q_x), with Q_x the Q
+            // of the other data symbols, then P is computed again
+            syndromes(symbols, x, x, nullptr, symbols[x], size);
+            recover_one(q, gf256::inv(gf256::pow2(x)), symbols[x], size);
+            encode(symbols, p, nullptr, size);
+        }
+        else
+        {
+            // A data symbol and maybe Q: D_x = P + P_x, then Q is computed
+            // again if it is lost
+            syndromes(symbols, x, x, symbols[x], nullptr, size);
+            add(p, symbols[x], size);
+            if (y == m_k + 1)
+                encode(symbols, nullptr, q, size);
+        }
+
+        return true;
+    }
+
+private:
+
+    /// P and Q (if not null) of the data symbols other than x and y
+    /// (use k for none)
+    void syndromes(uint8_t** data, uint32_t x, uint32_t y, uint8_t* p,
+        uint8_t* q, uint32_t size) const
+    {
+        uint32_t i = 0;
+#ifdef RAID6_PQ_AVX2
+        if (has_avx2())
+            i = syndromes_avx2(data, x, y, p, q, size);
+#endif
+        syndromes_generic(data, x, y, p, q, i, size);
+    }
+
+    /// D_y = a * (P + D_x) + b * (Q + D_y) and D_x = P + D_x + D_y, where
+    /// D_x and D_y hold the P and Q of the other data symbols
+    static void recover_two(const uint8_t* p, const uint8_t* q, uint8_t a,
+        uint8_t b, uint8_t* dx, uint8_t* dy, uint32_t size)
+    {
+        uint32_t i = 0;
+#ifdef RAID6_PQ_AVX2
+        if (has_avx2())
+            i = recover_two_avx2(p, q, a, b, dx, dy, size);
+#endif
+        for (; i < size; i++)
+        {
+            uint8_t pxy = p[i] ^ dx[i];
+            uint8_t qxy = q[i] ^ dy[i];
+            dy[i] = gf256::mul(a, pxy) ^ gf256::mul(b, qxy);
+            dx[i] = pxy ^ dy[i];
+        }
+    }
+
+    /// D_x = c * (Q + D_x), where D_x holds the Q of the other data symbols
+    static void recover_one(const uint8_t* q, uint8_t c, uint8_t* dx,
+        uint32_t size)
+    {
+        uint32_t i = 0;
+#ifdef RAID6_PQ_AVX2
+        if (has_avx2())
+            i = recover_one_avx2(q, c, dx, size);
+#endif
+        for (; i < size; i++)
+            dx[i] = gf256::mul(c, q[i] ^ dx[i]);
+    }
+
+    /// dest += src
+    static void add(const uint8_t* src, uint8_t* dest, uint32_t size)
+    {
+        uint32_t i = 0;
+        for (; i + 8 <= size; i += 8)
+            store64(dest + i, load64(dest + i) ^ load64(src + i));
+        for (; i < size; i++)
+            dest[i] ^= src[i];
+    }
+
+    /// The syndromes of the bytes from offset i, 8 at a time in a 64-bit
+    /// register
+    void syndromes_generic(uint8_t** data, uint32_t x, uint32_t y,
+        uint8_t* p, uint8_t* q, uint32_t i, uint32_t size) const
+    {
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t vp = 0, vq = 0;
+            for (uint32_t j = m_k; j-- > 0;)
+            {
+                vq = mul2(vq);
+                if (j == x || j == y)
+                    continue;
+
+                uint64_t d = load64(data[j] + i);
+                vp ^= d;
+                vq ^= d;
+            }
+
+            if (p)
+                store64(p + i, vp);
+            if (q)
+                store64(q + i, vq);
+        }
+
+        for (; i < size; i++)
+        {
+            uint8_t vp = 0, vq = 0;
+            for (uint32_t j = m_k; j-- > 0;)
+            {
+                vq = (uint8_t)((vq << 1) ^ ((vq & 0x80) ? 0x1d : 0));
+                if (j == x || j == y)
+                    continue;
+
+                vp ^= data[j][i];
+                vq ^= data[j][i];
+            }
+
+            if (p)
+                p[i] = vp;
+            if (q)
+                q[i] = vq;
+        }
+    }
+
+    /// The products by 2 of the 8 bytes of v
+    static uint64_t mul2(uint64_t v)
+    {
+        uint64_t high = (v >> 7) & 0x0101010101010101ULL;
+        return ((v & 0x7f7f7f7f7f7f7f7fULL) << 1) ^ (high * 0x1d);
+    }
+
+    static uint64_t load64(const uint8_t* src)
+    {
+        uint64_t v;
+        memcpy(&v, src, sizeof(v));
+        return v;
+    }
+
+    static void store64(uint8_t* dest, uint64_t v)
+    {
+        memcpy(dest, &v, sizeof(v));
+    }
+
+#ifdef RAID6_PQ_AVX2
+
+    static bool has_avx2()
+    {
+        static const bool avx2 = (__builtin_cpu_init(),
+            __builtin_cpu_supports("avx2") != 0);
+        return avx2;
+    }
+
+    /// The products by 2 of the 32 bytes of v: the bytes with the high
+    /// bit set (negative) are reduced by the polynomial
+    __attribute__((target("avx2")))
+    static inline __m256i mul2_avx2(__m256i v)
+    {
+        __m256i high = _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+        return _mm256_xor_si256(_mm256_add_epi8(v, v),
+            _mm256_and_si256(high, _mm256_set1_epi8(0x1d)));
+    }
+
+    /// The products of the 32 bytes of v by the constant of the tables of
+    /// the products of its low and high halves
+    __attribute__((target("avx2")))
+    static inline __m256i mul_avx2(__m256i v, __m256i low, __m256i high)
+    {
+        __m256i mask = _mm256_set1_epi8(0x0f);
+        __m256i l = _mm256_shuffle_epi8(low, _mm256_and_si256(v, mask));
+        __m256i h = _mm256_shuffle_epi8(high,
+            _mm256_and_si256(_mm256_srli_epi64(v, 4), mask));
+        return _mm256_xor_si256(l, h);
+    }
+
+    /// The tables of the products of c by the 16 low and the 16 high halves
+    /// of a byte, in both lanes
+    __attribute__((target("avx2")))
+    static inline void tables_avx2(uint8_t c, __m256i& low, __m256i& high)
+    {
+        uint8_t t[32];
+        for (uint32_t n = 0; n < 16; n++)
+        {
+            t[n] = gf256::mul(c, (uint8_t)n);
+            t[n + 16] = gf256::mul(c, (uint8_t)(n << 4));
+        }
+
+        __m128i l = _mm_loadu_si128((const __m128i*)t);
+        __m128i h = _mm_loadu_si128((const __m128i*)(t + 16));
+        low = _mm256_broadcastsi128_si256(l);
+        high = _mm256_broadcastsi128_si256(h);
+    }
+
+    /// The syndromes of the 64-byte blocks, two registers evaluated side by
+    /// side to hide the latency of the Horner chain. Returns the number of
+    /// bytes done.
+    __attribute__((target("avx2")))
+    uint32_t syndromes_avx2(uint8_t** data, uint32_t x, uint32_t y,
+        uint8_t* p, uint8_t* q, uint32_t size) const
+    {
+        uint32_t i = 0;
+        for (; i + 64 <= size; i += 64)
+        {
+            __m256i p0 = _mm256_setzero_si256(), p1 = p0;
+            __m256i q0 = p0, q1 = p0;
+            for (uint32_t j = m_k; j-- > 0;)
+            {
+                q0 = mul2_avx2(q0);
+                q1 = mul2_avx2(q1);
+                if (j == x || j == y)
+                    continue;
+
+                __m256i d0 = _mm256_loadu_si256((const __m256i*)(data[j] + i));
+                __m256i d1 = _mm256_loadu_si256(
+                    (const __m256i*)(data[j] + i + 32));
+                p0 = _mm256_xor_si256(p0, d0);
+                p1 = _mm256_xor_si256(p1, d1);
+                q0 = _mm256_xor_si256(q0, d0);
+                q1 = _mm256_xor_si256(q1, d1);
+            }
+
+            if (p)
+            {
+                _mm256_storeu_si256((__m256i*)(p + i), p0);
+                _mm256_storeu_si256((__m256i*)(p + i + 32), p1);
+            }
+            if (q)
+            {
+                _mm256_storeu_si256((__m256i*)(q + i), q0);
+                _mm256_storeu_si256((__m256i*)(q + i + 32), q1);
+            }
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static uint32_t recover_two_avx2(const uint8_t* p, const uint8_t* q,
+        uint8_t a, uint8_t b, uint8_t* dx, uint8_t* dy, uint32_t size)
+    {
+        __m256i a_low, a_high, b_low, b_high;
+        tables_avx2(a, a_low, a_high);
+        tables_avx2(b, b_low, b_high);
+
+        uint32_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m256i pxy = _mm256_xor_si256(
+                _mm256_loadu_si256((const __m256i*)(p + i)),
+                _mm256_loadu_si256((const __m256i*)(dx + i)));
+            __m256i qxy = _mm256_xor_si256(
+                _mm256_loadu_si256((const __m256i*)(q + i)),
+                _mm256_loadu_si256((const __m256i*)(dy + i)));
+
+            __m256i vy = _mm256_xor_si256(mul_avx2(pxy, a_low, a_high),
+                mul_avx2(qxy, b_low, b_high));
+
+            _mm256_storeu_si256((__m256i*)(dy + i), vy);
+            _mm256_storeu_si256((__m256i*)(dx + i),
+                _mm256_xor_si256(pxy, vy));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static uint32_t recover_one_avx2(const uint8_t* q, uint8_t c, uint8_t* dx,
+        uint32_t size)
+    {
+        __m256i low, high;
+        tables_avx2(c, low, high);
+
+        uint32_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m256i v = _mm256_xor_si256(
+                _mm256_loadu_si256((const __m256i*)(q + i)),
+                _mm256_loadu_si256((const __m256i*)(dx + i)));
+            _mm256_storeu_si256((__m256i*)(dx + i), mul_avx2(v, low, high));
+        }
+        return i;
+    }
+
+#endif
+
+    uint32_t m_k;
+};
@@ -11,6 +11,8 @@
 
 #include <gauge/gauge.hpp>
 
+#include "erasure_pattern.hpp"
+
 
 template<class Encoder, class Decoder, bool Relaxed = false>
 struct throughput_benchmark : public gauge::time_benchmark
@@ -108,6 +110,11 @@ struct throughput_benchmark : public gauge::time_benchmark
             // the measurement if the decoding was successful
             if (m_decoder->is_complete() == false)
             {
+                // We did not generate enough payloads to decode successfully,
+                // so we will generate more payloads for next run
+                if (Relaxed)
+                    ++m_factor;
+
                 return false;
             }
             // At this point, the output data should be equal to the input data
@@ -129,11 +136,16 @@ struct throughput_benchmark : public gauge::time_benchmark
         auto loss_rate = options["loss_rate"].as<std::vector<double> >();
         auto symbol_size = options["symbol_size"].as<std::vector<uint32_t> >();
         auto types = options["type"].as<std::vector<std::string> >();
+        auto models =
+            options["erasure_model"].as<std::vector<std::string> >();
+        m_burst_length = options["burst_length"].as<uint32_t>();
+        m_failure_domains = options["failure_domains"].as<uint32_t>();
 
         assert(symbols.size() > 0);
         assert(loss_rate.size() > 0);
         assert(symbol_size.size() > 0);
         assert(types.size() > 0);
+        assert(models.size() > 0);
 
         for (const auto& s : symbols)
         {
@@ -146,22 +158,41 @@ struct throughput_benchmark : public gauge::time_benchmark
 
                     for (const auto& t : types)
                     {
-                        gauge::config_set cs;
-                        cs.set_value<uint32_t>("symbols", s);
-                        cs.set_value<uint32_t>("symbol_size", p);
-                        cs.set_value<double>("loss_rate", r);
-                        cs.set_value<std::string>("type", t);
-
-                        uint32_t erased = (uint32_t)std::ceil(s * r);
-                        cs.set_value<uint32_t>("erased_symbols", erased);
-
-                        add_configuration(cs);
+                        for (const auto& e : models)
+                        {
+                            assert(erasure_pattern::is_model(e));
+
+                            // The erasures only matter to the decoders
+                            if (t != "decoder" && e != models[0])
+                                continue;
+
+                            gauge::config_set cs;
+                            cs.set_value<uint32_t>("symbols", s);
+                            cs.set_value<uint32_t>("symbol_size", p);
+                            cs.set_value<double>("loss_rate", r);
+                            cs.set_value<std::string>("type", t);
+                            cs.set_value<std::string>("erasure_model", e);
+
+                            uint32_t erased = (uint32_t)std::ceil(s * r);
+                            cs.set_value<uint32_t>("erased_symbols", erased);
+
+                            add_configuration(cs);
+                        }
                     }
                 }
             }
         }
     }
 
+    /// The erasure pattern of the current configuration
+    erasure_pattern erasures()
+    {
+        gauge::config_set cs = get_current_configuration();
+
+        return erasure_pattern(cs.get_value<std::string>("erasure_model"),
+            m_burst_length, m_failure_domains);
+    }
+
     void setup()
     {
         gauge::config_set cs = get_current_configuration();
@@ -171,9 +202,9 @@ struct throughput_benchmark : public gauge::time_benchmark
         uint32_t erased_symbols = cs.get_value<uint32_t>("erased_symbols");
 
         m_encoder = std::make_shared<Encoder>(
-            symbols, symbol_size, erased_symbols);
+            symbols, symbol_size, erased_symbols * m_factor);
         m_decoder = std::make_shared<Decoder>(
-            symbols, symbol_size, erased_symbols);
+            symbols, symbol_size, erased_symbols, erasures());
     }
 
     void encode_payloads()
@@ -258,4 +289,8 @@ protected:
 
     /// Multiplication factor for payload_count
     uint32_t m_factor;
+
+    /// Parameters of the erasure models
+    uint32_t m_burst_length;
+    uint32_t m_failure_domains;
 };
@@ -151,6 +151,80 @@ int gf_invert_matrix(unsigned char *in_mat, unsigned char *out_mat, const int n)
 	return 0;
 }
 
+// Product of (x + v[i]) over the n values of v, skipping v[skip]
+static unsigned char gf_prod_sum(unsigned char x, unsigned char *v, int n, int skip)
+{
+	int i;
+	unsigned char p = 1;
+
+	for (i = 0; i < n; i++)
+		if (i != skip)
+			p = gf_mul(p, x ^ v[i]);
+	return p;
+}
+
+int gf_invert_cauchy1_submatrix(unsigned char *rows, unsigned char *out_mat, const int n)
+{
+	int i, j, e, nerrs = 0, nparity = 0;
+	unsigned char present[256], erased[256], parity[256], prow[256];
+	unsigned char coef_a[256], coef_b[256], coef_d[256];
+
+	// Sort the rows into the present data symbols, and the parity rows
+	memset(present, 0, sizeof(present));
+	for (i = 0; i < n; i++) {
+		if (present[rows[i]])	// Repeated row means it's singular
+			return -1;
+		present[rows[i]] = 1;
+		if (rows[i] >= n) {
+			parity[nparity] = rows[i];
+			prow[nparity++] = i;
+		}
+	}
+	for (j = 0; j < n; j++)
+		if (!present[j])
+			erased[nerrs++] = j;
+
+	// Set out_mat[] to the rows of the present data symbols
+	memset(out_mat, 0, n * n);
+	for (i = 0; i < n; i++)
+		if (rows[i] < n)
+			out_mat[rows[i] * n + i] = 1;
+
+	// With x_p = p for the parity rows P, y_j = j for the erased symbols E
+	// and the present ones S, the partial fraction expansions of the
+	// rational functions vanishing on P give the erased symbol e as
+	// sum_p B_e D_p / (x_p + y_e) * parity_p
+	//   + sum_s A_s B_e / (y_s + y_e) * data_s
+	// where A_s = prod_e (y_s + y_e) / prod_p (y_s + x_p),
+	// B_e = prod_p (y_e + x_p) / prod_e'!=e (y_e + y_e') and
+	// D_p = prod_e (x_p + y_e) / prod_p'!=p (x_p + x_p').
+	for (i = 0; i < n; i++)
+		if (rows[i] < n)
+			coef_a[i] = gf_mul(gf_prod_sum(rows[i], erased, nerrs, -1),
+					   gf_inv(gf_prod_sum(rows[i], parity, nparity, -1)));
+
+	for (e = 0; e < nerrs; e++)
+		coef_b[e] = gf_mul(gf_prod_sum(erased[e], parity, nparity, -1),
+				   gf_inv(gf_prod_sum(erased[e], erased, nerrs, e)));
+
+	for (j = 0; j < nparity; j++)
+		coef_d[j] = gf_mul(gf_prod_sum(parity[j], erased, nerrs, -1),
+				   gf_inv(gf_prod_sum(parity[j], parity, nparity, j)));
+
+	for (e = 0; e < nerrs; e++) {
+		for (j = 0; j < nparity; j++)
+			out_mat[erased[e] * n + prow[j]] =
+			    gf_mul(gf_mul(coef_b[e], coef_d[j]), gf_inv(parity[j] ^ erased[e]));
+
+		for (i = 0; i < n; i++)
+			if (rows[i] < n)
+				out_mat[erased[e] * n + i] =
+				    gf_mul(gf_mul(coef_a[i], coef_b[e]),
+					   gf_inv(rows[i] ^ erased[e]));
+	}
+	return 0;
+}
+
 // Calculates const table gftbl in GF(2^8) from single input A
 // gftbl(A) = {A{00}, A{01}, A{02}, ... , A{0f} }, {A{00}, A{10}, A{20}, ... , A{f0} }
 
@@ -261,6 +335,18 @@ void gf_vect_mul_init(unsigned char c, unsigned char *tbl)
 #endif //__WORDSIZE == 64 || _WIN64 || __x86_64__
 }
 
+void ec_init_tables_base(int k, int rows, unsigned char *a, unsigned char *g_tbls)
+{
+	int i, j;
+
+	for (i = 0; i < rows; i++) {
+		for (j = 0; j < k; j++) {
+			gf_vect_mul_init(*a++, g_tbls);
+			g_tbls += 32;
+		}
+	}
+}
+
 void gf_vect_dot_prod_base(int len, int vlen, unsigned char *v,
 			   unsigned char **src, unsigned char *dest)
 {
@@ -304,6 +390,23 @@ void ec_encode_data_base(int len, int srcs, int dests, unsigned char *v,
 	}
 }
 
+void ec_encode_data_stripes_base(int len, int k, int rows, unsigned char *v, int stripes,
+				 unsigned char ***data, unsigned char ***coding)
+{
+	int s;
+
+	for (s = 0; s < stripes; s++)
+		ec_encode_data_base(len, k, rows, v, data[s], coding[s]);
+}
+
+void ec_encode_data_nt_base(int len, int k, int rows, unsigned char *v, unsigned char **data,
+			    unsigned char **coding, int prefetch)
+{
+	// Regular stores, and nothing to prefetch ahead of a byte-wise loop
+	(void)prefetch;
+	ec_encode_data_base(len, k, rows, v, data, coding);
+}
+
 void ec_encode_data_update_base(int len, int k, int rows, int vec_i, unsigned char *v,
 				unsigned char *data, unsigned char **dest)
 {
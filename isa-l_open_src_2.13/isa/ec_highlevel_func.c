@@ -27,19 +27,191 @@
   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **********************************************************************/
 #include <limits.h>
+#include <string.h>		// for memset
 #include "erasure_code.h"
 #include "types.h"
 
-void ec_init_tables(int k, int rows, unsigned char *a, unsigned char *g_tbls)
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+// Multiplies 16 GF(2^8) elements by GF{2}
+static inline __m128i gf_mul2_x16(__m128i v)
 {
-	int i, j;
+	__m128i carry = _mm_cmplt_epi8(v, _mm_setzero_si128());
 
-	for (i = 0; i < rows; i++) {
-		for (j = 0; j < k; j++) {
-			gf_vect_mul_init(*a++, g_tbls);
-			g_tbls += 32;
+	return _mm_xor_si128(_mm_add_epi8(v, v),
+			     _mm_and_si128(carry, _mm_set1_epi8(0x1d)));
+}
+
+// Interleaves the first and the last 8 rows of a 16x16 matrix of bytes,
+// four times in a row transposes it
+#define INTERLEAVE_16x16(r, t) \
+	do { \
+		t[0] = _mm_unpacklo_epi8(r[0], r[8]); \
+		t[1] = _mm_unpackhi_epi8(r[0], r[8]); \
+		t[2] = _mm_unpacklo_epi8(r[1], r[9]); \
+		t[3] = _mm_unpackhi_epi8(r[1], r[9]); \
+		t[4] = _mm_unpacklo_epi8(r[2], r[10]); \
+		t[5] = _mm_unpackhi_epi8(r[2], r[10]); \
+		t[6] = _mm_unpacklo_epi8(r[3], r[11]); \
+		t[7] = _mm_unpackhi_epi8(r[3], r[11]); \
+		t[8] = _mm_unpacklo_epi8(r[4], r[12]); \
+		t[9] = _mm_unpackhi_epi8(r[4], r[12]); \
+		t[10] = _mm_unpacklo_epi8(r[5], r[13]); \
+		t[11] = _mm_unpackhi_epi8(r[5], r[13]); \
+		t[12] = _mm_unpacklo_epi8(r[6], r[14]); \
+		t[13] = _mm_unpackhi_epi8(r[6], r[14]); \
+		t[14] = _mm_unpacklo_epi8(r[7], r[15]); \
+		t[15] = _mm_unpackhi_epi8(r[7], r[15]); \
+	} while (0)
+
+// Sets the 16 entries of a half table from the multiples of the
+// coefficients by its 4 powers of two: entry j is the sum of the multiples
+// selected by the bits of j
+#define HALF_TABLE_16(t, b0, b1, b2, b3) \
+	do { \
+		t[0] = _mm_setzero_si128(); \
+		t[1] = b0; \
+		t[2] = b1; \
+		t[3] = _mm_xor_si128(b1, b0); \
+		t[4] = b2; \
+		t[5] = _mm_xor_si128(b2, b0); \
+		t[6] = _mm_xor_si128(b2, b1); \
+		t[7] = _mm_xor_si128(b2, t[3]); \
+		t[8] = b3; \
+		t[9] = _mm_xor_si128(b3, b0); \
+		t[10] = _mm_xor_si128(b3, b1); \
+		t[11] = _mm_xor_si128(b3, t[3]); \
+		t[12] = _mm_xor_si128(b3, b2); \
+		t[13] = _mm_xor_si128(b3, t[5]); \
+		t[14] = _mm_xor_si128(b3, t[6]); \
+		t[15] = _mm_xor_si128(b3, t[7]); \
+	} while (0)
+
+// Calculates the gf_vect_mul_init() tables of 16 coefficients at once. The
+// entries are computed for the 16 coefficients in parallel, one per byte,
+// then transposed into one 32-byte table per coefficient.
+static void gf_vect_mul_init_x16(unsigned char *c, unsigned char *tbls)
+{
+	__m128i c1, c2, c4, c8, c16, c32, c64, c128;
+	__m128i lo[16], hi[16], t[16];
+	int i;
+
+	// The coefficients multiplied by GF{1}, GF{2}, ... , GF{80}
+	c1 = _mm_loadu_si128((__m128i *) c);
+	c2 = gf_mul2_x16(c1);
+	c4 = gf_mul2_x16(c2);
+	c8 = gf_mul2_x16(c4);
+	c16 = gf_mul2_x16(c8);
+	c32 = gf_mul2_x16(c16);
+	c64 = gf_mul2_x16(c32);
+	c128 = gf_mul2_x16(c64);
+
+	HALF_TABLE_16(lo, c1, c2, c4, c8);
+	INTERLEAVE_16x16(lo, t);
+	INTERLEAVE_16x16(t, lo);
+	INTERLEAVE_16x16(lo, t);
+	INTERLEAVE_16x16(t, lo);
+
+	HALF_TABLE_16(hi, c16, c32, c64, c128);
+	INTERLEAVE_16x16(hi, t);
+	INTERLEAVE_16x16(t, hi);
+	INTERLEAVE_16x16(hi, t);
+	INTERLEAVE_16x16(t, hi);
+
+	for (i = 0; i < 16; i++) {
+		_mm_storeu_si128((__m128i *) (tbls + 32 * i), lo[i]);
+		_mm_storeu_si128((__m128i *) (tbls + 32 * i + 16), hi[i]);
+	}
+}
+#endif //__SSE2__
+
+// Adds c * src to dest, the tables of c being in tbl
+static void gf_row_mad(int len, unsigned char *tbl, unsigned char *src, unsigned char *dest)
+{
+	// The vectorized versions need 32 bytes at least
+	if (len >= 32)
+		gf_vect_mad(len, 1, 0, tbl, src, dest);
+	else
+		gf_vect_mad_base(len, 1, 0, tbl, src, dest);
+}
+
+int gf_invert_matrix_mad(unsigned char *in_mat, unsigned char *out_mat, const int n)
+{
+	int i, j, k;
+	unsigned char temp, factors[256], tbls[256 * 32];
+
+	if (n > 256)
+		return -1;
+
+	// Set out_mat[] to the identity matrix
+	memset(out_mat, 0, n * n);
+	for (i = 0; i < n; i++)
+		out_mat[i * n + i] = 1;
+
+	// Inverse
+	for (i = 0; i < n; i++) {
+		// Check for 0 in pivot element
+		if (in_mat[i * n + i] == 0) {
+			// Find a row with non-zero in current column and swap
+			for (j = i + 1; j < n; j++)
+				if (in_mat[j * n + i])
+					break;
+
+			if (j == n)	// Couldn't find means it's singular
+				return -1;
+
+			for (k = 0; k < n; k++) {	// Swap rows i,j
+				temp = in_mat[i * n + k];
+				in_mat[i * n + k] = in_mat[j * n + k];
+				in_mat[j * n + k] = temp;
+
+				temp = out_mat[i * n + k];
+				out_mat[i * n + k] = out_mat[j * n + k];
+				out_mat[j * n + k] = temp;
+			}
+		}
+
+		// The rows are scaled by their pivots at the end only, so row j
+		// eliminates column i with in_mat[j][i] / pivot times row i. The
+		// tables of all these factors are built at once.
+		temp = gf_inv(in_mat[i * n + i]);	// 1/pivot
+		for (j = 0; j < n; j++)
+			factors[j] = gf_mul(in_mat[j * n + i], temp);
+
+		ec_init_tables(n, 1, factors, tbls);
+
+		for (j = 0; j < n; j++) {
+			if (j == i || factors[j] == 0)
+				continue;
+
+			// The columns before i of row i are zero
+			gf_row_mad(n - i, &tbls[32 * j], &in_mat[i * n + i], &in_mat[j * n + i]);
+			gf_row_mad(n, &tbls[32 * j], &out_mat[i * n], &out_mat[j * n]);
 		}
 	}
+
+	// Scale the rows by 1/pivot
+	for (i = 0; i < n; i++) {
+		temp = gf_inv(in_mat[i * n + i]);
+		in_mat[i * n + i] = 1;
+		for (k = 0; k < n; k++)
+			out_mat[i * n + k] = gf_mul(out_mat[i * n + k], temp);
+	}
+	return 0;
+}
+
+void ec_init_tables(int k, int rows, unsigned char *a, unsigned char *g_tbls)
+{
+	int i = 0, n = k * rows;
+
+#ifdef __SSE2__
+	// The tables are consecutive, in the order of the coefficients
+	for (; i + 16 <= n; i += 16)
+		gf_vect_mul_init_x16(&a[i], &g_tbls[32 * i]);
+#endif
+	for (; i < n; i++)
+		gf_vect_mul_init(a[i], &g_tbls[32 * i]);
 }
 
 void ec_encode_data_sse(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
@@ -73,6 +245,44 @@ void ec_encode_data_sse(int len, int k, int rows, unsigned char *g_tbls, unsigne
 
 }
 
+void ec_encode_data_stripes_sse(int len, int k, int rows, unsigned char *g_tbls, int stripes,
+			unsigned char ***data, unsigned char ***coding)
+{
+	int s, c = 0;
+
+	if (len < 16) {
+		ec_encode_data_stripes_base(len, k, rows, g_tbls, stripes, data, coding);
+		return;
+	}
+
+	/* Each group of rows goes over all the stripes before the next one,
+	 * so that its tables stay in the L1 cache */
+	while (rows >= 4) {
+		for (s = 0; s < stripes; s++)
+			gf_4vect_dot_prod_sse(len, k, g_tbls, data[s], &coding[s][c]);
+		g_tbls += 4 * k * 32;
+		c += 4;
+		rows -= 4;
+	}
+	switch (rows) {
+	case 3:
+		for (s = 0; s < stripes; s++)
+			gf_3vect_dot_prod_sse(len, k, g_tbls, data[s], &coding[s][c]);
+		break;
+	case 2:
+		for (s = 0; s < stripes; s++)
+			gf_2vect_dot_prod_sse(len, k, g_tbls, data[s], &coding[s][c]);
+		break;
+	case 1:
+		for (s = 0; s < stripes; s++)
+			gf_vect_dot_prod_sse(len, k, g_tbls, data[s], coding[s][c]);
+		break;
+	case 0:
+		break;
+	}
+
+}
+
 void ec_encode_data_avx(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
 			unsigned char **coding)
 {
@@ -103,6 +313,44 @@ void ec_encode_data_avx(int len, int k, int rows, unsigned char *g_tbls, unsigne
 
 }
 
+void ec_encode_data_stripes_avx(int len, int k, int rows, unsigned char *g_tbls, int stripes,
+			unsigned char ***data, unsigned char ***coding)
+{
+	int s, c = 0;
+
+	if (len < 16) {
+		ec_encode_data_stripes_base(len, k, rows, g_tbls, stripes, data, coding);
+		return;
+	}
+
+	/* Each group of rows goes over all the stripes before the next one,
+	 * so that its tables stay in the L1 cache */
+	while (rows >= 4) {
+		for (s = 0; s < stripes; s++)
+			gf_4vect_dot_prod_avx(len, k, g_tbls, data[s], &coding[s][c]);
+		g_tbls += 4 * k * 32;
+		c += 4;
+		rows -= 4;
+	}
+	switch (rows) {
+	case 3:
+		for (s = 0; s < stripes; s++)
+			gf_3vect_dot_prod_avx(len, k, g_tbls, data[s], &coding[s][c]);
+		break;
+	case 2:
+		for (s = 0; s < stripes; s++)
+			gf_2vect_dot_prod_avx(len, k, g_tbls, data[s], &coding[s][c]);
+		break;
+	case 1:
+		for (s = 0; s < stripes; s++)
+			gf_vect_dot_prod_avx(len, k, g_tbls, data[s], coding[s][c]);
+		break;
+	case 0:
+		break;
+	}
+
+}
+
 void ec_encode_data_avx2(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
 			 unsigned char **coding)
 {
@@ -112,6 +360,13 @@ void ec_encode_data_avx2(int len, int k, int rows, unsigned char *g_tbls, unsign
 		return;
 	}
 
+	// The coded vectors are too large to stay in the cache
+	if (len >= EC_NT_THRESHOLD) {
+		ec_encode_data_nt_avx2(len, k, rows, g_tbls, data, coding,
+				       EC_PREFETCH_DISTANCE);
+		return;
+	}
+
 	while (rows >= 4) {
 		gf_4vect_dot_prod_avx2(len, k, g_tbls, data, coding);
 		g_tbls += 4 * k * 32;
@@ -134,6 +389,309 @@ void ec_encode_data_avx2(int len, int k, int rows, unsigned char *g_tbls, unsign
 
 }
 
+void ec_encode_data_stripes_avx2(int len, int k, int rows, unsigned char *g_tbls, int stripes,
+			unsigned char ***data, unsigned char ***coding)
+{
+	int s, c = 0;
+
+	if (len < 32) {
+		ec_encode_data_stripes_base(len, k, rows, g_tbls, stripes, data, coding);
+		return;
+	}
+
+	if (len >= EC_NT_THRESHOLD) {
+		for (s = 0; s < stripes; s++)
+			ec_encode_data_nt_avx2(len, k, rows, g_tbls, data[s], coding[s],
+					       EC_PREFETCH_DISTANCE);
+		return;
+	}
+
+	/* Each group of rows goes over all the stripes before the next one,
+	 * so that its tables stay in the L1 cache */
+	while (rows >= 4) {
+		for (s = 0; s < stripes; s++)
+			gf_4vect_dot_prod_avx2(len, k, g_tbls, data[s], &coding[s][c]);
+		g_tbls += 4 * k * 32;
+		c += 4;
+		rows -= 4;
+	}
+	switch (rows) {
+	case 3:
+		for (s = 0; s < stripes; s++)
+			gf_3vect_dot_prod_avx2(len, k, g_tbls, data[s], &coding[s][c]);
+		break;
+	case 2:
+		for (s = 0; s < stripes; s++)
+			gf_2vect_dot_prod_avx2(len, k, g_tbls, data[s], &coding[s][c]);
+		break;
+	case 1:
+		for (s = 0; s < stripes; s++)
+			gf_vect_dot_prod_avx2(len, k, g_tbls, data[s], coding[s][c]);
+		break;
+	case 0:
+		break;
+	}
+
+}
+
+// Computes the bytes start to end - 1 of the coded vectors, one at a time
+static void gf_dot_prod_bytes(int start, int end, int k, int rows, unsigned char *g_tbls,
+			      unsigned char **data, unsigned char **coding)
+{
+	int i, j, l;
+	unsigned char s, b, *tbl;
+
+	for (l = 0; l < rows; l++) {
+		for (i = start; i < end; i++) {
+			s = 0;
+			for (j = 0; j < k; j++) {
+				tbl = &g_tbls[32 * (l * k + j)];
+				b = data[j][i];
+				s ^= tbl[b & 0x0f] ^ tbl[16 + (b >> 4)];
+			}
+			coding[l][i] = s;
+		}
+	}
+}
+
+// The alignment on 64 bytes of the coded vectors from which the streaming
+// stores are used: the bytes before it are computed apart. Returns -1 if
+// the coded vectors differ in their alignment.
+static int gf_nt_head(int rows, unsigned char **coding)
+{
+	int l;
+
+	for (l = 1; l < rows; l++)
+		if (((size_t) coding[l] & 63) != ((size_t) coding[0] & 63))
+			return -1;
+	return (64 - ((size_t) coding[0] & 63)) & 63;
+}
+
+#ifdef __GNUC__
+#include <immintrin.h>
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+
+// Multiplies 16 GF(2^8) elements by the coefficient of the tables tbl
+static inline __m128i gf_mul_x16(__m128i x, unsigned char *tbl, __m128i mask)
+{
+	__m128i lo = _mm_loadu_si128((__m128i *) tbl);
+	__m128i hi = _mm_loadu_si128((__m128i *) (tbl + 16));
+
+	return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+			     _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+}
+
+// Computes n <= 2 coded vectors a cache line at a time, from the byte start
+// to the last whole line, as gf_nvect_dot_prod_nt_avx2() with 4 registers
+// per line. The lines are written with streaming stores if nt is set.
+static inline __attribute__ ((always_inline))
+int gf_nvect_dot_prod_nt_sse(int len, int k, int n, int start, int nt, int prefetch,
+			     unsigned char *g_tbls, unsigned char **data,
+			     unsigned char **coding)
+{
+	__m128i mask = _mm_set1_epi8(0x0f);
+	__m128i x[4], p[8];
+	unsigned char *src, *tbl;
+	int i, j, l, b;
+
+	for (i = start; i + 64 <= len; i += 64) {
+		for (l = 0; l < 4 * n; l++)
+			p[l] = _mm_setzero_si128();
+
+		for (j = 0; j < k; j++) {
+			src = data[j] + i;
+			if (prefetch)
+				_mm_prefetch((char *)src + prefetch, _MM_HINT_T0);
+
+			for (b = 0; b < 4; b++)
+				x[b] = _mm_loadu_si128((__m128i *) (src + 16 * b));
+
+			for (l = 0; l < n; l++) {
+				tbl = &g_tbls[32 * (l * k + j)];
+				for (b = 0; b < 4; b++)
+					p[4 * l + b] =
+					    _mm_xor_si128(p[4 * l + b], gf_mul_x16(x[b], tbl, mask));
+			}
+		}
+
+		for (l = 0; l < n; l++) {
+			for (b = 0; b < 4; b++) {
+				if (nt)
+					_mm_stream_si128((__m128i *) (coding[l] + i + 16 * b),
+							 p[4 * l + b]);
+				else
+					_mm_storeu_si128((__m128i *) (coding[l] + i + 16 * b),
+							 p[4 * l + b]);
+			}
+		}
+	}
+	return i;
+}
+
+void ec_encode_data_nt_sse(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
+			   unsigned char **coding, int prefetch)
+{
+	int head, end = 0, nt = 1;
+
+	if (len < 128) {
+		ec_encode_data_base(len, k, rows, g_tbls, data, coding);
+		return;
+	}
+
+	head = gf_nt_head(rows, coding);
+	if (head < 0) {
+		head = 0;
+		nt = 0;
+	}
+
+	gf_dot_prod_bytes(0, head, k, rows, g_tbls, data, coding);
+
+	// The 8 accumulators of two coded vectors leave registers for the sources
+	while (rows >= 2) {
+		end = gf_nvect_dot_prod_nt_sse(len, k, 2, head, nt, prefetch, g_tbls, data, coding);
+		gf_dot_prod_bytes(end, len, k, 2, g_tbls, data, coding);
+		g_tbls += 2 * k * 32;
+		coding += 2;
+		rows -= 2;
+	}
+	if (rows == 1) {
+		end = gf_nvect_dot_prod_nt_sse(len, k, 1, head, nt, prefetch, g_tbls, data, coding);
+		gf_dot_prod_bytes(end, len, k, 1, g_tbls, data, coding);
+	}
+
+	// The streaming stores are weakly ordered
+	_mm_sfence();
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+// Multiplies 32 GF(2^8) elements by the coefficient of the tables tbl
+static inline __m256i gf_mul_x32(__m256i x, unsigned char *tbl, __m256i mask)
+{
+	__m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i *) tbl));
+	__m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i *) (tbl + 16)));
+
+	return _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+				_mm256_shuffle_epi8(hi,
+						    _mm256_and_si256(_mm256_srli_epi64(x, 4),
+								     mask)));
+}
+
+// Computes n <= 4 coded vectors a cache line at a time, from the byte start
+// to the last whole line. The lines are written with streaming stores if nt
+// is set, in which case they must be aligned on 64 bytes.
+static inline __attribute__ ((always_inline))
+int gf_nvect_dot_prod_nt_avx2(int len, int k, int n, int start, int nt, int prefetch,
+			      unsigned char *g_tbls, unsigned char **data,
+			      unsigned char **coding)
+{
+	__m256i mask = _mm256_set1_epi8(0x0f);
+	__m256i x0, x1, p[8];
+	unsigned char *src, *tbl;
+	int i, j, l;
+
+	for (i = start; i + 64 <= len; i += 64) {
+		for (l = 0; l < 2 * n; l++)
+			p[l] = _mm256_setzero_si256();
+
+		for (j = 0; j < k; j++) {
+			src = data[j] + i;
+			if (prefetch)
+				_mm_prefetch((char *)src + prefetch, _MM_HINT_T0);
+
+			x0 = _mm256_loadu_si256((__m256i *) src);
+			x1 = _mm256_loadu_si256((__m256i *) (src + 32));
+
+			for (l = 0; l < n; l++) {
+				tbl = &g_tbls[32 * (l * k + j)];
+				p[2 * l] = _mm256_xor_si256(p[2 * l], gf_mul_x32(x0, tbl, mask));
+				p[2 * l + 1] =
+				    _mm256_xor_si256(p[2 * l + 1], gf_mul_x32(x1, tbl, mask));
+			}
+		}
+
+		for (l = 0; l < n; l++) {
+			if (nt) {
+				_mm256_stream_si256((__m256i *) (coding[l] + i), p[2 * l]);
+				_mm256_stream_si256((__m256i *) (coding[l] + i + 32), p[2 * l + 1]);
+			} else {
+				_mm256_storeu_si256((__m256i *) (coding[l] + i), p[2 * l]);
+				_mm256_storeu_si256((__m256i *) (coding[l] + i + 32), p[2 * l + 1]);
+			}
+		}
+	}
+	return i;
+}
+
+void ec_encode_data_nt_avx2(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
+			    unsigned char **coding, int prefetch)
+{
+	int head, end = 0, nt = 1;
+
+	if (len < 128) {
+		ec_encode_data_base(len, k, rows, g_tbls, data, coding);
+		return;
+	}
+
+	/* The streaming stores need the same alignment in all the coded
+	 * vectors, the unaligned head is computed apart */
+	head = gf_nt_head(rows, coding);
+	if (head < 0) {
+		head = 0;
+		nt = 0;
+	}
+
+	gf_dot_prod_bytes(0, head, k, rows, g_tbls, data, coding);
+
+	while (rows >= 4) {
+		end = gf_nvect_dot_prod_nt_avx2(len, k, 4, head, nt, prefetch, g_tbls, data, coding);
+		gf_dot_prod_bytes(end, len, k, 4, g_tbls, data, coding);
+		g_tbls += 4 * k * 32;
+		coding += 4;
+		rows -= 4;
+	}
+	switch (rows) {
+	case 3:
+		end = gf_nvect_dot_prod_nt_avx2(len, k, 3, head, nt, prefetch, g_tbls, data, coding);
+		break;
+	case 2:
+		end = gf_nvect_dot_prod_nt_avx2(len, k, 2, head, nt, prefetch, g_tbls, data, coding);
+		break;
+	case 1:
+		end = gf_nvect_dot_prod_nt_avx2(len, k, 1, head, nt, prefetch, g_tbls, data, coding);
+		break;
+	case 0:
+		break;
+	}
+	gf_dot_prod_bytes(end, len, k, rows, g_tbls, data, coding);
+
+	// The streaming stores are weakly ordered
+	_mm_sfence();
+}
+
+#pragma GCC pop_options
+
+#else
+
+void ec_encode_data_nt_sse(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
+			   unsigned char **coding, int prefetch)
+{
+	ec_encode_data_nt_base(len, k, rows, g_tbls, data, coding, prefetch);
+}
+
+void ec_encode_data_nt_avx2(int len, int k, int rows, unsigned char *g_tbls, unsigned char **data,
+			    unsigned char **coding, int prefetch)
+{
+	ec_encode_data_nt_base(len, k, rows, g_tbls, data, coding, prefetch);
+}
+
+#endif //__GNUC__
+
 #if __WORDSIZE == 64 || _WIN64 || __x86_64__
 
 void ec_encode_data_update_sse(int len, int k, int rows, int vec_i, unsigned char *g_tbls,
@@ -84,6 +84,13 @@ extern gf_vect_dot_prod_avx2
 extern ec_encode_data_sse
 extern ec_encode_data_avx
 extern ec_encode_data_avx2
+extern ec_encode_data_stripes_base
+extern ec_encode_data_stripes_sse
+extern ec_encode_data_stripes_avx
+extern ec_encode_data_stripes_avx2
+extern ec_encode_data_nt_base
+extern ec_encode_data_nt_sse
+extern ec_encode_data_nt_avx2
 
 
 section .data
@@ -93,6 +100,12 @@ section .data
 ec_encode_data_dispatched:
 	def_wrd      ec_encode_data_mbinit
 
+ec_encode_data_stripes_dispatched:
+	def_wrd      ec_encode_data_stripes_mbinit
+
+ec_encode_data_nt_dispatched:
+	def_wrd      ec_encode_data_nt_mbinit
+
 gf_vect_mul_dispatched:
 	def_wrd      gf_vect_mul_mbinit
 
@@ -161,6 +174,114 @@ _done_ec_encode_data_init:
 	pop     arg1
 	ret
 
+;;;;
+; ec_encode_data_stripes multibinary function
+;;;;
+global ec_encode_data_stripes:function
+ec_encode_data_stripes_mbinit:
+	call	ec_encode_data_stripes_dispatch_init
+
+ec_encode_data_stripes:
+	jmp	wrd_sz [ec_encode_data_stripes_dispatched]
+
+ec_encode_data_stripes_dispatch_init:
+	push    arg1
+	push    arg2
+	push    arg3
+	push    arg4
+	push    arg5
+	lea     arg1, [ec_encode_data_stripes_base WRT_OPT] ; Default
+
+	mov     eax, 1
+	cpuid
+	lea     arg3, [ec_encode_data_stripes_sse WRT_OPT]
+	test    ecx, FLAG_CPUID1_ECX_SSE4_1
+	cmovne  arg1, arg3
+
+	and	ecx, (FLAG_CPUID1_ECX_AVX | FLAG_CPUID1_ECX_OSXSAVE)
+	cmp	ecx, (FLAG_CPUID1_ECX_AVX | FLAG_CPUID1_ECX_OSXSAVE)
+	lea	arg3, [ec_encode_data_stripes_avx WRT_OPT]
+
+	jne	_done_ec_encode_data_stripes_init
+	mov	arg1, arg3
+
+	;; Try for AVX2
+	xor	ecx, ecx
+	mov	eax, 7
+	cpuid
+	test	ebx, FLAG_CPUID1_EBX_AVX2
+	lea     arg3, [ec_encode_data_stripes_avx2 WRT_OPT]
+	cmovne	arg1, arg3
+	;; Does it have xmm and ymm support
+	xor	ecx, ecx
+	xgetbv
+	and	eax, FLAG_XGETBV_EAX_XMM_YMM
+	cmp	eax, FLAG_XGETBV_EAX_XMM_YMM
+	je	_done_ec_encode_data_stripes_init
+	lea     arg1, [ec_encode_data_stripes_sse WRT_OPT]
+
+_done_ec_encode_data_stripes_init:
+	pop     arg5
+	pop     arg4
+	pop     arg3
+	pop     arg2
+	mov     [ec_encode_data_stripes_dispatched], arg1
+	pop     arg1
+	ret
+
+;;;;
+; ec_encode_data_nt multibinary function
+;;;;
+global ec_encode_data_nt:function
+ec_encode_data_nt_mbinit:
+	call	ec_encode_data_nt_dispatch_init
+
+ec_encode_data_nt:
+	jmp	wrd_sz [ec_encode_data_nt_dispatched]
+
+ec_encode_data_nt_dispatch_init:
+	push    arg1
+	push    arg2
+	push    arg3
+	push    arg4
+	push    arg5
+	lea     arg1, [ec_encode_data_nt_base WRT_OPT] ; Default
+
+	mov     eax, 1
+	cpuid
+	lea     arg3, [ec_encode_data_nt_sse WRT_OPT]
+	test    ecx, FLAG_CPUID1_ECX_SSE4_1
+	cmovne  arg1, arg3
+
+	;; There is no AVX version, the SSE one is kept without AVX2
+	and	ecx, (FLAG_CPUID1_ECX_AVX | FLAG_CPUID1_ECX_OSXSAVE)
+	cmp	ecx, (FLAG_CPUID1_ECX_AVX | FLAG_CPUID1_ECX_OSXSAVE)
+	jne	_done_ec_encode_data_nt_init
+
+	;; Try for AVX2
+	xor	ecx, ecx
+	mov	eax, 7
+	cpuid
+	test	ebx, FLAG_CPUID1_EBX_AVX2
+	lea     arg3, [ec_encode_data_nt_avx2 WRT_OPT]
+	cmovne	arg1, arg3
+	;; Does it have xmm and ymm support
+	xor	ecx, ecx
+	xgetbv
+	and	eax, FLAG_XGETBV_EAX_XMM_YMM
+	cmp	eax, FLAG_XGETBV_EAX_XMM_YMM
+	je	_done_ec_encode_data_nt_init
+	lea     arg1, [ec_encode_data_nt_sse WRT_OPT]
+
+_done_ec_encode_data_nt_init:
+	pop     arg5
+	pop     arg4
+	pop     arg3
+	pop     arg2
+	mov     [ec_encode_data_nt_dispatched], arg1
+	pop     arg1
+	ret
+
 ;;;;
 ; gf_vect_mul multibinary function
 ;;;;
@@ -73,6 +73,15 @@ extern "C" {
 
 void ec_init_tables(int k, int rows, unsigned char* a, unsigned char* gftbls);
 
+/**
+ * @brief Initialize tables for fast Erasure Code encode and decode, runs baseline version.
+ *
+ * Baseline version of ec_init_tables() with same parameters, which expands
+ * one coefficient at a time. ec_init_tables() expands 16 coefficients at
+ * once with SSE2, which all x86-64 processors support.
+ */
+void ec_init_tables_base(int k, int rows, unsigned char* a, unsigned char* gftbls);
+
 /**
  * @brief Generate or decode erasure codes on blocks of data, runs appropriate version.
  *
@@ -119,7 +128,9 @@ void ec_encode_data_avx(int len, int k, int rows, unsigned char *gftbls, unsigne
 /**
  * @brief Generate or decode erasure codes on blocks of data.
  *
- * Arch specific version of ec_encode_data() with same parameters.
+ * Arch specific version of ec_encode_data() with same parameters. The
+ * vectors of EC_NT_THRESHOLD bytes or more are coded with
+ * ec_encode_data_nt_avx2().
  * @requires AVX2
  */
 void ec_encode_data_avx2(int len, int k, int rows, unsigned char *gftbls, unsigned char **data,
@@ -133,6 +144,138 @@ void ec_encode_data_avx2(int len, int k, int rows, unsigned char *gftbls, unsign
 void ec_encode_data_base(int len, int srcs, int dests, unsigned char *v, unsigned char **src,
 			 unsigned char **dest);
 
+/**
+ * @brief Generate or decode erasure codes on several stripes sharing one matrix, runs appropriate version.
+ *
+ * Same as calling ec_encode_data() on each stripe in turn, but each group of
+ * output vectors computed together by the dot product functions goes over all
+ * the stripes before the next group, so that its tables stay in the L1 cache
+ * and the dispatch is done once. This pays off with many small stripes.
+ *
+ * This function determines what instruction sets are enabled and
+ * selects the appropriate version at runtime.
+ *
+ * @param len     Length of each block of data (vector) of source or dest data.
+ * @param k       The number of vector sources or rows in the generator matrix
+ * 		  for coding.
+ * @param rows    The number of output vectors to concurrently encode/decode.
+ * @param gftbls  Pointer to array of input tables generated from coding
+ * 		  coefficients in ec_init_tables(). Must be of size 32*k*rows
+ * @param stripes The number of stripes.
+ * @param data    Array of stripes arrays of pointers to source input buffers.
+ * @param coding  Array of stripes arrays of pointers to coded output buffers.
+ * @returns none
+ */
+
+void ec_encode_data_stripes(int len, int k, int rows, unsigned char *gftbls, int stripes,
+			    unsigned char ***data, unsigned char ***coding);
+
+/**
+ * @brief Generate or decode erasure codes on several stripes sharing one matrix.
+ *
+ * Arch specific version of ec_encode_data_stripes() with same parameters.
+ * @requires SSE4.1
+ */
+void ec_encode_data_stripes_sse(int len, int k, int rows, unsigned char *gftbls, int stripes,
+				unsigned char ***data, unsigned char ***coding);
+
+/**
+ * @brief Generate or decode erasure codes on several stripes sharing one matrix.
+ *
+ * Arch specific version of ec_encode_data_stripes() with same parameters.
+ * @requires AVX
+ */
+void ec_encode_data_stripes_avx(int len, int k, int rows, unsigned char *gftbls, int stripes,
+				unsigned char ***data, unsigned char ***coding);
+
+/**
+ * @brief Generate or decode erasure codes on several stripes sharing one matrix.
+ *
+ * Arch specific version of ec_encode_data_stripes() with same parameters.
+ * @requires AVX2
+ */
+void ec_encode_data_stripes_avx2(int len, int k, int rows, unsigned char *gftbls, int stripes,
+				 unsigned char ***data, unsigned char ***coding);
+
+/**
+ * @brief Generate or decode erasure codes on several stripes sharing one matrix, runs baseline version.
+ *
+ * Baseline version of ec_encode_data_stripes() with same parameters.
+ */
+void ec_encode_data_stripes_base(int len, int k, int rows, unsigned char *v, int stripes,
+				 unsigned char ***data, unsigned char ***coding);
+
+/** Length of the vectors from which ec_encode_data_avx2() writes the coded
+ * vectors with ec_encode_data_nt_avx2() */
+#ifndef EC_NT_THRESHOLD
+#define EC_NT_THRESHOLD (1 << 20)
+#endif
+
+/** Distance in bytes ahead of the current position at which
+ * ec_encode_data_avx2() prefetches the sources in that case */
+#ifndef EC_PREFETCH_DISTANCE
+#define EC_PREFETCH_DISTANCE 512
+#endif
+
+/**
+ * @brief Generate or decode erasure codes on blocks of data much larger than the cache, runs appropriate version.
+ *
+ * Same as ec_encode_data(), but the coded vectors are written with
+ * non-temporal (streaming) stores, which do not read the destination lines
+ * into the cache before writing them nor evict the source data, and the
+ * sources are prefetched ahead of the current position. This pays off when
+ * the coded vectors are not read again soon, e.g. when rebuilding a device.
+ * The streaming stores are used when all the coded vectors have the same
+ * alignment on 64 bytes.
+ *
+ * This function determines what instruction sets are enabled and
+ * selects the appropriate version at runtime: the SSE version, also used
+ * with AVX, writes two coded vectors per pass with 16-byte streaming
+ * stores, the AVX2 version four with 32-byte ones, and the baseline version
+ * runs ec_encode_data_base().
+ *
+ * @param len      Length of each block of data (vector) of source or dest data.
+ * @param k        The number of vector sources or rows in the generator matrix
+ * 		   for coding.
+ * @param rows     The number of output vectors to concurrently encode/decode.
+ * @param gftbls   Pointer to array of input tables generated from coding
+ * 		   coefficients in ec_init_tables(). Must be of size 32*k*rows
+ * @param data     Array of pointers to source input buffers.
+ * @param coding   Array of pointers to coded output buffers.
+ * @param prefetch Distance in bytes of the prefetches of the sources, 0 to
+ * 		   disable them.
+ * @returns none
+ */
+
+void ec_encode_data_nt(int len, int k, int rows, unsigned char *gftbls, unsigned char **data,
+		       unsigned char **coding, int prefetch);
+
+/**
+ * @brief Generate or decode erasure codes on blocks of data much larger than the cache.
+ *
+ * Arch specific version of ec_encode_data_nt() with same parameters.
+ * @requires SSE4.1
+ */
+void ec_encode_data_nt_sse(int len, int k, int rows, unsigned char *gftbls, unsigned char **data,
+			   unsigned char **coding, int prefetch);
+
+/**
+ * @brief Generate or decode erasure codes on blocks of data much larger than the cache.
+ *
+ * Arch specific version of ec_encode_data_nt() with same parameters.
+ * @requires AVX2
+ */
+void ec_encode_data_nt_avx2(int len, int k, int rows, unsigned char *gftbls, unsigned char **data,
+			    unsigned char **coding, int prefetch);
+
+/**
+ * @brief Generate or decode erasure codes on blocks of data much larger than the cache, runs baseline version.
+ *
+ * Baseline version of ec_encode_data_nt() with same parameters.
+ */
+void ec_encode_data_nt_base(int len, int k, int rows, unsigned char *v, unsigned char **data,
+			    unsigned char **coding, int prefetch);
+
 /**
  * @brief Generate update for encode or decode of erasure codes from single source, runs appropriate version.
  *
@@ -923,6 +1066,37 @@ void gf_gen_cauchy1_matrix(unsigned char *a, int m, int k);
 
 int gf_invert_matrix(unsigned char *in, unsigned char *out, const int n);
 
+/**
+ * @brief Invert a matrix in GF(2^8) with vectorized row operations
+ *
+ * Same as gf_invert_matrix(), but the row operations of the Gauss-Jordan
+ * elimination are done by gf_vect_mad(), with the tables of the factors of
+ * each step generated at once by ec_init_tables().
+ *
+ * @param in  input matrix
+ * @param out output matrix such that [in] x [out] = [I] - identity matrix
+ * @param n   size of matrix [nxn], at most 256
+ * @returns 0 successful, other fail on singular input matrix
+ */
+
+int gf_invert_matrix_mad(unsigned char *in, unsigned char *out, const int n);
+
+/**
+ * @brief Invert a square sub-matrix of a Cauchy matrix in closed form
+ *
+ * Inverts the matrix made of n rows of the matrix generated by
+ * gf_gen_cauchy1_matrix(a, m, n), as gf_invert_matrix() would, with O(n^2)
+ * operations instead of O(n^3): the inverse of a Cauchy matrix has a closed
+ * form, and the rows of the identity only contribute known terms.
+ *
+ * @param rows indexes of the n rows of the generated matrix, in [0, m-1]
+ * @param out  output matrix such that [sub-matrix] x [out] = [I]
+ * @param n    number of columns of the generated matrix (k)
+ * @returns 0 successful, other fail on repeated rows
+ */
+
+int gf_invert_cauchy1_submatrix(unsigned char *rows, unsigned char *out, const int n);
+
 
 /*************************************************************/
 
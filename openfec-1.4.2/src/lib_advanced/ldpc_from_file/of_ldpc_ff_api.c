@@ -71,6 +71,10 @@ of_status_t	of_ldpc_ff_set_fec_parameters (of_ldpc_ff_cb_t*	cb,
 	UINT32		*p_matrix_nb_src;
 	char		* m_matrix_file;
 	FILE		*pFile;
+#ifdef OF_USE_MMAP
+	of_mod2sparse_key_t	key;
+	UINT32		magic;
+#endif
 
 	OF_ENTER_FUNCTION
 	p_matrix_nb_src = &matrix_nb_src;
@@ -87,8 +91,40 @@ of_status_t	of_ldpc_ff_set_fec_parameters (of_ldpc_ff_cb_t*	cb,
 		OF_PRINT_ERROR(("of_ldpc_ff_set_fec_parameters : ERROR, cannot open matrix file %s",m_matrix_file))
 		goto error;
 	}
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	ofcb->pchk_matrix_idx = NULL;
+#endif
+#ifdef OF_USE_DECODER
+	ofcb->symbol_pool = NULL;
+	ofcb->tab_repair_is_app_buffer = NULL;
+#endif
+#ifdef OF_USE_MMAP
+	if (fread(&magic, sizeof(magic), 1, pFile) == 1 && magic == OF_MOD2SPARSE_FILE_MAGIC)
+	{
+		/* binary matrix file, mapped in memory rather than parsed */
+		fclose(pFile);
+		ofcb->pchk_matrix = of_mod2sparse_read_binary(m_matrix_file, &key, NULL);
+		if (ofcb->pchk_matrix != NULL && (key.generator != OF_MOD2SPARSE_GEN_NONE || key.n_cols <= key.n_rows))
+		{
+			OF_PRINT_ERROR(("of_ldpc_ff_set_fec_parameters : ERROR, %s is not a parity check matrix file", m_matrix_file))
+			of_mod2sparse_free(ofcb->pchk_matrix);
+			of_free(ofcb->pchk_matrix);
+			ofcb->pchk_matrix = NULL;
+		}
+		/* the matrix file has one row per repair symbol */
+		matrix_nb_par = key.n_rows;
+		matrix_nb_src = key.n_cols - key.n_rows;
+	}
+	else
+	{
+		rewind(pFile);
+		ofcb->pchk_matrix = of_mod2sparse_read_human_readable(pFile, p_matrix_nb_src, p_matrix_nb_par);
+		fclose(pFile);
+	}
+#else
 	ofcb->pchk_matrix = of_mod2sparse_read_human_readable(pFile, p_matrix_nb_src, p_matrix_nb_par);
 	fclose(pFile);
+#endif
 
 	if (ofcb->pchk_matrix == NULL)
 	{
@@ -98,7 +134,11 @@ of_status_t	of_ldpc_ff_set_fec_parameters (of_ldpc_ff_cb_t*	cb,
 
 	cb->H2_is_identity_with_lower_triangle = true;
 
-	of_mod2sparse_matrix_stats(stdout, ofcb->pchk_matrix, *p_matrix_nb_src, *p_matrix_nb_par);
+	if (OF_GET_VERBOSITY () >= 1)
+	{
+		/* walks the whole matrix, so only do it when asked */
+		of_mod2sparse_matrix_stats(stdout, ofcb->pchk_matrix, *p_matrix_nb_src, *p_matrix_nb_par);
+	}
 
 	/* set ofcb attribute specific to from file code*/
 	if ((ofcb->nb_source_symbols = matrix_nb_src ) > ofcb->max_nb_source_symbols) {
@@ -178,6 +218,13 @@ of_status_t	of_ldpc_ff_set_fec_parameters (of_ldpc_ff_cb_t*	cb,
 	ofcb->dec_step = 0;		// Current step in the Gauss Elimination algorithm
 	ofcb->threshold_simplification = 0; // threshold (number of symbols) above which we
 					// run the Gauss Elimination algorithm
+	ofcb->ml_inactivation = false; // solve the whole simplified system as a dense system
+	ofcb->ml_m4ri_k = 0;	// column by column elimination of the dense system
+	ofcb->ml_nb_dense_cols = 0;
+	ofcb->ml_deferred_symbol_ops = false; // execute the symbol XORs of the dense system immediately
+	ofcb->ml_nb_threads = 1;
+	ofcb->ml_nb_symbol_xor = 0;
+	ofcb->ml_nb_saved_symbol_xor = 0;
 #endif
 	OF_EXIT_FUNCTION
 	return OF_STATUS_OK;
@@ -265,12 +312,27 @@ of_status_t  of_get_pck_matrix_dimensions_from_file(char * matrix_file,UINT32 *
 	FILE * f;
 	char * pch;
 	char line[1024];
+#ifdef OF_USE_MMAP
+	of_mod2sparse_file_header_t	hdr;
+#endif
 
 	f = fopen (matrix_file,"r");
 	if (f == NULL) {
 		OF_PRINT_ERROR(("Cannot open file %s\n",matrix_file))
 		goto error;
 	}
+#ifdef OF_USE_MMAP
+	if (fread (&hdr, sizeof(hdr), 1, f) == 1 && hdr.magic == OF_MOD2SPARSE_FILE_MAGIC)
+	{
+		/* binary matrix file, the dimensions are in the header */
+		*n_rows = hdr.key.n_rows;
+		*n_cols = hdr.key.n_cols;
+		fclose(f);
+		OF_EXIT_FUNCTION
+		return OF_STATUS_OK;
+	}
+	rewind(f);
+#endif
 	// get the number of row of the matrix
 	if (fgets (line, sizeof line, f) != NULL)
 	{
@@ -297,4 +359,55 @@ error:
 
 }
 
+#ifdef OF_USE_MMAP
+of_status_t  of_ldpc_ff_write_binary_matrix_file (char*	matrix_file,
+						  char*	binary_matrix_file)
+{
+	of_mod2sparse		*m;
+	of_mod2sparse_key_t	key;
+	UINT32			nb_src;
+	UINT32			nb_par;
+	of_status_t		status;
+	FILE			*f;
+
+	OF_ENTER_FUNCTION
+	f = fopen (matrix_file, "r");
+	if (f == NULL) {
+		OF_PRINT_ERROR(("Cannot open file %s\n", matrix_file))
+		goto error;
+	}
+	m = of_mod2sparse_read_human_readable(f, &nb_src, &nb_par);
+	fclose(f);
+	if (m == NULL) {
+		OF_PRINT_ERROR(("Cannot read the matrix of file %s\n", matrix_file))
+		goto error;
+	}
+	/* the binary file only records the matrix dimensions */
+	if (nb_par != (UINT32)of_mod2sparse_rows(m) || nb_src + nb_par != (UINT32)of_mod2sparse_cols(m)) {
+		OF_PRINT_ERROR(("%s: nb_source (%d) and nb_parity (%d) do not match the %dx%d matrix\n",
+				matrix_file, nb_src, nb_par, of_mod2sparse_rows(m), of_mod2sparse_cols(m)))
+		of_mod2sparse_free(m);
+		of_free(m);
+		goto error;
+	}
+	memset(&key, 0, sizeof(key));
+	key.generator = OF_MOD2SPARSE_GEN_NONE;
+	key.n_rows = nb_par;
+	key.n_cols = nb_src + nb_par;
+	status = of_mod2sparse_write_binary(binary_matrix_file, m, &key, 0);
+	of_mod2sparse_free(m);
+	of_free(m);
+	if (status != OF_STATUS_OK) {
+		OF_PRINT_ERROR(("Cannot write file %s\n", binary_matrix_file))
+		goto error;
+	}
+	OF_EXIT_FUNCTION
+	return OF_STATUS_OK;
+
+error:
+	OF_EXIT_FUNCTION
+	return OF_STATUS_ERROR;
+}
+#endif //OF_USE_MMAP
+
 #endif //OF_USE_LDPC_FROM_FILE_CODEC
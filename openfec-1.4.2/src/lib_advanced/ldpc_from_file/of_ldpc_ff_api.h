@@ -53,7 +53,8 @@ typedef struct of_ldpc_ff_parameters
 	/*
 	* FEC codec id specific attributes follow...
 	*/
-	/** Input file containing the binary parity check matrix, of size n-k x n */
+	/** Input file containing the binary parity check matrix, of size n-k x n, either
+	 * human readable or converted with of_ldpc_ff_write_binary_matrix_file() */
 	char	*pchk_file;
 } of_ldpc_ff_parameters_t;
 
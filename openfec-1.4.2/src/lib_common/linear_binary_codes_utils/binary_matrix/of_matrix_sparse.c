@@ -124,6 +124,57 @@ of_mod2sparse *of_mod2sparse_allocate  (UINT32	n_rows,		/* Number of rows in mat
 	return m;
 }
 
+/* ALLOCATE A SPARSE MOD2 MATRIX AND FILL IT FROM ROW ARRAYS.  The column
+   indexes of row i are row_col[row_start[i]] to row_col[row_start[i+1]-1], in
+   increasing order.  Since the rows are filled in increasing order too, each
+   entry is linked at the end of its row and column, without any search. */
+
+of_mod2sparse *of_mod2sparse_allocate_from_rows (UINT32		n_rows,
+						 UINT32		n_cols,
+						 const UINT32	*row_start,
+						 const UINT32	*row_col)
+{
+	of_mod2sparse	*m;
+#ifndef SPARSE_MATRIX_OPT_FOR_LDPC_STAIRCASE
+	of_mod2entry	*e;
+	of_mod2entry	*h;
+#endif
+	UINT32		i, j;
+
+	if ((m = of_mod2sparse_allocate (n_rows, n_cols)) == NULL)
+	{
+		return NULL;
+	}
+	for (i = 0; i < n_rows; i++)
+	{
+		for (j = row_start[i]; j < row_start[i + 1]; j++)
+		{
+#ifndef SPARSE_MATRIX_OPT_FOR_LDPC_STAIRCASE
+			e = of_alloc_entry (m);
+			e->row = i;
+			e->col = row_col[j];
+			/* last in row */
+			h = &m->rows[i];
+			e->left = h->left;
+			e->right = h;
+			h->left->right = e;
+			h->left = e;
+			/* last in column */
+			h = &m->cols[row_col[j]];
+			e->up = h->up;
+			e->down = h;
+			h->up->down = e;
+			h->up = e;
+#else
+			/* no "up" pointer to find the last entry of a column */
+			of_mod2sparse_insert (m, i, row_col[j]);
+#endif
+		}
+	}
+	return m;
+}
+
+
 /* FREE SPACE OCCUPIED BY A SPARSE MOD2 MATRIX. */
 
 void of_mod2sparse_free (of_mod2sparse	*m)				/* Matrix to free */
@@ -144,6 +195,37 @@ void of_mod2sparse_free (of_mod2sparse	*m)				/* Matrix to free */
 }
 
 
+/* RETURN THE AVERAGE NUMBER OF BYTES USED PER ENTRY OF A SPARSE MOD2 MATRIX
+   (row/column headers and unused entries of the allocated blocks included). */
+
+UINT32 of_mod2sparse_bytes_per_entry (of_mod2sparse *m)
+{
+	of_mod2block	*b;
+	of_mod2entry	*e;
+	UINT32		n_entries = 0;
+	UINT32		size;
+	INT32		i;
+
+	for (i = 0; i < of_mod2sparse_rows (m); i++)
+	{
+		for (e = of_mod2sparse_first_in_row (m, i); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			n_entries++;
+		}
+	}
+	if (n_entries == 0)
+	{
+		return 0;
+	}
+	size = sizeof (of_mod2sparse) + (of_mod2sparse_rows (m) + of_mod2sparse_cols (m)) * sizeof (of_mod2entry);
+	for (b = m->blocks; b != NULL; b = b->next)
+	{
+		size += sizeof (of_mod2block);
+	}
+	return (size + n_entries - 1) / n_entries;
+}
+
+
 /* CLEAR A SPARSE MATRIX TO ALL ZEROS. */
 
 void of_mod2sparse_clear (of_mod2sparse *r)
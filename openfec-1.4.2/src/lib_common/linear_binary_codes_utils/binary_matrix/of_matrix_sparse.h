@@ -163,6 +163,8 @@ void of_mod2sparse_free (of_mod2sparse *);
 
 void of_mod2sparse_clear (of_mod2sparse *);
 
+UINT32 of_mod2sparse_bytes_per_entry (of_mod2sparse *);
+
 //#if 0
 void of_mod2sparse_copy (of_mod2sparse *, of_mod2sparse *);
 //#endif // #if 0
@@ -229,6 +231,22 @@ of_mod2sparse *of_mod2sparse_read_human_readable (FILE *f,
 						  UINT32 *nb_source,
 						  UINT32 *nb_parity);
 
+/**
+ * Allocate a matrix and fill it from the column indexes of its non-zero entries,
+ * row by row, as stored in a compressed file.
+ *
+ * @param n_rows		(IN) number of rows
+ * @param n_cols		(IN) number of columns
+ * @param row_start		(IN) n_rows+1 offsets in row_col of the first entry of each row,
+ *				the last one being the number of entries
+ * @param row_col		(IN) column index of each entry, in increasing order within a row
+ * @return			the new matrix
+ */
+of_mod2sparse *of_mod2sparse_allocate_from_rows (UINT32		n_rows,
+						 UINT32		n_cols,
+						 const UINT32	*row_start,
+						 const UINT32	*row_col);
+
 /* PRINT matrix statistics: average number of 1's per row/line etc ...*/
 
 void of_mod2sparse_matrix_stats (FILE *,
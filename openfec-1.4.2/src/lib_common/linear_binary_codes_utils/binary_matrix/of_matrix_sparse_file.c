@@ -0,0 +1,287 @@
+/* $Id: of_matrix_sparse_file.c $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+
+#include "../of_linear_binary_code.h"
+
+
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef OF_USE_MMAP
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/******  Static Functions  ****************************************************/
+
+
+/**
+ * Build the name of the cache file of a matrix. Return 1 if it's OK, 0 if too long.
+ */
+static INT32
+of_mod2sparse_cache_path (char				*path,
+			  size_t			size,
+			  const char			*dir,
+			  const of_mod2sparse_key_t	*key)
+{
+	INT32	len;
+
+	len = snprintf (path, size, "%s/of_pchk_g%u_r%u_c%u_d%u_s%u.bin", dir, key->generator,
+			key->n_rows, key->n_cols, key->left_degree, key->seed);
+	return (len > 0 && (size_t) len < size);
+}
+
+
+/**
+ * Write all the bytes of buf. Return 1 if it's OK, 0 otherwise.
+ */
+static INT32
+of_write_all (INT32		fd,
+	      const void	*buf,
+	      size_t		size)
+{
+	const UINT8	*p = (const UINT8*) buf;
+	ssize_t		w;
+
+	while (size > 0)
+	{
+		if ((w = write (fd, p, size)) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return 0;
+		}
+		p += w;
+		size -= w;
+	}
+	return 1;
+}
+
+
+/******************************************************************************/
+
+
+of_status_t of_mod2sparse_write_binary (const char		*path,
+					of_mod2sparse		*m,
+					const of_mod2sparse_key_t *key,
+					UINT32			flags)
+{
+	OF_ENTER_FUNCTION
+	of_mod2sparse_file_header_t	hdr;
+	of_mod2entry	*e;
+	UINT32		*tab = NULL;
+	UINT32		n_rows;
+	UINT32		n_entries;
+	UINT32		i, j;
+	char		tmp_path[1024];
+	INT32		fd;
+	bool		written;
+
+	n_rows = of_mod2sparse_rows (m);
+	n_entries = 0;
+	for (i = 0; i < n_rows; i++)
+	{
+		for (e = of_mod2sparse_first_in_row (m, i); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+			n_entries++;
+	}
+	if ((tab = (UINT32*) of_malloc ((n_rows + 1 + n_entries) * sizeof (UINT32))) == NULL)
+	{
+		OF_PRINT_ERROR(("out of memory\n"))
+		OF_EXIT_FUNCTION
+		return OF_STATUS_ERROR;
+	}
+	/* row offsets, then column indexes */
+	for (i = 0, j = n_rows + 1; i < n_rows; i++)
+	{
+		tab[i] = j - (n_rows + 1);
+		for (e = of_mod2sparse_first_in_row (m, i); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+			tab[j++] = of_mod2sparse_col (e);
+	}
+	tab[n_rows] = n_entries;
+	memset (&hdr, 0, sizeof (hdr));
+	hdr.magic = OF_MOD2SPARSE_FILE_MAGIC;
+	hdr.version = OF_MOD2SPARSE_FILE_VERSION;
+	hdr.key = *key;
+	hdr.key.n_rows = n_rows;
+	hdr.key.n_cols = of_mod2sparse_cols (m);
+	hdr.n_entries = n_entries;
+	hdr.flags = flags;
+	/* write a temporary file then rename it, so that readers never see a partial file.
+	 * Its name is unique, as sessions of the same process may store the same matrix. */
+	if (snprintf (tmp_path, sizeof (tmp_path), "%s.XXXXXX", path) >= (INT32) sizeof (tmp_path) ||
+	    (fd = mkstemp (tmp_path)) < 0)
+	{
+		OF_TRACE_LVL(1, ("%s: cannot create %s\n", __FUNCTION__, path))
+		of_free (tab);
+		OF_EXIT_FUNCTION
+		return OF_STATUS_ERROR;
+	}
+	/* mkstemp() creates the file for its owner only, the cache is shared */
+	written = fchmod (fd, 0644) == 0 &&
+		  of_write_all (fd, &hdr, sizeof (hdr)) &&
+		  of_write_all (fd, tab, (n_rows + 1 + n_entries) * sizeof (UINT32));
+	if (close (fd) != 0 || !written ||
+	    rename (tmp_path, path) != 0)
+	{
+		OF_TRACE_LVL(1, ("%s: cannot write %s\n", __FUNCTION__, path))
+		unlink (tmp_path);
+		of_free (tab);
+		OF_EXIT_FUNCTION
+		return OF_STATUS_ERROR;
+	}
+	of_free (tab);
+	OF_EXIT_FUNCTION
+	return OF_STATUS_OK;
+}
+
+
+of_mod2sparse *of_mod2sparse_read_binary (const char		*path,
+					  of_mod2sparse_key_t	*key,
+					  UINT32		*flags)
+{
+	OF_ENTER_FUNCTION
+	const of_mod2sparse_file_header_t	*hdr;
+	of_mod2sparse	*m = NULL;
+	const UINT32	*row_start;
+	const UINT32	*row_col;
+	struct stat	st;
+	void		*map;
+	UINT64		size;
+	UINT32		i, j;
+	INT32		fd;
+
+	if ((fd = open (path, O_RDONLY)) < 0)
+	{
+		OF_EXIT_FUNCTION
+		return NULL;
+	}
+	if (fstat (fd, &st) != 0 || st.st_size < (off_t) sizeof (*hdr) ||
+	    (map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+	{
+		close (fd);
+		OF_EXIT_FUNCTION
+		return NULL;
+	}
+	close (fd);
+	hdr = (const of_mod2sparse_file_header_t*) map;
+	row_start = (const UINT32*) (hdr + 1);
+	row_col = row_start + hdr->key.n_rows + 1;
+	size = sizeof (*hdr) + ((UINT64) hdr->key.n_rows + 1 + hdr->n_entries) * sizeof (UINT32);
+	if (hdr->magic != OF_MOD2SPARSE_FILE_MAGIC || hdr->version != OF_MOD2SPARSE_FILE_VERSION ||
+	    hdr->key.n_rows == 0 || hdr->key.n_cols == 0 || size != (UINT64) st.st_size ||
+	    row_start[0] != 0 || row_start[hdr->key.n_rows] != hdr->n_entries)
+	{
+		OF_PRINT_ERROR(("%s: invalid matrix file %s\n", __FUNCTION__, path))
+		goto end;
+	}
+	for (i = 0; i < hdr->key.n_rows; i++)
+	{
+		if (row_start[i + 1] < row_start[i] || row_start[i + 1] > hdr->n_entries)
+			goto invalid;
+		for (j = row_start[i]; j < row_start[i + 1]; j++)
+		{
+			/* increasing column indexes, so that each entry is appended to its row and column */
+			if (row_col[j] >= hdr->key.n_cols || (j > row_start[i] && row_col[j] <= row_col[j - 1]))
+				goto invalid;
+		}
+	}
+	if ((m = of_mod2sparse_allocate_from_rows (hdr->key.n_rows, hdr->key.n_cols, row_start, row_col)) == NULL)
+	{
+		goto end;
+	}
+	if (key != NULL)
+		*key = hdr->key;
+	if (flags != NULL)
+		*flags = hdr->flags;
+end:
+	munmap (map, st.st_size);
+	OF_EXIT_FUNCTION
+	return m;
+
+invalid:
+	OF_PRINT_ERROR(("%s: invalid matrix file %s\n", __FUNCTION__, path))
+	goto end;
+}
+
+
+of_mod2sparse *of_mod2sparse_cache_load (const char		*dir,
+					 const of_mod2sparse_key_t *key,
+					 UINT32			*flags)
+{
+	OF_ENTER_FUNCTION
+	of_mod2sparse_key_t	file_key;
+	of_mod2sparse		*m;
+	char			path[1024];
+
+	if (!of_mod2sparse_cache_path (path, sizeof (path), dir, key) ||
+	    (m = of_mod2sparse_read_binary (path, &file_key, flags)) == NULL)
+	{
+		OF_EXIT_FUNCTION
+		return NULL;
+	}
+	if (memcmp (&file_key, key, sizeof (file_key)) != 0)
+	{
+		OF_PRINT_ERROR(("%s: %s does not match its name\n", __FUNCTION__, path))
+		of_mod2sparse_free (m);
+		of_free (m);
+		OF_EXIT_FUNCTION
+		return NULL;
+	}
+	OF_EXIT_FUNCTION
+	return m;
+}
+
+
+of_status_t of_mod2sparse_cache_store (const char		*dir,
+				       of_mod2sparse		*m,
+				       const of_mod2sparse_key_t *key,
+				       UINT32			flags)
+{
+	OF_ENTER_FUNCTION
+	char	path[1024];
+
+	if (!of_mod2sparse_cache_path (path, sizeof (path), dir, key))
+	{
+		OF_EXIT_FUNCTION
+		return OF_STATUS_ERROR;
+	}
+	OF_EXIT_FUNCTION
+	return of_mod2sparse_write_binary (path, m, key, flags);
+}
+
+
+#endif //OF_USE_MMAP
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
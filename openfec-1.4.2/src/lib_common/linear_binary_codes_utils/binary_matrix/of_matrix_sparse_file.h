@@ -0,0 +1,149 @@
+/* $Id: of_matrix_sparse_file.h $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+
+/*
+ * This module stores a sparse mod2 matrix in a binary file that is mapped in
+ * memory, checked in a single pass over its entries and turned back into a
+ * matrix, so that a codec can keep the parity check matrices it generates in
+ * an on-disk cache rather than generating them again for each session.
+ *
+ * The file is made of native endian UINT32 values:
+ * - the header (of_mod2sparse_file_header_t);
+ * - the n_rows+1 offsets of the first entry of each row;
+ * - the column index of each of the n_entries entries, row by row, in increasing
+ *   order within a row.
+ * The header also records how the matrix has been generated (the cache key), so
+ * that a cached matrix is never used for other parameters.
+ */
+
+#ifndef OF_LDPC_MATRIX_SPARSE_FILE__
+#define OF_LDPC_MATRIX_SPARSE_FILE__
+
+
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef OF_USE_MMAP
+
+#define OF_MOD2SPARSE_FILE_MAGIC	0x4B484350	/* "PCHK" */
+#define OF_MOD2SPARSE_FILE_VERSION	1
+
+/** Generators of the matrices, part of the cache key. */
+#define OF_MOD2SPARSE_GEN_NONE			0	/* not generated, e.g. read from a file */
+#define OF_MOD2SPARSE_GEN_LDPC_STAIRCASE	1	/* of_create_pchck_matrix_rfc5170_compliant() */
+
+
+/**
+ * What a matrix has been generated from.
+ */
+typedef struct of_mod2sparse_key
+{
+	UINT32	generator;	/* OF_MOD2SPARSE_GEN_* */
+	UINT32	n_rows;
+	UINT32	n_cols;
+	UINT32	left_degree;	/* number of "1" entries per column */
+	UINT32	seed;		/* seed of the PRNG */
+} of_mod2sparse_key_t;
+
+
+/**
+ * Header of a binary matrix file.
+ */
+typedef struct of_mod2sparse_file_header
+{
+	UINT32			magic;		/* OF_MOD2SPARSE_FILE_MAGIC */
+	UINT32			version;	/* OF_MOD2SPARSE_FILE_VERSION */
+	of_mod2sparse_key_t	key;		/* the matrix has key.n_rows rows and key.n_cols columns */
+	UINT32			n_entries;	/* number of non-zero entries */
+	UINT32			flags;		/* generator specific */
+} of_mod2sparse_file_header_t;
+
+
+/**
+ * Write a matrix in a binary file. The file is written under a temporary name then
+ * renamed, so that a concurrent reader never sees a partial file.
+ *
+ * @param path		(IN) file name
+ * @param m		(IN) sparse matrix
+ * @param key		(IN) what the matrix has been generated from
+ * @param flags		(IN) generator specific flags, given back when reading the file
+ * @return		OF_STATUS_OK, or OF_STATUS_ERROR if the file cannot be written
+ */
+of_status_t of_mod2sparse_write_binary (const char		*path,
+					of_mod2sparse		*m,
+					const of_mod2sparse_key_t *key,
+					UINT32			flags);
+
+/**
+ * Map a binary matrix file in memory and create the matrix. The entries are appended
+ * row by row, so that the matrix is built in a time linear with the number of entries.
+ *
+ * @param path		(IN) file name
+ * @param key		(OUT) what the matrix has been generated from (can be NULL)
+ * @param flags		(OUT) generator specific flags (can be NULL)
+ * @return		the new matrix, or NULL if the file does not exist or is not valid
+ */
+of_mod2sparse *of_mod2sparse_read_binary (const char		*path,
+					  of_mod2sparse_key_t	*key,
+					  UINT32		*flags);
+
+/**
+ * Load a generated matrix from the cache directory.
+ *
+ * @param dir		(IN) cache directory
+ * @param key		(IN) what the matrix is generated from
+ * @param flags		(OUT) generator specific flags (can be NULL)
+ * @return		the new matrix, or NULL if it is not in the cache
+ */
+of_mod2sparse *of_mod2sparse_cache_load (const char		*dir,
+					 const of_mod2sparse_key_t *key,
+					 UINT32			*flags);
+
+/**
+ * Store a generated matrix in the cache directory.
+ *
+ * @param dir		(IN) cache directory
+ * @param m		(IN) sparse matrix
+ * @param key		(IN) what the matrix has been generated from
+ * @param flags		(IN) generator specific flags
+ * @return		OF_STATUS_OK, or OF_STATUS_ERROR if the file cannot be written
+ */
+of_status_t of_mod2sparse_cache_store (const char		*dir,
+				       of_mod2sparse		*m,
+				       const of_mod2sparse_key_t *key,
+				       UINT32			flags);
+
+
+#endif //OF_USE_MMAP
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
+
+#endif /* OF_LDPC_MATRIX_SPARSE_FILE__ */
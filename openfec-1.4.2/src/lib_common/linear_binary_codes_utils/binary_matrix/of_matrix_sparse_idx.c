@@ -0,0 +1,190 @@
+/* $Id: of_matrix_sparse_idx.c $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+#include "../of_linear_binary_code.h"
+
+
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+
+/* CREATE AN INDEX-BASED COPY OF A LINKED-LIST SPARSE MATRIX. */
+
+of_mod2sparse_idx *of_mod2sparse_idx_from_sparse (of_mod2sparse *m)
+{
+	OF_ENTER_FUNCTION
+	of_mod2sparse_idx	*r;
+	of_mod2entry		*e;
+	UINT32			n_rows;
+	UINT32			n_cols;
+	UINT32			n_entries;
+	UINT32			n_words;
+	UINT32			*p;
+	UINT32			i;
+	UINT32			j;
+	UINT32			rs;	/* current row slot */
+	UINT32			cs;	/* current col slot */
+
+	n_rows = of_mod2sparse_rows (m);
+	n_cols = of_mod2sparse_cols (m);
+	n_entries = 0;
+	for (i = 0; i < n_rows; i++)
+	{
+		for (e = of_mod2sparse_first_in_row (m, i); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			n_entries++;
+		}
+	}
+	if ((r = (of_mod2sparse_idx *) of_calloc (1, sizeof (of_mod2sparse_idx))) == NULL)
+	{
+		goto no_mem;
+	}
+	r->n_rows = n_rows;
+	r->n_cols = n_cols;
+	r->n_entries = n_entries;
+	n_words = 2 * (n_rows + 1) + 2 * (n_cols + 1) + 4 * n_entries;
+	r->arena_size = n_words * sizeof (UINT32);
+	if ((r->arena = of_malloc (r->arena_size)) == NULL)
+	{
+		of_free (r);
+		goto no_mem;
+	}
+	p = (UINT32 *) r->arena;
+	r->row_start = p;	p += n_rows + 1;
+	r->row_first = p;	p += n_rows + 1;
+	r->col_start = p;	p += n_cols + 1;
+	r->col_first = p;	p += n_cols + 1;
+	r->row_col = p;		p += n_entries;
+	r->row_twin = p;	p += n_entries;
+	r->col_row = p;		p += n_entries;
+	r->col_twin = p;
+	/* count the entries of each column, then turn these counts into offsets */
+	memset (r->col_start, 0, (n_cols + 1) * sizeof (UINT32));
+	for (i = 0; i < n_rows; i++)
+	{
+		for (e = of_mod2sparse_first_in_row (m, i); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			r->col_start[of_mod2sparse_col (e) + 1]++;
+		}
+	}
+	for (j = 0; j < n_cols; j++)
+	{
+		r->col_start[j + 1] += r->col_start[j];
+		r->col_first[j] = r->col_start[j];	/* used as a fill cursor below */
+	}
+	/* now fill both views, row by row, so that entries remain sorted within each row and column */
+	rs = 0;
+	for (i = 0; i < n_rows; i++)
+	{
+		r->row_start[i] = rs;
+		r->row_first[i] = rs;
+		for (e = of_mod2sparse_first_in_row (m, i); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			j = of_mod2sparse_col (e);
+			cs = r->col_first[j]++;
+			r->row_col[rs] = j;
+			r->row_twin[rs] = cs;
+			r->col_row[cs] = i;
+			r->col_twin[cs] = rs;
+			rs++;
+		}
+	}
+	r->row_start[n_rows] = rs;
+	for (j = 0; j < n_cols; j++)
+	{
+		r->col_first[j] = r->col_start[j];
+	}
+	OF_EXIT_FUNCTION
+	return r;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory\n"))
+	OF_EXIT_FUNCTION
+	return NULL;
+}
+
+
+/* CREATE A LINKED-LIST SPARSE MATRIX FROM THE ENTRIES LEFT IN AN INDEX-BASED ONE. */
+
+of_mod2sparse *of_mod2sparse_idx_to_sparse (of_mod2sparse_idx *m)
+{
+	OF_ENTER_FUNCTION
+	of_mod2sparse	*r;
+	UINT32		i;
+	UINT32		s;
+
+	if ((r = of_mod2sparse_allocate (m->n_rows, m->n_cols)) == NULL)
+	{
+		OF_PRINT_ERROR(("out of memory\n"))
+		OF_EXIT_FUNCTION
+		return NULL;
+	}
+	/* rows and columns are both visited in increasing order, so each insertion appends */
+	for (i = 0; i < m->n_rows; i++)
+	{
+		for (s = of_mod2sparse_idx_first_in_row (m, i); !of_mod2sparse_idx_at_end (s); s = of_mod2sparse_idx_next_in_row (m, i, s))
+		{
+			of_mod2sparse_insert (r, i, of_mod2sparse_idx_col_of_row_slot (m, s));
+		}
+	}
+	OF_EXIT_FUNCTION
+	return r;
+}
+
+
+/* FREE AN INDEX-BASED SPARSE MATRIX. */
+
+void of_mod2sparse_idx_free (of_mod2sparse_idx *m)
+{
+	OF_ENTER_FUNCTION
+	if (m != NULL)
+	{
+		of_free (m->arena);
+		of_free (m);
+	}
+	OF_EXIT_FUNCTION
+}
+
+
+/* RETURN THE AVERAGE NUMBER OF BYTES USED PER ENTRY. */
+
+UINT32 of_mod2sparse_idx_bytes_per_entry (of_mod2sparse_idx *m)
+{
+	if (m->n_entries == 0)
+	{
+		return 0;
+	}
+	return (sizeof (of_mod2sparse_idx) + m->arena_size + m->n_entries - 1) / m->n_entries;
+}
+
+#endif //OF_USE_INDEXED_SPARSE_MATRIX
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
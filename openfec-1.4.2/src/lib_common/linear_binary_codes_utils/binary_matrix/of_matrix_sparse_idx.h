@@ -0,0 +1,216 @@
+/* $Id: of_matrix_sparse_idx.h $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+/*
+ * This module implements an index-based representation of a sparse mod2
+ * matrix, meant to be used by the IT decoder in place of the linked-list
+ * representation of of_matrix_sparse.h.
+ *
+ * All the non-zero entries of a given row (resp. column) are stored in a
+ * contiguous array of 32-bit column (resp. row) indexes, and every entry
+ * knows the location of its twin in the column (resp. row) array. All the
+ * arrays are carved out of a single memory block (arena) allocated when the
+ * matrix is created from its linked-list counterpart, so that no allocation
+ * takes place afterwards.
+ *
+ * Deleting an entry does not move anything: both twins are overwritten with
+ * a tombstone (OF_MOD2SPARSE_IDX_DELETED), and walking a row or a column
+ * simply skips them. A per row/column hint remembers the first slot that is
+ * not a tombstone, so that the "first entry" request does not rescan the
+ * entries deleted so far (the IT decoder mostly deletes the first entries).
+ *
+ * An entry is identified by its slot, i.e. its position either in the row
+ * arrays (row slot) or in the column arrays (col slot). The row (resp.
+ * column) of a slot is not stored, which is why the traversal functions
+ * require it.
+ */
+
+#ifndef OF_LDPC_MATRIX_SPARSE_IDX__
+#define OF_LDPC_MATRIX_SPARSE_IDX__
+
+
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+
+/** Tombstone value left in both twins of a deleted entry. */
+#define OF_MOD2SPARSE_IDX_DELETED	0xFFFFFFFF
+
+/** Value returned when moving past the last entry of a row or column. */
+#define OF_MOD2SPARSE_IDX_END		0xFFFFFFFF
+
+
+/**
+ * Representation of an index-based sparse matrix.
+ */
+typedef struct of_mod2sparse_idx
+{
+	UINT32	n_rows;		/* Number of rows in the matrix */
+	UINT32	n_cols;		/* Number of columns in the matrix */
+	UINT32	n_entries;	/* Number of slots (i.e. entries, deleted or not) */
+
+	UINT32	*row_start;	/* n_rows+1 offsets of the first slot of each row */
+	UINT32	*col_start;	/* n_cols+1 offsets of the first slot of each column */
+	UINT32	*row_first;	/* first slot of each row that may not be a tombstone */
+	UINT32	*col_first;	/* first slot of each column that may not be a tombstone */
+
+	UINT32	*row_col;	/* column index of each row slot, or DELETED */
+	UINT32	*row_twin;	/* col slot of the same entry, for each row slot */
+	UINT32	*col_row;	/* row index of each col slot, or DELETED */
+	UINT32	*col_twin;	/* row slot of the same entry, for each col slot */
+
+	void	*arena;		/* memory block where all the above tables live */
+	UINT32	arena_size;	/* size in bytes of this memory block */
+} of_mod2sparse_idx;
+
+
+/* MACROS TO GET AT ELEMENTS OF AN INDEX-BASED SPARSE MATRIX. */
+
+#define of_mod2sparse_idx_rows(m)		((m)->n_rows)
+#define of_mod2sparse_idx_cols(m)		((m)->n_cols)
+
+#define of_mod2sparse_idx_col_of_row_slot(m,s)	((m)->row_col[s])	/* Find out the column of a row slot */
+#define of_mod2sparse_idx_row_of_col_slot(m,s)	((m)->col_row[s])	/* Find out the row of a col slot */
+
+#define of_mod2sparse_idx_at_end(s)		((s) == OF_MOD2SPARSE_IDX_END)
+
+
+/**
+ * Return the first row slot of row i that is not deleted, or OF_MOD2SPARSE_IDX_END.
+ */
+static inline UINT32 of_mod2sparse_idx_first_in_row (of_mod2sparse_idx *m, UINT32 i)
+{
+	UINT32	s = m->row_first[i];
+	UINT32	end = m->row_start[i + 1];
+
+	while (s < end && m->row_col[s] == OF_MOD2SPARSE_IDX_DELETED)
+		s++;
+	m->row_first[i] = s;
+	return (s < end) ? s : OF_MOD2SPARSE_IDX_END;
+}
+
+/**
+ * Return the row slot that follows row slot s in row i, or OF_MOD2SPARSE_IDX_END.
+ */
+static inline UINT32 of_mod2sparse_idx_next_in_row (of_mod2sparse_idx *m, UINT32 i, UINT32 s)
+{
+	UINT32	end = m->row_start[i + 1];
+
+	for (s++; s < end && m->row_col[s] == OF_MOD2SPARSE_IDX_DELETED; s++);
+	return (s < end) ? s : OF_MOD2SPARSE_IDX_END;
+}
+
+/**
+ * Return the first col slot of column j that is not deleted, or OF_MOD2SPARSE_IDX_END.
+ */
+static inline UINT32 of_mod2sparse_idx_first_in_col (of_mod2sparse_idx *m, UINT32 j)
+{
+	UINT32	s = m->col_first[j];
+	UINT32	end = m->col_start[j + 1];
+
+	while (s < end && m->col_row[s] == OF_MOD2SPARSE_IDX_DELETED)
+		s++;
+	m->col_first[j] = s;
+	return (s < end) ? s : OF_MOD2SPARSE_IDX_END;
+}
+
+/**
+ * Return the col slot that follows col slot s in column j, or OF_MOD2SPARSE_IDX_END.
+ */
+static inline UINT32 of_mod2sparse_idx_next_in_col (of_mod2sparse_idx *m, UINT32 j, UINT32 s)
+{
+	UINT32	end = m->col_start[j + 1];
+
+	for (s++; s < end && m->col_row[s] == OF_MOD2SPARSE_IDX_DELETED; s++);
+	return (s < end) ? s : OF_MOD2SPARSE_IDX_END;
+}
+
+/**
+ * Delete the entry of row slot s, i.e. tombstone it as well as its twin col slot.
+ */
+static inline void of_mod2sparse_idx_delete_row_slot (of_mod2sparse_idx *m, UINT32 s)
+{
+	ASSERT(m->row_col[s] != OF_MOD2SPARSE_IDX_DELETED);
+	m->col_row[m->row_twin[s]] = OF_MOD2SPARSE_IDX_DELETED;
+	m->row_col[s] = OF_MOD2SPARSE_IDX_DELETED;
+}
+
+/**
+ * Delete the entry of col slot s, i.e. tombstone it as well as its twin row slot.
+ */
+static inline void of_mod2sparse_idx_delete_col_slot (of_mod2sparse_idx *m, UINT32 s)
+{
+	ASSERT(m->col_row[s] != OF_MOD2SPARSE_IDX_DELETED);
+	m->row_col[m->col_twin[s]] = OF_MOD2SPARSE_IDX_DELETED;
+	m->col_row[s] = OF_MOD2SPARSE_IDX_DELETED;
+}
+
+
+/* PROCEDURES TO MANIPULATE INDEX-BASED SPARSE MATRICES. */
+
+/**
+ * Create an index-based copy of a linked-list sparse matrix.
+ *
+ * @param m		(IN) linked-list sparse matrix
+ * @return		the new matrix, or NULL in case of error (out of memory)
+ */
+of_mod2sparse_idx *of_mod2sparse_idx_from_sparse (of_mod2sparse *m);
+
+/**
+ * Create a linked-list sparse matrix containing the entries of the index-based
+ * matrix that are not deleted.
+ *
+ * @param m		(IN) index-based sparse matrix
+ * @return		the new matrix, or NULL in case of error (out of memory)
+ */
+of_mod2sparse *of_mod2sparse_idx_to_sparse (of_mod2sparse_idx *m);
+
+/**
+ * Free an index-based sparse matrix, including the structure itself.
+ *
+ * @param m		(IN) index-based sparse matrix
+ */
+void of_mod2sparse_idx_free (of_mod2sparse_idx *m);
+
+/**
+ * Return the average number of bytes used per entry (header tables included).
+ *
+ * @param m		(IN) index-based sparse matrix
+ * @return		number of bytes per entry, rounded up
+ */
+UINT32 of_mod2sparse_idx_bytes_per_entry (of_mod2sparse_idx *m);
+
+
+#endif //OF_USE_INDEXED_SPARSE_MATRIX
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
+
+#endif /* OF_LDPC_MATRIX_SPARSE_IDX__ */
@@ -37,12 +37,54 @@
 #ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
 
 
+/*
+ * Parity check matrix accessors used by the IT decoder. Depending on
+ * OF_USE_INDEXED_SPARSE_MATRIX, an entry is either a pointer to a linked-list
+ * entry of ofcb->pchk_matrix, or a slot of the index-based ofcb->pchk_matrix_idx.
+ * In the latter case the row (resp. column) being walked must be provided.
+ */
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+
+typedef UINT32	of_it_entry_t;
+
+#define OF_IT_FIRST_IN_COL(ofcb,c)	of_mod2sparse_idx_first_in_col ((ofcb)->pchk_matrix_idx, (c))
+#define OF_IT_NEXT_IN_COL(ofcb,c,e)	of_mod2sparse_idx_next_in_col ((ofcb)->pchk_matrix_idx, (c), (e))
+#define OF_IT_AT_END_COL(e)		of_mod2sparse_idx_at_end (e)
+#define OF_IT_ROW_OF(ofcb,e)		of_mod2sparse_idx_row_of_col_slot ((ofcb)->pchk_matrix_idx, (e))
+#define OF_IT_DELETE_IN_COL(ofcb,e)	of_mod2sparse_idx_delete_col_slot ((ofcb)->pchk_matrix_idx, (e))
+
+#define OF_IT_FIRST_IN_ROW(ofcb,r)	of_mod2sparse_idx_first_in_row ((ofcb)->pchk_matrix_idx, (r))
+#define OF_IT_NEXT_IN_ROW(ofcb,r,e)	of_mod2sparse_idx_next_in_row ((ofcb)->pchk_matrix_idx, (r), (e))
+#define OF_IT_AT_END_ROW(e)		of_mod2sparse_idx_at_end (e)
+#define OF_IT_COL_OF(ofcb,e)		of_mod2sparse_idx_col_of_row_slot ((ofcb)->pchk_matrix_idx, (e))
+#define OF_IT_DELETE_IN_ROW(ofcb,e)	of_mod2sparse_idx_delete_row_slot ((ofcb)->pchk_matrix_idx, (e))
+
+#else
+
+typedef of_mod2entry*	of_it_entry_t;
+
+#define OF_IT_FIRST_IN_COL(ofcb,c)	of_mod2sparse_first_in_col ((ofcb)->pchk_matrix, (c))
+#define OF_IT_NEXT_IN_COL(ofcb,c,e)	of_mod2sparse_next_in_col (e)
+#define OF_IT_AT_END_COL(e)		of_mod2sparse_at_end_col (e)
+#define OF_IT_ROW_OF(ofcb,e)		((e)->row)
+#define OF_IT_DELETE_IN_COL(ofcb,e)	of_mod2sparse_delete ((ofcb)->pchk_matrix, (e))
+
+#define OF_IT_FIRST_IN_ROW(ofcb,r)	of_mod2sparse_first_in_row ((ofcb)->pchk_matrix, (r))
+#define OF_IT_NEXT_IN_ROW(ofcb,r,e)	of_mod2sparse_next_in_row (e)
+#define OF_IT_AT_END_ROW(e)		of_mod2sparse_at_end_row (e)
+#define OF_IT_COL_OF(ofcb,e)		((e)->col)
+#define OF_IT_DELETE_IN_ROW(ofcb,e)	of_mod2sparse_delete ((ofcb)->pchk_matrix, (e))
+
+#endif // OF_USE_INDEXED_SPARSE_MATRIX
+
+
 of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_cb_t*	ofcb,
 							  void*				new_symbol,
 							  UINT32			new_symbol_esi)
 {
-	of_mod2entry	*e = NULL;			// entry ("1") in parity check matrix
-	of_mod2entry	*mod_entry_to_delete;		// temp: entry to delete in row/column
+	of_it_entry_t	e;				// entry ("1") in parity check matrix
+	of_it_entry_t	mod_entry_to_delete;		// temp: entry to delete in row/column
+	UINT32		col;				// column of new_symbol
 	void		*const_term;			// temp: pointer to constant term, containing the sum of
 							// all the known symbols of this equation
 	UINT32		row;				// temp: current row value
@@ -101,13 +143,22 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 #endif
 		// in ML decoding, we need to store all parity symbols, whereas with pure IT
 		// decoding this is not necessary.
-		if ((ofcb->encoding_symbols_tab[new_symbol_esi] = (void *)
-						of_malloc (ofcb->encoding_symbol_length)) == NULL)
+		if (ofcb->tab_repair_is_app_buffer != NULL)
 		{
-			goto no_mem;
+			// zero-copy mode: the application guarantees this buffer outlives decoding.
+			ofcb->encoding_symbols_tab[new_symbol_esi] = new_symbol;
+			ofcb->tab_repair_is_app_buffer[new_symbol_esi - ofcb->nb_source_symbols] = 1;
+		}
+		else
+		{
+			if ((ofcb->encoding_symbols_tab[new_symbol_esi] = (void *)
+							of_symbol_pool_malloc (ofcb->symbol_pool, ofcb->encoding_symbol_length)) == NULL)
+			{
+				goto no_mem;
+			}
+			// copy the content...
+			memcpy (ofcb->encoding_symbols_tab[new_symbol_esi], new_symbol, ofcb->encoding_symbol_length);
 		}
-		// copy the content...
-		memcpy (ofcb->encoding_symbols_tab[new_symbol_esi], new_symbol, ofcb->encoding_symbol_length);
 	}
 	OF_TRACE_LVL (1, ("%s: new %s symbol (esi=%d), total of %d/%d source/repair symbols ready\n",
 			__FUNCTION__, (of_is_source_symbol ((of_cb_t*)ofcb, new_symbol_esi)) ? "source" : "parity",
@@ -117,11 +168,22 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 	 * Step 2: Inject the symbol value in each equation it is involved
 	 */
 	// (if partial sum already exists or if partial sum should be created)
-	for (e = of_mod2sparse_first_in_col (ofcb->pchk_matrix, of_get_symbol_col ((of_cb_t*)ofcb, new_symbol_esi)); !of_mod2sparse_at_end_col (e); )
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	if (ofcb->pchk_matrix_idx == NULL)
+	{
+		// first symbol: switch to the index-based parity check matrix
+		if ((ofcb->pchk_matrix_idx = of_mod2sparse_idx_from_sparse (ofcb->pchk_matrix)) == NULL)
+		{
+			goto no_mem;
+		}
+	}
+#endif
+	col = of_get_symbol_col ((of_cb_t*)ofcb, new_symbol_esi);
+	for (e = OF_IT_FIRST_IN_COL (ofcb, col); !OF_IT_AT_END_COL (e); )
 	{
 		// for a given row, ie for a given equation where this symbol
 		// is implicated, do the following:
-		row = e->row;
+		row = OF_IT_ROW_OF (ofcb, e);
 		ofcb->tab_nb_unknown_symbols[row]--;		// symbol is known
 		const_term = ofcb->tab_const_term_of_equ[row];	// associated partial sum buffer (if any)
 		if ((const_term == NULL) && ((ofcb->tab_nb_unknown_symbols[row] == 1)))
@@ -129,7 +191,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 			// we need to allocate a partial sum (i.e. check node)
 			// and add the symbol to it, because it is the
 			// last missing symbol of this equation.
-			const_term = (void*) of_calloc (1, ofcb->encoding_symbol_length);
+			const_term = (void*) of_symbol_pool_calloc (ofcb->symbol_pool, ofcb->encoding_symbol_length);
 			if ((ofcb->tab_const_term_of_equ[row] = const_term) == NULL)
 			{
 				goto no_mem;
@@ -138,7 +200,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 		if (const_term != NULL)
 		{
 			mod_entry_to_delete = e;
-			of_mod2entry	*tmp_e;		// current symbol in this equation
+			of_it_entry_t	tmp_e;		// current symbol in this equation
 			UINT32		tmp_esi;	// corresponding esi
 			void		*tmp_symbol;	// corresponding symbol pointer
 
@@ -157,8 +219,8 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 			// symbol of this equation, and its value is necessarilly
 			// equal to the constant term. Their sum must be 0 (we don't check it).
 			// Remove the symbol from the equation since this entry is now useless.
-			e = of_mod2sparse_next_in_col (e);
-			of_mod2sparse_delete (ofcb->pchk_matrix, mod_entry_to_delete);
+			e = OF_IT_NEXT_IN_COL (ofcb, col, e);
+			OF_IT_DELETE_IN_COL (ofcb, mod_entry_to_delete);
 			ofcb->tab_nb_enc_symbols_per_equ[row]--;
 			if (of_is_repair_symbol ((of_cb_t*)ofcb, new_symbol_esi))
 			{
@@ -167,9 +229,9 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 			// Inject all permanently stored symbols
 			// (source and repair) into this partial sum.
 			// Requires to scan the equation (i.e. row).
-			for (tmp_e = of_mod2sparse_first_in_row (ofcb->pchk_matrix, row); !of_mod2sparse_at_end_row (tmp_e); )
+			for (tmp_e = OF_IT_FIRST_IN_ROW (ofcb, row); !OF_IT_AT_END_ROW (tmp_e); )
 			{
-				tmp_esi = of_get_symbol_esi ((of_cb_t*)ofcb, tmp_e->col);
+				tmp_esi = of_get_symbol_esi ((of_cb_t*)ofcb, OF_IT_COL_OF (ofcb, tmp_e));
 				tmp_symbol = ofcb->encoding_symbols_tab[tmp_esi];
 				if (tmp_symbol != NULL)
 				{
@@ -181,8 +243,8 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 							);
 					// delete the entry
 					mod_entry_to_delete = tmp_e;
-					tmp_e =  of_mod2sparse_next_in_row (tmp_e);
-					of_mod2sparse_delete (ofcb->pchk_matrix, mod_entry_to_delete);
+					tmp_e = OF_IT_NEXT_IN_ROW (ofcb, row, tmp_e);
+					OF_IT_DELETE_IN_ROW (ofcb, mod_entry_to_delete);
 					ofcb->tab_nb_enc_symbols_per_equ[row]--;
 					if (of_is_repair_symbol ((of_cb_t*)ofcb, tmp_esi))
 					{
@@ -192,8 +254,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 						// if ML decoding is needed, then keep the repair symbol
 						if (ofcb->tab_nb_equ_for_repair[tmp_esi - ofcb->nb_source_symbols] == 0)
 						{
-							of_free (tmp_symbol);
-							ofcb->encoding_symbols_tab[tmp_esi] = NULL;
+							of_linear_binary_code_free_repair_symbol (ofcb, tmp_esi);
 						}
 #endif
 					}
@@ -201,7 +262,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 				else
 				{
 					// this symbol is not yet known, switch to next one in equation
-					tmp_e =  of_mod2sparse_next_in_row (tmp_e);
+					tmp_e = OF_IT_NEXT_IN_ROW (ofcb, row, tmp_e);
 				}
 			}
 		}
@@ -209,7 +270,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 		{
 			// here m_checkValues[row] is NULL, ie. the partial
 			// sum has not been allocated
-			e = of_mod2sparse_next_in_col (e);
+			e = OF_IT_NEXT_IN_COL (ofcb, col, e);
 		}
 		if (ofcb->tab_nb_enc_symbols_per_equ[row] == 1)
 		{
@@ -256,9 +317,9 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 			// NB: because of the recursion below, we need to
 			// check that all equations mentioned in the
 			// table_of_check_deg_1 list are __still__ of degree 1.
-			e = of_mod2sparse_first_in_row (ofcb->pchk_matrix, row);
-			ASSERT (!of_mod2sparse_at_end_row (e) && of_mod2sparse_at_end_row (e->right))
-			decoded_symbol_esi = of_get_symbol_esi ((of_cb_t*)ofcb, e->col);
+			e = OF_IT_FIRST_IN_ROW (ofcb, row);
+			ASSERT (!OF_IT_AT_END_ROW (e) && OF_IT_AT_END_ROW (OF_IT_NEXT_IN_ROW (ofcb, row, e)))
+			decoded_symbol_esi = of_get_symbol_esi ((of_cb_t*)ofcb, OF_IT_COL_OF (ofcb, e));
 			// remove the entry from the matrix
 			const_term = ofcb->tab_const_term_of_equ[row];	// remember it
 			ofcb->tab_const_term_of_equ[row] = NULL;
@@ -267,7 +328,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 			{
 				ofcb->tab_nb_equ_for_repair[decoded_symbol_esi - ofcb->nb_source_symbols]--;
 			}
-			of_mod2sparse_delete (ofcb->pchk_matrix, e);
+			OF_IT_DELETE_IN_ROW (ofcb, e);
 			OF_TRACE_LVL (1, ("%s: REBUILT %s symbol %d\n", __FUNCTION__,
 					  (of_is_repair_symbol ((of_cb_t*)ofcb, decoded_symbol_esi)) ? "Parity" : "Source",
 					  decoded_symbol_esi));
@@ -292,7 +353,7 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 						// if the application has allocated a buffer, copy the symbol into it.
 						memcpy (decoded_symbol_dst, const_term, ofcb->encoding_symbol_length);
 						// we don't need the const_term buffer any more, so free it.
-						of_free (const_term);
+						of_symbol_pool_free (ofcb->symbol_pool, const_term);
 					}
 					else
 					{
@@ -305,6 +366,16 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 					// else reuse the const_term buffer in order to save extra malloc/memcpy.
 					decoded_symbol_dst = const_term;
 				}
+				if (decoded_symbol_dst == const_term && of_symbol_pool_owns (ofcb->symbol_pool, const_term))
+				{
+					// the application will own this buffer, so it cannot come from the pool.
+					if ((decoded_symbol_dst = of_malloc (ofcb->encoding_symbol_length)) == NULL)
+					{
+						goto no_mem;
+					}
+					memcpy (decoded_symbol_dst, const_term, ofcb->encoding_symbol_length);
+					of_symbol_pool_free (ofcb->symbol_pool, const_term);
+				}
 				// And finally call this function recursively
 				of_linear_binary_code_decode_with_new_symbol (ofcb, decoded_symbol_dst, decoded_symbol_esi);
 			}
@@ -323,8 +394,18 @@ of_status_t of_linear_binary_code_decode_with_new_symbol (of_linear_binary_code_
 				}
 				// Call this function recursively first...
 				of_linear_binary_code_decode_with_new_symbol (ofcb, const_term, decoded_symbol_esi);
-				// ...then free the partial sum which is no longer needed.
-				of_free (const_term);
+				if (ofcb->tab_repair_is_app_buffer != NULL &&
+				    ofcb->encoding_symbols_tab[decoded_symbol_esi] == const_term)
+				{
+					// ...in zero-copy mode the partial sum has been stored as is, and it
+					// remains ours.
+					ofcb->tab_repair_is_app_buffer[decoded_symbol_esi - ofcb->nb_source_symbols] = 0;
+				}
+				else
+				{
+					// ...then free the partial sum which is no longer needed.
+					of_symbol_pool_free (ofcb->symbol_pool, const_term);
+				}
 			}
 		}
 	}
@@ -343,6 +424,24 @@ no_mem:
 	return OF_STATUS_FATAL_ERROR;
 }
 
+
+void of_linear_binary_code_free_repair_symbol (of_linear_binary_code_cb_t*	ofcb,
+					       UINT32				esi)
+{
+	ASSERT(of_is_repair_symbol ((of_cb_t*)ofcb, esi));
+	if (ofcb->tab_repair_is_app_buffer != NULL &&
+	    ofcb->tab_repair_is_app_buffer[esi - ofcb->nb_source_symbols])
+	{
+		// zero-copy mode, this buffer belongs to the application
+		ofcb->tab_repair_is_app_buffer[esi - ofcb->nb_source_symbols] = 0;
+	}
+	else
+	{
+		of_symbol_pool_free (ofcb->symbol_pool, ofcb->encoding_symbols_tab[esi]);
+	}
+	ofcb->encoding_symbols_tab[esi] = NULL;
+}
+
 #endif //OF_USE_LINEAR_BINARY_CODES_UTILS
 
 #endif //OF_USE_DECODER
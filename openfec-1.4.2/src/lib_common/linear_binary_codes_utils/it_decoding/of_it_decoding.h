@@ -51,6 +51,15 @@
  */
 of_status_t of_linear_binary_code_decode_with_new_symbol(of_linear_binary_code_cb_t* ofcb,void* new_symbol,UINT32 new_symbol_esi);
 
+/**
+ * @fn	  void	of_linear_binary_code_free_repair_symbol (of_linear_binary_code_cb_t* ofcb, UINT32 esi)
+ * @brief release the buffer of a repair symbol stored in encoding_symbols_tab, unless it belongs
+ *	  to the application (zero-copy mode), and reset the entry.
+ * @param ofcb			(IN) Pointer to the linear binary code control block.
+ * @param esi			(IN) Encoding symbol ID of the repair symbol, in {k..n-1}.
+ */
+void of_linear_binary_code_free_repair_symbol (of_linear_binary_code_cb_t* ofcb, UINT32 esi);
+
 #endif //OF_USE_LINEAR_BINARY_CODES_UTILS
 
 #endif //OF_USE_DECODER
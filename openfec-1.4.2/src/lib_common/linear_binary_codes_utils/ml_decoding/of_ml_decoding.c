@@ -91,10 +91,11 @@ of_linear_binary_code_finish_decoding_with_ml (of_linear_binary_code_cb_t	*ofcb)
 	INT32		i;
 	UINT32		*permutation_array		= NULL;
 	of_mod2dense	*dense_pchk_matrix_simplified	= NULL;
-	INT32		*column_idx			= NULL;
 	void		**const_term			= NULL;
 	void		**variable_member		= NULL;
 	UINT32		nb_computed_repair_in_ml;
+	INT32		nb_rows				= 0;	/* size of the simplified system */
+	INT32		nb_cols;
 #ifdef DEBUG
 	struct timeval	gdtv0;		/* start */
 	struct timeval	gdtv1;		/* end */
@@ -103,6 +104,27 @@ of_linear_binary_code_finish_decoding_with_ml (of_linear_binary_code_cb_t	*ofcb)
 
 	OF_ENTER_FUNCTION
 	OF_TRACE_LVL (1, ("ML decoding on parity check matrix\n"))
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	/*
+	 * IT decoding has only updated the index-based copy of the parity check matrix,
+	 * so bring the linked-list version, used by the ML decoder, up to date.
+	 */
+	if (ofcb->pchk_matrix_idx != NULL)
+	{
+		of_mod2sparse	*m;
+
+		if ((m = of_mod2sparse_idx_to_sparse (ofcb->pchk_matrix_idx)) == NULL)
+		{
+			OF_EXIT_FUNCTION
+			return OF_STATUS_FATAL_ERROR;
+		}
+		of_mod2sparse_free (ofcb->pchk_matrix);
+		of_free (ofcb->pchk_matrix);
+		ofcb->pchk_matrix = m;
+		of_mod2sparse_idx_free (ofcb->pchk_matrix_idx);
+		ofcb->pchk_matrix_idx = NULL;
+	}
+#endif
 	/*
 	 *  Step 0: Matrix simplification, where we remove known symbols from the system, adding their value
 	 * to corresponding constant terms.
@@ -186,45 +208,74 @@ of_linear_binary_code_finish_decoding_with_ml (of_linear_binary_code_cb_t	*ofcb)
 #ifdef IL_SUPPORT
 	of_mod2sparse_print_bitmap(ofcb->pchk_matrix_simplified);
 #endif
-	/*
-	 * It's now time to create the simplified matrix, in dense format.
-	 */
-	dense_pchk_matrix_simplified = of_mod2dense_allocate (ofcb->pchk_matrix_simplified->n_rows, ofcb->pchk_matrix_simplified->n_cols);
-	of_mod2sparse_to_dense (ofcb->pchk_matrix_simplified, dense_pchk_matrix_simplified);
-	/* and immediately free the now useless sparse version to save memory... */
-	of_mod2sparse_free (ofcb->pchk_matrix_simplified);
-	of_free (ofcb->pchk_matrix_simplified);
-	ofcb->pchk_matrix_simplified = NULL;
+	nb_rows = of_mod2sparse_rows (ofcb->pchk_matrix_simplified);
+	nb_cols = of_mod2sparse_cols (ofcb->pchk_matrix_simplified);
+	if (!ofcb->ml_inactivation)
+	{
+		/*
+		 * It's now time to create the simplified matrix, in dense format.
+		 */
+		dense_pchk_matrix_simplified = of_mod2dense_allocate (nb_rows, nb_cols);
+		of_mod2sparse_to_dense (ofcb->pchk_matrix_simplified, dense_pchk_matrix_simplified);
+		ofcb->ml_nb_dense_cols = of_mod2dense_cols (dense_pchk_matrix_simplified);
+		/* and immediately free the now useless sparse version to save memory... */
+		of_mod2sparse_free (ofcb->pchk_matrix_simplified);
+		of_free (ofcb->pchk_matrix_simplified);
+		ofcb->pchk_matrix_simplified = NULL;
+	}
 
 #ifdef DEBUG
 	gettimeofday (&gdtv0, NULL);
 	OF_TRACE_LVL (1, ("gauss_decoding_start=%ld.%ld\n", gdtv0.tv_sec, gdtv0.tv_usec))
 #endif
-	if ((column_idx = (INT32 *) of_malloc (of_mod2dense_cols (dense_pchk_matrix_simplified) * sizeof (INT32))) == NULL)
-	{
-		goto no_mem;
-	}
-	for (i = 0; i < of_mod2dense_cols (dense_pchk_matrix_simplified); i++)
-	{
-		column_idx[i] = i;
-	}
-	if ((const_term = (void **) of_malloc (of_mod2dense_rows (dense_pchk_matrix_simplified) * sizeof (void*))) == NULL)
+	if ((const_term = (void **) of_malloc (nb_rows * sizeof (void*))) == NULL)
 	{
 		goto no_mem;
 	}
-	for (i = 0; i < of_mod2dense_rows (dense_pchk_matrix_simplified); i++)
+	for (i = 0; i < nb_rows; i++)
 	{
 		const_term[i] = ofcb->tab_const_term_of_equ[ofcb->index_rows[i]];
 		ofcb->tab_const_term_of_equ[ofcb->index_rows[i]] = NULL;
+		if (of_symbol_pool_owns (ofcb->symbol_pool, const_term[i]))
+		{
+			// constant terms may end up as decoded source symbols owned by the
+			// application, so they cannot come from the pool.
+			void	*tmp = const_term[i];
+
+			if ((const_term[i] = of_malloc (ofcb->encoding_symbol_length)) == NULL)
+			{
+				const_term[i] = tmp;
+				goto no_mem;
+			}
+			memcpy (const_term[i], tmp, ofcb->encoding_symbol_length);
+			of_symbol_pool_free (ofcb->symbol_pool, tmp);
+		}
 	}
-	if ((variable_member = (void **) of_calloc (of_mod2dense_cols (dense_pchk_matrix_simplified), sizeof (void*))) == NULL)
+	if ((variable_member = (void **) of_calloc (nb_cols, sizeof (void*))) == NULL)
 	{
 		goto no_mem;
 	}
+	nb_computed_repair_in_ml = ofcb->nb_repair_symbols - ofcb->nb_repair_symbol_ready; /* this is the number of repair found in ML */
+	if (ofcb->ml_inactivation)
+	{
+		/*
+		 * Peel the sparse system and only solve the inactive columns as a dense system.
+		 */
+		if (of_linear_binary_code_solve_sparse_system_with_inactivation (ofcb, ofcb->pchk_matrix_simplified, const_term,
+										  variable_member, nb_computed_repair_in_ml) != OF_STATUS_OK)
+		{
+			OF_TRACE_LVL(0,("Solve sparse system with inactivation failed\n"))
+			goto failure;
+		}
+		of_mod2sparse_free (ofcb->pchk_matrix_simplified);
+		of_free (ofcb->pchk_matrix_simplified);
+		ofcb->pchk_matrix_simplified = NULL;
+	}
 	/*
-	 * And finally launch Gaussian Elimination.
+	 * Or launch Gaussian Elimination on the whole system.
 	 */
-	if (of_linear_binary_code_solve_dense_system (ofcb, dense_pchk_matrix_simplified, const_term, variable_member) != OF_STATUS_OK)
+	else if (of_linear_binary_code_solve_dense_system (ofcb, dense_pchk_matrix_simplified, const_term, variable_member,
+							   nb_computed_repair_in_ml) != OF_STATUS_OK)
 	{
 		OF_TRACE_LVL(0,("Solve dense system failed\n"))
 		goto failure;
@@ -233,7 +284,6 @@ of_linear_binary_code_finish_decoding_with_ml (of_linear_binary_code_cb_t	*ofcb)
 	 * the system has been solved, so store the result in the canvas
 	 */
 	OF_TRACE_LVL (1, ("Solve dense system successful\n"))
-	nb_computed_repair_in_ml = ofcb->nb_repair_symbols - ofcb->nb_repair_symbol_ready; /* this is the number of repair found in ML */
 	/* ignore the first nb_computed_repair_in_ml symbols found in ML as they are repair symbols and we don't need them */
 	for (i = 0; i < nb_computed_repair_in_ml; i++)
 	{
@@ -260,7 +310,7 @@ of_linear_binary_code_finish_decoding_with_ml (of_linear_binary_code_cb_t	*ofcb)
 			gdtv1.tv_sec, gdtv1.tv_usec, gdtv_delta.tv_sec, gdtv_delta.tv_usec))
 #endif
 
-	for (i = 0; i < of_mod2dense_rows (dense_pchk_matrix_simplified); i++)
+	for (i = 0; i < nb_rows; i++)
 	{
 		if (const_term[i])
 		{
@@ -271,10 +321,11 @@ of_linear_binary_code_finish_decoding_with_ml (of_linear_binary_code_cb_t	*ofcb)
 	const_term = NULL;
 	of_free(variable_member);
 	variable_member = NULL;
-	of_free(column_idx);
-	column_idx = NULL;
-	of_mod2dense_free(dense_pchk_matrix_simplified);
-	dense_pchk_matrix_simplified = NULL;
+	if (dense_pchk_matrix_simplified != NULL)
+	{
+		of_mod2dense_free(dense_pchk_matrix_simplified);
+		dense_pchk_matrix_simplified = NULL;
+	}
 	OF_EXIT_FUNCTION
 	return OF_STATUS_OK;
 
@@ -286,11 +337,11 @@ failure:
 	}
 	if (const_term != NULL)
 	{
-		for (i = 0; i < of_mod2dense_rows (dense_pchk_matrix_simplified); i++)
+		for (i = 0; i < nb_rows; i++)
 		{
 			if (const_term[i])
 			{
-				of_free(const_term[i]);
+				of_symbol_pool_free(ofcb->symbol_pool, const_term[i]);
 			}
 		}
 		of_free(const_term);
@@ -301,16 +352,17 @@ failure:
 		of_free(variable_member);
 		variable_member = NULL;
 	}
-	if (column_idx != NULL)
-	{
-		of_free(column_idx);
-		column_idx = NULL;
-	}
 	if (dense_pchk_matrix_simplified != NULL)
 	{
 		of_mod2dense_free(dense_pchk_matrix_simplified);
 		dense_pchk_matrix_simplified = NULL;
 	}
+	if (ofcb->pchk_matrix_simplified != NULL)
+	{
+		of_mod2sparse_free (ofcb->pchk_matrix_simplified);
+		of_free (ofcb->pchk_matrix_simplified);
+		ofcb->pchk_matrix_simplified = NULL;
+	}
 	OF_EXIT_FUNCTION
 	return OF_STATUS_FAILURE;
 
@@ -397,7 +449,7 @@ of_linear_binary_code_simplify_linear_system_with_a_symbol (of_linear_binary_cod
 		// If the constant term buffer does not exist, create it
 		if (ofcb->tab_const_term_of_equ[_row] == NULL)
 		{
-			if ((ofcb->tab_const_term_of_equ[_row] = of_malloc (ofcb->encoding_symbol_length)) == NULL)
+			if ((ofcb->tab_const_term_of_equ[_row] = of_symbol_pool_malloc (ofcb->symbol_pool, ofcb->encoding_symbol_length)) == NULL)
 			{
 				goto no_mem;
 			}
@@ -451,7 +503,7 @@ of_linear_binary_code_simplify_linear_system_with_a_symbol (of_linear_binary_cod
 					memcpy((ofcb->encoding_symbols_tab[decoded_symbol_seqno]),
 						 (ofcb->tab_const_term_of_equ[_row]),
 						 ofcb->encoding_symbol_length);
-					of_free (ofcb->tab_const_term_of_equ[_row]);
+					of_symbol_pool_free (ofcb->symbol_pool, ofcb->tab_const_term_of_equ[_row]);
 					ofcb->tab_const_term_of_equ[_row] = NULL;
 					// It'll be known at the end of this step
 					ofcb->tab_nb_unknown_symbols[_row]--;	// symbol is known
@@ -475,7 +527,7 @@ of_linear_binary_code_simplify_linear_system_with_a_symbol (of_linear_binary_cod
 					}
 					else
 					{
-						ofcb->encoding_symbols_tab[decoded_symbol_seqno] = of_malloc (ofcb->encoding_symbol_length);
+						ofcb->encoding_symbols_tab[decoded_symbol_seqno] = of_symbol_pool_malloc (ofcb->symbol_pool, ofcb->encoding_symbol_length);
 					}
 					if (ofcb->encoding_symbols_tab[decoded_symbol_seqno] == NULL)
 					{
@@ -485,7 +537,7 @@ of_linear_binary_code_simplify_linear_system_with_a_symbol (of_linear_binary_cod
 					memcpy(ofcb->encoding_symbols_tab[decoded_symbol_seqno],
 						ofcb->tab_const_term_of_equ[_row],
 						ofcb->encoding_symbol_length);
-					of_free (ofcb->tab_const_term_of_equ[_row]);
+					of_symbol_pool_free (ofcb->symbol_pool, ofcb->tab_const_term_of_equ[_row]);
 					ofcb->tab_const_term_of_equ[_row] = NULL;
 					// It'll be known at the end of this step
 					ofcb->tab_nb_unknown_symbols[_row]--;	// symbol is known
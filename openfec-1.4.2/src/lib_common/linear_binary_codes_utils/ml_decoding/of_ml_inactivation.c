@@ -0,0 +1,485 @@
+/* $Id: of_ml_inactivation.c $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+
+#include "../of_linear_binary_code.h"
+
+#ifdef OF_USE_DECODER
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef ML_DECODING
+
+
+#define OF_ML_COL_ACTIVE	0	/* the variable is not determined yet */
+#define OF_ML_COL_PIVOT		1	/* the variable is determined by a pivot row */
+#define OF_ML_COL_INACTIVE	2	/* the variable is solved by the dense system */
+
+
+/**
+ * Peeling state of the sparse system.
+ */
+typedef struct
+{
+	of_mod2sparse	*m;
+	UINT32		*row_deg;	/* number of active columns of each row */
+	INT32		*row_pivot;	/* pivot index of each row, -1 if not a pivot */
+	UINT8		*col_state;	/* OF_ML_COL_* */
+	UINT32		*col_idx;	/* pivot index or inactive index of each column */
+	UINT32		*pivot_row;	/* pivot rows, in peeling order */
+	UINT32		*pivot_col;	/* column determined by each pivot row */
+	UINT32		nb_pivots;
+	UINT32		nb_inactive;
+	UINT32		*stack;		/* rows that may have a single active column */
+	UINT32		nb_stacked;
+} of_ml_peeling_t;
+
+
+/******  Static Functions  ****************************************************/
+
+
+/**
+ * Column c is not active anymore: update the degree of the rows that are not pivot.
+ */
+static void
+of_ml_peeling_remove_col (of_ml_peeling_t	*pl,
+			  UINT32		c)
+{
+	of_mod2entry	*e;
+	UINT32		r;
+
+	for (e = of_mod2sparse_first_in_col (pl->m, c); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_col (e))
+	{
+		r = of_mod2sparse_row (e);
+		if (pl->row_pivot[r] < 0 && --pl->row_deg[r] == 1)
+		{
+			pl->stack[pl->nb_stacked++] = r;
+		}
+	}
+}
+
+
+/**
+ * Row r has a single active column: it becomes the pivot that determines this column.
+ */
+static void
+of_ml_peeling_pivot (of_ml_peeling_t	*pl,
+		     UINT32		r)
+{
+	of_mod2entry	*e;
+	UINT32		c;
+
+	for (e = of_mod2sparse_first_in_row (pl->m, r); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+	{
+		if (pl->col_state[of_mod2sparse_col (e)] == OF_ML_COL_ACTIVE)
+			break;
+	}
+	ASSERT(!of_mod2sparse_at_end (e))
+	c = of_mod2sparse_col (e);
+	pl->row_pivot[r] = pl->nb_pivots;
+	pl->col_state[c] = OF_ML_COL_PIVOT;
+	pl->col_idx[c] = pl->nb_pivots;
+	pl->pivot_row[pl->nb_pivots] = r;
+	pl->pivot_col[pl->nb_pivots] = c;
+	pl->nb_pivots++;
+	of_ml_peeling_remove_col (pl, c);
+}
+
+
+static void
+of_ml_peeling_inactivate (of_ml_peeling_t	*pl,
+			  UINT32		c)
+{
+	pl->col_state[c] = OF_ML_COL_INACTIVE;
+	pl->col_idx[c] = pl->nb_inactive++;
+	of_ml_peeling_remove_col (pl, c);
+}
+
+
+/**
+ * Peel the system, inactivating columns when needed, until there is no active column left.
+ */
+static void
+of_ml_peeling_run (of_ml_peeling_t	*pl)
+{
+	of_mod2entry	*e;
+	UINT32		n, p;
+	UINT32		nb_done;	/* number of pivot or inactive columns */
+	INT32		best;		/* row of minimum degree */
+	UINT32		r, c;
+	bool		keep;
+
+	n = of_mod2sparse_cols (pl->m);
+	p = of_mod2sparse_rows (pl->m);
+	for (nb_done = 0; nb_done < n; )
+	{
+		while (pl->nb_stacked > 0)
+		{
+			r = pl->stack[--pl->nb_stacked];
+			if (pl->row_pivot[r] < 0 && pl->row_deg[r] == 1)
+			{
+				of_ml_peeling_pivot (pl, r);
+				nb_done++;
+			}
+		}
+		if (nb_done == n)
+			break;
+		/* peeling is stuck: find a row of minimum degree... */
+		best = -1;
+		for (r = 0; r < p; r++)
+		{
+			if (pl->row_pivot[r] < 0 && pl->row_deg[r] >= 2 &&
+			    (best < 0 || pl->row_deg[r] < pl->row_deg[best]))
+			{
+				best = r;
+				if (pl->row_deg[r] == 2)
+					break;
+			}
+		}
+		if (best < 0)
+		{
+			/* the remaining active columns are in no equation, the dense system will fail */
+			for (c = 0; c < n; c++)
+			{
+				if (pl->col_state[c] == OF_ML_COL_ACTIVE)
+				{
+					of_ml_peeling_inactivate (pl, c);
+					nb_done++;
+				}
+			}
+			break;
+		}
+		/* ... and inactivate all its active columns but one, so that it can be a pivot */
+		keep = true;
+		for (e = of_mod2sparse_first_in_row (pl->m, best); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			c = of_mod2sparse_col (e);
+			if (pl->col_state[c] != OF_ML_COL_ACTIVE)
+				continue;
+			if (keep)
+			{
+				keep = false;
+				continue;
+			}
+			of_ml_peeling_inactivate (pl, c);
+			nb_done++;
+		}
+	}
+}
+
+
+static void
+of_ml_peeling_free (of_ml_peeling_t	*pl)
+{
+	of_free (pl->row_deg);
+	of_free (pl->row_pivot);
+	of_free (pl->col_state);
+	of_free (pl->col_idx);
+	of_free (pl->pivot_row);
+	of_free (pl->pivot_col);
+	of_free (pl->stack);
+}
+
+
+/******************************************************************************/
+
+
+of_status_t
+of_linear_binary_code_solve_sparse_system_with_inactivation (of_linear_binary_code_cb_t	*ofcb,
+							     of_mod2sparse		*m,
+							     void			**constant_tab,
+							     void			**variable_tab,
+							     UINT32			nb_unneeded_variables)
+{
+	of_ml_peeling_t		pl;
+	of_ml_symbol_ops_t	*ops = NULL;
+	of_mod2entry		*e;
+	of_mod2dense		*core = NULL;	/* dense system over the inactive variables */
+	of_mod2word		*dep = NULL;	/* inactive variables of each pivot partial sum */
+	of_mod2word		*d;
+	UINT8			*needed = NULL;	/* the partial sum of a pivot is used by the dense system */
+	UINT32			*sum_slot = NULL; /* symbol of the partial sum of each pivot */
+	UINT32			*core_slot = NULL; /* constant term symbol of each row of the dense system */
+	UINT32			*var_slot = NULL; /* symbol of each variable */
+	UINT32			*src = NULL;
+	UINT32			nb_src;
+	UINT32			nb_core_rows;
+	UINT32			n, p, w;
+	UINT32			max_deg;
+	UINT32			r, c, t, i;
+	of_status_t		status = OF_STATUS_OK;
+
+	OF_ENTER_FUNCTION
+	n = of_mod2sparse_cols (m);
+	p = of_mod2sparse_rows (m);
+	ofcb->ml_nb_symbol_xor = 0;
+	ofcb->ml_nb_saved_symbol_xor = 0;
+	memset (&pl, 0, sizeof (pl));
+	pl.m = m;
+	if ((pl.row_deg = (UINT32*) of_calloc (p, sizeof (UINT32))) == NULL ||
+	    (pl.row_pivot = (INT32*) of_malloc (p * sizeof (INT32))) == NULL ||
+	    (pl.col_state = (UINT8*) of_calloc (n, sizeof (UINT8))) == NULL ||
+	    (pl.col_idx = (UINT32*) of_malloc (n * sizeof (UINT32))) == NULL ||
+	    (pl.pivot_row = (UINT32*) of_malloc (n * sizeof (UINT32))) == NULL ||
+	    (pl.pivot_col = (UINT32*) of_malloc (n * sizeof (UINT32))) == NULL ||
+	    (pl.stack = (UINT32*) of_malloc (p * sizeof (UINT32))) == NULL)
+	{
+		goto no_mem;
+	}
+	/*
+	 * Step 1: peel the system, inactivating columns when needed.
+	 */
+	max_deg = 0;
+	for (r = 0; r < p; r++)
+	{
+		pl.row_pivot[r] = -1;
+		for (e = of_mod2sparse_first_in_row (m, r); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			pl.row_deg[r]++;
+		}
+		if (pl.row_deg[r] == 1)
+		{
+			pl.stack[pl.nb_stacked++] = r;
+		}
+		if (pl.row_deg[r] > max_deg)
+		{
+			max_deg = pl.row_deg[r];
+		}
+	}
+	of_ml_peeling_run (&pl);
+	ofcb->ml_nb_dense_cols = pl.nb_inactive;
+	nb_core_rows = 0;
+	for (r = 0; r < p; r++)
+	{
+		if (pl.row_pivot[r] < 0 && !of_mod2sparse_empty_row (m, r))
+			nb_core_rows++;
+	}
+	OF_TRACE_LVL(1,("%s: %u pivots, %u inactive columns, %u rows in the dense system\n", __FUNCTION__,
+			pl.nb_pivots, pl.nb_inactive, nb_core_rows))
+	if (nb_core_rows < pl.nb_inactive)
+	{
+		OF_TRACE_LVL(0,("%s: not enough equations (%u) for the %u inactive columns\n", __FUNCTION__,
+				nb_core_rows, pl.nb_inactive))
+		of_ml_peeling_free (&pl);
+		OF_EXIT_FUNCTION
+		return OF_STATUS_FAILURE;
+	}
+	if ((ops = of_ml_symbol_ops_create (ofcb->encoding_symbol_length, ofcb->symbol_pool,
+					    ofcb->ml_deferred_symbol_ops, ofcb->ml_nb_threads,
+					    constant_tab, p)) == NULL ||
+	    (needed = (UINT8*) of_calloc (pl.nb_pivots + 1, sizeof (UINT8))) == NULL ||
+	    (sum_slot = (UINT32*) of_malloc ((pl.nb_pivots + 1) * sizeof (UINT32))) == NULL ||
+	    (core_slot = (UINT32*) of_malloc ((nb_core_rows + 1) * sizeof (UINT32))) == NULL ||
+	    (var_slot = (UINT32*) of_malloc (n * sizeof (UINT32))) == NULL ||
+	    (src = (UINT32*) of_malloc ((max_deg + 1) * sizeof (UINT32))) == NULL)
+	{
+		goto no_mem;
+	}
+	if (pl.nb_inactive > 0)
+	{
+		/*
+		 * Step 2: the partial sum of a pivot is its constant term plus the partial sums of
+		 * the other pivots of its row, and depends on the inactive variables of dep. Only
+		 * those used by the rows of the dense system are needed.
+		 */
+		for (t = pl.nb_pivots; t-- > 0; )
+		{
+			for (e = of_mod2sparse_first_in_col (m, pl.pivot_col[t]); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_col (e))
+			{
+				r = of_mod2sparse_row (e);
+				if (r != pl.pivot_row[t] && (pl.row_pivot[r] < 0 || needed[pl.row_pivot[r]]))
+				{
+					needed[t] = 1;
+					break;
+				}
+			}
+		}
+		w = (pl.nb_inactive + of_mod2_wordsize - 1) >> of_mod2_wordsize_shift;
+		if ((dep = (of_mod2word*) of_calloc ((size_t) (pl.nb_pivots + 1) * w, sizeof (of_mod2word))) == NULL ||
+		    (core = of_mod2dense_allocate (nb_core_rows, pl.nb_inactive)) == NULL)
+		{
+			goto no_mem;
+		}
+		for (t = 0; t < pl.nb_pivots; t++)
+		{
+			if (!needed[t])
+				continue;
+			d = dep + (size_t) t * w;
+			src[0] = pl.pivot_row[t];
+			nb_src = 1;
+			for (e = of_mod2sparse_first_in_row (m, pl.pivot_row[t]); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+			{
+				c = of_mod2sparse_col (e);
+				if (c == pl.pivot_col[t])
+					continue;
+				if (pl.col_state[c] == OF_ML_COL_PIVOT)
+				{
+					for (i = 0; i < w; i++)
+						d[i] ^= dep[(size_t) pl.col_idx[c] * w + i];
+					src[nb_src++] = sum_slot[pl.col_idx[c]];
+				}
+				else
+				{
+					d[pl.col_idx[c] >> of_mod2_wordsize_shift] ^= (of_mod2word) 1 << (pl.col_idx[c] & of_mod2_wordsize_mask);
+				}
+			}
+			if (of_ml_symbol_ops_new_temp (ops, &sum_slot[t]) != OF_STATUS_OK ||
+			    of_ml_symbol_ops_add_from_multiple (ops, sum_slot[t], src, nb_src) != OF_STATUS_OK)
+			{
+				goto no_mem;
+			}
+		}
+		/*
+		 * Step 3: the rows that are not pivot, once the pivot variables are replaced by
+		 * their partial sums, make the dense system over the inactive variables.
+		 */
+		for (r = 0, i = 0; r < p; r++)
+		{
+			if (pl.row_pivot[r] >= 0 || of_mod2sparse_empty_row (m, r))
+				continue;
+			d = core->row[i];
+			nb_src = 0;
+			for (e = of_mod2sparse_first_in_row (m, r); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+			{
+				c = of_mod2sparse_col (e);
+				if (pl.col_state[c] == OF_ML_COL_PIVOT)
+				{
+					of_mod2word	*s = dep + (size_t) pl.col_idx[c] * w;
+					UINT32		k;
+
+					for (k = 0; k < w; k++)
+						d[k] ^= s[k];
+					src[nb_src++] = sum_slot[pl.col_idx[c]];
+				}
+				else
+				{
+					d[pl.col_idx[c] >> of_mod2_wordsize_shift] ^= (of_mod2word) 1 << (pl.col_idx[c] & of_mod2_wordsize_mask);
+				}
+			}
+			if (nb_src != 0 && of_ml_symbol_ops_add_from_multiple (ops, r, src, nb_src) != OF_STATUS_OK)
+			{
+				goto no_mem;
+			}
+			core_slot[i++] = r;
+		}
+		for (t = 0; t < pl.nb_pivots; t++)
+		{
+			if (needed[t] && of_ml_symbol_ops_release_temp (ops, sum_slot[t]) != OF_STATUS_OK)
+			{
+				goto no_mem;
+			}
+		}
+		of_free (dep);
+		dep = NULL;
+		/*
+		 * Step 4: solve the dense system, the inactive variables are then known.
+		 */
+		if ((status = of_linear_binary_code_eliminate_dense_system (ofcb, core, ops, core_slot)) != OF_STATUS_OK)
+		{
+			goto end;
+		}
+	}
+	for (c = 0; c < n; c++)
+	{
+		var_slot[c] = (pl.col_state[c] == OF_ML_COL_PIVOT) ? pl.pivot_row[pl.col_idx[c]] : core_slot[pl.col_idx[c]];
+	}
+	/*
+	 * Step 5: back-substitution, in peeling order each pivot variable is the sum of the
+	 * constant term and of the other variables of its row, that are all known.
+	 */
+	for (t = 0; t < pl.nb_pivots; t++)
+	{
+		nb_src = 0;
+		for (e = of_mod2sparse_first_in_row (m, pl.pivot_row[t]); !of_mod2sparse_at_end (e); e = of_mod2sparse_next_in_row (e))
+		{
+			c = of_mod2sparse_col (e);
+			if (c != pl.pivot_col[t])
+				src[nb_src++] = var_slot[c];
+		}
+		if (nb_src != 0 && of_ml_symbol_ops_add_from_multiple (ops, pl.pivot_row[t], src, nb_src) != OF_STATUS_OK)
+		{
+			goto no_mem;
+		}
+	}
+	/* the needed variables are the outputs, all the other symbol operations can be dropped */
+	if (of_ml_symbol_ops_execute (ops, var_slot + nb_unneeded_variables, n - nb_unneeded_variables) != OF_STATUS_OK)
+	{
+		status = OF_STATUS_FATAL_ERROR;
+		goto end;
+	}
+	for (c = 0; c < n; c++)
+	{
+		variable_tab[c] = of_ml_symbol_ops_get_symbol (ops, var_slot[c]);
+		of_ml_symbol_ops_get_symbol (ops, var_slot[c]) = NULL;
+	}
+end:
+	/* give the (possibly allocated) buffers back, the caller frees them */
+	for (r = 0; r < p; r++)
+	{
+		constant_tab[r] = of_ml_symbol_ops_get_symbol (ops, r);
+	}
+	ofcb->ml_nb_symbol_xor = ops->nb_recorded_xor;
+	ofcb->ml_nb_saved_symbol_xor = ops->nb_recorded_xor - ops->nb_executed_xor;
+#ifdef OF_DEBUG
+	ofcb->stats_xor->nb_xor_for_ML += ops->nb_executed_xor;
+#endif
+	OF_TRACE_LVL(1,("%s: %u symbol XORs requested, %u saved\n", __FUNCTION__,
+			ofcb->ml_nb_symbol_xor, ofcb->ml_nb_saved_symbol_xor))
+	of_ml_symbol_ops_free (ops);
+	if (core)
+		of_mod2dense_free (core);
+	of_free (needed);
+	of_free (sum_slot);
+	of_free (core_slot);
+	of_free (var_slot);
+	of_free (src);
+	of_ml_peeling_free (&pl);
+	OF_EXIT_FUNCTION
+	return status;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory"))
+	if (ops == NULL)
+	{
+		of_ml_peeling_free (&pl);
+		OF_EXIT_FUNCTION
+		return OF_STATUS_FATAL_ERROR;
+	}
+	if (dep)
+		of_free (dep);
+	status = OF_STATUS_FATAL_ERROR;
+	goto end;
+}
+
+
+#endif //ML_DECODING
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
+#endif //OF_USE_DECODER
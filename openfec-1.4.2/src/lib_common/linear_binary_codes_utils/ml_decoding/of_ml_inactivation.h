@@ -0,0 +1,85 @@
+/* $Id: of_ml_inactivation.h $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+
+/*
+ * Inactivation decoding of the simplified linear system of the ML decoder.
+ *
+ * Instead of turning the whole simplified system into a dense matrix, the sparse
+ * system is peeled as far as possible: an equation with a single undetermined
+ * variable determines it. When no such equation is left, the undetermined variables
+ * of an equation of minimum degree but one are inactivated, i.e. treated as known,
+ * which lets peeling go on. Once all the variables are either determined by an
+ * equation (pivot) or inactive, only the equations that have not been used as pivot
+ * remain, and they form a small dense system over the inactive variables, solved by
+ * Gaussian elimination. The pivot variables are then back-substituted through the
+ * sparse equations.
+ */
+
+#ifndef OF_ML_INACTIVATION_H
+#define OF_ML_INACTIVATION_H
+
+
+#ifdef OF_USE_DECODER
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef ML_DECODING
+
+
+/**
+ * This function solves the sparse system m with inactivation decoding. The symbol
+ * operations are recorded in a single symbol operation list, the dense system over the
+ * inactive variables being solved with of_linear_binary_code_eliminate_dense_system(),
+ * so that in deferred mode only those that contribute to the needed variables are
+ * executed. The number of inactive variables is stored in ofcb->ml_nb_dense_cols.
+ *
+ * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
+ * @param m 			(IN) address of the sparse matrix.
+ * @param constant_tab		(IN/OUT) constant term of each row.
+ * @param variable_tab		(OUT) symbol of each variable (i.e. column).
+ * @param nb_unneeded_variables	(IN) the first nb_unneeded_variables variables are not needed,
+ *				their buffers (if not NULL) may not be up to date.
+ * @return			error status
+ */
+of_status_t
+of_linear_binary_code_solve_sparse_system_with_inactivation (of_linear_binary_code_cb_t	*ofcb,
+							     of_mod2sparse		*m,
+							     void			**constant_tab,
+							     void			**variable_tab,
+							     UINT32			nb_unneeded_variables);
+
+
+#endif //ML_DECODING
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
+#endif //OF_USE_DECODER
+
+#endif //OF_ML_INACTIVATION_H
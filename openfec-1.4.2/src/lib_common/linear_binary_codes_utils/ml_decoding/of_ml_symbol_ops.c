@@ -0,0 +1,820 @@
+/* $Id: of_ml_symbol_ops.c $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+#include "../of_linear_binary_code.h"
+
+#ifdef OF_USE_PTHREADS
+#include <pthread.h>
+#endif
+
+#ifdef OF_USE_DECODER
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef ML_DECODING
+
+
+/**
+ * Minimum number of bytes of each symbol processed by a thread.
+ */
+#define OF_ML_MIN_BYTES_PER_THREAD	4096
+
+/**
+ * Number of bytes of the symbols processed at once by the deferred program.
+ */
+#ifndef OF_ML_CHUNK_SIZE
+#define OF_ML_CHUNK_SIZE	4096
+#endif
+
+
+/******  Static Functions  ****************************************************/
+
+
+/**
+ * Make sure *tab can hold nb + 1 elements of size elem_size.
+ */
+static of_status_t
+of_ml_grow (void	**tab,
+	    UINT32	*max,
+	    UINT32	nb,
+	    size_t	elem_size)
+{
+	void	*new_tab;
+	UINT32	new_max;
+
+	if (nb < *max)
+	{
+		return OF_STATUS_OK;
+	}
+	new_max = (*max == 0) ? 16 : 2 * (*max);
+	if ((new_tab = of_realloc (*tab, new_max * elem_size)) == NULL)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	*tab = new_tab;
+	*max = new_max;
+	return OF_STATUS_OK;
+}
+
+
+static of_status_t
+of_ml_symbol_ops_new_slot (of_ml_symbol_ops_t	*ops,
+			   void			*buf,
+			   UINT8		flags,
+			   UINT32		*slot)
+{
+	if (of_ml_grow ((void**)&ops->slot, &ops->max_slots, ops->nb_slots, sizeof (of_ml_symbol_slot_t)) != OF_STATUS_OK)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	memset (&ops->slot[ops->nb_slots], 0, sizeof (of_ml_symbol_slot_t));
+	ops->slot[ops->nb_slots].buf = buf;
+	ops->slot[ops->nb_slots].flags = flags;
+	*slot = ops->nb_slots++;
+	return OF_STATUS_OK;
+}
+
+
+static int
+of_ml_compare_slots (const void	*a,
+		     const void	*b)
+{
+	UINT32	x = *(const UINT32*)a;
+	UINT32	y = *(const UINT32*)b;
+
+	return (x < y) ? -1 : (x > y);
+}
+
+
+/**
+ * Close the open group of XORs to slot d (if any), and append it to the program.
+ */
+static of_status_t
+of_ml_symbol_ops_close (of_ml_symbol_ops_t	*ops,
+			UINT32			d)
+{
+	of_ml_symbol_slot_t	*s = &ops->slot[d];
+	of_ml_symbol_group_t	*g;
+	UINT32			i;
+	UINT32			nb;
+
+	if (!(s->flags & OF_ML_SLOT_OPEN))
+	{
+		return OF_STATUS_OK;
+	}
+	/* a source that appears twice cancels out */
+	qsort (s->src, s->nb_src, sizeof (UINT32), of_ml_compare_slots);
+	for (i = 0, nb = 0; i < s->nb_src; i++)
+	{
+		if (i + 1 < s->nb_src && s->src[i] == s->src[i + 1])
+		{
+			i++;
+			continue;
+		}
+		s->src[nb++] = s->src[i];
+	}
+	if (nb > 0)
+	{
+		if (of_ml_grow ((void**)&ops->group, &ops->max_groups, ops->nb_groups, sizeof (of_ml_symbol_group_t)) != OF_STATUS_OK)
+		{
+			return OF_STATUS_FATAL_ERROR;
+		}
+		while (ops->nb_srcs + nb > ops->max_srcs)
+		{
+			if (of_ml_grow ((void**)&ops->src, &ops->max_srcs, ops->max_srcs, sizeof (UINT32)) != OF_STATUS_OK)
+			{
+				return OF_STATUS_FATAL_ERROR;
+			}
+		}
+		g = &ops->group[ops->nb_groups++];
+		g->dst = d;
+		g->first_src = ops->nb_srcs;
+		g->nb_src = nb;
+		g->is_copy = (s->flags & OF_ML_SLOT_COPY) ? 1 : 0;
+		memcpy (ops->src + ops->nb_srcs, s->src, nb * sizeof (UINT32));
+		ops->nb_srcs += nb;
+		s->flags &= ~OF_ML_SLOT_NULL;
+	}
+	s->nb_src = 0;
+	s->flags &= ~(OF_ML_SLOT_OPEN | OF_ML_SLOT_COPY);
+	return OF_STATUS_OK;
+}
+
+
+static of_status_t
+of_ml_symbol_ops_add_deferred (of_ml_symbol_ops_t	*ops,
+			       UINT32			dst,
+			       UINT32			src)
+{
+	of_ml_symbol_slot_t	*d = &ops->slot[dst];
+	of_ml_symbol_slot_t	*s = &ops->slot[src];
+	UINT32			i;
+
+	/* src is read, so its pending XORs must be done first */
+	if (of_ml_symbol_ops_close (ops, src) != OF_STATUS_OK)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	if (s->flags & OF_ML_SLOT_NULL)
+	{
+		return OF_STATUS_OK;
+	}
+	/* dst is modified, so the pending XORs that read it must be done first */
+	for (i = 0; i < d->nb_readers; i++)
+	{
+		if (d->readers[i] != dst && of_ml_symbol_ops_close (ops, d->readers[i]) != OF_STATUS_OK)
+		{
+			return OF_STATUS_FATAL_ERROR;
+		}
+	}
+	d->nb_readers = 0;
+	if (!(d->flags & OF_ML_SLOT_OPEN))
+	{
+		d->flags |= OF_ML_SLOT_OPEN | ((d->flags & OF_ML_SLOT_NULL) ? OF_ML_SLOT_COPY : 0);
+	}
+	if ((d->nb_src > 0 || !(d->flags & OF_ML_SLOT_COPY)))
+	{
+		/* a copy to a null symbol is not an XOR */
+		ops->nb_recorded_xor++;
+	}
+	if (of_ml_grow ((void**)&d->src, &d->max_src, d->nb_src, sizeof (UINT32)) != OF_STATUS_OK ||
+	    of_ml_grow ((void**)&s->readers, &s->max_readers, s->nb_readers, sizeof (UINT32)) != OF_STATUS_OK)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	d->src[d->nb_src++] = src;
+	if (s->nb_readers == 0 || s->readers[s->nb_readers - 1] != dst)
+	{
+		s->readers[s->nb_readers++] = dst;
+	}
+	return OF_STATUS_OK;
+}
+
+
+/**
+ * Allocate the buffer of a null symbol that is about to be written.
+ */
+static of_status_t
+of_ml_symbol_ops_alloc (of_ml_symbol_ops_t	*ops,
+			UINT32			slot)
+{
+	of_ml_symbol_slot_t	*s = &ops->slot[slot];
+
+	if (s->flags & OF_ML_SLOT_TEMP)
+	{
+		s->buf = of_symbol_pool_malloc (ops->pool, ops->symbol_size);
+	}
+	else
+	{
+		/* may become a decoded symbol, owned by the application */
+		s->buf = of_malloc (ops->symbol_size);
+	}
+	return (s->buf != NULL) ? OF_STATUS_OK : OF_STATUS_FATAL_ERROR;
+}
+
+
+/**
+ * Per thread context, to execute the program on a byte range of the symbols.
+ */
+typedef struct
+{
+	of_ml_symbol_ops_t	*ops;
+	UINT32			offset;
+	UINT32			size;
+	const void		**from;		/* room for the sources of the largest group */
+#ifdef OF_USE_PTHREADS
+	pthread_t		thread;
+	bool			started;
+#endif
+} of_ml_symbol_ops_worker_t;
+
+
+/**
+ * Execute the whole program on bytes offset to offset + size - 1 of the symbols.
+ */
+static void
+of_ml_symbol_ops_run_range (of_ml_symbol_ops_t	*ops,
+			    const void		**from,
+			    UINT32		offset,
+			    UINT32		size)
+{
+	of_ml_symbol_group_t	*g;
+	void			**src;
+	UINT8			*to;
+	UINT32			i, j;
+
+	for (i = 0; i < ops->nb_groups; i++)
+	{
+		g = &ops->group[i];
+		if (g->nb_src == 0)
+		{
+			/* dropped, its result is never read */
+			continue;
+		}
+		to = (UINT8*) g->dst_buf + offset;
+		src = ops->src_buf + g->first_src;
+		j = 0;
+		if (g->is_copy)
+		{
+			memcpy (to, (UINT8*) src[0] + offset, size);
+			j = 1;
+		}
+		if (j == g->nb_src)
+		{
+			continue;
+		}
+		if (j + 1 == g->nb_src)
+		{
+			of_add_to_symbol (to, (UINT8*) src[j] + offset, size
+#ifdef OF_DEBUG
+					  , NULL
+#endif
+					 );
+			continue;
+		}
+		for (; j < g->nb_src; j++)
+		{
+			from[j] = (UINT8*) src[j] + offset;
+		}
+		j = g->is_copy;
+		of_add_from_multiple_symbols (to, from + j, g->nb_src - j, size
+#ifdef OF_DEBUG
+					      , NULL
+#endif
+					     );
+	}
+}
+
+
+static void*
+of_ml_symbol_ops_run (void	*arg)
+{
+	of_ml_symbol_ops_worker_t	*w = (of_ml_symbol_ops_worker_t*) arg;
+	UINT32				offset;
+	UINT32				size;
+
+	/* process the byte range by chunks, so that all the symbols of a chunk stay in cache */
+	for (offset = w->offset; offset < w->offset + w->size; offset += size)
+	{
+		size = w->offset + w->size - offset;
+		if (size > OF_ML_CHUNK_SIZE)
+		{
+			size = OF_ML_CHUNK_SIZE;
+		}
+		of_ml_symbol_ops_run_range (w->ops, w->from, offset, size);
+	}
+	return NULL;
+}
+
+
+/******************************************************************************/
+
+
+of_ml_symbol_ops_t*
+of_ml_symbol_ops_create (UINT32			symbol_size,
+			 of_symbol_pool_t	*pool,
+			 bool			deferred,
+			 UINT32			nb_threads,
+			 void			**symbols,
+			 UINT32			nb_symbols)
+{
+	of_ml_symbol_ops_t	*ops;
+	UINT32			i;
+
+	OF_ENTER_FUNCTION
+	if ((ops = (of_ml_symbol_ops_t*) of_calloc (1, sizeof (of_ml_symbol_ops_t))) == NULL)
+	{
+		goto no_mem;
+	}
+	ops->symbol_size = symbol_size;
+	ops->pool = pool;
+	ops->deferred = deferred;
+	ops->nb_threads = (nb_threads > 0) ? nb_threads : 1;
+	if ((ops->slot = (of_ml_symbol_slot_t*) of_calloc (nb_symbols, sizeof (of_ml_symbol_slot_t))) == NULL)
+	{
+		goto no_mem;
+	}
+	ops->max_slots = nb_symbols;
+	for (i = 0; i < nb_symbols; i++)
+	{
+		ops->slot[i].buf = symbols[i];
+		ops->slot[i].flags = (symbols[i] == NULL) ? OF_ML_SLOT_NULL : 0;
+	}
+	ops->nb_slots = nb_symbols;
+	OF_EXIT_FUNCTION
+	return ops;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory"))
+	of_ml_symbol_ops_free (ops);
+	OF_EXIT_FUNCTION
+	return NULL;
+}
+
+
+void
+of_ml_symbol_ops_free (of_ml_symbol_ops_t	*ops)
+{
+	UINT32	i;
+
+	OF_ENTER_FUNCTION
+	if (ops == NULL)
+	{
+		OF_EXIT_FUNCTION
+		return;
+	}
+	if (ops->slot != NULL)
+	{
+		for (i = 0; i < ops->nb_slots; i++)
+		{
+			if ((ops->slot[i].flags & OF_ML_SLOT_TEMP) && ops->slot[i].buf != NULL)
+			{
+				of_symbol_pool_free (ops->pool, ops->slot[i].buf);
+			}
+			of_free (ops->slot[i].src);
+			of_free (ops->slot[i].readers);
+		}
+		of_free (ops->slot);
+	}
+	of_free (ops->free_temp);
+	of_free (ops->group);
+	of_free (ops->src);
+	of_free (ops->src_buf);
+	of_free (ops);
+	OF_EXIT_FUNCTION
+}
+
+
+of_status_t
+of_ml_symbol_ops_new_temp (of_ml_symbol_ops_t	*ops,
+			   UINT32		*slot)
+{
+	if (ops->nb_free_temps > 0)
+	{
+		*slot = ops->free_temp[--ops->nb_free_temps];
+		return OF_STATUS_OK;
+	}
+	return of_ml_symbol_ops_new_slot (ops, NULL, OF_ML_SLOT_NULL | OF_ML_SLOT_TEMP, slot);
+}
+
+
+of_status_t
+of_ml_symbol_ops_release_temp (of_ml_symbol_ops_t	*ops,
+			       UINT32			slot)
+{
+	of_ml_symbol_slot_t	*s = &ops->slot[slot];
+
+	ASSERT(s->flags & OF_ML_SLOT_TEMP);
+	if (of_ml_grow ((void**)&ops->free_temp, &ops->max_free_temps, ops->nb_free_temps, sizeof (UINT32)) != OF_STATUS_OK)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	if (ops->deferred)
+	{
+		/*
+		 * the buffer is only allocated during execution. The pending XORs to this symbol
+		 * are useless, and its next value starts from a null symbol.
+		 */
+		if (of_ml_symbol_ops_close (ops, slot) != OF_STATUS_OK)
+		{
+			return OF_STATUS_FATAL_ERROR;
+		}
+	}
+	else if (s->buf != NULL)
+	{
+		of_symbol_pool_free (ops->pool, s->buf);
+		s->buf = NULL;
+	}
+	s->flags = OF_ML_SLOT_TEMP | OF_ML_SLOT_NULL;
+	ops->free_temp[ops->nb_free_temps++] = slot;
+	return OF_STATUS_OK;
+}
+
+
+of_status_t
+of_ml_symbol_ops_add (of_ml_symbol_ops_t	*ops,
+		      UINT32			dst,
+		      UINT32			src)
+{
+	of_ml_symbol_slot_t	*d = &ops->slot[dst];
+	of_ml_symbol_slot_t	*s = &ops->slot[src];
+
+	ASSERT(dst != src);
+	if (ops->deferred)
+	{
+		return of_ml_symbol_ops_add_deferred (ops, dst, src);
+	}
+	if (s->flags & OF_ML_SLOT_NULL)
+	{
+		return OF_STATUS_OK;
+	}
+	if (d->flags & OF_ML_SLOT_NULL)
+	{
+		/* copy data directly, there's no XOR to perform */
+		if (d->buf == NULL && of_ml_symbol_ops_alloc (ops, dst) != OF_STATUS_OK)
+		{
+			return OF_STATUS_FATAL_ERROR;
+		}
+		memcpy (d->buf, s->buf, ops->symbol_size);
+		d->flags &= ~OF_ML_SLOT_NULL;
+		return OF_STATUS_OK;
+	}
+	of_add_to_symbol (d->buf, s->buf, ops->symbol_size
+#ifdef OF_DEBUG
+			  , NULL
+#endif
+			 );
+	ops->nb_recorded_xor++;
+	ops->nb_executed_xor++;
+	return OF_STATUS_OK;
+}
+
+
+of_status_t
+of_ml_symbol_ops_add_to_multiple (of_ml_symbol_ops_t	*ops,
+				  UINT32		*dst,
+				  UINT32		nb_dst,
+				  UINT32		src)
+{
+	void	**to;
+	UINT32	nb_to;
+	UINT32	i;
+
+	if (ops->deferred || nb_dst == 1 || (ops->slot[src].flags & OF_ML_SLOT_NULL))
+	{
+		for (i = 0; i < nb_dst; i++)
+		{
+			if (of_ml_symbol_ops_add (ops, dst[i], src) != OF_STATUS_OK)
+			{
+				return OF_STATUS_FATAL_ERROR;
+			}
+		}
+		return OF_STATUS_OK;
+	}
+	/* immediate mode: copy to the null symbols, and add to all the others at once */
+	if ((to = (void**) of_malloc (nb_dst * sizeof (void*))) == NULL)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	for (i = 0, nb_to = 0; i < nb_dst; i++)
+	{
+		if (ops->slot[dst[i]].flags & OF_ML_SLOT_NULL)
+		{
+			if (of_ml_symbol_ops_add (ops, dst[i], src) != OF_STATUS_OK)
+			{
+				of_free (to);
+				return OF_STATUS_FATAL_ERROR;
+			}
+		}
+		else
+		{
+			to[nb_to++] = ops->slot[dst[i]].buf;
+		}
+	}
+	if (nb_to > 0)
+	{
+		of_add_to_multiple_symbols (to, ops->slot[src].buf, nb_to, ops->symbol_size
+#ifdef OF_DEBUG
+					    , NULL
+#endif
+					   );
+		ops->nb_recorded_xor += nb_to;
+		ops->nb_executed_xor += nb_to;
+	}
+	of_free (to);
+	return OF_STATUS_OK;
+}
+
+
+of_status_t
+of_ml_symbol_ops_add_from_multiple (of_ml_symbol_ops_t	*ops,
+				    UINT32		dst,
+				    UINT32		*src,
+				    UINT32		nb_src)
+{
+	const void	**from;
+	UINT32		nb_from;
+	UINT32		i;
+
+	if (ops->deferred || nb_src == 1 || (ops->slot[dst].flags & OF_ML_SLOT_NULL))
+	{
+		for (i = 0; i < nb_src; i++)
+		{
+			if (of_ml_symbol_ops_add (ops, dst, src[i]) != OF_STATUS_OK)
+			{
+				return OF_STATUS_FATAL_ERROR;
+			}
+		}
+		return OF_STATUS_OK;
+	}
+	/* immediate mode: add all the non null sources at once */
+	if ((from = (const void**) of_malloc (nb_src * sizeof (void*))) == NULL)
+	{
+		return OF_STATUS_FATAL_ERROR;
+	}
+	for (i = 0, nb_from = 0; i < nb_src; i++)
+	{
+		if (!(ops->slot[src[i]].flags & OF_ML_SLOT_NULL))
+		{
+			from[nb_from++] = ops->slot[src[i]].buf;
+		}
+	}
+	if (nb_from > 0)
+	{
+		of_add_from_multiple_symbols (ops->slot[dst].buf, from, nb_from, ops->symbol_size
+#ifdef OF_DEBUG
+					      , NULL
+#endif
+					     );
+		ops->nb_recorded_xor += nb_from;
+		ops->nb_executed_xor += nb_from;
+	}
+	of_free ((void*) from);
+	return OF_STATUS_OK;
+}
+
+
+of_status_t
+of_ml_symbol_ops_execute (of_ml_symbol_ops_t	*ops,
+			  const UINT32		*outputs,
+			  UINT32		nb_outputs)
+{
+	of_ml_symbol_ops_worker_t	*worker = NULL;
+	of_ml_symbol_group_t		*g;
+	of_ml_symbol_slot_t		*s;
+	void				**free_temps = NULL;	/* buffers of the temporary symbols no longer used */
+	UINT32				nb_free_temps = 0;
+	UINT32				max_group = 0;
+	UINT32				nb_workers = 0;
+	UINT32				bytes_per_worker;
+	UINT32				i, j;
+	INT32				k;
+
+	OF_ENTER_FUNCTION
+	if (ops->deferred)
+	{
+		for (i = 0; i < ops->nb_slots; i++)
+		{
+			if (of_ml_symbol_ops_close (ops, i) != OF_STATUS_OK)
+			{
+				goto no_mem;
+			}
+		}
+		/*
+		 * Liveness analysis, starting from the end: a group is only needed if its destination
+		 * is read afterwards, or is an output. Unneeded groups are dropped by setting their
+		 * number of sources to 0.
+		 */
+		for (i = 0; i < nb_outputs; i++)
+		{
+			ops->slot[outputs[i]].flags |= OF_ML_SLOT_LIVE;
+		}
+		for (k = (INT32) ops->nb_groups - 1; k >= 0; k--)
+		{
+			g = &ops->group[k];
+			if (!(ops->slot[g->dst].flags & OF_ML_SLOT_LIVE))
+			{
+				g->nb_src = 0;
+				continue;
+			}
+			if (g->is_copy)
+			{
+				/* the previous value of dst is not read */
+				ops->slot[g->dst].flags &= ~OF_ML_SLOT_LIVE;
+			}
+			for (j = 0; j < g->nb_src; j++)
+			{
+				ops->slot[ops->src[g->first_src + j]].flags |= OF_ML_SLOT_LIVE;
+			}
+			ops->nb_executed_xor += g->nb_src - g->is_copy;
+			max_group = (g->nb_src > max_group) ? g->nb_src : max_group;
+		}
+		/*
+		 * Allocate the buffers that are written, reusing those of the temporary symbols
+		 * once they are no longer read.
+		 */
+		for (i = 0; i < ops->nb_groups; i++)
+		{
+			g = &ops->group[i];
+			if (g->nb_src == 0)
+			{
+				continue;
+			}
+			ops->slot[g->dst].last_use = i;
+			for (j = 0; j < g->nb_src; j++)
+			{
+				ops->slot[ops->src[g->first_src + j]].last_use = i;
+			}
+		}
+		if ((free_temps = (void**) of_malloc ((ops->nb_slots + 1) * sizeof (void*))) == NULL ||
+		    (ops->src_buf = (void**) of_malloc ((ops->nb_srcs + 1) * sizeof (void*))) == NULL)
+		{
+			goto no_mem;
+		}
+		for (i = 0; i < ops->nb_groups; i++)
+		{
+			g = &ops->group[i];
+			if (g->nb_src == 0)
+			{
+				continue;
+			}
+			s = &ops->slot[g->dst];
+			if (s->buf == NULL)
+			{
+				if ((s->flags & OF_ML_SLOT_TEMP) && nb_free_temps > 0)
+				{
+					s->buf = free_temps[--nb_free_temps];
+				}
+				else if (of_ml_symbol_ops_alloc (ops, g->dst) != OF_STATUS_OK)
+				{
+					goto no_mem;
+				}
+			}
+			g->dst_buf = s->buf;
+			for (j = 0; j < g->nb_src; j++)
+			{
+				s = &ops->slot[ops->src[g->first_src + j]];
+				ops->src_buf[g->first_src + j] = s->buf;
+				if ((s->flags & OF_ML_SLOT_TEMP) && s->last_use == i && s->buf != NULL)
+				{
+					/* will not be read anymore, the next temporary symbols can use it */
+					free_temps[nb_free_temps++] = s->buf;
+					s->buf = NULL;
+				}
+			}
+		}
+	}
+	for (i = 0; i < nb_outputs; i++)
+	{
+		s = &ops->slot[outputs[i]];
+		if (s->buf == NULL && (s->buf = of_calloc (1, ops->symbol_size)) == NULL)
+		{
+			goto no_mem;
+		}
+	}
+	if (ops->deferred && ops->nb_groups > 0)
+	{
+		/* each worker processes the same program on its own byte range of the symbols */
+		nb_workers = ops->nb_threads;
+		if (nb_workers > ops->symbol_size / OF_ML_MIN_BYTES_PER_THREAD)
+		{
+			nb_workers = (ops->symbol_size / OF_ML_MIN_BYTES_PER_THREAD > 0) ? ops->symbol_size / OF_ML_MIN_BYTES_PER_THREAD : 1;
+		}
+		/* keep the byte ranges 64 byte aligned */
+		bytes_per_worker = ((ops->symbol_size / nb_workers) + 63) & ~63;
+		if ((worker = (of_ml_symbol_ops_worker_t*) of_calloc (nb_workers, sizeof (of_ml_symbol_ops_worker_t))) == NULL)
+		{
+			nb_workers = 0;
+			goto no_mem;
+		}
+		for (i = 0; i < nb_workers; i++)
+		{
+			worker[i].ops = ops;
+			worker[i].offset = i * bytes_per_worker;
+			worker[i].size = (i == nb_workers - 1) ? ops->symbol_size - worker[i].offset : bytes_per_worker;
+			if ((worker[i].from = (const void**) of_malloc ((max_group + 1) * sizeof (void*))) == NULL)
+			{
+				goto no_mem;
+			}
+		}
+#ifdef OF_USE_PTHREADS
+		if (nb_workers > 1)
+		{
+			for (i = 1; i < nb_workers; i++)
+			{
+				worker[i].started = (pthread_create (&worker[i].thread, NULL, of_ml_symbol_ops_run, &worker[i]) == 0);
+				if (!worker[i].started)
+				{
+					/* do it ourselves */
+					of_ml_symbol_ops_run (&worker[i]);
+				}
+			}
+			of_ml_symbol_ops_run (&worker[0]);
+			for (i = 1; i < nb_workers; i++)
+			{
+				if (worker[i].started)
+				{
+					pthread_join (worker[i].thread, NULL);
+				}
+			}
+		}
+		else
+#endif
+		{
+			for (i = 0; i < nb_workers; i++)
+			{
+				of_ml_symbol_ops_run (&worker[i]);
+			}
+		}
+		for (i = 0; i < nb_workers; i++)
+		{
+			of_free ((void*) worker[i].from);
+		}
+		of_free (worker);
+		worker = NULL;
+	}
+	if (free_temps != NULL)
+	{
+		for (i = 0; i < nb_free_temps; i++)
+		{
+			of_symbol_pool_free (ops->pool, free_temps[i]);
+		}
+		of_free (free_temps);
+	}
+	OF_EXIT_FUNCTION
+	return OF_STATUS_OK;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory"))
+	if (worker != NULL)
+	{
+		for (i = 0; i < nb_workers; i++)
+		{
+			of_free ((void*) worker[i].from);
+		}
+		of_free (worker);
+	}
+	if (free_temps != NULL)
+	{
+		for (i = 0; i < nb_free_temps; i++)
+		{
+			of_symbol_pool_free (ops->pool, free_temps[i]);
+		}
+		of_free (free_temps);
+	}
+	OF_EXIT_FUNCTION
+	return OF_STATUS_FATAL_ERROR;
+}
+
+
+#endif //ML_DECODING
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
+#endif //OF_USE_DECODER
@@ -0,0 +1,227 @@
+/* $Id: of_ml_symbol_ops.h $ */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 - 2012 INRIA - All rights reserved
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ */
+
+/*
+ * This module records the symbol operations (XORs) done while solving the dense
+ * system of the ML decoder, so that the row operations of the bit matrix and the
+ * much more expensive symbol operations are decoupled.
+ *
+ * Symbols are identified by slots: the first ones are the constant terms of the
+ * system, the next ones are temporary symbols (e.g. M4RI lookup tables).
+ *
+ * In immediate mode, each operation is executed when it is recorded.
+ *
+ * In deferred mode, the operations are only executed by of_ml_symbol_ops_execute(),
+ * once the outputs are known, after the following optimizations:
+ * - the XORs to the same symbol are merged into a single multi-source XOR as long
+ *   as this symbol is not read, and as long as its sources are not modified, a
+ *   source that appears twice cancelling out;
+ * - the operations whose result is never read back (e.g. on the equations that are
+ *   not needed to solve the system) are dropped;
+ * - the temporary symbols are only allocated while they are in use.
+ * The resulting program is executed by chunks of bytes of all the symbols, so that the
+ * symbols of a chunk stay in cache, and can be executed by several threads, each of
+ * them processing its own byte range.
+ */
+
+#ifndef OF_ML_SYMBOL_OPS_H
+#define OF_ML_SYMBOL_OPS_H
+
+
+#ifdef OF_USE_DECODER
+#ifdef OF_USE_LINEAR_BINARY_CODES_UTILS
+#ifdef ML_DECODING
+
+
+/**
+ * A symbol, and in deferred mode the open group of XORs to this symbol.
+ */
+typedef struct of_ml_symbol_slot
+{
+	void	*buf;		/* symbol buffer, NULL if not allocated (yet) */
+	UINT32	*src;		/* sources of the open group */
+	UINT32	nb_src;
+	UINT32	max_src;
+	UINT32	*readers;	/* slots whose open group may read this one */
+	UINT32	nb_readers;
+	UINT32	max_readers;
+	UINT32	last_use;	/* last group that reads or writes this slot, when executing */
+	UINT8	flags;		/* OF_ML_SLOT_* */
+} of_ml_symbol_slot_t;
+
+#define OF_ML_SLOT_NULL		0x01	/* the symbol is null (once the open group is closed) */
+#define OF_ML_SLOT_TEMP		0x02	/* temporary symbol, taken from the symbol pool */
+#define OF_ML_SLOT_OPEN		0x04	/* a group of XORs to this symbol is open */
+#define OF_ML_SLOT_COPY		0x08	/* the open group starts from a null symbol */
+#define OF_ML_SLOT_LIVE		0x10	/* the symbol is needed, when executing */
+
+
+/**
+ * A multi-source XOR of the deferred program: dst = (is_copy ? 0 : dst) + src[0] + ...
+ */
+typedef struct of_ml_symbol_group
+{
+	UINT32	dst;
+	UINT32	first_src;	/* index of the first source in the sources table */
+	UINT32	nb_src;
+	UINT32	is_copy;
+	void	*dst_buf;	/* buffer of dst, once allocated for execution */
+} of_ml_symbol_group_t;
+
+
+/**
+ * Symbol operation list.
+ */
+typedef struct of_ml_symbol_ops
+{
+	UINT32			symbol_size;
+	of_symbol_pool_t	*pool;		/* temporary symbols come from there (NULL: heap) */
+	bool			deferred;
+	UINT32			nb_threads;
+
+	of_ml_symbol_slot_t	*slot;
+	UINT32			nb_slots;
+	UINT32			max_slots;
+	UINT32			*free_temp;	/* released temporary slots, that can be reused */
+	UINT32			nb_free_temps;
+	UINT32			max_free_temps;
+
+	of_ml_symbol_group_t	*group;		/* the deferred program, in execution order */
+	UINT32			nb_groups;
+	UINT32			max_groups;
+	UINT32			*src;		/* sources of all the groups */
+	UINT32			nb_srcs;
+	UINT32			max_srcs;
+	void			**src_buf;	/* buffers of the sources, once allocated for execution */
+
+	UINT32			nb_recorded_xor;	/* XORs requested so far */
+	UINT32			nb_executed_xor;	/* XORs done */
+} of_ml_symbol_ops_t;
+
+
+/**
+ * Create a symbol operation list, whose first nb_symbols slots are the symbols of the
+ * symbols table (NULL for a null symbol). These buffers remain owned by the caller, who
+ * gets the up to date buffers with of_ml_symbol_ops_get_symbol() once done.
+ *
+ * @param symbol_size		(IN) symbol size in bytes.
+ * @param pool			(IN) pool used for the temporary symbols, or NULL.
+ * @param deferred		(IN) true for the deferred mode, false for the immediate mode.
+ * @param nb_threads		(IN) number of threads executing the deferred program.
+ * @param symbols		(IN) initial symbols.
+ * @param nb_symbols		(IN) number of initial symbols.
+ * @return			the symbol operation list, or NULL if out of memory.
+ */
+of_ml_symbol_ops_t*	of_ml_symbol_ops_create (UINT32			symbol_size,
+						 of_symbol_pool_t	*pool,
+						 bool			deferred,
+						 UINT32			nb_threads,
+						 void			**symbols,
+						 UINT32			nb_symbols);
+
+/**
+ * Free a symbol operation list and its temporary symbols.
+ */
+void	of_ml_symbol_ops_free (of_ml_symbol_ops_t	*ops);
+
+/**
+ * Add a temporary null symbol, reusing a released one if any.
+ *
+ * @return			OF_STATUS_OK, or OF_STATUS_FATAL_ERROR if out of memory.
+ */
+of_status_t	of_ml_symbol_ops_new_temp (of_ml_symbol_ops_t	*ops,
+					   UINT32		*slot);
+
+/**
+ * Tell that the value of a temporary symbol will not be used anymore by the operations
+ * to come, so that it can be reused by of_ml_symbol_ops_new_temp().
+ *
+ * @return			OF_STATUS_OK, or OF_STATUS_FATAL_ERROR if out of memory.
+ */
+of_status_t	of_ml_symbol_ops_release_temp (of_ml_symbol_ops_t	*ops,
+					       UINT32			slot);
+
+/**
+ * Return true if the symbol is known to be null.
+ */
+#define of_ml_symbol_ops_is_null(ops,s)	\
+		(((ops)->slot[s].flags & (OF_ML_SLOT_NULL | OF_ML_SLOT_OPEN)) == OF_ML_SLOT_NULL)
+
+/**
+ * dst = dst + src.
+ *
+ * @return			OF_STATUS_OK, or OF_STATUS_FATAL_ERROR if out of memory.
+ */
+of_status_t	of_ml_symbol_ops_add (of_ml_symbol_ops_t	*ops,
+				      UINT32			dst,
+				      UINT32			src);
+
+/**
+ * dst[i] = dst[i] + src, for all the nb_dst destinations.
+ */
+of_status_t	of_ml_symbol_ops_add_to_multiple (of_ml_symbol_ops_t	*ops,
+						  UINT32		*dst,
+						  UINT32		nb_dst,
+						  UINT32		src);
+
+/**
+ * dst = dst + src[0] + ... + src[nb_src - 1].
+ */
+of_status_t	of_ml_symbol_ops_add_from_multiple (of_ml_symbol_ops_t	*ops,
+						    UINT32		dst,
+						    UINT32		*src,
+						    UINT32		nb_src);
+
+/**
+ * Execute the deferred program so that the nb_outputs output symbols are up to date
+ * (all the other ones may not be). The output symbols that are still null are
+ * allocated, so that of_ml_symbol_ops_get_symbol() returns a buffer for each of them.
+ *
+ * @return			OF_STATUS_OK, or OF_STATUS_FATAL_ERROR if out of memory.
+ */
+of_status_t	of_ml_symbol_ops_execute (of_ml_symbol_ops_t	*ops,
+					  const UINT32		*outputs,
+					  UINT32		nb_outputs);
+
+/**
+ * Return the buffer of an initial symbol, which may have been allocated by the symbol
+ * operation list. It must be called for all the initial symbols before freeing the list.
+ */
+#define of_ml_symbol_ops_get_symbol(ops,s)	((ops)->slot[s].buf)
+
+
+#endif //ML_DECODING
+#endif //OF_USE_LINEAR_BINARY_CODES_UTILS
+#endif //OF_USE_DECODER
+
+#endif //OF_ML_SYMBOL_OPS_H
@@ -46,15 +46,17 @@
  * to find the pivot and eliminate '1's below the pivot.
  *
  * @brief			triangularize the dense system
- * @param m			(IN/OUT) address of the dense matrix.
- * @param constant_tab		(IN/OUT)
+ * @param m			(IN/OUT) address of the dense matrix.
+ * @param ops			(IN/OUT) symbol operations on the constant terms.
+ * @param row_slot		(IN/OUT) constant term symbol of each row.
  * @param ofcb			(IN) Linear-Binary-Code control-block.
  * @return			1 if it's OK, or 0 if an error took place.
  */
 static INT32
 of_linear_binary_code_triangularize_dense_system (of_linear_binary_code_cb_t	*ofcb,
 						  of_mod2dense			*m,
-						  void				**constant_tab);
+						  of_ml_symbol_ops_t		*ops,
+						  UINT32			*row_slot);
 
 
 /**
@@ -62,35 +64,79 @@ of_linear_binary_code_triangularize_dense_system (of_linear_binary_code_cb_t	*of
  *
  * @brief			eliminates "1" entries in parity check matrix
  * @param m 			(IN/OUT) address of the dense matrix.
- * @param constant_tab		(IN/OUT) pointer to all constant members
+ * @param ops			(IN/OUT) symbol operations on the constant terms.
+ * @param row_slot		(IN/OUT) constant term symbol of each row.
  * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
  * @param col_idx		(IN) column index
- * @param stats			(IN)
+ * @param dst			(IN) scratch table, for the rows to update
  * @return			1 if it's OK, or 0 if an error took place.
  */
 static INT32
 of_linear_binary_code_col_forward_elimination  (of_linear_binary_code_cb_t	*ofcb,
 						of_mod2dense			*m,
-						void				**constant_tab,
-						INT32				col_idx);
+						of_ml_symbol_ops_t		*ops,
+						UINT32				*row_slot,
+						INT32				col_idx,
+						UINT32				*dst);
 
 
 /**
  * This function computes the actual values of the symbols, starting from the bottom row up to the first one. It assumes the parity check matrix has
- * already been transformed into a triangular matrix.
+ * already been transformed into a triangular matrix. Variable i is computed in place of
+ * the constant term of row i.
  *
  * @brief			solve system with backward substitution
- * @param variable_tab		(IN/OUT) address of the dense matrix.
- * @param constant_tab
  * @param m 			(IN/OUT) address of the dense matrix.
+ * @param ops			(IN/OUT) symbol operations on the constant terms.
+ * @param row_slot		(IN) constant term symbol of each row.
  * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
  * @return			1 if it's OK, or 0 if an error took place.
  */
 static INT32
 of_linear_binary_code_backward_substitution (of_linear_binary_code_cb_t	*ofcb,
 					     of_mod2dense		*m,
-					     void			*variable_tab[],
-					     void			*constant_tab[]);
+					     of_ml_symbol_ops_t		*ops,
+					     UINT32			*row_slot);
+
+
+/**
+ * M4RI version of of_linear_binary_code_triangularize_dense_system(). For each block of
+ * columns, the pivots are found and reduced to the identity on the block columns, then
+ * all the rows below are cleared on the block columns with a single row XOR (from a Gray
+ * code table of the 2^k pivot row combinations) and a single symbol XOR (from a table of
+ * the pivot constant term combinations, built lazily).
+ *
+ * @brief			triangularize the dense system, k columns at a time
+ * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
+ * @param m			(IN/OUT) address of the dense matrix.
+ * @param ops			(IN/OUT) symbol operations on the constant terms.
+ * @param row_slot		(IN/OUT) constant term symbol of each row.
+ * @return			1 if it's OK, or 0 if an error took place.
+ */
+static INT32
+of_linear_binary_code_m4ri_triangularize_dense_system (of_linear_binary_code_cb_t	*ofcb,
+						       of_mod2dense			*m,
+						       of_ml_symbol_ops_t		*ops,
+						       UINT32				*row_slot);
+
+
+/**
+ * M4RI version of of_linear_binary_code_backward_substitution(). Once the variables of a
+ * block of columns are known, their contribution is added to the constant term of every
+ * row above with a single symbol XOR, from a table of the variable combinations.
+ *
+ * @brief			solve system with blocked backward substitution
+ * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
+ * @param m 			(IN) address of the triangular dense matrix.
+ * @param ops			(IN/OUT) symbol operations on the constant terms.
+ * @param row_slot		(IN) constant term symbol of each row.
+ * @return			1 if it's OK, or 0 if an error took place.
+ */
+static INT32
+of_linear_binary_code_m4ri_backward_substitution (of_linear_binary_code_cb_t	*ofcb,
+						  of_mod2dense			*m,
+						  of_ml_symbol_ops_t		*ops,
+						  UINT32			*row_slot);
 
 
 /******************************************************************************/
@@ -100,27 +146,120 @@ of_linear_binary_code_backward_substitution (of_linear_binary_code_cb_t	*ofcb,
 /**
  * This function solves the system: first triangularize the system, then for each column,
  * do a forward elimination, then do the backward elimination.
+ * The symbol operations are done through a symbol operation list, so that in deferred
+ * mode they are only executed once the whole system is solved.
  */
 of_status_t
 of_linear_binary_code_solve_dense_system (of_linear_binary_code_cb_t	*ofcb,
 					  of_mod2dense			*m,
 					  void				**constant_tab,
-					  void				**variable_tab)
+					  void				**variable_tab,
+					  UINT32			nb_unneeded_variables)
 {
+	of_ml_symbol_ops_t	*ops;
+	UINT32			*row_slot = NULL;	/* symbol of the constant term of each row */
+	of_status_t		status = OF_STATUS_OK;
+	INT32			n, p;
+	INT32			i;
+
 	OF_ENTER_FUNCTION
-	if (!of_linear_binary_code_triangularize_dense_system (ofcb, m, constant_tab))
+	n = of_mod2dense_cols (m);
+	p = of_mod2dense_rows (m);
+	ofcb->ml_nb_symbol_xor = 0;
+	ofcb->ml_nb_saved_symbol_xor = 0;
+	if ((ops = of_ml_symbol_ops_create (ofcb->encoding_symbol_length, ofcb->symbol_pool,
+					    ofcb->ml_deferred_symbol_ops, ofcb->ml_nb_threads,
+					    constant_tab, p)) == NULL ||
+	    (row_slot = (UINT32*) of_malloc (p * sizeof (UINT32))) == NULL)
 	{
-		OF_TRACE_LVL(0,("%s: triangularize_dense_system failed for system with %d rows, %d cols\n",
-				__FUNCTION__, of_mod2dense_rows(m), of_mod2dense_cols(m)))
+		OF_PRINT_ERROR(("out of memory"))
+		of_ml_symbol_ops_free (ops);
 		OF_EXIT_FUNCTION
-		return OF_STATUS_FAILURE;
+		return OF_STATUS_FATAL_ERROR;
 	}
-	//of_mod2dense_print_bitmap(m);
-	if (!of_linear_binary_code_backward_substitution (ofcb, m, variable_tab, constant_tab))
+	for (i = 0; i < p; i++)
 	{
-		OF_TRACE_LVL(0,("%s: backward_substitution failed\n", __FUNCTION__))
-		OF_EXIT_FUNCTION
-		return OF_STATUS_FAILURE;
+		row_slot[i] = i;
+	}
+	if ((status = of_linear_binary_code_eliminate_dense_system (ofcb, m, ops, row_slot)) != OF_STATUS_OK)
+	{
+		goto end;
+	}
+	/* the needed variables are the outputs, all the other symbol operations can be dropped */
+	if (of_ml_symbol_ops_execute (ops, row_slot + nb_unneeded_variables, n - nb_unneeded_variables) != OF_STATUS_OK)
+	{
+		status = OF_STATUS_FATAL_ERROR;
+		goto end;
+	}
+	/* variable i has been computed in place of the constant term of row i */
+	for (i = 0; i < n; i++)
+	{
+		variable_tab[i] = of_ml_symbol_ops_get_symbol (ops, row_slot[i]);
+		of_ml_symbol_ops_get_symbol (ops, row_slot[i]) = NULL;
+	}
+end:
+	/* give the (possibly allocated) buffers back, the caller frees them */
+	for (i = 0; i < p; i++)
+	{
+		constant_tab[i] = of_ml_symbol_ops_get_symbol (ops, i);
+	}
+	ofcb->ml_nb_symbol_xor = ops->nb_recorded_xor;
+	ofcb->ml_nb_saved_symbol_xor = ops->nb_recorded_xor - ops->nb_executed_xor;
+#ifdef OF_DEBUG
+	ofcb->stats_xor->nb_xor_for_ML += ops->nb_executed_xor;
+#endif
+	OF_TRACE_LVL(1,("%s: %u symbol XORs requested, %u saved\n", __FUNCTION__,
+			ofcb->ml_nb_symbol_xor, ofcb->ml_nb_saved_symbol_xor))
+	of_ml_symbol_ops_free (ops);
+	of_free (row_slot);
+	OF_EXIT_FUNCTION
+	return status;
+}
+
+
+/**
+ * Record the symbol operations of the triangularization then of the backward substitution,
+ * either column by column or with M4RI.
+ */
+of_status_t
+of_linear_binary_code_eliminate_dense_system (of_linear_binary_code_cb_t	*ofcb,
+					      of_mod2dense			*m,
+					      of_ml_symbol_ops_t		*ops,
+					      UINT32				*row_slot)
+{
+	OF_ENTER_FUNCTION
+	if (ofcb->ml_m4ri_k > 0)
+	{
+		if (!of_linear_binary_code_m4ri_triangularize_dense_system (ofcb, m, ops, row_slot))
+		{
+			OF_TRACE_LVL(0,("%s: m4ri_triangularize_dense_system failed for system with %d rows, %d cols\n",
+					__FUNCTION__, of_mod2dense_rows(m), of_mod2dense_cols(m)))
+			OF_EXIT_FUNCTION
+			return OF_STATUS_FAILURE;
+		}
+		if (!of_linear_binary_code_m4ri_backward_substitution (ofcb, m, ops, row_slot))
+		{
+			OF_TRACE_LVL(0,("%s: m4ri_backward_substitution failed\n", __FUNCTION__))
+			OF_EXIT_FUNCTION
+			return OF_STATUS_FAILURE;
+		}
+	}
+	else
+	{
+		if (!of_linear_binary_code_triangularize_dense_system (ofcb, m, ops, row_slot))
+		{
+			OF_TRACE_LVL(0,("%s: triangularize_dense_system failed for system with %d rows, %d cols\n",
+					__FUNCTION__, of_mod2dense_rows(m), of_mod2dense_cols(m)))
+			OF_EXIT_FUNCTION
+			return OF_STATUS_FAILURE;
+		}
+		//of_mod2dense_print_bitmap(m);
+		if (!of_linear_binary_code_backward_substitution (ofcb, m, ops, row_slot))
+		{
+			OF_TRACE_LVL(0,("%s: backward_substitution failed\n", __FUNCTION__))
+			OF_EXIT_FUNCTION
+			return OF_STATUS_FAILURE;
+		}
 	}
 	OF_EXIT_FUNCTION
 	return OF_STATUS_OK;
@@ -133,21 +272,31 @@ of_linear_binary_code_solve_dense_system (of_linear_binary_code_cb_t	*ofcb,
 static
 INT32	of_linear_binary_code_triangularize_dense_system (of_linear_binary_code_cb_t	*ofcb,
 							  of_mod2dense			*m,
-							  void				**constant_tab)
+							  of_ml_symbol_ops_t		*ops,
+							  UINT32			*row_slot)
 {
-	INT32 i, n;
+	UINT32	*dst;
+	INT32	i, n;
 
 	OF_ENTER_FUNCTION
 	n = of_mod2dense_cols (m);
+	if ((dst = (UINT32*) of_malloc (of_mod2dense_rows (m) * sizeof (UINT32))) == NULL)
+	{
+		OF_PRINT_ERROR(("out of memory"))
+		OF_EXIT_FUNCTION
+		return 0;
+	}
 	/* for each row */
 	for (i = 0; i < n; i++)
 	{
-		if (!of_linear_binary_code_col_forward_elimination(ofcb, m, constant_tab, i))
+		if (!of_linear_binary_code_col_forward_elimination(ofcb, m, ops, row_slot, i, dst))
 		{
+			of_free (dst);
 			OF_EXIT_FUNCTION
 			return 0;
 		}
 	}
+	of_free (dst);
 	OF_EXIT_FUNCTION
 	return 1;
 }
@@ -156,8 +305,10 @@ INT32	of_linear_binary_code_triangularize_dense_system (of_linear_binary_code_cb
 static
 INT32	of_linear_binary_code_col_forward_elimination  (of_linear_binary_code_cb_t	*ofcb,
 								of_mod2dense			*m,
-								void				**constant_tab,
-								INT32				col_idx)
+								of_ml_symbol_ops_t		*ops,
+								UINT32				*row_slot,
+								INT32				col_idx,
+								UINT32				*dst)
 {
 	of_mod2word	*s;
 	of_mod2word	*t;
@@ -166,11 +317,10 @@ INT32	of_linear_binary_code_col_forward_elimination  (of_linear_binary_code_cb_t
 	INT32		w;
 	INT32		w0;
 	INT32		b0;
-	INT32		symbol_size;
-	void		*tmp_buffer;
+	UINT32		nb_dst;
+	UINT32		tmp_slot;
 
 	OF_ENTER_FUNCTION
-	symbol_size = ofcb->encoding_symbol_length;
 	n = of_mod2dense_cols (m);
 	p = of_mod2dense_rows (m);
 	w = m->n_words;
@@ -199,14 +349,14 @@ INT32	of_linear_binary_code_col_forward_elimination  (of_linear_binary_code_cb_t
 		m->row[i] = m->row[j];
 		m->row[j] = t;
 		// swap the partial sum
-		tmp_buffer = constant_tab[i];
-		constant_tab[i] = constant_tab[j];
-		constant_tab[j] = tmp_buffer;
+		tmp_slot = row_slot[i];
+		row_slot[i] = row_slot[j];
+		row_slot[j] = tmp_slot;
 		//of_mod2dense_print(stdout,m);
 	}
 	/* we have found the pivot and made sure that it is at row i (potentially after swapping two rows).
 	 * Now eliminate the other '1's below this pivot... */
-	ofcb->nb_tmp_symbols = 0;
+	nb_dst = 0;
 	for (j = i + 1; j < p; j++)
 	{
 		if (of_mod2_getbit(m->row[j][w0], b0))
@@ -224,45 +374,15 @@ INT32	of_linear_binary_code_col_forward_elimination  (of_linear_binary_code_cb_t
 				t++;
 			}
 			//of_mod2dense_print(stdout,m);
-			if (constant_tab[i] != NULL)
-			{
-				/* if the buffer of line i is NULL there is nothing to add.
-				 * add the constant term of the i to the constant term of line j */
-				if (constant_tab[j] == NULL)
-				{
-					constant_tab[j] = of_malloc (symbol_size);
-					/* copy data directly, there's no XOR to perform */
-					memcpy (constant_tab[j], constant_tab[i], symbol_size);
-				}
-				else
-				{
-					/* add constant term i to constant term j */
-					ofcb->tmp_tab_symbols[ofcb->nb_tmp_symbols++] = constant_tab[j];
-				}
-			}
-			else
-			{
-				constant_tab[i] = of_calloc (1, symbol_size);
-			}
+			/* add the constant term of the i to the constant term of line j */
+			dst[nb_dst++] = row_slot[j];
 		}
 	}
-	if (ofcb->nb_tmp_symbols != 0)
+	if (nb_dst != 0 && of_ml_symbol_ops_add_to_multiple (ops, dst, nb_dst, row_slot[i]) != OF_STATUS_OK)
 	{
-		if (ofcb->nb_tmp_symbols == 1)
-		{
-			of_add_to_symbol (ofcb->tmp_tab_symbols[0], constant_tab[i], symbol_size OP_ARG_VAL);
-		}
-		else
-		{
-			of_add_to_multiple_symbols (ofcb->tmp_tab_symbols,
-						    constant_tab[i],
-						    ofcb->nb_tmp_symbols,
-						    ofcb->encoding_symbol_length
-#ifdef OF_DEBUG
-						    , &(ofcb->stats_xor->nb_xor_for_ML)
-#endif
-						   );
-		}
+		OF_PRINT_ERROR(("out of memory"))
+		OF_EXIT_FUNCTION
+		return 0;
 	}
 	OF_EXIT_FUNCTION
 	return 1;
@@ -273,63 +393,465 @@ INT32	of_linear_binary_code_col_forward_elimination  (of_linear_binary_code_cb_t
 static
 INT32	of_linear_binary_code_backward_substitution    (of_linear_binary_code_cb_t	*ofcb,
 							of_mod2dense			*m,
-							void				*variable_tab[],
-							void				*constant_tab[])
+							of_ml_symbol_ops_t		*ops,
+							UINT32				*row_slot)
 {
 	INT32	i;		/* current variable index for which we apply backward substition. It's also the row index. */
 	INT32	j;		/*  */
 	INT32	n;
 	INT32	w0;		/* dense matrix word index for variable j */
 	INT32	b0;		/* dense matrix bit index in word of index w0 */
+	UINT32	*src;		/* variables to add */
+	UINT32	nb_src;
 
 	OF_ENTER_FUNCTION
 	n = of_mod2dense_cols (m);
+	if ((src = (UINT32*) of_malloc ((n + 1) * sizeof (UINT32))) == NULL)
+	{
+		goto no_mem;
+	}
 	/* go through all the rows, starting from the last one... */
 	for (i = n - 1; i >= 0; i--)
 	{
-		ASSERT(variable_tab[i] == NULL);
-		//if (variable_tab[i] == NULL)
-		{
-			of_mod2word	*row = m->row[i];		// row corresponding to variable i
+		of_mod2word	*row = m->row[i];		// row corresponding to variable i
 #ifdef OF_DEBUG
-			w0 = i >> of_mod2_wordsize_shift;	// word index of the ith bit
-			b0 = i & of_mod2_wordsize_mask;		// bit index of the ith bit in the w0-th word
-			ASSERT(of_mod2_getbit(row[w0], b0))
+		w0 = i >> of_mod2_wordsize_shift;	// word index of the ith bit
+		b0 = i & of_mod2_wordsize_mask;		// bit index of the ith bit in the w0-th word
+		ASSERT(of_mod2_getbit(row[w0], b0))
+#endif
+		/*
+		 * the missing source symbol in col i is equal to the sum of the constant term of this
+		 * equation (i.e. row i) plus all the variables of this equation.
+		 */
+		//OF_TRACE_LVL(1, ("%s: rebuilding source symbol %d with col %d\n", __FUNCTION__, col_index[i], i))
+		/* determine the list of symbols to add to compute the decoded source symbol */
+		nb_src = 0;
+		for (j = i + 1; j < n; j++)
+		{
+			w0 = j >> of_mod2_wordsize_shift;	// word index of the ith bit
+			b0 = j & of_mod2_wordsize_mask;		// bit index of the ith bit in the w0-th word
+			/* search for the non-null element in row i */
+			if (of_mod2_getbit(row[w0], b0))
+			{
+				/* since the bit is set, add variable j */
+				src[nb_src++] = row_slot[j];
+			}
+		}
+		if (nb_src != 0 && of_ml_symbol_ops_add_from_multiple (ops, row_slot[i], src, nb_src) != OF_STATUS_OK)
+		{
+			goto no_mem;
+		}
+	}
+	of_free (src);
+	OF_EXIT_FUNCTION
+	return 1;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory"))
+	if (src)
+		of_free (src);
+	OF_EXIT_FUNCTION
+	return 0;
+}
+
+
+/******  M4RI  ****************************************************************/
+
+
+/**
+ * Lookup table of the XOR sums of up to OF_ML_M4RI_MAX_K symbols (the block pivot constant
+ * terms or the block variables). An entry is only computed when a row needs it, from the
+ * entry without its lowest bit, so it costs at most one symbol XOR.
+ */
+typedef struct
+{
+	UINT32		*base;		/* the slots of the k symbols of the block */
+	UINT32		sum[1 << OF_ML_M4RI_MAX_K];	/* slot of each sum */
+	UINT8		state[1 << OF_ML_M4RI_MAX_K];	/* 0: not computed, 1: alias, 2: temporary symbol */
+} of_m4ri_symbol_table_t;
+
+
+/**
+ * XOR nb_words words of from into to. This is the inner loop of all row operations.
+ */
+static inline void
+of_m4ri_xor_words (of_mod2word		*to,
+		   const of_mod2word	*from,
+		   INT32		nb_words)
+{
+#ifdef ASSEMBLY_SSE_OPT
+	/* rows are only word aligned, so use unaligned 128 bit loads/stores */
+	for (; nb_words >= 4; nb_words -= 4)
+	{
+		_mm_storeu_ps ((float*) to, _mm_xor_ps (_mm_loadu_ps ((const float*) to),
+							 _mm_loadu_ps ((const float*) from)));
+		to += 4;
+		from += 4;
+	}
 #endif
-			/*
-			 * the missing source symbol in col i is equal to the sum of the constant term of this
-			 * equation (i.e. row i) plus all the variables of this equation.
-			 */
-			//OF_TRACE_LVL(1, ("%s: rebuilding source symbol %d with col %d\n", __FUNCTION__, col_index[i], i))
-			ASSERT(variable_tab[i] == NULL);
-			variable_tab[i] = constant_tab[i];
-			constant_tab[i] = NULL;
-			/* determine the list of symbols to add to compute the decoded source symbol */
-			ofcb->nb_tmp_symbols = 0;
-			for (j = i + 1; j < n; j++)
+	/* the compiler vectorizes this loop if it's allowed to */
+	for (; nb_words > 0; nb_words--)
+	{
+		*to++ ^= *from++;
+	}
+}
+
+
+/**
+ * Return the nb_bits (at most OF_ML_M4RI_MAX_K) bits of row starting at column col, the
+ * bit of column col being the least significant one.
+ */
+static inline UINT32
+of_m4ri_read_bits (const of_mod2word	*row,
+		   INT32		col,
+		   INT32		nb_bits)
+{
+	INT32	w0 = col >> of_mod2_wordsize_shift;
+	INT32	b0 = col & of_mod2_wordsize_mask;
+	UINT32	bits;
+
+	if (nb_bits == 0)
+		return 0;
+	bits = row[w0] >> b0;
+	if (b0 + nb_bits > of_mod2_wordsize)
+	{
+		bits |= row[w0 + 1] << (of_mod2_wordsize - b0);
+	}
+	return bits & ((1 << nb_bits) - 1);
+}
+
+
+/**
+ * Index of the least significant bit set in a non null value.
+ */
+static inline INT32
+of_m4ri_lowest_bit (UINT32	v)
+{
+	INT32	i = 0;
+
+	while ((v & 1) == 0)
+	{
+		v >>= 1;
+		i++;
+	}
+	return i;
+}
+
+
+/**
+ * Choose the width of the next block: the 2^k table entries are only worth computing if
+ * there are enough rows to use them, i.e. if k is around log2(nb_rows) - 1.
+ */
+static INT32
+of_m4ri_block_width (of_linear_binary_code_cb_t	*ofcb,
+		     INT32			nb_rows,
+		     INT32			nb_cols)
+{
+	INT32	k = 1;
+
+	while ((2 << (k + 1)) <= nb_rows && k < (INT32) ofcb->ml_m4ri_k && k < OF_ML_M4RI_MAX_K)
+	{
+		k++;
+	}
+	return (k < nb_cols) ? k : nb_cols;
+}
+
+
+static void
+of_m4ri_symbol_table_init (of_m4ri_symbol_table_t	*tab,
+			   UINT32			*base,
+			   INT32			k)
+{
+	tab->base = base;
+	memset (tab->state, 0, 1 << k);
+}
+
+
+/**
+ * Release the temporary symbols of the table.
+ * Return 1 if it's OK, or 0 if out of memory.
+ */
+static INT32
+of_m4ri_symbol_table_clear (of_ml_symbol_ops_t		*ops,
+			    of_m4ri_symbol_table_t	*tab,
+			    INT32			k)
+{
+	INT32	ok = 1;
+	INT32	i;
+
+	for (i = 0; i < (1 << k); i++)
+	{
+		if (tab->state[i] == 2 && of_ml_symbol_ops_release_temp (ops, tab->sum[i]) != OF_STATUS_OK)
+		{
+			ok = 0;
+		}
+		tab->state[i] = 0;
+	}
+	return ok;
+}
+
+
+/**
+ * Get in *sum the slot of the sum of the block symbols selected by pattern.
+ * Return 1 if it's OK, or 0 if out of memory.
+ */
+static INT32
+of_m4ri_symbol_table_get (of_ml_symbol_ops_t		*ops,
+			  of_m4ri_symbol_table_t	*tab,
+			  UINT32			pattern,
+			  UINT32			*sum)
+{
+	UINT32	low;
+	UINT32	parent;
+	UINT32	last;
+
+	if (tab->state[pattern] != 0)
+	{
+		*sum = tab->sum[pattern];
+		return 1;
+	}
+	low = pattern & (~pattern + 1);
+	last = tab->base[of_m4ri_lowest_bit (low)];
+	if (low == pattern)
+	{
+		tab->sum[pattern] = last;
+		tab->state[pattern] = 1;
+	}
+	else if (!of_m4ri_symbol_table_get (ops, tab, pattern ^ low, &parent))
+	{
+		return 0;
+	}
+	else if (of_ml_symbol_ops_is_null (ops, parent) || of_ml_symbol_ops_is_null (ops, last))
+	{
+		/* nothing to add, reuse the non null symbol if any */
+		tab->sum[pattern] = of_ml_symbol_ops_is_null (ops, parent) ? last : parent;
+		tab->state[pattern] = 1;
+	}
+	else
+	{
+		/* temporary symbol, released at the end of the block */
+		if (of_ml_symbol_ops_new_temp (ops, &tab->sum[pattern]) != OF_STATUS_OK)
+		{
+			return 0;
+		}
+		tab->state[pattern] = 2;
+		if (of_ml_symbol_ops_add (ops, tab->sum[pattern], parent) != OF_STATUS_OK ||
+		    of_ml_symbol_ops_add (ops, tab->sum[pattern], last) != OF_STATUS_OK)
+		{
+			return 0;
+		}
+	}
+	*sum = tab->sum[pattern];
+	return 1;
+}
+
+
+static
+INT32	of_linear_binary_code_m4ri_triangularize_dense_system (of_linear_binary_code_cb_t	*ofcb,
+							       of_mod2dense			*m,
+							       of_ml_symbol_ops_t		*ops,
+							       UINT32				*row_slot)
+{
+	of_m4ri_symbol_table_t	*sym_tab = NULL;
+	of_mod2word	*row_tab = NULL;	/* Gray code table of the pivot row combinations */
+	of_mod2word	*t;
+	UINT32		tmp_slot;
+	UINT32		sum;
+	INT32		n, p, w;
+	INT32		c0;			/* first column of the block */
+	INT32		k;			/* width of the block */
+	INT32		wb;			/* first word of the block */
+	INT32		c, i, j, s;
+	UINT32		pattern;
+	UINT32		g, prev_g;
+	UINT32		bit;
+
+	OF_ENTER_FUNCTION
+	n = of_mod2dense_cols (m);
+	p = of_mod2dense_rows (m);
+	w = m->n_words;
+	if ((row_tab = (of_mod2word*) of_malloc ((1 << OF_ML_M4RI_MAX_K) * w * sizeof (of_mod2word))) == NULL ||
+	    (sym_tab = (of_m4ri_symbol_table_t*) of_malloc (sizeof (of_m4ri_symbol_table_t))) == NULL)
+	{
+		goto no_mem;
+	}
+	for (c0 = 0; c0 < n; c0 += k)
+	{
+		k = of_m4ri_block_width (ofcb, p - c0, n - c0);
+		wb = c0 >> of_mod2_wordsize_shift;
+		/*
+		 * Step 1: find the k pivots and reduce them to the identity on the block columns.
+		 * Rows are only modified when they become a pivot.
+		 */
+		for (i = 0; i < k; i++)
+		{
+			c = c0 + i;
+			for (j = c; j < p; j++)
 			{
-				w0 = j >> of_mod2_wordsize_shift;	// word index of the ith bit
-				b0 = j & of_mod2_wordsize_mask;		// bit index of the ith bit in the w0-th word
-				/* search for the non-null element in row i */
-				if (of_mod2_getbit(row[w0], b0))
+				/* value of bit c once row j is reduced by the pivots found so far */
+				bit = of_mod2_getbit (m->row[j][c >> of_mod2_wordsize_shift], c & of_mod2_wordsize_mask);
+				for (pattern = of_m4ri_read_bits (m->row[j], c0, i); pattern != 0; pattern &= pattern - 1)
 				{
-					/* since the bit is set, add the variable_tab[j] symbol */
-					ofcb->tmp_tab_symbols[ofcb->nb_tmp_symbols++] = variable_tab[j];
+					t = m->row[c0 + of_m4ri_lowest_bit (pattern)];
+					bit ^= of_mod2_getbit (t[c >> of_mod2_wordsize_shift], c & of_mod2_wordsize_mask);
 				}
+				if (bit)
+					break;
 			}
-			if (ofcb->nb_tmp_symbols != 0)
+			if (j == p)
 			{
-				of_add_from_multiple_symbols(variable_tab[i], (const void**)ofcb->tmp_tab_symbols,
-							     ofcb->nb_tmp_symbols, ofcb->encoding_symbol_length
-#ifdef OF_DEBUG
-							     , &(ofcb->stats_xor->nb_xor_for_ML)
-#endif
-								);
+				/* it's a failure, it's not possible to choose a pivot for this empty column */
+				goto failure;
+			}
+			if (j != c)
+			{
+				/* swap rows c and j, and the partial sums */
+				t = m->row[c];
+				m->row[c] = m->row[j];
+				m->row[j] = t;
+				tmp_slot = row_slot[c];
+				row_slot[c] = row_slot[j];
+				row_slot[j] = tmp_slot;
+			}
+			for (pattern = of_m4ri_read_bits (m->row[c], c0, i); pattern != 0; pattern &= pattern - 1)
+			{
+				s = c0 + of_m4ri_lowest_bit (pattern);
+				of_m4ri_xor_words (m->row[c] + wb, m->row[s] + wb, w - wb);
+				if (of_ml_symbol_ops_add (ops, row_slot[c], row_slot[s]) != OF_STATUS_OK)
+					goto no_mem;
+			}
+			for (s = c0; s < c; s++)
+			{
+				if (of_mod2_getbit (m->row[s][c >> of_mod2_wordsize_shift], c & of_mod2_wordsize_mask))
+				{
+					of_m4ri_xor_words (m->row[s] + wb, m->row[c] + wb, w - wb);
+					if (of_ml_symbol_ops_add (ops, row_slot[s], row_slot[c]) != OF_STATUS_OK)
+						goto no_mem;
+				}
+			}
+		}
+		/*
+		 * Step 2: build the table of the 2^k pivot row combinations, in Gray code order so
+		 * that each entry costs a single row XOR.
+		 */
+		memset (row_tab, 0, w * sizeof (of_mod2word));
+		for (prev_g = 0, i = 1; i < (1 << k); i++, prev_g = g)
+		{
+			g = i ^ (i >> 1);
+			t = row_tab + g * w;
+			memcpy (t + wb, row_tab + prev_g * w + wb, (w - wb) * sizeof (of_mod2word));
+			of_m4ri_xor_words (t + wb, m->row[c0 + of_m4ri_lowest_bit (g ^ prev_g)] + wb, w - wb);
+		}
+		/*
+		 * Step 3: eliminate the block columns from all the rows below the pivots.
+		 */
+		of_m4ri_symbol_table_init (sym_tab, row_slot + c0, k);
+		for (j = c0 + k; j < p; j++)
+		{
+			if ((pattern = of_m4ri_read_bits (m->row[j], c0, k)) == 0)
+				continue;
+			of_m4ri_xor_words (m->row[j] + wb, row_tab + pattern * w + wb, w - wb);
+			if (!of_m4ri_symbol_table_get (ops, sym_tab, pattern, &sum) ||
+			    of_ml_symbol_ops_add (ops, row_slot[j], sum) != OF_STATUS_OK)
+			{
+				of_m4ri_symbol_table_clear (ops, sym_tab, k);
+				goto no_mem;
+			}
+		}
+		if (!of_m4ri_symbol_table_clear (ops, sym_tab, k))
+			goto no_mem;
+	}
+	of_free (sym_tab);
+	of_free (row_tab);
+	OF_EXIT_FUNCTION
+	return 1;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory"))
+failure:
+	if (sym_tab)
+		of_free (sym_tab);
+	if (row_tab)
+		of_free (row_tab);
+	OF_EXIT_FUNCTION
+	return 0;
+}
+
+
+static
+INT32	of_linear_binary_code_m4ri_backward_substitution (of_linear_binary_code_cb_t	*ofcb,
+							  of_mod2dense			*m,
+							  of_ml_symbol_ops_t		*ops,
+							  UINT32			*row_slot)
+{
+	of_m4ri_symbol_table_t	*sym_tab;
+	of_mod2word	*row;
+	UINT32		src[OF_ML_M4RI_MAX_K];	/* variables to add */
+	UINT32		nb_src;
+	UINT32		sum;
+	INT32		n;
+	INT32		b0, b1;		/* the block is made of variables b0 to b1 - 1 */
+	INT32		k;
+	INT32		i, j;
+	UINT32		pattern;
+
+	OF_ENTER_FUNCTION
+	n = of_mod2dense_cols (m);
+	if ((sym_tab = (of_m4ri_symbol_table_t*) of_malloc (sizeof (of_m4ri_symbol_table_t))) == NULL)
+	{
+		goto no_mem;
+	}
+	for (b1 = n; b1 > 0; b1 = b0)
+	{
+		k = of_m4ri_block_width (ofcb, b1, b1);
+		b0 = b1 - k;
+		/*
+		 * the constant terms of the block rows already include the variables of the next
+		 * blocks, so only the variables of the block remain to be added.
+		 */
+		for (i = b1 - 1; i >= b0; i--)
+		{
+			row = m->row[i];
+			ASSERT(of_mod2_getbit(row[i >> of_mod2_wordsize_shift], i & of_mod2_wordsize_mask))
+			nb_src = 0;
+			for (j = i + 1; j < b1; j++)
+			{
+				if (of_mod2_getbit(row[j >> of_mod2_wordsize_shift], j & of_mod2_wordsize_mask))
+				{
+					src[nb_src++] = row_slot[j];
+				}
+			}
+			if (nb_src != 0 && of_ml_symbol_ops_add_from_multiple (ops, row_slot[i], src, nb_src) != OF_STATUS_OK)
+			{
+				goto no_mem;
 			}
 		}
+		/* then add the block variables to the constant terms of all the rows above */
+		of_m4ri_symbol_table_init (sym_tab, row_slot + b0, k);
+		for (i = 0; i < b0; i++)
+		{
+			if ((pattern = of_m4ri_read_bits (m->row[i], b0, k)) == 0)
+				continue;
+			if (!of_m4ri_symbol_table_get (ops, sym_tab, pattern, &sum) ||
+			    of_ml_symbol_ops_add (ops, row_slot[i], sum) != OF_STATUS_OK)
+			{
+				of_m4ri_symbol_table_clear (ops, sym_tab, k);
+				goto no_mem;
+			}
+		}
+		if (!of_m4ri_symbol_table_clear (ops, sym_tab, k))
+			goto no_mem;
 	}
+	of_free (sym_tab);
 	OF_EXIT_FUNCTION
 	return 1;
+
+no_mem:
+	OF_PRINT_ERROR(("out of memory"))
+	if (sym_tab)
+		of_free (sym_tab);
+	OF_EXIT_FUNCTION
+	return 0;
 }
 
 
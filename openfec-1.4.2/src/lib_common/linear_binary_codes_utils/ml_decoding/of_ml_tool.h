@@ -47,10 +47,20 @@
 #define OP_ARG_VAL
 #endif
 
+/* OF_ML_M4RI_MAX_K and OF_ML_M4RI_DEFAULT_K, the M4RI block widths an application can
+ * set, are defined with OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K */
+#include "../../../lib_stable/ldpc_staircase/of_ldpc_staircase_api.h"
+
 
 /**
  * This function solves the system: first triangularize the system, then for each column,
  * do a forward elimination, then do the backward elimination.
+ * If ofcb->ml_m4ri_k is not 0, both steps process blocks of up to ofcb->ml_m4ri_k columns
+ * at once with the Method of Four Russians: each row is updated with a single row and
+ * symbol XOR taken from lookup tables of the linear combinations of the block pivots.
+ * If ofcb->ml_deferred_symbol_ops is set, the symbol XORs are only executed once the
+ * system is solved, after being merged and after dropping those that do not contribute
+ * to the needed variables (see of_ml_symbol_ops.h).
  *
  * @fn INT32			of_linear_binary_code_solve_dense_system (of_mod2dense *m,void ** constant_member,void **variables,of_linear_binary_code_cb_t *ofcb)
  * @brief			solves the system
@@ -58,13 +68,37 @@
  * @param variables
  * @param constant_member	(IN/OUT)pointer to all constant members
  * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
+ * @param nb_unneeded_variables	(IN) the first nb_unneeded_variables variables are not needed,
+ *				their buffers (if not NULL) may not be up to date.
  * @return			error status
  */
 of_status_t
 of_linear_binary_code_solve_dense_system (of_linear_binary_code_cb_t	*ofcb,
 					  of_mod2dense		*m,
 					  void			**constant_tab,
-					  void			**variable_tab);
+					  void			**variable_tab,
+					  UINT32		nb_unneeded_variables);
+
+
+/**
+ * This function records in ops the symbol operations that solve the system, without
+ * executing them: the rows of m are eliminated as in of_linear_binary_code_solve_dense_system(),
+ * and once done variable i is the symbol of slot row_slot[i]. It lets a caller solve a dense
+ * system as a step of a larger symbol operation list.
+ *
+ * @param ofcb			(IN/OUT) Linear-Binary-Code control-block.
+ * @param m 			(IN/OUT) address of the dense matrix.
+ * @param ops			(IN/OUT) symbol operations on the constant terms.
+ * @param row_slot		(IN/OUT) constant term symbol of each row, then variable symbol
+ *				of each of the first of_mod2dense_cols(m) rows.
+ * @return			OF_STATUS_OK, or OF_STATUS_FAILURE if the system cannot be solved
+ *				(or if out of memory).
+ */
+of_status_t
+of_linear_binary_code_eliminate_dense_system (of_linear_binary_code_cb_t	*ofcb,
+					      of_mod2dense		*m,
+					      of_ml_symbol_ops_t	*ops,
+					      UINT32			*row_slot);
 
 
 #endif //ML_DECODING				   
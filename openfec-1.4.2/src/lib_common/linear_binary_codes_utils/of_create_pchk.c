@@ -63,6 +63,7 @@ of_mod2sparse* of_create_pchk_matrix_general (UINT32		nb_rows,
 	UINT32 col_end = 0;
 	INT32 i;
 	of_mod2sparse *pchkMatrix = NULL;
+	UINT64 prng_state;	/* PRNG of this matrix, so that sessions can be created concurrently */
 
 	OF_ENTER_FUNCTION
 	if (type != TypeLDGM && type != TypeSTAIRS && type != TypeTRIANGLE && type != TypeREGULAR_LDPC)
@@ -86,7 +87,7 @@ of_mod2sparse* of_create_pchk_matrix_general (UINT32		nb_rows,
 		OF_EXIT_FUNCTION
 		return NULL;
 	}
-	of_rfc5170_srand (seed);
+	of_rfc5170_srand_r (&prng_state, seed);
 	pchkMatrix = of_mod2sparse_allocate (nb_rows, nb_cols);
 
 	switch (type) {
@@ -108,7 +109,7 @@ of_mod2sparse* of_create_pchk_matrix_general (UINT32		nb_rows,
 		break;
 	}
 	of_fill_regular_pchk_matrix (pchkMatrix, row_start, row_end, col_start, col_end, make_method,
-				     left_degree, no4cycle, verbosity);
+				     left_degree, &prng_state, no4cycle, verbosity);
 
 	switch (type) {
 	case TypeLDGM:
@@ -203,6 +204,7 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 					    UINT32		col_end,
 					    make_method		make_method,
 					    UINT32		left_degree,
+					    UINT64		*prng_state,
 					    bool		no4cycle,
 					    UINT8		verbosity)
 {
@@ -227,7 +229,7 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 			{
 				do
 				{
-					i = of_rfc5170_rand (nb_row);
+					i = of_rfc5170_rand_r (prng_state, nb_row);
 				}
 				while (of_mod2sparse_find (pchkMatrix, i, j));
 				of_mod2sparse_insert (pchkMatrix, i, j);
@@ -260,7 +262,7 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 					/* choose one index within the list of possible choices */
 					do
 					{
-						i = t + of_rfc5170_rand (left_degree * nb_col - t);
+						i = t + of_rfc5170_rand_r (prng_state, left_degree * nb_col - t);
 					}
 					while (of_mod2sparse_find (pchkMatrix, u[i], j));
 					of_mod2sparse_insert (pchkMatrix, u[i], j);
@@ -274,7 +276,7 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 					uneven += 1;
 					do
 					{
-						i = of_rfc5170_rand (nb_row);
+						i = of_rfc5170_rand_r (prng_state, nb_row);
 					}
 					while (of_mod2sparse_find (pchkMatrix, i, j));
 					of_mod2sparse_insert (pchkMatrix, i, j);
@@ -300,7 +302,7 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 		e = of_mod2sparse_first_in_row (pchkMatrix, i);
 		if (of_mod2sparse_at_end (e))
 		{
-			j = (of_rfc5170_rand (nb_col) + col_start);
+			j = (of_rfc5170_rand_r (prng_state, nb_col) + col_start);
 			e = of_mod2sparse_insert (pchkMatrix, i, j);
 			added ++;
 		}
@@ -309,7 +311,7 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 		{
 			do
 			{
-				j = (of_rfc5170_rand (nb_col)) + col_start;
+				j = (of_rfc5170_rand_r (prng_state, nb_col)) + col_start;
 			}
 			while (j == of_mod2sparse_col (e));
 			of_mod2sparse_insert (pchkMatrix, i, j);
@@ -330,8 +332,8 @@ of_mod2sparse* of_fill_regular_pchk_matrix (of_mod2sparse	*m,
 		{
 			do
 			{
-				i = of_rfc5170_rand (nb_row);
-				j = (of_rfc5170_rand (nb_col)) + col_start;
+				i = of_rfc5170_rand_r (prng_state, nb_row);
+				j = (of_rfc5170_rand_r (prng_state, nb_col)) + col_start;
 			}
 			while (of_mod2sparse_find (pchkMatrix, i, j));
 			of_mod2sparse_insert (pchkMatrix, i, j);
@@ -105,6 +105,7 @@ of_mod2sparse*	of_create_pchk_matrix_general  (UINT32		nb_rows,
  * @param col_end	(IN) number of col to stop
  * @param make_method	(IN) method to fill the matrix
  * @param left_degree	(IN) number of "1" entry for each column
+ * @param prng_state	(IN/OUT) state of the PRNG, see of_rfc5170_srand_r()
  * @param no4cycle	(IN) with or without cycles
  * @param verbosity	(IN) verbosity level
  * @param stats		(IN/OUT) memory statistics (can be NULL)
@@ -117,6 +118,7 @@ of_mod2sparse*	of_fill_regular_pchk_matrix    (of_mod2sparse*	m,
 						UINT32		col_end,
 						make_method	make_method,
 						UINT32		left_degree,
+						UINT64*		prng_state,
 						bool		no4cycle,
 						UINT8		verbosity);
 
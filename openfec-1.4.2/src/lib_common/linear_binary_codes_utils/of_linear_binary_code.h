@@ -59,6 +59,8 @@
 #include "../statistics/of_statistics.h"
 
 #include "binary_matrix/of_matrix_sparse.h"
+#include "binary_matrix/of_matrix_sparse_idx.h"
+#include "binary_matrix/of_matrix_sparse_file.h"
 #include "binary_matrix/of_matrix_dense.h"
 #include "of_create_pchk.h"
 
@@ -85,6 +87,17 @@ typedef struct of_linear_binary_code_cb
 	UINT32		nb_total_symbols;	/** n parameter (AKA code length). */
 	/* parity check matrix */
 	of_mod2sparse*	pchk_matrix;
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	/* index-based copy of pchk_matrix used by the IT decoder (if any) */
+	of_mod2sparse_idx	*pchk_matrix_idx;
+#endif
+#ifdef OF_USE_DECODER
+	/* pool providing the repair symbol copies and the partial sums (NULL: use the heap) */
+	of_symbol_pool_t	*symbol_pool;
+	/* in zero-copy mode, tells for each repair symbol if the buffer stored in
+	 * encoding_symbols_tab belongs to the application (NULL if not in zero-copy mode) */
+	UINT8		*tab_repair_is_app_buffer;
+#endif
 
 	/** statistics for this codec instance. */
 	of_symbol_stats_op_t	*stats_xor;
@@ -108,6 +121,13 @@ typedef struct of_linear_binary_code_cb
 	UINT32		dec_step;		// Current step in the Gauss decoding algorithm
 	UINT32		threshold_simplification;// threshold (number of symbols) above which we
 						// run the Gaussian Elimination algorithm
+	bool		ml_inactivation; // solve the simplified system by inactivation decoding rather than as a whole dense system
+	UINT32		ml_m4ri_k;	// maximum M4RI block width of the dense elimination (0: column by column)
+	UINT32		ml_nb_dense_cols; // number of columns of the last dense system built by ML decoding (inactive columns with inactivation decoding)
+	bool		ml_deferred_symbol_ops;	// record the symbol XORs of the dense system, optimize then execute them
+	UINT32		ml_nb_threads;	// number of threads executing the deferred symbol XORs
+	UINT32		ml_nb_symbol_xor; // number of symbol XORs requested while solving the last dense system
+	UINT32		ml_nb_saved_symbol_xor; // number of those XORs not executed thanks to the deferred mode
 #endif
 
 #ifdef OF_USE_DECODER /* { */
@@ -141,7 +161,9 @@ typedef struct of_linear_binary_code_cb
 
 #include "it_decoding/of_it_decoding.h"
 #include "ml_decoding/of_ml_decoding.h"
+#include "ml_decoding/of_ml_symbol_ops.h"
 #include "ml_decoding/of_ml_tool.h"
+#include "ml_decoding/of_ml_inactivation.h"
 
 
 #endif
@@ -48,6 +48,18 @@
  *   The printf code is only compiled in OF_DEBUG mode, there's no code otherwise.
  */
 
+/**
+ * The global verbosity level. Sessions created concurrently (OF_USE_PTHREADS) all
+ * set it, so it is read and written atomically.
+ */
+#ifdef __GNUC__
+#define OF_GET_VERBOSITY()	__atomic_load_n (&of_verbosity, __ATOMIC_RELAXED)
+#define OF_SET_VERBOSITY(v)	__atomic_store_n (&of_verbosity, (v), __ATOMIC_RELAXED)
+#else
+#define OF_GET_VERBOSITY()	(of_verbosity)
+#define OF_SET_VERBOSITY(v)	(of_verbosity = (v))
+#endif
+
 /**
  * Print to stdout.
  */
@@ -56,7 +68,7 @@
 /**
  * Print to stdout with a verbosity level.
  */
-#define OF_PRINT_LVL(l, a)	if (of_verbosity >= (l)) {		\
+#define OF_PRINT_LVL(l, a)	if (OF_GET_VERBOSITY() >= (l)) {	\
 					printf a;			\
 					fflush(stdout);			\
 				}
@@ -75,7 +87,7 @@
  * Trace with a level in OF_DEBUG mode only
  */
 #ifdef OF_DEBUG
-#define OF_TRACE_LVL(l, a) 	if (of_verbosity >= (l)) {		\
+#define OF_TRACE_LVL(l, a) 	if (OF_GET_VERBOSITY() >= (l)) {	\
 					printf a;			\
 					fflush(stdout);			\
 				}
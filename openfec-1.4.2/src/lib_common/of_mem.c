@@ -33,10 +33,27 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include "of_openfec_api.h"
 
+
+/** number of allocations done so far, for statistics purposes. */
+static UINT32	of_nb_allocs = 0;
+
+/* sessions may allocate memory concurrently from several threads */
+#if defined(OF_USE_PTHREADS) && defined(__GNUC__)
+#define OF_COUNT_ALLOC()	__sync_fetch_and_add (&of_nb_allocs, 1)
+#define OF_NB_ALLOCS()		__sync_fetch_and_add (&of_nb_allocs, 0)
+#else
+#define OF_COUNT_ALLOC()	of_nb_allocs++
+#define OF_NB_ALLOCS()		of_nb_allocs
+#endif
+
+
 void* of_malloc (size_t	size)
 {
+	OF_COUNT_ALLOC();
 	return malloc (size);
 }
 
@@ -44,6 +61,7 @@ void* of_malloc (size_t	size)
 void* of_calloc (size_t	nmemb,
 		 size_t	size)
 {
+	OF_COUNT_ALLOC();
 	return calloc (nmemb, size);
 }
 
@@ -51,6 +69,7 @@ void* of_calloc (size_t	nmemb,
 void* of_realloc (void* ptr,
 		  size_t size)
 {
+	OF_COUNT_ALLOC();
 	return realloc (ptr, size);
 
 }
@@ -64,6 +83,121 @@ void  of_free (void* ptr)
 }
 
 
+UINT32 of_get_nb_allocs (void)
+{
+	return OF_NB_ALLOCS();
+}
+
+
+of_symbol_pool_t* of_symbol_pool_create (UINT32	symbol_size,
+					 UINT32	nb_symbols)
+{
+	of_symbol_pool_t	*pool;
+
+	if ((pool = (of_symbol_pool_t*) of_calloc (1, sizeof (of_symbol_pool_t))) == NULL)
+	{
+		return NULL;
+	}
+	pool->symbol_size = symbol_size;
+	/* a released buffer must be able to hold the free list link */
+	pool->stride = (symbol_size < sizeof (void*)) ? sizeof (void*) : symbol_size;
+	pool->stride = (pool->stride + OF_SYMBOL_POOL_ALIGNMENT - 1) & ~(OF_SYMBOL_POOL_ALIGNMENT - 1);
+	pool->nb_symbols = nb_symbols;
+	if ((pool->mem = of_malloc ((size_t)nb_symbols * pool->stride + OF_SYMBOL_POOL_ALIGNMENT)) == NULL)
+	{
+		of_free (pool);
+		return NULL;
+	}
+	pool->base = (char*)(((uintptr_t)pool->mem + OF_SYMBOL_POOL_ALIGNMENT - 1) & ~(uintptr_t)(OF_SYMBOL_POOL_ALIGNMENT - 1));
+	of_symbol_pool_reset (pool);
+	return pool;
+}
+
+
+void of_symbol_pool_release (of_symbol_pool_t*	pool)
+{
+	if (pool != NULL)
+	{
+		of_free (pool->mem);
+		of_free (pool);
+	}
+}
+
+
+void of_symbol_pool_reset (of_symbol_pool_t*	pool)
+{
+	pool->nb_used = 0;
+	pool->free_list = NULL;
+	pool->nb_pool_allocs = 0;
+	pool->nb_heap_allocs = 0;
+}
+
+
+void* of_symbol_pool_malloc (of_symbol_pool_t*	pool,
+			     size_t		size)
+{
+	void	*ptr;
+
+	if (pool == NULL || size > pool->symbol_size)
+	{
+		if (pool != NULL)
+		{
+			pool->nb_heap_allocs++;
+		}
+		return of_malloc (size);
+	}
+	if ((ptr = pool->free_list) != NULL)
+	{
+		pool->free_list = *(void**)ptr;
+	}
+	else if (pool->nb_used < pool->nb_symbols)
+	{
+		ptr = pool->base + (size_t)pool->nb_used * pool->stride;
+		pool->nb_used++;
+	}
+	else
+	{
+		/* pool exhausted */
+		pool->nb_heap_allocs++;
+		return of_malloc (size);
+	}
+	pool->nb_pool_allocs++;
+	return ptr;
+}
+
+
+void* of_symbol_pool_calloc (of_symbol_pool_t*	pool,
+			     size_t		size)
+{
+	void	*ptr;
+
+	if (pool == NULL)
+	{
+		return of_calloc (1, size);
+	}
+	if ((ptr = of_symbol_pool_malloc (pool, size)) != NULL)
+	{
+		memset (ptr, 0, size);
+	}
+	return ptr;
+}
+
+
+void of_symbol_pool_free (of_symbol_pool_t*	pool,
+			  void*			ptr)
+{
+	if (of_symbol_pool_owns (pool, ptr))
+	{
+		*(void**)ptr = pool->free_list;
+		pool->free_list = ptr;
+	}
+	else
+	{
+		of_free (ptr);
+	}
+}
+
+
 #if 0
 void of_dump_buffer (char* buf, UINT32 size)
 {
@@ -39,6 +39,8 @@
 #ifndef OF_MEM_H
 #define OF_MEM_H
 
+#include <stddef.h>
+
 
 /**
  * @fn			inline void*	of_malloc (size_t size)
@@ -74,5 +76,104 @@ void*	of_realloc (void* ptr, size_t size);
  */
 void	of_free (void* ptr);
 
+/**
+ * @fn			UINT32		of_get_nb_allocs (void)
+ * @brief		get the number of allocations done so far with of_malloc(), of_calloc() and
+ *			of_realloc(), by all sessions. Used for statistics purposes.
+ * @return		number of allocations
+ */
+UINT32	of_get_nb_allocs (void);
+
+
+/*
+ * Symbol pool.
+ *
+ * A symbol pool provides symbol buffers of a given size out of a single
+ * memory block, allocated once. Each buffer is aligned on
+ * OF_SYMBOL_POOL_ALIGNMENT bytes. Released buffers are kept in a free list
+ * for later use, and the whole pool can be reset in O(1), e.g. between two
+ * blocks, once all the buffers are known to be useless. When the pool is
+ * exhausted, buffers are taken from the heap.
+ *
+ * All the functions below accept a NULL pool, in which case they simply
+ * use the heap.
+ */
+
+/** Alignment, in bytes, of the buffers provided by a symbol pool. */
+#define OF_SYMBOL_POOL_ALIGNMENT	32
+
+typedef struct of_symbol_pool
+{
+	UINT32		symbol_size;	/* size of a symbol buffer, as requested */
+	UINT32		stride;		/* size of a symbol buffer, rounded up to the alignment */
+	UINT32		nb_symbols;	/* number of buffers in the memory block */
+	UINT32		nb_used;	/* number of buffers taken from the memory block since last reset */
+	void		*free_list;	/* buffers released since last reset, linked through their first word */
+	char		*base;		/* first (aligned) buffer of the memory block */
+	void		*mem;		/* memory block, as returned by of_malloc() */
+	UINT32		nb_pool_allocs;	/* number of buffers provided by the pool since last reset */
+	UINT32		nb_heap_allocs;	/* number of buffers taken from the heap since last reset */
+} of_symbol_pool_t;
+
+/**
+ * @fn			of_symbol_pool_t* of_symbol_pool_create (UINT32 symbol_size, UINT32 nb_symbols)
+ * @brief		create a symbol pool
+ * @param symbol_size	(IN) size in bytes of each buffer
+ * @param nb_symbols	(IN) number of buffers that can be provided before using the heap
+ * @return		pool or NULL if error.
+ */
+of_symbol_pool_t* of_symbol_pool_create (UINT32 symbol_size, UINT32 nb_symbols);
+
+/**
+ * @fn			void		of_symbol_pool_release (of_symbol_pool_t* pool)
+ * @brief		release a symbol pool. All the buffers it provided become invalid.
+ * @param pool		(IN) pool
+ */
+void	of_symbol_pool_release (of_symbol_pool_t* pool);
+
+/**
+ * @fn			void		of_symbol_pool_reset (of_symbol_pool_t* pool)
+ * @brief		make all the buffers of the pool available again, in O(1). All the buffers
+ *			provided by the pool become invalid, those taken from the heap must have
+ *			been released with of_symbol_pool_free() first.
+ * @param pool		(IN) pool
+ */
+void	of_symbol_pool_reset (of_symbol_pool_t* pool);
+
+/**
+ * @fn			void*		of_symbol_pool_malloc (of_symbol_pool_t* pool, size_t size)
+ * @brief		get a symbol buffer
+ * @param pool		(IN) pool, or NULL
+ * @param size		(IN) size of the buffer, must be lower than or equal to the pool symbol size
+ * @return		allocated pointer or NULL if error.
+ */
+void*	of_symbol_pool_malloc (of_symbol_pool_t* pool, size_t size);
+
+/**
+ * @fn			void*		of_symbol_pool_calloc (of_symbol_pool_t* pool, size_t size)
+ * @brief		get a symbol buffer, set to zero
+ * @param pool		(IN) pool, or NULL
+ * @param size		(IN) size of the buffer, must be lower than or equal to the pool symbol size
+ * @return		allocated pointer or NULL if error.
+ */
+void*	of_symbol_pool_calloc (of_symbol_pool_t* pool, size_t size);
+
+/**
+ * @fn			void		of_symbol_pool_free (of_symbol_pool_t* pool, void* ptr)
+ * @brief		release a symbol buffer, that has been provided either by the pool or by the heap
+ * @param pool		(IN) pool, or NULL
+ * @param ptr		(IN) buffer
+ */
+void	of_symbol_pool_free (of_symbol_pool_t* pool, void* ptr);
+
+/**
+ * @brief		check if a buffer belongs to the memory block of a pool
+ * @param pool		(IN) pool, or NULL
+ * @param ptr		(IN) buffer
+ * @return		boolean
+ */
+#define of_symbol_pool_owns(pool,ptr)	((pool) != NULL && (char*)(ptr) >= (pool)->base && \
+					 (char*)(ptr) < (pool)->base + (size_t)(pool)->nb_symbols * (pool)->stride)
+
 
 #endif  //OF_MEM_H
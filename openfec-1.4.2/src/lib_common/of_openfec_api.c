@@ -59,7 +59,8 @@ of_status_t	of_create_codec_instance (of_session_t**	ses,
 	of_status_t	status;
 	
 	OF_ENTER_FUNCTION
-	of_verbosity = verbosity;
+	/* the verbosity is global, and sessions may be created concurrently */
+	OF_SET_VERBOSITY (verbosity);
 	/**
 	 * each codec must realloc control block.
 	 */
@@ -721,7 +722,7 @@ of_status_t	of_set_control_parameter (of_session_t*	ses,
 	{
 #ifdef OF_USE_REED_SOLOMON_CODEC
 		case OF_CODEC_REED_SOLOMON_GF_2_8_STABLE:
-			//status = of_rs_set_control_parameter ( (of_rs_cb_t*) ses, type, value, length);
+			status = of_rs_set_control_parameter ( (of_rs_cb_t*) ses, type, value, length);
 			break;
 #endif
 #ifdef OF_USE_REED_SOLOMON_2_M_CODEC
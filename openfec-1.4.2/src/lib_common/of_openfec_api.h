@@ -56,6 +56,7 @@
 #include "../lib_advanced/ldpc_from_file/of_ldpc_ff_api.h"
 #endif
 #include "of_debug.h"
+#include "of_mem.h"
 
 
 /****** OpenFEC.org general definitions ***********************************************************/
@@ -341,6 +342,9 @@ of_status_t	of_set_callback_functions (of_session_t	*ses,
  * can either be set to NULL, in which case the library allocates a buffer and copies the
  * newly built symbol to it, or point to a buffer allocated by the application, in which
  * case the library only copies the newly built symbol to it.
+ * With OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, where repair symbols only depend on the source
+ * symbols, several threads can build distinct repair symbols of the same session
+ * concurrently, provided their entries point to buffers allocated by the application.
  *
  * @fn		of_status_t	of_build_repair_symbol (of_session_t* ses, void* encoding_symbols_tab[], UINT32	esi_of_symbol_to_build)
  * @brief			build a repair symbol (encoder only)
@@ -548,6 +552,24 @@ of_status_t	of_get_control_parameter (of_session_t*	ses,
 					  UINT32	length);
 
 
+#if defined(OF_USE_LDPC_FROM_FILE_CODEC) && defined(OF_USE_MMAP)
+/**
+ * Convert a human readable parity check matrix file into a binary one, that
+ * of_set_fec_parameters() maps in memory rather than parsing it. This is the
+ * format to use for large matrices, when the session setup time matters.
+ *
+ * @fn of_status_t	of_ldpc_ff_write_binary_matrix_file (char* matrix_file, char* binary_matrix_file)
+ * @brief		convert a parity check matrix file into a binary one
+ * @param matrix_file	(IN) name of the human readable matrix file
+ * @param binary_matrix_file
+ *			(IN) name of the binary matrix file to write
+ * @return		Error status.
+ */
+of_status_t	of_ldpc_ff_write_binary_matrix_file (char*	matrix_file,
+						     char*	binary_matrix_file);
+#endif
+
+
 /**
  * Control parameters for of_set_control_parameter()/of_get_control_parameter() functions:
  *   - range {0 .. 1023} inclusive are for generic parameters;
@@ -69,6 +69,45 @@
 #define OF_USE_LINEAR_BINARY_CODES_UTILS
 #define OF_USE_GALOIS_FIELD_CODES_UTILS
 
+/**
+ * Define if the IT decoder should work on an index-based copy of the
+ * parity check matrix (contiguous 32-bit row/column index arrays, see
+ * binary_matrix/of_matrix_sparse_idx.h) rather than on the linked-list
+ * one. This reduces the memory used per matrix entry and improves cache
+ * locality when walking rows and columns, at the cost of a conversion
+ * when the first symbol is received and before ML decoding.
+ */
+#ifndef OF_USE_INDEXED_SPARSE_MATRIX
+//#define OF_USE_INDEXED_SPARSE_MATRIX
+#endif
+
+/**
+ * Define if the library can use POSIX threads. This lets the ML decoder execute the
+ * symbol operations of the dense system with several threads, each of them processing
+ * its own byte range of the symbols (see OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS), and
+ * the Reed-Solomon GF(2^8) decoder split the missing symbols the same way (see
+ * OF_CRTL_REED_SOLOMON_SET_NB_THREADS).
+ * It also makes the one-time initializations of the library (e.g. the Reed-Solomon
+ * GF(2^8) tables) thread-safe, so that independent sessions can be used concurrently,
+ * one per thread. The application must then be linked with the pthread library.
+ * This define is required to use the library from several threads: without it, the
+ * sessions must be created from one thread at a time.
+ */
+#ifndef OF_USE_PTHREADS
+//#define OF_USE_PTHREADS
+#endif
+
+/**
+ * Define if the library can map files in memory with the POSIX mmap() function. This
+ * lets LDPC-Staircase sessions keep their parity check matrices in an on-disk cache
+ * (see OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR) rather than generating them again.
+ */
+#ifndef OF_USE_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define OF_USE_MMAP
+#endif
+#endif
+
 /**
  * Define if you need SSE optimizations for XOR operations.
  * This is useful for PC usage, with processors that support this
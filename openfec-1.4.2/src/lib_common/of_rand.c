@@ -250,19 +250,26 @@ of_check_prng (void)
  * (2^^31-2) inclusive.
  */
 void of_rfc5170_srand (UINT64 s)
+{
+	of_rfc5170_srand_r (&of_seed, s);
+}
+
+
+void of_rfc5170_srand_r (UINT64	*state,
+			 UINT64	s)
 {
 	OF_ENTER_FUNCTION
 	if ( (s >= 1) && (s <= 0x7FFFFFFE))
-		of_seed = s;
+		*state = s;
 	else
 	{
-		fprintf (stderr, "ldpc_rand: ERROR, seed (%llu) out of range\n", of_seed);
+		fprintf (stderr, "ldpc_rand: ERROR, seed (%llu) out of range\n", s);
 		OF_EXIT_FUNCTION
 		return;
 	}
 #if CHECK_PRNG_CONFORMITY
 	check_PRNG();
-	of_seed = s;
+	*state = s;
 #endif
 	OF_EXIT_FUNCTION
 }
@@ -281,18 +288,25 @@ void of_rfc5170_srand (UINT64 s)
  */
 UINT64
 of_rfc5170_rand (UINT64	maxv)
+{
+	return of_rfc5170_rand_r (&of_seed, maxv);
+}
+
+
+UINT64
+of_rfc5170_rand_r (UINT64	*state,
+		   UINT64	maxv)
 {
 	//OF_ENTER_FUNCTION
 	UINT64	hi, lo;
-	lo = 16807 * (of_seed & 0xFFFF);
-	hi = 16807 * (of_seed >> 16);
+	lo = 16807 * (*state & 0xFFFF);
+	hi = 16807 * (*state >> 16);
 	lo += (hi & 0x7FFF) << 16;
 	lo += hi >> 15;
 	if (lo > 0x7FFFFFFF)
 		lo -= 0x7FFFFFFF;
-	of_seed = (UINT64) lo;
+	*state = (UINT64) lo;
 	//OF_EXIT_FUNCTION
 	return ( (UINT64)
-		 ( (double) of_seed * (double) maxv / (double) 0x7FFFFFFF));
+		 ( (double) *state * (double) maxv / (double) 0x7FFFFFFF));
 }
-
@@ -59,4 +59,29 @@ void		of_rfc5170_srand (UINT64 s);
  */
 UINT64	of_rfc5170_rand (UINT64	maxv);
 
+
+/**
+ * \fn void		of_rfc5170_srand_r (UINT64 *state, UINT64 s)
+ * \brief Reentrant version of of_rfc5170_srand(), that initializes a PRNG
+ * state owned by the caller rather than the global one, so that several
+ * sessions can generate their matrices concurrently.
+ * \param state	(OUT) PRNG state
+ * \param s	(IN) seed
+ * \return 	void
+ */
+void		of_rfc5170_srand_r (UINT64	*state,
+				    UINT64	s);
+
+
+/**
+ * \fn UINT64	of_rfc5170_rand_r (UINT64 *state, UINT64 maxv)
+ * \brief Reentrant version of of_rfc5170_rand(), with a PRNG state
+ * initialized by of_rfc5170_srand_r().
+ * \param state	(IN/OUT) PRNG state
+ * \param maxv	(IN) upper bound
+ * \return Returns a random integer between 0 and maxv-1 inclusive.
+ */
+UINT64	of_rfc5170_rand_r (UINT64	*state,
+			   UINT64	maxv);
+
 #endif //OF_RAND
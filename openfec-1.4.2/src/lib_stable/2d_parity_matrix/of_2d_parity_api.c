@@ -69,6 +69,13 @@ of_status_t	of_2d_parity_release_codec_instance (of_2d_parity_cb_t*	ofcb)
 		of_free (ofcb->pchk_matrix);
 		ofcb->pchk_matrix  = NULL;
 	}
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	if (ofcb->pchk_matrix_idx != NULL)
+	{
+		of_mod2sparse_idx_free (ofcb->pchk_matrix_idx);
+		ofcb->pchk_matrix_idx = NULL;
+	}
+#endif
 	if (ofcb->encoding_symbols_tab != NULL)
 	{
 		/* do not try to free source buffers, it's the responsibility of the application
@@ -186,6 +193,13 @@ of_status_t	of_2d_parity_set_fec_parameters (of_2d_parity_cb_t*	ofcb,
 	OF_TRACE_LVL (1, ("%s: k=%u, n-k=%u, n=%u, symbol_length=%u, PRNG seed=%u, N1=%u\n", __FUNCTION__,
 			ofcb->nb_source_symbols, ofcb->nb_repair_symbols, ofcb->nb_total_symbols,
 			ofcb->encoding_symbol_length, 0, 0))
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	ofcb->pchk_matrix_idx = NULL;
+#endif
+#ifdef OF_USE_DECODER
+	ofcb->symbol_pool = NULL;
+	ofcb->tab_repair_is_app_buffer = NULL;
+#endif
 	ofcb->pchk_matrix = of_create_pchk_matrix (ofcb->nb_repair_symbols, ofcb->nb_total_symbols, Evenboth,
 						   0, 0, false, Type2DMATRIX, 1);
 
@@ -195,7 +209,7 @@ of_status_t	of_2d_parity_set_fec_parameters (of_2d_parity_cb_t*	ofcb,
 		goto error;
 	}
 #ifdef OF_DEBUG
-	if (of_verbosity >= 2)
+	if (OF_GET_VERBOSITY () >= 2)
 	{
 		of_mod2sparse_matrix_stats(stdout, ofcb->pchk_matrix, ofcb->nb_source_symbols, ofcb->nb_repair_symbols);
 	}
@@ -259,6 +273,13 @@ of_status_t	of_2d_parity_set_fec_parameters (of_2d_parity_cb_t*	ofcb,
 	ofcb->dec_step = 0;		// Current step in the Gauss Elimination algorithm
 	ofcb->threshold_simplification = 0; // threshold (number of symbols) above which we
 					// run the Gauss Elimination algorithm
+	ofcb->ml_inactivation = false; // solve the whole simplified system as a dense system
+	ofcb->ml_m4ri_k = 0;	// column by column elimination of the dense system
+	ofcb->ml_nb_dense_cols = 0;
+	ofcb->ml_deferred_symbol_ops = false; // execute the symbol XORs of the dense system immediately
+	ofcb->ml_nb_threads = 1;
+	ofcb->ml_nb_symbol_xor = 0;
+	ofcb->ml_nb_saved_symbol_xor = 0;
 #endif
 
 	OF_EXIT_FUNCTION
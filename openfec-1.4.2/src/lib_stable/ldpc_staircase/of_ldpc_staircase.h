@@ -54,6 +54,17 @@ typedef struct of_ldpc_staircase_cb
 
 	/* parity check matrix */
 	of_mod2sparse	*pchk_matrix;
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	/* index-based copy of pchk_matrix used by the IT decoder (if any) */
+	of_mod2sparse_idx	*pchk_matrix_idx;
+#endif
+#ifdef OF_USE_DECODER
+	/* pool providing the repair symbol copies and the partial sums (NULL: use the heap) */
+	of_symbol_pool_t	*symbol_pool;
+	/* in zero-copy mode, tells for each repair symbol if the buffer stored in
+	 * encoding_symbols_tab belongs to the application (NULL if not in zero-copy mode) */
+	UINT8		*tab_repair_is_app_buffer;
+#endif
 
 	/** usage statistics for this codec instance. */
 	of_symbol_stats_op_t	*stats_xor;
@@ -75,6 +86,13 @@ typedef struct of_ldpc_staircase_cb
 	UINT32		dec_step;	// Current step in the Gauss decoding algorithm
 	UINT32		threshold_simplification; // threshold (number of symbols) above which we
 					// run the Gaussian Elimination algorithm
+	bool		ml_inactivation; // solve the simplified system by inactivation decoding rather than as a whole dense system
+	UINT32		ml_m4ri_k;	// maximum M4RI block width of the dense elimination (0: column by column)
+	UINT32		ml_nb_dense_cols; // number of columns of the last dense system built by ML decoding (inactive columns with inactivation decoding)
+	bool		ml_deferred_symbol_ops;	// record the symbol XORs of the dense system, optimize then execute them
+	UINT32		ml_nb_threads;	// number of threads executing the deferred symbol XORs
+	UINT32		ml_nb_symbol_xor; // number of symbol XORs requested while solving the last dense system
+	UINT32		ml_nb_saved_symbol_xor; // number of those XORs not executed thanks to the deferred mode
 #endif /* } ML_DECODING */
 
 #ifdef OF_USE_DECODER /* { */
@@ -118,6 +136,12 @@ typedef struct of_ldpc_staircase_cb
 	bool		extra_entries_added_in_pchk;
 	/** ESI of first non decoded source symbol. Used by is_decoding_complete function. */
 	UINT32		first_non_decoded;
+#ifdef OF_USE_MMAP
+	/** Directory of the on-disk cache of parity check matrices (NULL: no cache). */
+	char		*pchk_cache_dir;
+	/** Has the parity check matrix been loaded from the cache? */
+	bool		pchk_from_cache;
+#endif
 } of_ldpc_staircase_cb_t;
 
 
@@ -66,6 +66,13 @@ of_status_t	of_ldpc_staircase_release_codec_instance (of_ldpc_staircase_cb_t*	of
 		of_free (ofcb->pchk_matrix);
 		ofcb->pchk_matrix  = NULL;
 	}
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	if (ofcb->pchk_matrix_idx != NULL)
+	{
+		of_mod2sparse_idx_free (ofcb->pchk_matrix_idx);
+		ofcb->pchk_matrix_idx = NULL;
+	}
+#endif
 	if (ofcb->encoding_symbols_tab != NULL)
 	{
 		/* do not try to free source buffers, it's the responsibility of the application
@@ -74,8 +81,12 @@ of_status_t	of_ldpc_staircase_release_codec_instance (of_ldpc_staircase_cb_t*	of
 		{
 			if (ofcb->encoding_symbols_tab[i] != NULL)
 			{
+#ifdef OF_USE_DECODER
+				of_linear_binary_code_free_repair_symbol ((of_linear_binary_code_cb_t*)ofcb, i);
+#else
 				of_free (ofcb->encoding_symbols_tab[i]);
 				ofcb->encoding_symbols_tab[i] = NULL;
+#endif
 			}
 		}
 		of_free (ofcb->encoding_symbols_tab);
@@ -110,12 +121,17 @@ of_status_t	of_ldpc_staircase_release_codec_instance (of_ldpc_staircase_cb_t*	of
 			{
 				if (ofcb->tab_const_term_of_equ[i] != NULL)
 				{
-					of_free (ofcb->tab_const_term_of_equ[i]);
+					of_symbol_pool_free (ofcb->symbol_pool, ofcb->tab_const_term_of_equ[i]);
 					ofcb->tab_const_term_of_equ[i] = NULL;
 				}
 			}
 			of_free(ofcb->tab_const_term_of_equ);
 		}
+		if (ofcb->tab_repair_is_app_buffer != NULL)
+		{
+			of_free (ofcb->tab_repair_is_app_buffer);
+			ofcb->tab_repair_is_app_buffer = NULL;
+		}
 		of_free(ofcb->tmp_tab_symbols);
 		ofcb->tmp_tab_symbols=NULL;
 	}
@@ -149,6 +165,13 @@ of_status_t	of_ldpc_staircase_release_codec_instance (of_ldpc_staircase_cb_t*	of
 		ofcb->pchk_matrix_gauss = NULL;
 	}
 #endif
+#ifdef OF_USE_MMAP
+	if (ofcb->pchk_cache_dir != NULL)
+	{
+		of_free (ofcb->pchk_cache_dir);
+		ofcb->pchk_cache_dir = NULL;
+	}
+#endif
 #ifdef OF_DEBUG
 	if (ofcb->stats_xor != NULL) {
 		of_print_xor_symbols_statistics(ofcb->stats_xor);
@@ -211,7 +234,43 @@ of_status_t	of_ldpc_staircase_set_fec_parameters (of_ldpc_staircase_cb_t*	ofcb,
 	OF_TRACE_LVL (1, ("%s: k=%u, n-k=%u, n=%u, symbol_length=%u, PRNG seed=%u, N1=%u\n", __FUNCTION__,
 			ofcb->nb_source_symbols, ofcb->nb_repair_symbols, ofcb->nb_total_symbols,
 			ofcb->encoding_symbol_length, ofcb->prng_seed, ofcb->N1))
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+	ofcb->pchk_matrix_idx = NULL;
+#endif
+#ifdef OF_USE_DECODER
+	ofcb->symbol_pool = NULL;
+	ofcb->tab_repair_is_app_buffer = NULL;
+#endif
 	/* it's now time to create the parity check matrix! */
+#ifdef OF_USE_MMAP
+	ofcb->pchk_from_cache = false;
+	if (ofcb->pchk_cache_dir != NULL)
+	{
+		of_mod2sparse_key_t	key;
+		UINT32			flags;
+
+		key.generator = OF_MOD2SPARSE_GEN_LDPC_STAIRCASE;
+		key.n_rows = ofcb->nb_repair_symbols;
+		key.n_cols = ofcb->nb_total_symbols;
+		key.left_degree = ofcb->N1;
+		key.seed = ofcb->prng_seed;
+		if ((ofcb->pchk_matrix = of_mod2sparse_cache_load (ofcb->pchk_cache_dir, &key, &flags)) != NULL)
+		{
+			/* the only flag is whether extra entries have been added to H1 */
+			ofcb->extra_entries_added_in_pchk = flags;
+			ofcb->pchk_from_cache = true;
+		}
+		else if ((ofcb->pchk_matrix = of_create_pchck_matrix_rfc5170_compliant (ofcb->nb_repair_symbols,
+				ofcb->nb_total_symbols, ofcb->N1, ofcb->prng_seed, ofcb)) != NULL &&
+			 of_mod2sparse_cache_store (ofcb->pchk_cache_dir, ofcb->pchk_matrix, &key,
+				ofcb->extra_entries_added_in_pchk) != OF_STATUS_OK)
+		{
+			/* not fatal, the next sessions will generate it again */
+			OF_TRACE_LVL(1, ("%s: cannot store the parity check matrix in %s\n", __FUNCTION__, ofcb->pchk_cache_dir))
+		}
+	}
+	else
+#endif
 	ofcb->pchk_matrix = of_create_pchck_matrix_rfc5170_compliant
 						  (ofcb->nb_repair_symbols,
 						   ofcb->nb_total_symbols,
@@ -306,6 +365,13 @@ of_status_t	of_ldpc_staircase_set_fec_parameters (of_ldpc_staircase_cb_t*	ofcb,
 	ofcb->dec_step = 0;		// Current step in the Gauss Elimination algorithm
 	ofcb->threshold_simplification = 0; // threshold (number of symbols) above which we
 					// run the Gauss Elimination algorithm
+	ofcb->ml_inactivation = false; // solve the whole simplified system as a dense system
+	ofcb->ml_m4ri_k = 0;	// column by column elimination of the dense system
+	ofcb->ml_nb_dense_cols = 0;
+	ofcb->ml_deferred_symbol_ops = false; // execute the symbol XORs of the dense system immediately
+	ofcb->ml_nb_threads = 1;
+	ofcb->ml_nb_symbol_xor = 0;
+	ofcb->ml_nb_saved_symbol_xor = 0;
 #endif
 #ifdef OF_USE_DECODER
 	/*
@@ -337,8 +403,11 @@ of_status_t	of_ldpc_staircase_set_fec_parameters (of_ldpc_staircase_cb_t*	ofcb,
 													!= OF_STATUS_OK)
 			{
 				OF_PRINT_ERROR(("%s: ERROR: of_ldpc_staircase_decode_with_new_symbol() failed\n", __FUNCTION__))
+				of_free(null_symbol);
 				goto error;
 			}
+			/* the decoder keeps its own copy of repair symbols */
+			of_free(null_symbol);
 		}
 	}
 #endif //OF_USE_DECODER
@@ -505,7 +574,141 @@ of_status_t	of_ldpc_staircase_set_control_parameter  (of_ldpc_staircase_cb_t*	of
 							  void*				value,
 							  UINT32			length)
 {
-	OF_PRINT_ERROR(("of_ldpc_staircase_set_control_parameter: ERROR, not implemented...\n"))
+	OF_ENTER_FUNCTION
+	switch (type) {
+#ifdef OF_USE_MMAP
+	case OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR:
+		if (value == NULL || length == 0 || ((char*)value)[length - 1] != '\0') {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR ERROR: null value or not a NUL terminated string\n",
+				__FUNCTION__))
+			goto error;
+		}
+		if (ofcb->pchk_matrix != NULL) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR ERROR: must be set before of_set_fec_parameters()\n",
+				__FUNCTION__))
+			goto error;
+		}
+		of_free (ofcb->pchk_cache_dir);
+		if ((ofcb->pchk_cache_dir = (char*) of_malloc (length)) == NULL) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR ERROR: out of memory\n", __FUNCTION__))
+			goto error;
+		}
+		memcpy (ofcb->pchk_cache_dir, value, length);
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR (%s)\n", __FUNCTION__, ofcb->pchk_cache_dir))
+		break;
+#endif
+
+#ifdef OF_USE_DECODER
+	case OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL:
+		if (value == NULL || length != sizeof(of_symbol_pool_t*)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(of_symbol_pool_t*)))
+			goto error;
+		}
+		if (!(ofcb->codec_type & OF_DECODER) || ofcb->symbol_pool != NULL) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL ERROR: not a decoder or pool already set\n", __FUNCTION__))
+			goto error;
+		}
+		if (*(of_symbol_pool_t**)value != NULL &&
+		    (*(of_symbol_pool_t**)value)->symbol_size < ofcb->encoding_symbol_length) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL ERROR: pool symbol size too small (got %d, expected %d)\n",
+				__FUNCTION__, (*(of_symbol_pool_t**)value)->symbol_size, ofcb->encoding_symbol_length))
+			goto error;
+		}
+		ofcb->symbol_pool = *(of_symbol_pool_t**)value;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL (%p)\n", __FUNCTION__, ofcb->symbol_pool))
+		break;
+
+	case OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		if (!(ofcb->codec_type & OF_DECODER) || ofcb->encoding_symbols_tab == NULL) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY ERROR: not a decoder or FEC parameters not set\n", __FUNCTION__))
+			goto error;
+		}
+		if (*(UINT32*)value == 0) {
+			if (ofcb->tab_repair_is_app_buffer != NULL) {
+				OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY ERROR: cannot be disabled\n", __FUNCTION__))
+				goto error;
+			}
+		} else if (ofcb->tab_repair_is_app_buffer == NULL) {
+			if ((ofcb->tab_repair_is_app_buffer = (UINT8*) of_calloc (ofcb->nb_repair_symbols, sizeof(UINT8))) == NULL) {
+				OF_PRINT_ERROR(("%s: out of memory\n", __FUNCTION__))
+				goto error;
+			}
+		}
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY (%d)\n", __FUNCTION__, *(UINT32*)value))
+		break;
+#endif
+
+#ifdef OF_LDPC_STAIRCASE_ML_DECODING
+	case OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		if (*(UINT32*)value > OF_ML_M4RI_MAX_K) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K ERROR: value too large (got %d, max %d)\n",
+				__FUNCTION__, *(UINT32*)value, OF_ML_M4RI_MAX_K))
+			goto error;
+		}
+		ofcb->ml_m4ri_k = *(UINT32*)value;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K (%d)\n", __FUNCTION__, ofcb->ml_m4ri_k))
+		break;
+
+	case OF_CRTL_LDPC_STAIRCASE_SET_ML_DEFERRED_SYMBOL_OPS:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_DEFERRED_SYMBOL_OPS ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		ofcb->ml_deferred_symbol_ops = (*(UINT32*)value != 0);
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_DEFERRED_SYMBOL_OPS (%d)\n", __FUNCTION__, ofcb->ml_deferred_symbol_ops))
+		break;
+
+	case OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+#ifdef OF_USE_PTHREADS
+		if (*(UINT32*)value == 0) {
+#else
+		if (*(UINT32*)value != 1) {
+#endif
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS ERROR: unsupported number of threads (got %d)\n",
+				__FUNCTION__, *(UINT32*)value))
+			goto error;
+		}
+		ofcb->ml_nb_threads = *(UINT32*)value;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS (%d)\n", __FUNCTION__, ofcb->ml_nb_threads))
+		break;
+
+	case OF_CRTL_LDPC_STAIRCASE_SET_ML_INACTIVATION:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_INACTIVATION ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		ofcb->ml_inactivation = (*(UINT32*)value != 0);
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_SET_ML_INACTIVATION (%d)\n", __FUNCTION__, ofcb->ml_inactivation))
+		break;
+#endif
+
+	default:
+		OF_PRINT_ERROR(("%s: unknown type (%d)\n", __FUNCTION__, type))
+		goto error;
+	}
+	OF_EXIT_FUNCTION
+	return OF_STATUS_OK;
+
+error:
+	OF_EXIT_FUNCTION
 	return OF_STATUS_ERROR;
 }
 
@@ -555,6 +758,87 @@ of_status_t	of_ldpc_staircase_get_control_parameter (of_ldpc_staircase_cb_t*	ofc
 		}
 		break;
 
+	case OF_CRTL_LDPC_STAIRCASE_GET_PCHK_BYTES_PER_ENTRY:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_GET_PCHK_BYTES_PER_ENTRY ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+#ifdef OF_USE_INDEXED_SPARSE_MATRIX
+		if (ofcb->pchk_matrix_idx != NULL)
+		{
+			*(UINT32*)value = of_mod2sparse_idx_bytes_per_entry(ofcb->pchk_matrix_idx);
+		}
+		else if (ofcb->pchk_matrix != NULL)
+		{
+			/* the IT decoder has not created it yet, so do it temporarily */
+			of_mod2sparse_idx	*m;
+
+			if ((m = of_mod2sparse_idx_from_sparse(ofcb->pchk_matrix)) == NULL)
+			{
+				goto error;
+			}
+			*(UINT32*)value = of_mod2sparse_idx_bytes_per_entry(m);
+			of_mod2sparse_idx_free(m);
+		}
+		else
+		{
+			goto error;
+		}
+#else
+		if (ofcb->pchk_matrix == NULL)
+		{
+			goto error;
+		}
+		*(UINT32*)value = of_mod2sparse_bytes_per_entry(ofcb->pchk_matrix);
+#endif
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_GET_PCHK_BYTES_PER_ENTRY (%d)\n", __FUNCTION__, *(UINT32*)value))
+		break;
+
+#ifdef OF_USE_MMAP
+	case OF_CRTL_LDPC_STAIRCASE_GET_PCHK_FROM_CACHE:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_GET_PCHK_FROM_CACHE ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		*(UINT32*)value = ofcb->pchk_from_cache;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_GET_PCHK_FROM_CACHE (%d)\n", __FUNCTION__, *(UINT32*)value))
+		break;
+#endif
+
+#ifdef OF_LDPC_STAIRCASE_ML_DECODING
+	case OF_CRTL_LDPC_STAIRCASE_GET_ML_DENSE_COLS:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_GET_ML_DENSE_COLS ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		*(UINT32*)value = ofcb->ml_nb_dense_cols;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_GET_ML_DENSE_COLS (%d)\n", __FUNCTION__, *(UINT32*)value))
+		break;
+
+	case OF_CRTL_LDPC_STAIRCASE_GET_ML_SYMBOL_XORS:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_GET_ML_SYMBOL_XORS ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		*(UINT32*)value = ofcb->ml_nb_symbol_xor;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_GET_ML_SYMBOL_XORS (%d)\n", __FUNCTION__, *(UINT32*)value))
+		break;
+
+	case OF_CRTL_LDPC_STAIRCASE_GET_ML_SAVED_SYMBOL_XORS:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_LDPC_STAIRCASE_GET_ML_SAVED_SYMBOL_XORS ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+		*(UINT32*)value = ofcb->ml_nb_saved_symbol_xor;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_LDPC_STAIRCASE_GET_ML_SAVED_SYMBOL_XORS (%d)\n", __FUNCTION__, *(UINT32*)value))
+		break;
+#endif
+
 	default:
 		OF_PRINT_ERROR(("%s: unknown type (%d)\n", __FUNCTION__, type))
 		goto error;
@@ -76,6 +76,128 @@ typedef struct of_ldpc_parameters
  */
 #define	OF_CRTL_LDPC_STAIRCASE_IS_LAST_SYMBOL_NULL	1024
 
+/**
+ * Ask the OF library how many bytes of memory the parity check matrix uses per
+ * non-zero entry, in the representation used by the IT decoder (linked-list, or
+ * index-based when OF_USE_INDEXED_SPARSE_MATRIX is defined). The per row/column
+ * headers are included.
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_GET_PCHK_BYTES_PER_ENTRY	1025
+
+/**
+ * Set the symbol pool (see of_mem.h) from which a decoder takes the copies of the
+ * received repair symbols and the partial sums of the equations, instead of the heap.
+ * The pool is owned by the application, that must release the session before resetting
+ * or releasing the pool. It is typically reset between blocks and reused by the session
+ * of the next block. The pool symbol size must be at least the encoding symbol length.
+ * This can only be done once, after of_set_fec_parameters().
+ * Argument: of_symbol_pool_t*
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_SYMBOL_POOL		1026
+
+/**
+ * Enable the zero-copy mode of a decoder: the repair symbols given to
+ * of_decode_with_new_symbol() are used in place instead of being copied, which requires
+ * the application to keep these buffers untouched until the session is released.
+ * This must be done after of_set_fec_parameters(), and cannot be undone.
+ * Argument: UINT32 (1 to enable, 0 otherwise)
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_REPAIR_ZERO_COPY	1027
+
+/**
+ * Set the maximum number of columns the ML decoder eliminates at once in the dense system,
+ * with the Method of Four Russians (M4RI). 0 selects the column by column elimination.
+ * The default is 0, OF_ML_M4RI_DEFAULT_K is the recommended width and OF_ML_M4RI_MAX_K
+ * the maximum.
+ * This must be done after of_set_fec_parameters().
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_ML_M4RI_K		1028
+
+/**
+ * Maximum number of columns eliminated at once by the Method of Four Russians (M4RI),
+ * i.e. log2 of the maximum number of entries of the lookup tables.
+ */
+#define OF_ML_M4RI_MAX_K	8
+
+/**
+ * Recommended maximum M4RI block width. The actual width of each block is chosen from
+ * the number of rows the lookup tables are applied to.
+ */
+#define OF_ML_M4RI_DEFAULT_K	OF_ML_M4RI_MAX_K
+
+/**
+ * Ask the OF library the number of columns of the dense system solved by the last ML
+ * decoding (finish_decoding), i.e. the number of symbols IT decoding could not recover.
+ * With inactivation decoding, it is the number of inactive columns.
+ * It is 0 if ML decoding has not been used.
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_GET_ML_DENSE_COLS	1029
+
+/**
+ * Set whether the ML decoder records the symbol XORs of the dense system and optimizes
+ * them (merged into multi-source XORs, dropped if they do not contribute to a decoded
+ * source symbol) before executing them (1), or executes them immediately (0, the default).
+ * This must be done after of_set_fec_parameters().
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_ML_DEFERRED_SYMBOL_OPS	1030
+
+/**
+ * Set the number of threads executing the deferred symbol XORs of the ML decoder, each
+ * of them processing its own byte range of the symbols. Values above 1 require the
+ * library to be built with OF_USE_PTHREADS, and are only worth it for large symbols.
+ * The default is 1.
+ * This must be done after of_set_fec_parameters().
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_ML_NB_THREADS		1031
+
+/**
+ * Ask the OF library the number of symbol XORs requested while solving the dense system
+ * of the last ML decoding.
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_GET_ML_SYMBOL_XORS		1032
+
+/**
+ * Ask the OF library the number of symbol XORs of the last ML decoding that have not
+ * been executed, thanks to the deferred symbol operations.
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_GET_ML_SAVED_SYMBOL_XORS	1033
+
+/**
+ * Set whether the ML decoder uses inactivation decoding (1): the simplified
+ * system is peeled as far as possible, inactivating a few columns when peeling is stuck,
+ * so that only the inactive columns make a dense system, the other variables being
+ * back-substituted through the sparse equations. With 0 (the default), the whole
+ * simplified system is solved as a dense system.
+ * This must be done after of_set_fec_parameters().
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_ML_INACTIVATION		1034
+
+/**
+ * Set the directory of the on-disk cache of parity check matrices. of_set_fec_parameters()
+ * then loads the matrix from a file of this directory if it has already been generated
+ * for the same parameters (k, n, N1 and seed), or generates it and stores it there.
+ * The files are mapped in memory, checked in O(number of entries) and turned back
+ * into a matrix, without the pseudo-random generation of the entries.
+ * This requires OF_USE_MMAP, and must be done before of_set_fec_parameters().
+ * Argument: char[] (the NUL terminated directory name, length including the NUL)
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_SET_PCHK_CACHE_DIR		1035
+
+/**
+ * Ask the OF library if the parity check matrix has been loaded from the on-disk cache
+ * (1) or generated (0).
+ * Argument: UINT32
+ */
+#define	OF_CRTL_LDPC_STAIRCASE_GET_PCHK_FROM_CACHE		1036
+
 
 #endif  /* OF_CODEC_STABLE_LDPC_SCSTAIRCASE_API */
 
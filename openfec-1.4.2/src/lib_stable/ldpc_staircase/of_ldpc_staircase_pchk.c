@@ -65,6 +65,7 @@ of_mod2sparse* of_create_pchck_matrix_rfc5170_compliant (UINT32		nb_rows,
 	of_mod2sparse	*pchkMatrix = NULL;
 	UINT32		skipCols = 0;		// avoid warning
 	UINT32		nbDataCols = 0;		// avoid warning
+	UINT64		prng_state;		/* PRNG of this matrix, so that sessions can be created concurrently */
 
 	skipCols = nb_rows;
 	nbDataCols = nb_cols - skipCols;
@@ -76,7 +77,7 @@ of_mod2sparse* of_create_pchck_matrix_rfc5170_compliant (UINT32		nb_rows,
 		OF_EXIT_FUNCTION
 		return NULL;
 	}
-	of_rfc5170_srand (seed);
+	of_rfc5170_srand_r (&prng_state, seed);
 	pchkMatrix = of_mod2sparse_allocate (nb_rows, nb_cols);
 	/* create the initial version of the parity check matrix. */
 	/* evenboth make method only */
@@ -103,7 +104,7 @@ of_mod2sparse* of_create_pchck_matrix_rfc5170_compliant (UINT32		nb_rows,
 				/* choose one index within the list of possible choices */
 				do
 				{
-					i = t + of_rfc5170_rand (left_degree * nbDataCols - t);
+					i = t + of_rfc5170_rand_r (&prng_state, left_degree * nbDataCols - t);
 				}
 				while (of_mod2sparse_find (pchkMatrix, u[i], j));
 				of_mod2sparse_insert (pchkMatrix, u[i], j);
@@ -120,14 +121,14 @@ of_mod2sparse* of_create_pchck_matrix_rfc5170_compliant (UINT32		nb_rows,
 				uneven += 1;
 				do
 				{
-					i = of_rfc5170_rand (nb_rows);
+					i = of_rfc5170_rand_r (&prng_state, nb_rows);
 				}
 				while (of_mod2sparse_find (pchkMatrix, i, j));
 				of_mod2sparse_insert (pchkMatrix, i, j);
 			}
 		}
 	}
-	if (uneven > 0 && of_verbosity >= 1)
+	if (uneven > 0 && OF_GET_VERBOSITY () >= 1)
 	{
 		OF_PRINT_LVL(1, ("%s: Had to place %d checks in rows unevenly\n", __FUNCTION__, uneven))
 	}
@@ -139,7 +140,7 @@ of_mod2sparse* of_create_pchck_matrix_rfc5170_compliant (UINT32		nb_rows,
 		e = of_mod2sparse_first_in_row (pchkMatrix, i);
 		if (of_mod2sparse_at_end (e))
 		{
-			j = (of_rfc5170_rand (nbDataCols)) + skipCols;
+			j = (of_rfc5170_rand_r (&prng_state, nbDataCols)) + skipCols;
 			e = of_mod2sparse_insert (pchkMatrix, i, j);
 			added ++;
 		}
@@ -148,7 +149,7 @@ of_mod2sparse* of_create_pchck_matrix_rfc5170_compliant (UINT32		nb_rows,
 		{
 			do
 			{
-				j = (of_rfc5170_rand (nbDataCols)) + skipCols;
+				j = (of_rfc5170_rand_r (&prng_state, nbDataCols)) + skipCols;
 			}
 			while (j == of_mod2sparse_col (e));
 			of_mod2sparse_insert (pchkMatrix, i, j);
@@ -36,6 +36,10 @@
 
 #ifdef OF_USE_REED_SOLOMON_CODEC
 
+#ifdef OF_USE_PTHREADS
+#include <pthread.h>
+#endif
+
 /* VR: added for WIN CE support */
 #ifdef _WIN32_WCE
 #define bzero(to,sz)	memset((to), 0, (sz))
@@ -719,7 +723,11 @@ of_invert_vdm (gf *src, int k)
 	return 0 ;
 }
 
+#ifdef OF_USE_PTHREADS
+static pthread_once_t of_rs_init_control = PTHREAD_ONCE_INIT;
+#else
 static int of_rs_initialized = 0 ;
+#endif
 /* static */
 void		/* VR: removed static */
 of_rs_init()
@@ -733,10 +741,28 @@ of_rs_init()
 	of_rs_init_mul_table();
 	TOCK (ticks[0]);
 	DDB (printf("init_mul_table took %ldus\n", ticks[0]);)
+#ifndef OF_USE_PTHREADS
 	of_rs_initialized = 1 ;
+#endif
 	OF_EXIT_FUNCTION
 }
 
+/*
+ * Initialize the GF tables the first time a codec is created. With threads,
+ * pthread_once() also guarantees that sessions created concurrently wait
+ * until the tables are complete, and then only read them.
+ */
+static void
+of_rs_init_once (void)
+{
+#ifdef OF_USE_PTHREADS
+	pthread_once (&of_rs_init_control, of_rs_init);
+#else
+	if (of_rs_initialized == 0)
+		of_rs_init();
+#endif
+}
+
 /*
  * This section contains the proper FEC encoding/decoding routines.
  * The encoding matrix is computed starting with a Vandermonde matrix,
@@ -793,8 +819,7 @@ of_rs_new (UINT32 k, UINT32 n)
 
 	struct fec_parms *retval ;
 
-	if (of_rs_initialized == 0)
-		of_rs_init();
+	of_rs_init_once();
 
 	if (k > GF_SIZE + 1 || n > GF_SIZE + 1 || k > n)
 	{
@@ -995,6 +1020,63 @@ of_build_decode_matrix (struct fec_parms *code, gf *pkt[], int index[])
 	return matrix ;
 }
 
+/*
+ * Minimum number of bytes of the symbols processed by each decoding thread,
+ * below which the thread creation costs more than it saves.
+ */
+#define OF_RS_MIN_BYTES_PER_THREAD	4096
+
+/*
+ * Byte offset x rounded up to a multiple of 64, capped by sz.
+ */
+static int
+of_rs_align64_min (long long x, int sz)
+{
+	x = (x + 63) & ~63LL;
+	return (x < sz) ? (int) x : sz;
+}
+
+/*
+ * Per thread context, to rebuild a byte range of the missing packets.
+ */
+typedef struct
+{
+	int		k;
+	gf		**pkt;
+	int		*index;
+	gf		*m_dec;
+	gf		**new_pkt;
+	int		offset;
+	int		size;
+#ifdef OF_USE_PTHREADS
+	pthread_t	thread;
+	bool		started;
+#endif
+} of_rs_decode_worker_t;
+
+/*
+ * Rebuild bytes offset to offset + size - 1 of the missing packets.
+ */
+static void *
+of_rs_decode_range (void *arg)
+{
+	of_rs_decode_worker_t	*w = (of_rs_decode_worker_t*) arg;
+	int			row, col, k = w->k;
+
+	for (row = 0 ; row < k ; row++)
+	{
+		if (w->index[row] >= k)
+		{
+			for (col = 0 ; col < k ; col++)
+			{
+				addmul (w->new_pkt[row] + w->offset, w->pkt[col] + w->offset,
+					w->m_dec[row*k + col], w->size) ;
+			}
+		}
+	}
+	return NULL;
+}
+
 /*
  * of_rs_decode receives as input a vector of packets, the indexes of
  * packets, and produces the correct vector as output.
@@ -1005,6 +1087,8 @@ of_build_decode_matrix (struct fec_parms *code, gf *pkt[], int index[])
  *	      to store the output packets (in place)
  *	index: pointer to packet indexes (modified but not updated upon return)
  *	sz:    size of each packet
+ *	nb_threads: number of threads rebuilding the missing packets, each
+ *	      of them on its own byte range (requires OF_USE_PTHREADS)
  */
 /*
  * VR: changed for C++ compilers who don't accept diff in parameters...
@@ -1013,10 +1097,10 @@ of_build_decode_matrix (struct fec_parms *code, gf *pkt[], int index[])
 #define CPLUSPLUS_COMPATIBLE			/* VR: added */
 #ifdef CPLUSPLUS_COMPATIBLE
 of_status_t
-of_rs_decode (void *code_vp, void **pkt_vp, int index[], int sz)
+of_rs_decode (void *code_vp, void **pkt_vp, int index[], int sz, UINT32 nb_threads)
 #else
 int
-of_rs_decode (struct fec_parms *code, gf *pkt[], int index[], int sz)
+of_rs_decode (struct fec_parms *code, gf *pkt[], int index[], int sz, UINT32 nb_threads)
 #endif
 {
 	OF_ENTER_FUNCTION
@@ -1026,7 +1110,9 @@ of_rs_decode (struct fec_parms *code, gf *pkt[], int index[], int sz)
 #endif /* CPLUSPLUS_COMPATIBLE */
 	gf *m_dec ;
 	gf **new_pkt ;
-	int row, col, k = code->k ;
+	of_rs_decode_worker_t *worker ;
+	int row, k = code->k ;
+	int i, nb_workers, nb_ranges, begin, end ;
 
 	if (GF_BITS > 8)
 		sz /= 2 ;
@@ -1054,12 +1140,68 @@ of_rs_decode (struct fec_parms *code, gf *pkt[], int index[], int sz)
 		{
 			new_pkt[row] = (gf *) of_my_malloc (sz * sizeof (gf), "new pkt buffer");
 			bzero (new_pkt[row], sz * sizeof (gf)) ;
-			for (col = 0 ; col < k ; col++)
+		}
+	}
+	/* each worker rebuilds its own byte range of the missing packets */
+	nb_workers = (nb_threads > 0) ? nb_threads : 1;
+	if (nb_workers > sz / OF_RS_MIN_BYTES_PER_THREAD)
+	{
+		nb_workers = (sz / OF_RS_MIN_BYTES_PER_THREAD > 0) ? sz / OF_RS_MIN_BYTES_PER_THREAD : 1;
+	}
+	worker = (of_rs_decode_worker_t *) of_my_malloc (nb_workers * sizeof (of_rs_decode_worker_t), "decode workers");
+	/*
+	 * Worker i rebuilds bytes i * sz / nb_workers to (i + 1) * sz / nb_workers,
+	 * both bounds rounded up to 64 bytes and capped by sz. The workers whose
+	 * range is empty once rounded are dropped.
+	 */
+	for (i = 0, nb_ranges = 0 ; i < nb_workers ; i++)
+	{
+		begin = of_rs_align64_min ((long long) i * sz / nb_workers, sz);
+		end = of_rs_align64_min ((long long) (i + 1) * sz / nb_workers, sz);
+		if (end <= begin)
+		{
+			continue;
+		}
+		worker[nb_ranges].k = k;
+		worker[nb_ranges].pkt = pkt;
+		worker[nb_ranges].index = index;
+		worker[nb_ranges].m_dec = m_dec;
+		worker[nb_ranges].new_pkt = new_pkt;
+		worker[nb_ranges].offset = begin;
+		worker[nb_ranges].size = end - begin;
+		nb_ranges++;
+	}
+	nb_workers = nb_ranges;
+#ifdef OF_USE_PTHREADS
+	if (nb_workers > 1)
+	{
+		for (i = 1 ; i < nb_workers ; i++)
+		{
+			worker[i].started = (pthread_create (&worker[i].thread, NULL, of_rs_decode_range, &worker[i]) == 0);
+			if (!worker[i].started)
 			{
-				addmul (new_pkt[row], pkt[col], m_dec[row*k + col], sz) ;
+				/* do it ourselves */
+				of_rs_decode_range (&worker[i]);
 			}
 		}
+		of_rs_decode_range (&worker[0]);
+		for (i = 1 ; i < nb_workers ; i++)
+		{
+			if (worker[i].started)
+			{
+				pthread_join (worker[i].thread, NULL);
+			}
+		}
+	}
+	else
+#endif
+	{
+		for (i = 0 ; i < nb_workers ; i++)
+		{
+			of_rs_decode_range (&worker[i]);
+		}
 	}
+	free (worker);
 	/*
 	 * move pkts to their final destination
 	 * Warning: this function does not update the index[] table to contain
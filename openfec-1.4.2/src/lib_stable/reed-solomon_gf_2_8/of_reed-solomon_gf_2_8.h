@@ -69,6 +69,7 @@ typedef struct of_rs_cb
 	UINT32		encoding_symbol_length;	/** symbol length. */
 
 	void 		*rs_cb;			/** Reed-Solomon internal codec control block */
+	UINT32		nb_threads;		/** number of threads rebuilding the missing source symbols */
 
 #ifdef OF_USE_DECODER
 	/*
@@ -300,7 +301,7 @@ void		of_rs_init (void) ;
 
 of_status_t	of_rs_encode (void *code, void **src, void *dst,  int index, int sz) ;
 
-of_status_t 	of_rs_decode (void *code,  void **pkt, int index[], int sz) ;
+of_status_t 	of_rs_decode (void *code,  void **pkt, int index[], int sz, UINT32 nb_threads) ;
 
 
 #endif /* OF_REED_SOLOMON_GF_2_8_H */
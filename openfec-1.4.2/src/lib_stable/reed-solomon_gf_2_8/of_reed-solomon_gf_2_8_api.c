@@ -72,6 +72,7 @@ of_status_t of_rs_create_codec_instance (of_rs_cb_t**	of_cb)
 	cb->codec_id			= OF_CODEC_REED_SOLOMON_GF_2_8_STABLE;
 	cb->max_nb_source_symbols	= OF_REED_SOLOMON_MAX_NB_SOURCE_SYMBOLS_DEFAULT;	/* init it immediately... */
 	cb->max_nb_encoding_symbols	= OF_REED_SOLOMON_MAX_NB_ENCODING_SYMBOLS_DEFAULT;	/* init it immediately... */
+	cb->nb_threads			= 1;
 	OF_EXIT_FUNCTION
 	return OF_STATUS_OK;
 }
@@ -111,6 +112,19 @@ of_status_t	of_rs_set_fec_parameters (of_rs_cb_t*		ofcb,
 	ofcb->nb_repair_symbols = params->nb_repair_symbols;
 	ofcb->encoding_symbol_length = params->encoding_symbol_length;
 	ofcb->nb_encoding_symbols = ofcb->nb_source_symbols + ofcb->nb_repair_symbols;
+#ifdef OF_USE_ENCODER
+	if (ofcb->codec_type & OF_ENCODER)
+	{
+		/* initialize the Reed-Solomon internal codec now, so that building repair symbols
+		 * leaves the session untouched and can be done by several threads concurrently */
+		ofcb->rs_cb = of_rs_new (ofcb->nb_source_symbols, ofcb->nb_encoding_symbols);
+		if (ofcb->rs_cb == NULL)
+		{
+			OF_PRINT_ERROR(("of_rs_set_fec_parameters: ERROR, of_rs_new failed"))
+			goto error;
+		}
+	}
+#endif  /* OF_USE_ENCODER */
 #ifdef OF_USE_DECODER
 	ofcb->available_symbols_tab = (void**) of_calloc (ofcb->nb_encoding_symbols, sizeof (void*));
 	ofcb->nb_available_symbols = 0;
@@ -295,6 +309,7 @@ of_status_t	of_rs_finish_decoding (of_rs_cb_t*	ofcb)
 	void		**ars_buf;		/* tmp pointer to the current repair symbol entry in
 						 * available_symbols_tab[] */
 	UINT32		ars_esi;		/* corresponding available repair symbol ESI */
+	void		*rs_cb;			/* Reed-Solomon internal codec used to decode */
 
 	OF_ENTER_FUNCTION
 	if (ofcb->decoding_finished)
@@ -377,16 +392,31 @@ of_status_t	of_rs_finish_decoding (of_rs_cb_t*	ofcb)
 #endif
 	/*
 	 * Let's decode now.
-	 * Create a context first, decode, then release this context.
+	 * Use the context of the encoder if any, otherwise create a context first,
+	 * decode, then release this context.
 	 */
-	ofcb->rs_cb = of_rs_new (ofcb->nb_source_symbols, ofcb->nb_encoding_symbols);
-	if (of_rs_decode (ofcb->rs_cb, (void**)tmp_buf, (int*)tmp_esi, ofcb->encoding_symbol_length) != OF_STATUS_OK)
+	rs_cb = ofcb->rs_cb;
+	if (rs_cb == NULL)
+	{
+		if ((rs_cb = of_rs_new (ofcb->nb_source_symbols, ofcb->nb_encoding_symbols)) == NULL)
+		{
+			OF_PRINT_ERROR(("of_rs_finish_decoding: Error, of_rs_new failed\n"))
+			goto error;
+		}
+	}
+	if (of_rs_decode (rs_cb, (void**)tmp_buf, (int*)tmp_esi, ofcb->encoding_symbol_length, ofcb->nb_threads) != OF_STATUS_OK)
 	{
 		OF_PRINT_ERROR(("of_rs_finish_decoding: Error, of_rs_decode failure\n"))
+		if (rs_cb != ofcb->rs_cb)
+		{
+			of_rs_free (rs_cb);
+		}
 		goto error;
 	}
-	of_rs_free (ofcb->rs_cb);
-	ofcb->rs_cb = NULL;
+	if (rs_cb != ofcb->rs_cb)
+	{
+		of_rs_free (rs_cb);
+	}
 	ofcb->decoding_finished = true;
 #if 0
 	for (tmp_idx = 0; tmp_idx < k; tmp_idx++)
@@ -483,7 +513,36 @@ of_status_t	of_rs_set_control_parameter    (of_rs_cb_t*	ofcb,
 						void*		value,
 						UINT32		length)
 {
-	OF_PRINT_ERROR(("of_rs_set_control_parameter: ERROR, not implemented...\n"))
+	OF_ENTER_FUNCTION
+	switch (type) {
+	case OF_CRTL_REED_SOLOMON_SET_NB_THREADS:
+		if (value == NULL || length != sizeof(UINT32)) {
+			OF_PRINT_ERROR(("%s: OF_CRTL_REED_SOLOMON_SET_NB_THREADS ERROR: null value or bad length (got %d, expected %ld)\n",
+				__FUNCTION__, length, sizeof(UINT32)))
+			goto error;
+		}
+#ifdef OF_USE_PTHREADS
+		if (*(UINT32*)value == 0) {
+#else
+		if (*(UINT32*)value != 1) {
+#endif
+			OF_PRINT_ERROR(("%s: OF_CRTL_REED_SOLOMON_SET_NB_THREADS ERROR: unsupported number of threads (got %d)\n",
+				__FUNCTION__, *(UINT32*)value))
+			goto error;
+		}
+		ofcb->nb_threads = *(UINT32*)value;
+		OF_TRACE_LVL(1, ("%s: OF_CRTL_REED_SOLOMON_SET_NB_THREADS (%d)\n", __FUNCTION__, ofcb->nb_threads))
+		break;
+
+	default:
+		OF_PRINT_ERROR(("%s: unknown type (%d)\n", __FUNCTION__, type))
+		goto error;
+	}
+	OF_EXIT_FUNCTION
+	return OF_STATUS_OK;
+
+error:
+	OF_EXIT_FUNCTION
 	return OF_STATUS_ERROR;
 }
 
@@ -54,6 +54,20 @@ typedef struct of_rs_parameters
 
 } of_rs_parameters_t;
 
+/**
+ * Control parameters for of_set_control_parameter()/of_get_control_parameter() functions
+ * (see of_ldpc_staircase_api.h for the numbering of the codec specific parameters).
+ */
+
+/**
+ * Set the number of threads decoding a block, each of them rebuilding its own byte range
+ * of the missing source symbols. Values above 1 require the library to be built with
+ * OF_USE_PTHREADS, and are only worth it for large symbols. The default is 1.
+ * This must be done after of_set_fec_parameters().
+ * Argument: UINT32
+ */
+#define	OF_CRTL_REED_SOLOMON_SET_NB_THREADS		1024
+
 #endif /* OF_REED_SOLOMON_GF_2_8_API_H */
 
 #endif //#ifdef OF_USE_REED_SOLOMON_CODEC
\ No newline at end of file
@@ -0,0 +1,162 @@
+/* rs_decode_threads_test.c */
+/*
+ * OpenFEC.org AL-FEC Library.
+ * (c) Copyright 2009 INRIA - All rights reserved
+ * Main authors:	Mathieu Cunche (INRIA)
+ *			Jonathan Detchart (INRIA)
+ *			Julien Laboure (INRIA)
+ *			Christoph Neumann (INRIA)
+ *			Vincent Roca (INRIA)
+ * Contact: vincent.roca@inria.fr
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+
+/**
+ * This small program decodes Reed-Solomon blocks whose missing source
+ * symbols are rebuilt by many threads (OF_CRTL_REED_SOLOMON_SET_NB_THREADS),
+ * for symbol sizes which are not multiples of the 64 byte ranges of the
+ * threads, and checks the rebuilt symbols. Without OF_USE_PTHREADS, the
+ * blocks are decoded by a single thread.
+ */
+
+#define OF_USE_ENCODER
+#define OF_USE_DECODER
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/lib_common/of_openfec_api.h"
+#include "../src/lib_common/of_debug.h"
+
+
+#define K		10	/* source symbols */
+#define N		15	/* source + repair symbols */
+#define NB_SIZES	4
+#define NB_THREADS	3
+
+
+int main()
+{
+	static const UINT32	sizes[NB_SIZES] = { 278656, 278657, 300001, 4097 };
+	static const UINT32	threads[NB_THREADS] = { 3, 68, 200 };
+	of_session_t		*ses;
+	of_rs_parameters_t	params;
+	void			*encoding_symb_tab[N];
+	void			*received_tab[N];
+	void			*source_symb_tab[K];
+	UINT32			s, t, i, j, nb_threads;
+
+	for (s = 0; s < NB_SIZES; s++)
+	{
+		for (t = 0; t < NB_THREADS; t++)
+		{
+#ifdef OF_USE_PTHREADS
+			nb_threads = threads[t];
+#else
+			nb_threads = 1;
+#endif
+			printf("symbol size %u, %u threads: ", sizes[s], nb_threads);
+			params.nb_source_symbols = K;
+			params.nb_repair_symbols = N - K;
+			params.encoding_symbol_length = sizes[s];
+
+			for (i = 0; i < N; i++)
+			{
+				encoding_symb_tab[i] = calloc(1, sizes[s]);
+				if (encoding_symb_tab[i] == NULL)
+				{
+					printf("calloc: ERROR, no memory\n");
+					return -1;
+				}
+				for (j = 0; i < K && j < sizes[s]; j++)
+				{
+					((char*)encoding_symb_tab[i])[j] = rand();
+				}
+			}
+
+			/* build the repair symbols */
+			if (of_create_codec_instance(&ses, OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, OF_ENCODER, 0) != OF_STATUS_OK ||
+			    of_set_fec_parameters(ses, (of_parameters_t*)&params) != OF_STATUS_OK)
+			{
+				printf("encoder: ERROR\n");
+				return -1;
+			}
+			for (i = K; i < N; i++)
+			{
+				if (of_build_repair_symbol(ses, encoding_symb_tab, i) != OF_STATUS_OK)
+				{
+					printf("of_build_repair_symbol: ERROR\n");
+					return -1;
+				}
+			}
+			of_release_codec_instance(ses);
+
+			/* the first N - K source symbols are lost */
+			for (i = 0; i < N; i++)
+			{
+				received_tab[i] = (i < N - K) ? NULL : encoding_symb_tab[i];
+			}
+			if (of_create_codec_instance(&ses, OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, OF_DECODER, 0) != OF_STATUS_OK ||
+			    of_set_fec_parameters(ses, (of_parameters_t*)&params) != OF_STATUS_OK ||
+			    of_set_control_parameter(ses, OF_CRTL_REED_SOLOMON_SET_NB_THREADS, &nb_threads, sizeof(nb_threads)) != OF_STATUS_OK ||
+			    of_set_available_symbols(ses, received_tab) != OF_STATUS_OK ||
+			    of_finish_decoding(ses) != OF_STATUS_OK ||
+			    !of_is_decoding_complete(ses))
+			{
+				printf("decoder: ERROR\n");
+				return -1;
+			}
+			memset(source_symb_tab, 0, sizeof(source_symb_tab));
+			if (of_get_source_symbols_tab(ses, source_symb_tab) != OF_STATUS_OK)
+			{
+				printf("of_get_source_symbols_tab: ERROR\n");
+				return -1;
+			}
+			for (i = 0; i < K; i++)
+			{
+				if (source_symb_tab[i] == NULL ||
+				    memcmp(source_symb_tab[i], encoding_symb_tab[i], sizes[s]) != 0)
+				{
+					printf("source symbol %u: FAILURE\n", i);
+					return -1;
+				}
+				if (i < N - K)
+				{
+					free(source_symb_tab[i]);
+				}
+			}
+			of_release_codec_instance(ses);
+			for (i = 0; i < N; i++)
+			{
+				free(encoding_symb_tab[i]);
+			}
+			printf("ok\n");
+		}
+	}
+	printf("OK\n");
+	return 0;
+}
@@ -1,6 +1,19 @@
 #!/bin/sh
 build/linux/benchmark/kodo_storage/kodo_storage $@
 build/linux/benchmark/isa_throughput/isa_throughput $@
+build/linux/benchmark/isa_repair/isa_repair $@
+# The intrinsics kernels are only built for x86 CPUs
+case "$(uname -m)" in
+    x86_64|i?86) build/linux/benchmark/isa_intrinsics/isa_intrinsics $@ ;;
+esac
+# The fixed geometry encoders are only built with ISA and at least SSSE3
+if [ -x build/linux/benchmark/isa_fixed/isa_fixed ]; then
+    build/linux/benchmark/isa_fixed/isa_fixed $@
+fi
 #build/linux/benchmark/jerasure_throughput/jerasure_throughput $@
+build/linux/benchmark/cauchy_throughput/cauchy_throughput $@
 build/linux/benchmark/openfec_throughput/openfec_throughput $@
+build/linux/benchmark/openfec_session_setup/openfec_session_setup $@
+build/linux/benchmark/openfec_concurrent/openfec_concurrent $@
+build/linux/benchmark/openfec_object/openfec_object $@
 